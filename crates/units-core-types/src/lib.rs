@@ -53,6 +53,9 @@ pub use transaction::{
 pub use scheduler::{
     ConflictChecker,
     BasicConflictChecker,
+    IndexedConflictChecker,
+    AccessSet,
+    ConflictGraph,
 };
 
 // Re-export proof types
@@ -75,6 +78,12 @@ pub use storage::{
     ReceiptStorage,
     LockManager,
     UnitsStorageStruct,
+    ObjectPage,
+    PagedObjects,
+    ReceiptCursor,
+    ReceiptPage,
+    DEFAULT_PAGE_SIZE,
+    page_read_len,
 };
 
 // Re-export unified storage trait
@@ -87,6 +96,7 @@ pub use runtime::Runtime;
 pub use vm_executor::{
     VMExecutor,
     ExecutionContext,
+    ExecutionMetrics,
     ObjectEffect,
     VMExecutionError,
     validate_object_effects,
@@ -3,7 +3,7 @@ use serde::{Deserialize, Serialize};
 use crate::Proof;
 
 /// VM types for executable objects
-#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize, Deserialize)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Serialize, Deserialize)]
 #[non_exhaustive]
 pub enum VMType {
     /// RISC-V ELF shared objects (primary implementation)
@@ -11,7 +11,7 @@ pub enum VMType {
 }
 
 /// Object type distinguishing data from executable objects
-#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
+#[derive(Debug, Clone, PartialEq, Eq, Hash, Serialize, Deserialize)]
 pub enum ObjectType {
     /// Data object - not executable
     Data,
@@ -14,7 +14,7 @@ pub type SlotNumber = u64;
 ///
 /// This proof commits to the state of a UnitsObject at a particular slot,
 /// and optionally links to a previous proof to form a chain of state changes.
-#[derive(Debug, Clone, Serialize, Deserialize)]
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
 pub struct UnitsObjectProof {
     /// The UnitsObjectId this proof is for
     pub object_id: UnitsObjectId,
@@ -90,7 +90,7 @@ impl UnitsObjectProof {
 ///
 /// State proofs commit to the collective state of the system at a point in time,
 /// and form a chain that can be used to verify the evolution of the system state.
-#[derive(Debug, Clone, Serialize, Deserialize)]
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
 pub struct StateProof {
     /// The slot number this state proof is for
     pub slot: SlotNumber,
@@ -11,7 +11,7 @@ use crate::transaction::{
 use std::collections::HashMap;
 
 // Forward declare types that will be defined in vm_executor module
-use crate::vm_executor::{ExecutionContext, VMExecutionError, VMExecutor, ObjectEffect};
+use crate::vm_executor::{ExecutionContext, ExecutionMetrics, VMExecutionError, VMExecutor, ObjectEffect};
 use crate::verification::Verifier;
 
 /// Runtime for executing transactions and programs in the UNITS system
@@ -26,6 +26,44 @@ pub trait Runtime {
     /// Execute a transaction and return a transaction receipt with proofs
     fn execute_transaction(&self, transaction: Transaction) -> TransactionReceipt;
 
+    /// Execute a transaction against input objects the caller already loaded
+    ///
+    /// `objects` holds every controller and target object the instructions
+    /// name, so nothing is fetched again. Instructions run in order through
+    /// `execute_instruction_metered`; the first failure fails the transaction.
+    fn execute_transaction_with_objects(
+        &self,
+        transaction: Transaction,
+        mut objects: HashMap<UnitsObjectId, UnitsObject>,
+        slot: u64,
+        timestamp: u64,
+    ) -> TransactionReceipt {
+        let mut receipt = TransactionReceipt::new(transaction.hash, slot, true, timestamp);
+        let last = transaction.instructions.len().saturating_sub(1);
+        for (i, instruction) in transaction.instructions.iter().enumerate() {
+            // Only earlier instructions need their own copy of the inputs
+            let inputs = if i == last { std::mem::take(&mut objects) } else { objects.clone() };
+            match self.execute_instruction_metered(instruction, inputs, slot, timestamp) {
+                Ok((effects, metrics)) => {
+                    receipt.record_execution(&metrics);
+                    for effect in effects {
+                        receipt.add_object_effect(
+                            transaction.hash,
+                            effect.object_id,
+                            effect.before_image,
+                            effect.after_image,
+                        );
+                    }
+                }
+                Err(e) => {
+                    receipt.set_error(e.to_string());
+                    break;
+                }
+            }
+        }
+        receipt
+    }
+
     /// Try to execute a transaction with conflict checking
     fn try_execute_transaction(
         &self,
@@ -60,6 +98,18 @@ pub trait Runtime {
         slot: u64,
         timestamp: u64,
     ) -> Result<Vec<ObjectEffect>, VMExecutionError> {
+        self.execute_instruction_metered(instruction, objects, slot, timestamp)
+            .map(|(effects, _)| effects)
+    }
+
+    /// Execute a program call instruction, reporting instruction count and wall time
+    fn execute_instruction_metered(
+        &self,
+        instruction: &Instruction,
+        objects: HashMap<UnitsObjectId, UnitsObject>,
+        slot: u64,
+        timestamp: u64,
+    ) -> Result<(Vec<ObjectEffect>, ExecutionMetrics), VMExecutionError> {
         // Get the controller object 
         let controller = objects.get(&instruction.controller_id)
             .ok_or_else(|| VMExecutionError::InvalidBytecode("Controller object not found".to_string()))?
@@ -82,7 +132,7 @@ pub trait Runtime {
         );
 
         // Execute the instruction
-        executor.load_and_execute(controller.data(), &context)
+        executor.load_and_execute_metered(controller.data(), &context)
     }
 
     //--------------------------------------------------------------------------
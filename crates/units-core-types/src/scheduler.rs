@@ -1,6 +1,9 @@
-use std::collections::HashSet;
+use std::collections::{BTreeMap, HashMap, HashSet};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Mutex, RwLock};
 use crate::id::UnitsObjectId;
-use crate::transaction::{ConflictResult, Transaction};
+use crate::proofs::SlotNumber;
+use crate::transaction::{ConflictResult, Transaction, TransactionHash};
 
 /// Trait for transaction conflict checking
 pub trait ConflictChecker {
@@ -100,4 +103,502 @@ impl ConflictChecker for BasicConflictChecker {
             Ok(ConflictResult::Conflict(conflicts))
         }
     }
-}
\ No newline at end of file
+}
+
+//==============================================================================
+// CONFLICT GRAPH SCHEDULING
+//==============================================================================
+
+/// Objects a transaction reads and writes
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct AccessSet {
+    /// Objects only read (including controllers)
+    pub reads: HashSet<UnitsObjectId>,
+    /// Objects that may be modified
+    pub writes: HashSet<UnitsObjectId>,
+}
+
+impl AccessSet {
+    /// Derive the access set of `transaction` using the checker's write-set rules
+    pub fn of<C: ConflictChecker + ?Sized>(checker: &C, transaction: &Transaction) -> Self {
+        let writes = checker.extract_write_objects(transaction);
+        let reads = transaction
+            .instructions
+            .iter()
+            .flat_map(|instruction| {
+                std::iter::once(&instruction.controller_id).chain(&instruction.target_objects)
+            })
+            .filter(|id| !writes.contains(*id))
+            .copied()
+            .collect();
+        Self { reads, writes }
+    }
+}
+
+/// Dependency graph over a batch of transactions
+///
+/// Transactions are placed in a canonical order (by hash, then by position)
+/// and each one depends on the earlier transactions it conflicts with: the
+/// last writer of anything it touches, and for writes, every reader since
+/// that writer. Conflicting transactions therefore always run in canonical
+/// order and the outcome does not depend on thread timing.
+#[derive(Debug, Clone)]
+pub struct ConflictGraph {
+    /// Input indices in canonical execution order
+    order: Vec<usize>,
+    /// Direct dependencies of each transaction, by input index
+    dependencies: Vec<Vec<usize>>,
+    /// Direct dependents of each transaction, by input index
+    dependents: Vec<Vec<usize>>,
+}
+
+impl ConflictGraph {
+    /// Build the graph for `transactions` using the checker's write-set rules
+    pub fn build<C: ConflictChecker + ?Sized>(checker: &C, transactions: &[Transaction]) -> Self {
+        let mut order: Vec<usize> = (0..transactions.len()).collect();
+        order.sort_by(|a, b| transactions[*a].hash.cmp(&transactions[*b].hash).then(a.cmp(b)));
+
+        #[derive(Default)]
+        struct ObjectState {
+            last_writer: Option<usize>,
+            readers: Vec<usize>,
+        }
+
+        let mut objects: HashMap<UnitsObjectId, ObjectState> = HashMap::new();
+        let mut dependencies = vec![Vec::new(); transactions.len()];
+        let mut dependents = vec![Vec::new(); transactions.len()];
+
+        for &node in &order {
+            let access = AccessSet::of(checker, &transactions[node]);
+            let mut deps = HashSet::new();
+
+            for id in &access.reads {
+                let state = objects.entry(*id).or_default();
+                deps.extend(state.last_writer);
+                state.readers.push(node);
+            }
+            for id in &access.writes {
+                let state = objects.entry(*id).or_default();
+                deps.extend(state.last_writer);
+                deps.extend(state.readers.drain(..));
+                state.last_writer = Some(node);
+            }
+
+            deps.remove(&node);
+            let mut deps: Vec<usize> = deps.into_iter().collect();
+            deps.sort_unstable();
+            for &dep in &deps {
+                dependents[dep].push(node);
+            }
+            dependencies[node] = deps;
+        }
+
+        Self { order, dependencies, dependents }
+    }
+
+    /// Number of transactions in the graph
+    pub fn len(&self) -> usize {
+        self.order.len()
+    }
+
+    /// Whether the graph is empty
+    pub fn is_empty(&self) -> bool {
+        self.order.is_empty()
+    }
+
+    /// Input indices in canonical execution order
+    pub fn order(&self) -> &[usize] {
+        &self.order
+    }
+
+    /// Direct dependencies of the transaction at input index `node`
+    pub fn dependencies(&self, node: usize) -> &[usize] {
+        &self.dependencies[node]
+    }
+
+    /// Group transactions into waves whose members never conflict
+    ///
+    /// Every transaction lands one wave after its latest dependency; within a
+    /// wave, indices are in canonical order.
+    pub fn waves(&self) -> Vec<Vec<usize>> {
+        let mut level = vec![0usize; self.len()];
+        let mut waves: Vec<Vec<usize>> = Vec::new();
+        for &node in &self.order {
+            // Dependencies always precede a node in canonical order
+            let wave = self.dependencies[node]
+                .iter()
+                .map(|dep| level[*dep] + 1)
+                .max()
+                .unwrap_or(0);
+            level[node] = wave;
+            if waves.len() <= wave {
+                waves.resize_with(wave + 1, Vec::new);
+            }
+            waves[wave].push(node);
+        }
+        waves
+    }
+
+    /// Run `task` for every transaction on the current rayon pool
+    ///
+    /// That is the global pool unless called inside `ThreadPool::install`.
+    /// A transaction is spawned once all of its dependencies have finished;
+    /// rayon's workers steal from each other and park when there is nothing
+    /// to run. Results are returned by input index.
+    pub fn execute<R, F>(&self, task: F) -> Vec<R>
+    where
+        R: Send,
+        F: Fn(usize) -> R + Sync,
+    {
+        let node_count = self.len();
+        if node_count <= 1 || rayon::current_num_threads() == 1 {
+            let mut results: Vec<Option<R>> = (0..node_count).map(|_| None).collect();
+            for &node in &self.order {
+                results[node] = Some(task(node));
+            }
+            return results.into_iter().map(|r| r.expect("every node executes")).collect();
+        }
+
+        let pending: Vec<AtomicUsize> = self
+            .dependencies
+            .iter()
+            .map(|deps| AtomicUsize::new(deps.len()))
+            .collect();
+        let results: Vec<Mutex<Option<R>>> = (0..node_count).map(|_| Mutex::new(None)).collect();
+
+        // Spawn the roots in canonical order; a panic resurfaces once the scope drains
+        rayon::scope(|scope| {
+            for &node in self.order.iter().filter(|node| self.dependencies[**node].is_empty()) {
+                self.spawn_node(scope, node, &task, &pending, &results);
+            }
+        });
+
+        results
+            .into_iter()
+            .map(|slot| slot.into_inner().unwrap().expect("every node executes"))
+            .collect()
+    }
+
+    /// Run `node`, then spawn each dependent whose last dependency it was
+    fn spawn_node<'scope, R, F>(
+        &'scope self,
+        scope: &rayon::Scope<'scope>,
+        node: usize,
+        task: &'scope F,
+        pending: &'scope [AtomicUsize],
+        results: &'scope [Mutex<Option<R>>],
+    ) where
+        R: Send,
+        F: Fn(usize) -> R + Sync,
+    {
+        scope.spawn(move |scope| {
+            *results[node].lock().unwrap() = Some(task(node));
+            for &dependent in &self.dependents[node] {
+                if pending[dependent].fetch_sub(1, Ordering::AcqRel) == 1 {
+                    self.spawn_node(scope, dependent, task, pending, results);
+                }
+            }
+        });
+    }
+}
+
+//==============================================================================
+// INDEXED CONFLICT DETECTION
+//==============================================================================
+
+/// In-flight transactions touching a single object, by intent
+#[derive(Debug, Default)]
+struct ObjectIntents {
+    readers: HashSet<TransactionHash>,
+    writers: HashSet<TransactionHash>,
+}
+
+impl ObjectIntents {
+    fn is_empty(&self) -> bool {
+        self.readers.is_empty() && self.writers.is_empty()
+    }
+}
+
+/// A transaction held in the index
+#[derive(Debug)]
+struct TrackedTransaction {
+    slot: SlotNumber,
+    access: AccessSet,
+}
+
+#[derive(Debug, Default)]
+struct ConflictIndex {
+    objects: HashMap<UnitsObjectId, ObjectIntents>,
+    transactions: HashMap<TransactionHash, TrackedTransaction>,
+    slots: BTreeMap<SlotNumber, HashSet<TransactionHash>>,
+}
+
+impl ConflictIndex {
+    /// Hashes of tracked transactions that conflict with `access`
+    ///
+    /// A write conflicts with any reader or writer of the object; a read
+    /// conflicts only with writers.
+    fn conflicts(&self, hash: &TransactionHash, access: &AccessSet) -> Vec<TransactionHash> {
+        let mut conflicts = HashSet::new();
+        for id in &access.writes {
+            if let Some(intents) = self.objects.get(id) {
+                conflicts.extend(intents.writers.iter().chain(&intents.readers).copied());
+            }
+        }
+        for id in &access.reads {
+            if let Some(intents) = self.objects.get(id) {
+                conflicts.extend(intents.writers.iter().copied());
+            }
+        }
+        conflicts.remove(hash);
+
+        let mut conflicts: Vec<_> = conflicts.into_iter().collect();
+        conflicts.sort_unstable();
+        conflicts
+    }
+
+    fn insert(&mut self, hash: TransactionHash, slot: SlotNumber, access: AccessSet) {
+        // Re-registering replaces the previous entry
+        self.remove(&hash);
+
+        for id in &access.writes {
+            self.objects.entry(*id).or_default().writers.insert(hash);
+        }
+        for id in &access.reads {
+            self.objects.entry(*id).or_default().readers.insert(hash);
+        }
+        self.slots.entry(slot).or_default().insert(hash);
+        self.transactions.insert(hash, TrackedTransaction { slot, access });
+    }
+
+    fn remove(&mut self, hash: &TransactionHash) -> bool {
+        let Some(tracked) = self.transactions.remove(hash) else {
+            return false;
+        };
+
+        for id in tracked.access.writes.iter().chain(&tracked.access.reads) {
+            if let Some(intents) = self.objects.get_mut(id) {
+                intents.writers.remove(hash);
+                intents.readers.remove(hash);
+                if intents.is_empty() {
+                    self.objects.remove(id);
+                }
+            }
+        }
+        if let Some(hashes) = self.slots.get_mut(&tracked.slot) {
+            hashes.remove(hash);
+            if hashes.is_empty() {
+                self.slots.remove(&tracked.slot);
+            }
+        }
+        true
+    }
+}
+
+/// Conflict checker backed by an object-id index of in-flight transactions
+///
+/// Transactions are registered with their read/write intent when they are
+/// admitted and evicted when they commit or their slot finalizes. A check
+/// only visits the transaction's own objects, so it costs time proportional
+/// to the transaction's size rather than to the number of in-flight
+/// transactions.
+#[derive(Debug, Default)]
+pub struct IndexedConflictChecker {
+    index: RwLock<ConflictIndex>,
+}
+
+impl IndexedConflictChecker {
+    /// Create an empty checker
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Check `transaction` against the in-flight transactions in the index
+    pub fn check(&self, transaction: &Transaction) -> ConflictResult {
+        let access = AccessSet::of(self, transaction);
+        if access.writes.is_empty() {
+            return ConflictResult::ReadOnly;
+        }
+
+        let conflicts = self.index.read().unwrap().conflicts(&transaction.hash, &access);
+        if conflicts.is_empty() {
+            ConflictResult::NoConflict
+        } else {
+            ConflictResult::Conflict(conflicts)
+        }
+    }
+
+    /// Register `transaction` as in flight for `slot`, regardless of conflicts
+    pub fn register(&self, transaction: &Transaction, slot: SlotNumber) {
+        let access = AccessSet::of(self, transaction);
+        self.index.write().unwrap().insert(transaction.hash, slot, access);
+    }
+
+    /// Check and register `transaction` atomically
+    ///
+    /// The transaction is only registered if it does not conflict; the
+    /// returned result is the same as `check` would have produced.
+    pub fn try_admit(&self, transaction: &Transaction, slot: SlotNumber) -> ConflictResult {
+        let access = AccessSet::of(self, transaction);
+        let read_only = access.writes.is_empty();
+
+        let mut index = self.index.write().unwrap();
+        let conflicts = index.conflicts(&transaction.hash, &access);
+        if !conflicts.is_empty() {
+            return ConflictResult::Conflict(conflicts);
+        }
+        index.insert(transaction.hash, slot, access);
+
+        if read_only {
+            ConflictResult::ReadOnly
+        } else {
+            ConflictResult::NoConflict
+        }
+    }
+
+    /// Evict a committed (or abandoned) transaction; returns whether it was tracked
+    pub fn commit(&self, hash: &TransactionHash) -> bool {
+        self.index.write().unwrap().remove(hash)
+    }
+
+    /// Evict every transaction registered for `slot` or any earlier slot
+    ///
+    /// Returns the number of transactions evicted.
+    pub fn finalize_slot(&self, slot: SlotNumber) -> usize {
+        let mut index = self.index.write().unwrap();
+        let finalized: Vec<SlotNumber> = index.slots.range(..=slot).map(|(slot, _)| *slot).collect();
+
+        let mut evicted = 0;
+        for slot in finalized {
+            if let Some(hashes) = index.slots.remove(&slot) {
+                for hash in hashes {
+                    evicted += usize::from(index.remove(&hash));
+                }
+            }
+        }
+        evicted
+    }
+
+    /// Whether `hash` is currently tracked
+    pub fn contains(&self, hash: &TransactionHash) -> bool {
+        self.index.read().unwrap().transactions.contains_key(hash)
+    }
+
+    /// Number of tracked transactions
+    pub fn len(&self) -> usize {
+        self.index.read().unwrap().transactions.len()
+    }
+
+    /// Whether no transactions are tracked
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+}
+
+impl ConflictChecker for IndexedConflictChecker {
+    /// Check against the index; `recent_transactions` is ignored since the
+    /// index already covers every in-flight transaction
+    fn check_conflicts(
+        &self,
+        transaction: &Transaction,
+        _recent_transactions: &[Transaction],
+    ) -> Result<ConflictResult, String> {
+        Ok(self.check(transaction))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::transaction::Instruction;
+
+    fn tx(seed: u8, writes: &[u8]) -> Transaction {
+        let instruction = Instruction::new(
+            UnitsObjectId::new([200u8; 32]),
+            "transfer".to_string(),
+            writes.iter().map(|b| UnitsObjectId::new([*b; 32])).collect(),
+            Vec::new(),
+        );
+        Transaction::new(vec![instruction], [seed; 32])
+    }
+
+    #[test]
+    fn test_conflict_graph_orders_by_hash() {
+        // Input order is reversed relative to hash order
+        let transactions = vec![tx(3, &[1]), tx(2, &[2]), tx(1, &[1, 2])];
+        let graph = ConflictGraph::build(&BasicConflictChecker::new(), &transactions);
+
+        assert_eq!(graph.order(), &[2, 1, 0]);
+        assert!(graph.dependencies(2).is_empty());
+        assert_eq!(graph.dependencies(1), &[2]);
+        assert_eq!(graph.dependencies(0), &[2]);
+        assert_eq!(graph.waves(), vec![vec![2], vec![1, 0]]);
+    }
+
+    #[test]
+    fn test_shared_controller_is_not_a_conflict() {
+        let transactions = vec![tx(1, &[1]), tx(2, &[2]), tx(3, &[3])];
+        let graph = ConflictGraph::build(&BasicConflictChecker::new(), &transactions);
+        assert_eq!(graph.waves().len(), 1);
+    }
+
+    #[test]
+    fn test_parallel_execute_respects_dependencies() {
+        // A chain on object 1 interleaved with independent transactions
+        let transactions: Vec<_> = (0..64u8)
+            .map(|i| if i % 2 == 0 { tx(i, &[1]) } else { tx(i, &[i]) })
+            .collect();
+        let graph = ConflictGraph::build(&BasicConflictChecker::new(), &transactions);
+
+        let executed = Mutex::new(Vec::new());
+        let pool = rayon::ThreadPoolBuilder::new().num_threads(4).build().unwrap();
+        let results = pool.install(|| {
+            graph.execute(|node| {
+                executed.lock().unwrap().push(node);
+                transactions[node].hash[0]
+            })
+        });
+
+        let executed = executed.into_inner().unwrap();
+        assert_eq!(executed.len(), 64);
+        let chain: Vec<_> = executed.iter().filter(|n| **n % 2 == 0).copied().collect();
+        assert_eq!(chain, (0..64).step_by(2).collect::<Vec<_>>());
+        assert_eq!(results, (0..64u8).collect::<Vec<_>>());
+    }
+
+    #[test]
+    fn test_indexed_checker_read_write_intent() {
+        let checker = IndexedConflictChecker::new();
+        let writer = tx(1, &[1]);
+        assert!(matches!(checker.try_admit(&writer, 5), ConflictResult::NoConflict));
+
+        // Writing the same object conflicts; a disjoint write does not
+        match checker.try_admit(&tx(2, &[1, 2]), 5) {
+            ConflictResult::Conflict(conflicts) => assert_eq!(conflicts, vec![writer.hash]),
+            other => panic!("expected conflict, got {:?}", other),
+        }
+        assert!(matches!(checker.try_admit(&tx(3, &[3]), 5), ConflictResult::NoConflict));
+        assert!(!checker.contains(&[2u8; 32]));
+
+        // Controllers are read-only, so sharing one is not a conflict
+        assert_eq!(checker.len(), 2);
+
+        // Once committed the object is free again
+        assert!(checker.commit(&writer.hash));
+        assert!(matches!(checker.check(&tx(2, &[1, 2])), ConflictResult::NoConflict));
+    }
+
+    #[test]
+    fn test_indexed_checker_evicts_finalized_slots() {
+        let checker = IndexedConflictChecker::new();
+        checker.register(&tx(1, &[1]), 1);
+        checker.register(&tx(2, &[2]), 2);
+        checker.register(&tx(3, &[3]), 3);
+
+        assert_eq!(checker.finalize_slot(2), 2);
+        assert_eq!(checker.len(), 1);
+        assert!(checker.contains(&[3u8; 32]));
+        assert!(matches!(checker.check(&tx(4, &[1, 2])), ConflictResult::NoConflict));
+        assert!(matches!(checker.check(&tx(4, &[3])), ConflictResult::Conflict(_)));
+    }
+}
@@ -16,10 +16,179 @@
 use std::collections::HashMap;
 use crate::error::StorageError;
 use crate::id::UnitsObjectId;
-use crate::objects::UnitsObject;
+use crate::objects::{ObjectType, UnitsObject};
 use crate::{SlotNumber, StateProof, UnitsObjectProof};
 use crate::transaction::TransactionReceipt;
 
+//==============================================================================
+// PAGINATION
+//==============================================================================
+
+/// Entries to read for a page of `limit`, including the one that only
+/// signals a further page
+///
+/// A zero limit is read as 1: an empty page has no last entry to continue
+/// from, so it could never report that more remain.
+pub fn page_read_len(limit: usize) -> usize {
+    limit.max(1).saturating_add(1)
+}
+
+/// One page of a cursor-paginated object query
+///
+/// Objects are in id order. Pass `next_cursor` back as the cursor to fetch
+/// the following page; it is `None` on the last page.
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct ObjectPage {
+    pub objects: Vec<UnitsObject>,
+    pub next_cursor: Option<UnitsObjectId>,
+}
+
+impl ObjectPage {
+    /// Build a page from up to `page_read_len(limit)` objects in id order
+    ///
+    /// The extra object only signals that another page exists. A zero
+    /// `limit` is read as 1.
+    pub fn from_sorted(mut objects: Vec<UnitsObject>, limit: usize) -> Self {
+        let limit = limit.max(1);
+        let next_cursor = if objects.len() > limit {
+            objects.truncate(limit);
+            objects.last().map(|object| object.id)
+        } else {
+            None
+        };
+        Self { objects, next_cursor }
+    }
+}
+
+/// Position of a receipt in (slot, transaction hash) order
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub struct ReceiptCursor {
+    pub slot: SlotNumber,
+    pub transaction_hash: [u8; 32],
+}
+
+impl ReceiptCursor {
+    pub fn of(receipt: &TransactionReceipt) -> Self {
+        Self { slot: receipt.slot, transaction_hash: receipt.transaction_hash }
+    }
+}
+
+/// One page of a cursor-paginated receipt query
+///
+/// Receipts are in (slot, transaction hash) order. Pass `next_cursor` back
+/// as the cursor to fetch the following page; it is `None` on the last page.
+#[derive(Debug, Clone, Default)]
+pub struct ReceiptPage {
+    pub receipts: Vec<TransactionReceipt>,
+    pub next_cursor: Option<ReceiptCursor>,
+}
+
+impl ReceiptPage {
+    /// Build a page from up to `page_read_len(limit)` receipts in cursor order
+    ///
+    /// The extra receipt only signals that another page exists. A zero
+    /// `limit` is read as 1.
+    pub fn from_sorted(mut receipts: Vec<TransactionReceipt>, limit: usize) -> Self {
+        let limit = limit.max(1);
+        let next_cursor = if receipts.len() > limit {
+            receipts.truncate(limit);
+            receipts.last().map(ReceiptCursor::of)
+        } else {
+            None
+        };
+        Self { receipts, next_cursor }
+    }
+
+    /// Page of `receipts`, in any order, that come after `cursor`
+    fn select(mut receipts: Vec<TransactionReceipt>, cursor: Option<&ReceiptCursor>, limit: usize) -> Self {
+        receipts.retain(|receipt| cursor.map_or(true, |cursor| ReceiptCursor::of(receipt) > *cursor));
+        receipts.sort_by_key(ReceiptCursor::of);
+        receipts.truncate(page_read_len(limit));
+        Self::from_sorted(receipts, limit)
+    }
+}
+
+/// Objects fetched per page by `PagedObjects`
+pub const DEFAULT_PAGE_SIZE: usize = 1024;
+
+/// Streaming iterator over `ObjectStorage::list`
+///
+/// Holds at most one page of objects at a time and resumes from the last
+/// id seen, so storage locks are only held while a page is read. The walk
+/// is not a point-in-time snapshot: objects written behind the cursor
+/// during iteration are not revisited.
+pub struct PagedObjects<'a, S: ObjectStorage + ?Sized> {
+    storage: &'a S,
+    page_size: usize,
+    cursor: Option<UnitsObjectId>,
+    page: std::vec::IntoIter<UnitsObject>,
+    done: bool,
+}
+
+impl<'a, S: ObjectStorage + ?Sized> PagedObjects<'a, S> {
+    /// Iterate `storage` in id order, `page_size` objects per page
+    pub fn new(storage: &'a S, page_size: usize) -> Self {
+        Self {
+            storage,
+            page_size: page_size.max(1),
+            cursor: None,
+            page: Vec::new().into_iter(),
+            done: false,
+        }
+    }
+
+    /// Resume after `cursor` instead of starting from the first object
+    pub fn after(mut self, cursor: UnitsObjectId) -> Self {
+        self.cursor = Some(cursor);
+        self
+    }
+}
+
+impl<S: ObjectStorage + ?Sized> Iterator for PagedObjects<'_, S> {
+    type Item = Result<UnitsObject, StorageError>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        loop {
+            if let Some(object) = self.page.next() {
+                return Some(Ok(object));
+            }
+            if self.done {
+                return None;
+            }
+            match self.storage.list(self.cursor.as_ref(), self.page_size) {
+                Ok(page) => {
+                    self.done = page.next_cursor.is_none();
+                    self.cursor = page.next_cursor;
+                    self.page = page.objects.into_iter();
+                }
+                Err(e) => {
+                    self.done = true;
+                    return Some(Err(e));
+                }
+            }
+        }
+    }
+}
+
+/// Page of the objects yielded by `objects` that match `filter`, by full scan
+fn scan_page<'a>(
+    objects: Box<dyn Iterator<Item = Result<UnitsObject, StorageError>> + 'a>,
+    filter: impl Fn(&UnitsObject) -> bool,
+    cursor: Option<&UnitsObjectId>,
+    limit: usize,
+) -> Result<ObjectPage, StorageError> {
+    let mut matching = Vec::new();
+    for object in objects {
+        let object = object?;
+        if cursor.map_or(true, |cursor| object.id > *cursor) && filter(&object) {
+            matching.push(object);
+        }
+    }
+    matching.sort_by_key(|object| object.id);
+    matching.truncate(page_read_len(limit));
+    Ok(ObjectPage::from_sorted(matching, limit))
+}
+
 //==============================================================================
 // CORE STORAGE TRAIT
 //==============================================================================
@@ -55,6 +224,14 @@ pub trait ObjectStorage: Send + Sync {
         Ok(self.get(id)?.is_some())
     }
     
+    /// Get several objects at once, in the order of `ids`
+    /// 
+    /// The default calls `get` per id; backends override it to batch lock
+    /// acquisitions and reads.
+    fn get_many(&self, ids: &[UnitsObjectId]) -> Result<Vec<Option<UnitsObject>>, StorageError> {
+        ids.iter().map(|id| self.get(id)).collect()
+    }
+    
     //--------------------------------------------------------------------------
     // BATCH OPERATIONS
     //--------------------------------------------------------------------------
@@ -107,6 +284,45 @@ pub trait ObjectStorage: Send + Sync {
             result.as_ref().map(|obj| filter(obj)).unwrap_or(true)
         }))
     }
+    
+    /// Page of all objects after `cursor` in id order
+    /// 
+    /// The default scans every object; ordered implementations override it.
+    fn list(
+        &self,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        scan_page(self.iter(), |_| true, cursor, limit)
+    }
+    
+    //--------------------------------------------------------------------------
+    // SECONDARY INDEXES
+    //--------------------------------------------------------------------------
+    
+    /// Page of objects controlled by `controller_id`, after `cursor` in id order
+    /// 
+    /// The default scans every object; indexed implementations override it.
+    fn get_by_controller(
+        &self,
+        controller_id: &UnitsObjectId,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        scan_page(self.iter(), |object| object.controller_id == *controller_id, cursor, limit)
+    }
+    
+    /// Page of objects of `object_type`, after `cursor` in id order
+    /// 
+    /// The default scans every object; indexed implementations override it.
+    fn get_by_type(
+        &self,
+        object_type: &ObjectType,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        scan_page(self.iter(), |object| object.object_type == *object_type, cursor, limit)
+    }
 }
 
 //==============================================================================
@@ -117,7 +333,10 @@ pub trait ObjectStorage: Send + Sync {
 /// 
 /// This trait adds time-travel capabilities to basic storage
 pub trait HistoricalStorage: ObjectStorage {
-    /// Get an object at a specific historical slot
+    /// Get an object as it was at a specific historical slot
+    ///
+    /// Returns the newest version written at or before `slot`, or `None` if
+    /// the object did not exist yet or had been deleted by then.
     fn get_at_slot(
         &self,
         id: &UnitsObjectId,
@@ -133,6 +352,9 @@ pub trait HistoricalStorage: ObjectStorage {
     ) -> Result<Vec<(SlotNumber, UnitsObject)>, StorageError>;
     
     /// Compact historical data before a specific slot
+    ///
+    /// Drops versions no `get_at_slot` query at or after `before_slot` can
+    /// return, and returns how many were dropped.
     fn compact_history(
         &self,
         before_slot: SlotNumber,
@@ -261,6 +483,30 @@ pub trait ReceiptStorage: Send + Sync {
         &self,
         slot: SlotNumber,
     ) -> Result<usize, StorageError>;
+    
+    /// Page of receipts within a slot range, starting after `cursor`
+    ///
+    /// The default filters `get_receipts_range`; backends with ordered
+    /// receipt indexes override it.
+    fn get_receipts_range_page(
+        &self,
+        start_slot: SlotNumber,
+        end_slot: SlotNumber,
+        cursor: Option<&ReceiptCursor>,
+        limit: usize,
+    ) -> Result<ReceiptPage, StorageError> {
+        Ok(ReceiptPage::select(self.get_receipts_range(start_slot, end_slot)?, cursor, limit))
+    }
+    
+    /// Page of receipts affecting `object_id`, starting after `cursor`
+    fn get_receipts_for_object_page(
+        &self,
+        object_id: &UnitsObjectId,
+        cursor: Option<&ReceiptCursor>,
+        limit: usize,
+    ) -> Result<ReceiptPage, StorageError> {
+        Ok(ReceiptPage::select(self.get_receipts_for_object(object_id, None, None)?, cursor, limit))
+    }
 }
 
 //==============================================================================
@@ -325,4 +571,35 @@ where
         
         Ok(proof)
     }
-}
\ No newline at end of file
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn objects(count: u8) -> Vec<UnitsObject> {
+        (0..count)
+            .map(|seed| UnitsObject::new_data(UnitsObjectId::new([seed; 32]), UnitsObjectId::new([0xff; 32]), vec![seed]))
+            .collect()
+    }
+
+    #[test]
+    fn test_object_page_cursor() {
+        let page = ObjectPage::from_sorted(objects(3), 2);
+        assert_eq!(page.objects.len(), 2);
+        assert_eq!(page.next_cursor, Some(UnitsObjectId::new([1; 32])));
+
+        let last = ObjectPage::from_sorted(objects(2), 2);
+        assert_eq!(last.next_cursor, None);
+    }
+
+    #[test]
+    fn test_zero_limit_still_reports_more_objects() {
+        let mut remaining = objects(3);
+        remaining.truncate(page_read_len(0));
+
+        let page = ObjectPage::from_sorted(remaining, 0);
+        assert_eq!(page.objects.len(), 1);
+        assert_eq!(page.next_cursor, Some(UnitsObjectId::new([0; 32])));
+    }
+}
@@ -2,6 +2,7 @@ use crate::id::UnitsObjectId;
 use crate::locks::{ObjectLockGuard, PersistentLockManager};
 use crate::objects::UnitsObject;
 use crate::UnitsObjectProof;
+use crate::vm_executor::ExecutionMetrics;
 use serde::{Deserialize, Serialize};
 use std::collections::HashMap;
 
@@ -310,6 +311,10 @@ pub struct TransactionReceipt {
 
     /// Effects of the transaction on objects
     pub effects: Vec<TransactionEffect>,
+
+    /// VM resources used across all of the transaction's instructions
+    #[serde(default)]
+    pub execution: ExecutionMetrics,
 }
 
 impl TransactionReceipt {
@@ -333,6 +338,7 @@ impl TransactionReceipt {
             },
             error_message: None,
             effects: Vec::new(),
+            execution: ExecutionMetrics::default(),
         }
     }
 
@@ -353,6 +359,7 @@ impl TransactionReceipt {
             commitment_level,
             error_message: None,
             effects: Vec::new(),
+            execution: ExecutionMetrics::default(),
         }
     }
 
@@ -386,6 +393,11 @@ impl TransactionReceipt {
     }
     
 
+    /// Record the VM resources used by one of the transaction's instructions
+    pub fn record_execution(&mut self, metrics: &ExecutionMetrics) {
+        self.execution.accumulate(metrics);
+    }
+
     /// Set an error message (used when transaction fails)
     pub fn set_error(&mut self, error: String) {
         self.success = false;
@@ -7,6 +7,8 @@ use std::collections::HashMap;
 use crate::error::{RuntimeError, StorageError};
 use crate::id::UnitsObjectId;
 use crate::objects::UnitsObject;
+use crate::scheduler::{BasicConflictChecker, ConflictGraph};
+use crate::vm_executor::ExecutionMetrics;
 use crate::{SlotNumber, UnitsObjectProof};
 use crate::transaction::{
     CommitmentLevel, ConflictResult, Transaction, TransactionEffect, 
@@ -45,6 +47,22 @@ pub trait TransactionManager: Send + Sync {
         Ok(receipts)
     }
     
+    /// Execute a batch of transactions in parallel where they don't conflict
+    ///
+    /// Transactions are scheduled through a `ConflictGraph`, so conflicting
+    /// ones run in hash order and the result is independent of thread timing.
+    /// They run on the current rayon pool. Receipts are returned in input order.
+    fn execute_transaction_batch_parallel(
+        &self,
+        transactions: &[Transaction],
+    ) -> Result<Vec<TransactionReceipt>, RuntimeError> {
+        let graph = ConflictGraph::build(&BasicConflictChecker::new(), transactions);
+        graph
+            .execute(|node| self.execute_transaction(&transactions[node]))
+            .into_iter()
+            .collect()
+    }
+    
     //--------------------------------------------------------------------------
     // TRANSACTION STORAGE
     //--------------------------------------------------------------------------
@@ -246,6 +264,9 @@ pub struct TransactionContext {
     
     /// Whether the transaction has been rolled back
     pub rolled_back: bool,
+
+    /// VM resources used so far
+    pub execution: ExecutionMetrics,
 }
 
 impl TransactionContext {
@@ -258,6 +279,7 @@ impl TransactionContext {
             proofs: HashMap::new(),
             effects: Vec::new(),
             rolled_back: false,
+            execution: ExecutionMetrics::default(),
         }
     }
     
@@ -295,8 +317,9 @@ impl TransactionContext {
             receipt.add_proof(id, proof);
         }
         
-        // Add effects
+        // Add effects and resource usage
         receipt.effects = self.effects;
+        receipt.execution = self.execution;
         
         // Set commitment level
         receipt.commitment_level = if success {
@@ -97,6 +97,27 @@ impl ObjectEffect {
     }
 }
 
+/// Resource usage of a single VM execution
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize, Deserialize)]
+pub struct ExecutionMetrics {
+    /// Instructions retired by the guest
+    pub instructions: u64,
+    /// Wall-clock time spent loading and executing, in microseconds
+    pub wall_time_us: u64,
+    /// Peak guest heap usage in bytes, when the module reports it
+    #[serde(default)]
+    pub heap_peak_bytes: u64,
+}
+
+impl ExecutionMetrics {
+    /// Add another execution's usage to this one
+    pub fn accumulate(&mut self, other: &ExecutionMetrics) {
+        self.instructions = self.instructions.saturating_add(other.instructions);
+        self.wall_time_us = self.wall_time_us.saturating_add(other.wall_time_us);
+        self.heap_peak_bytes = self.heap_peak_bytes.max(other.heap_peak_bytes);
+    }
+}
+
 /// Execution error types
 #[derive(Debug, thiserror::Error)]
 pub enum VMExecutionError {
@@ -136,6 +157,25 @@ pub trait VMExecutor: Send + Sync {
         bytecode: &[u8],
         context: &ExecutionContext,
     ) -> Result<Vec<ObjectEffect>, VMExecutionError>;
+
+    /// Load and execute, also reporting the resources the execution used
+    ///
+    /// The default only measures wall time; executors that meter
+    /// instructions should override it.
+    fn load_and_execute_metered(
+        &self,
+        bytecode: &[u8],
+        context: &ExecutionContext,
+    ) -> Result<(Vec<ObjectEffect>, ExecutionMetrics), VMExecutionError> {
+        let start = std::time::Instant::now();
+        let effects = self.load_and_execute(bytecode, context)?;
+        let metrics = ExecutionMetrics {
+            instructions: 0,
+            wall_time_us: start.elapsed().as_micros() as u64,
+            heap_peak_bytes: 0,
+        };
+        Ok((effects, metrics))
+    }
 }
 
 /// Validate that controller can only modify objects it controls
@@ -9,6 +9,8 @@ use borsh::{BorshDeserialize, BorshSerialize};
 pub mod signature_schemes;
 pub mod policies;
 pub mod multi_factor;
+#[cfg(feature = "std")]
+pub mod verification_cache;
 
 /// Authentication result
 #[derive(Debug, Clone, PartialEq, Eq)]
@@ -104,6 +106,14 @@ pub trait Authenticator {
     
     /// Check if this authenticator can handle the credential
     fn can_handle(&self, credential: &AuthCredential) -> bool;
+    
+    /// Verify several credentials at once, returning results in input order
+    ///
+    /// The default verifies them one at a time; schemes with cheaper batch
+    /// verification override it.
+    fn verify_batch(&self, requests: &[(&AuthCredential, &AuthContext)]) -> Vec<AuthResult> {
+        requests.iter().map(|(credential, context)| self.verify(credential, context)).collect()
+    }
 }
 
 /// Authorization policy trait
@@ -161,37 +171,93 @@ impl AuthManager {
         credentials: &[AuthCredential],
         context: &AuthContext,
     ) -> AuthResult {
+        self.authenticate_batch(&[(credentials, context)])
+            .pop()
+            .unwrap_or(AuthResult::Failed(AuthError::InvalidPolicy))
+    }
+    
+    /// Authenticate several operations, verifying credentials in batches
+    ///
+    /// Every credential is routed to the first authenticator that handles
+    /// it, and each authenticator verifies all of its credentials across the
+    /// batch in one `verify_batch` call. Results are in request order and
+    /// match calling `authenticate` on each request.
+    pub fn authenticate_batch(
+        &self,
+        requests: &[(&[AuthCredential], &AuthContext)],
+    ) -> Vec<AuthResult> {
         // Get required authentication from policies
-        let mut all_requirements = Vec::new();
-        for policy in &self.policies {
-            all_requirements.extend(policy.required_auth(context));
+        let requirements: Vec<Vec<AuthRequirement>> = requests.iter()
+            .map(|(_, context)| {
+                self.policies.iter().flat_map(|policy| policy.required_auth(context)).collect()
+            })
+            .collect();
+        
+        // Group credentials by authenticator as (request, credential) indices
+        let mut routed: Vec<Vec<(usize, usize)>> = self.authenticators.iter().map(|_| Vec::new()).collect();
+        for (request, (credentials, _)) in requests.iter().enumerate() {
+            if requirements[request].is_empty() {
+                continue; // No authentication required
+            }
+            for (index, credential) in credentials.iter().enumerate() {
+                if let Some(authenticator) = self.authenticators.iter().position(|a| a.can_handle(credential)) {
+                    routed[authenticator].push((request, index));
+                }
+            }
         }
         
-        if all_requirements.is_empty() {
+        let mut outcomes: Vec<Vec<Option<AuthResult>>> = requests.iter()
+            .map(|(credentials, _)| alloc::vec![None; credentials.len()])
+            .collect();
+        for (authenticator, routed) in self.authenticators.iter().zip(&routed) {
+            if routed.is_empty() {
+                continue;
+            }
+            let batch: Vec<(&AuthCredential, &AuthContext)> = routed.iter()
+                .map(|&(request, index)| (&requests[request].0[index], requests[request].1))
+                .collect();
+            for (&(request, index), result) in routed.iter().zip(authenticator.verify_batch(&batch)) {
+                outcomes[request][index] = Some(result);
+            }
+        }
+        
+        requests.iter()
+            .zip(requirements)
+            .zip(outcomes)
+            .map(|(((credentials, _), requirements), outcomes)| {
+                self.evaluate(credentials, &requirements, outcomes)
+            })
+            .collect()
+    }
+    
+    /// Combine per-credential outcomes into the result for one request
+    fn evaluate(
+        &self,
+        credentials: &[AuthCredential],
+        requirements: &[AuthRequirement],
+        outcomes: Vec<Option<AuthResult>>,
+    ) -> AuthResult {
+        if requirements.is_empty() {
             return AuthResult::Success; // No authentication required
         }
         
-        // Validate each credential
+        // Credentials no authenticator handles are skipped
         let mut verified_factors = Vec::new();
-        for credential in credentials {
-            for authenticator in &self.authenticators {
-                if authenticator.can_handle(credential) {
-                    match authenticator.verify(credential, context) {
-                        AuthResult::Success => {
-                            if let Some(factor) = self.credential_to_factor(credential) {
-                                verified_factors.push(factor);
-                            }
-                        }
-                        AuthResult::Failed(err) => return AuthResult::Failed(err),
-                        AuthResult::Pending(pending) => return AuthResult::Pending(pending),
+        for (credential, outcome) in credentials.iter().zip(outcomes) {
+            match outcome {
+                Some(AuthResult::Success) => {
+                    if let Some(factor) = self.credential_to_factor(credential) {
+                        verified_factors.push(factor);
                     }
-                    break;
                 }
+                Some(AuthResult::Failed(err)) => return AuthResult::Failed(err),
+                Some(AuthResult::Pending(pending)) => return AuthResult::Pending(pending),
+                None => {}
             }
         }
         
         // Check if requirements are satisfied
-        self.check_requirements(&all_requirements, &verified_factors)
+        self.check_requirements(requirements, &verified_factors)
     }
     
     fn credential_to_factor(&self, credential: &AuthCredential) -> Option<AuthFactor> {
@@ -7,51 +7,85 @@ use super::{Authenticator, AuthCredential, AuthContext, AuthResult, AuthError, A
 use crate::crypto;
 
 /// Ed25519 signature authenticator
+///
+/// Batches of credentials are checked with one batch verification, falling
+/// back to per-signature checks only when the batch fails.
 pub struct Ed25519Authenticator;
 
+impl Ed25519Authenticator {
+    /// Decode an Ed25519 credential and build the message it must sign
+    fn prepare(
+        credential: &AuthCredential,
+        context: &AuthContext,
+    ) -> Result<(crypto::PublicKey, Vec<u8>, crypto::Signature), AuthResult> {
+        let AuthCredential::Signature { signature_type, signature_bytes, public_key } = credential else {
+            return Err(AuthResult::Failed(AuthError::UnsupportedMethod));
+        };
+        if *signature_type != SignatureType::Ed25519 {
+            return Err(AuthResult::Failed(AuthError::UnsupportedMethod));
+        }
+        
+        // Convert to our crypto types
+        let signature = crypto::Signature::from_slice(signature_bytes)
+            .map_err(|_| AuthResult::Failed(AuthError::InvalidCredentials))?;
+        let key_bytes: [u8; crypto::PUBLIC_KEY_SIZE] = public_key.as_slice().try_into()
+            .map_err(|_| AuthResult::Failed(AuthError::InvalidCredentials))?;
+        let public_key = crypto::PublicKey::from_bytes(&key_bytes)
+            .map_err(|_| AuthResult::Failed(AuthError::InvalidCredentials))?;
+        
+        // The key must belong to the requester
+        if public_key.to_units_object_id() != context.requester {
+            return Err(AuthResult::Failed(AuthError::InvalidCredentials));
+        }
+        
+        // Create message for verification
+        let message = crypto::create_operation_message(
+            &context.operation,
+            &context.target_account,
+            context.timestamp,
+            &context.operation_data,
+        );
+        
+        Ok((public_key, message, signature))
+    }
+}
+
 impl Authenticator for Ed25519Authenticator {
     fn verify(&self, credential: &AuthCredential, context: &AuthContext) -> AuthResult {
-        if let AuthCredential::Signature { signature_type, signature_bytes, public_key } = credential {
-            if *signature_type != SignatureType::Ed25519 {
-                return AuthResult::Failed(AuthError::UnsupportedMethod);
-            }
-            
-            // Convert to our crypto types
-            let signature = match crypto::Signature::from_slice(signature_bytes) {
-                Ok(sig) => sig,
-                Err(_) => return AuthResult::Failed(AuthError::InvalidCredentials),
-            };
-            
-            let public_key = match crypto::PublicKey::from_bytes(
-                &public_key.clone().try_into().map_err(|_| AuthError::InvalidCredentials).unwrap()
-            ) {
-                Ok(pk) => pk,
-                Err(_) => return AuthResult::Failed(AuthError::InvalidCredentials),
-            };
-            
-            // Create message for verification
-            let message = crypto::create_operation_message(
-                &context.operation,
-                &context.target_account,
-                context.timestamp,
-                &context.operation_data,
-            );
-            
-            // Verify signature
-            match crypto::verify_signature(&public_key, &message, &signature) {
-                Ok(_) => {
-                    // Check if public key matches the requester
-                    if public_key.to_units_object_id() == context.requester {
-                        AuthResult::Success
-                    } else {
-                        AuthResult::Failed(AuthError::InvalidCredentials)
-                    }
+        let (public_key, message, signature) = match Self::prepare(credential, context) {
+            Ok(prepared) => prepared,
+            Err(result) => return result,
+        };
+        
+        // Verify signature
+        match crypto::verify_signature(&public_key, &message, &signature) {
+            Ok(_) => AuthResult::Success,
+            Err(_) => AuthResult::Failed(AuthError::InvalidCredentials),
+        }
+    }
+    
+    fn verify_batch(&self, requests: &[(&AuthCredential, &AuthContext)]) -> Vec<AuthResult> {
+        let mut results = Vec::with_capacity(requests.len());
+        let mut prepared = Vec::new();
+        for (index, (credential, context)) in requests.iter().enumerate() {
+            match Self::prepare(credential, context) {
+                Ok(parts) => {
+                    results.push(AuthResult::Success);
+                    prepared.push((index, parts));
                 }
-                Err(_) => AuthResult::Failed(AuthError::InvalidCredentials),
+                Err(result) => results.push(result),
             }
-        } else {
-            AuthResult::Failed(AuthError::UnsupportedMethod)
         }
+        
+        let items: Vec<crypto::BatchItem<'_>> = prepared.iter()
+            .map(|(_, (public_key, message, signature))| crypto::BatchItem { public_key, message, signature })
+            .collect();
+        for ((index, _), outcome) in prepared.iter().zip(crypto::verify_batch_each(&items)) {
+            if outcome.is_err() {
+                results[*index] = AuthResult::Failed(AuthError::InvalidCredentials);
+            }
+        }
+        results
     }
     
     fn supported_factors(&self) -> Vec<AuthFactor> {
@@ -245,4 +279,12 @@ pub fn create_default_signature_authenticators() -> Vec<Box<dyn Authenticator>>
         Box::new(RsaAuthenticator::new(4096)),
         Box::new(RecoveryKeyAuthenticator),
     ]
-}
\ No newline at end of file
+}
+
+/// Default signature authenticators sharing one verified-signature cache
+#[cfg(feature = "std")]
+pub fn create_cached_signature_authenticators(
+    cache: std::sync::Arc<super::verification_cache::VerifiedSignatureCache>,
+) -> Vec<Box<dyn Authenticator>> {
+    super::verification_cache::CachedAuthenticator::wrap_all(create_default_signature_authenticators(), cache)
+}
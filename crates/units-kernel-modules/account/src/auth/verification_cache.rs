@@ -0,0 +1,343 @@
+//! Cache of successful signature verifications
+//!
+//! A signature that verified once always verifies, so a retried or
+//! resubmitted transaction doesn't need its signatures checked again.
+//! `CachedAuthenticator` sits in front of any `Authenticator` and remembers
+//! which signature credentials succeeded; a repeat is a hash lookup instead
+//! of a curve operation. Entries are never invalidated, only evicted when
+//! the cache is full.
+//!
+//! The cache is split into shards picked by key, each with its own lock and
+//! CLOCK eviction, so concurrent verifiers rarely contend.
+
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, OnceLock};
+
+use alloc::{boxed::Box, vec::Vec};
+use sha2::{Digest, Sha512};
+
+use super::{AuthContext, AuthCredential, AuthError, AuthFactor, AuthResult, Authenticator};
+
+/// Default number of verifications remembered
+pub const DEFAULT_SIGNATURE_CACHE_CAPACITY: usize = 65_536;
+
+/// Number of independently locked shards
+const SHARDS: usize = 16;
+
+/// Digest identifying one verified (scheme, public key, message) triple
+pub type VerificationKey = [u8; 32];
+
+struct Shard {
+    index: HashMap<VerificationKey, usize>,
+    /// Keys and their referenced bits, in slot order
+    slots: Vec<(VerificationKey, bool)>,
+    hand: usize,
+}
+
+/// Signature cache counters
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct SignatureCacheStats {
+    /// Verifications answered from the cache
+    pub hits: u64,
+    /// Verifications passed to the authenticator
+    pub misses: u64,
+    /// Entries dropped to make room
+    pub evictions: u64,
+    /// Entries currently cached
+    pub entries: usize,
+}
+
+/// Bounded, sharded set of signature verifications known to succeed
+pub struct VerifiedSignatureCache {
+    shards: Box<[Mutex<Shard>]>,
+    /// Entries kept per shard
+    per_shard: usize,
+    hits: AtomicU64,
+    misses: AtomicU64,
+    evictions: AtomicU64,
+}
+
+impl VerifiedSignatureCache {
+    /// Create a cache remembering roughly `capacity` verifications
+    ///
+    /// A capacity of zero disables caching.
+    pub fn new(capacity: usize) -> Self {
+        let shards = SHARDS.min(capacity).max(1);
+        Self {
+            shards: (0..shards)
+                .map(|_| Mutex::new(Shard { index: HashMap::new(), slots: Vec::new(), hand: 0 }))
+                .collect(),
+            per_shard: capacity.div_ceil(shards),
+            hits: AtomicU64::new(0),
+            misses: AtomicU64::new(0),
+            evictions: AtomicU64::new(0),
+        }
+    }
+
+    /// Key for a signature credential, or `None` for other credentials
+    ///
+    /// The digest covers the scheme, public key and signature together with
+    /// every context field the signed message and requester check depend on.
+    pub fn key(credential: &AuthCredential, context: &AuthContext) -> Option<VerificationKey> {
+        let AuthCredential::Signature { signature_type, signature_bytes, public_key } = credential else {
+            return None;
+        };
+
+        let mut hasher = Sha512::new();
+        hasher.update(borsh::to_vec(signature_type).ok()?);
+        for field in [
+            public_key.as_slice(),
+            signature_bytes.as_slice(),
+            context.operation.as_bytes(),
+            context.operation_data.as_slice(),
+        ] {
+            hasher.update((field.len() as u64).to_le_bytes());
+            hasher.update(field);
+        }
+        hasher.update(context.target_account.bytes());
+        hasher.update(context.requester.bytes());
+        hasher.update(context.timestamp.to_le_bytes());
+
+        let mut key = [0u8; 32];
+        key.copy_from_slice(&hasher.finalize()[..32]);
+        Some(key)
+    }
+
+    fn shard(&self, key: &VerificationKey) -> &Mutex<Shard> {
+        &self.shards[key[0] as usize % self.shards.len()]
+    }
+
+    /// Whether `key` is known to have verified, marking it recently used
+    pub fn contains(&self, key: &VerificationKey) -> bool {
+        let mut shard = self.shard(key).lock().unwrap();
+        let found = match shard.index.get(key) {
+            Some(&position) => {
+                shard.slots[position].1 = true;
+                true
+            }
+            None => false,
+        };
+        drop(shard);
+
+        let counter = if found { &self.hits } else { &self.misses };
+        counter.fetch_add(1, Ordering::Relaxed);
+        found
+    }
+
+    /// Remember that `key` verified, evicting an entry if its shard is full
+    pub fn insert(&self, key: VerificationKey) {
+        if self.per_shard == 0 {
+            return;
+        }
+        let mut shard = self.shard(&key).lock().unwrap();
+        if shard.index.contains_key(&key) {
+            return;
+        }
+        if shard.slots.len() < self.per_shard {
+            let position = shard.slots.len();
+            shard.slots.push((key, false));
+            shard.index.insert(key, position);
+            return;
+        }
+
+        // Sweep, giving referenced entries a second chance
+        let victim = loop {
+            let hand = shard.hand;
+            shard.hand = (hand + 1) % shard.slots.len();
+            let candidate = &mut shard.slots[hand];
+            if !candidate.1 {
+                break hand;
+            }
+            candidate.1 = false;
+        };
+        let (evicted, _) = std::mem::replace(&mut shard.slots[victim], (key, false));
+        shard.index.remove(&evicted);
+        shard.index.insert(key, victim);
+        self.evictions.fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Cache shared by every account module in the process
+    ///
+    /// Modules are rebuilt for each execution, so a cache of their own would
+    /// start empty every time.
+    pub fn shared() -> Arc<Self> {
+        static SHARED: OnceLock<Arc<VerifiedSignatureCache>> = OnceLock::new();
+        Arc::clone(SHARED.get_or_init(|| Arc::new(Self::default())))
+    }
+
+    /// Hit, miss, eviction and size counters
+    pub fn stats(&self) -> SignatureCacheStats {
+        SignatureCacheStats {
+            hits: self.hits.load(Ordering::Relaxed),
+            misses: self.misses.load(Ordering::Relaxed),
+            evictions: self.evictions.load(Ordering::Relaxed),
+            entries: self.shards.iter().map(|shard| shard.lock().unwrap().slots.len()).sum(),
+        }
+    }
+}
+
+impl Default for VerifiedSignatureCache {
+    fn default() -> Self {
+        Self::new(DEFAULT_SIGNATURE_CACHE_CAPACITY)
+    }
+}
+
+/// Authenticator that consults a shared cache before verifying signatures
+///
+/// Only successful signature verifications are cached; failures and
+/// non-signature credentials always reach the wrapped authenticator.
+pub struct CachedAuthenticator {
+    inner: Box<dyn Authenticator>,
+    cache: Arc<VerifiedSignatureCache>,
+}
+
+impl CachedAuthenticator {
+    pub fn new(inner: Box<dyn Authenticator>, cache: Arc<VerifiedSignatureCache>) -> Self {
+        Self { inner, cache }
+    }
+
+    /// Wrap every authenticator in `authenticators` around one shared cache
+    pub fn wrap_all(
+        authenticators: Vec<Box<dyn Authenticator>>,
+        cache: Arc<VerifiedSignatureCache>,
+    ) -> Vec<Box<dyn Authenticator>> {
+        authenticators
+            .into_iter()
+            .map(|inner| Box::new(Self::new(inner, cache.clone())) as Box<dyn Authenticator>)
+            .collect()
+    }
+}
+
+impl Authenticator for CachedAuthenticator {
+    fn verify(&self, credential: &AuthCredential, context: &AuthContext) -> AuthResult {
+        self.verify_batch(&[(credential, context)]).pop().unwrap_or(AuthResult::Failed(AuthError::InvalidCredentials))
+    }
+
+    fn supported_factors(&self) -> Vec<AuthFactor> {
+        self.inner.supported_factors()
+    }
+
+    fn can_handle(&self, credential: &AuthCredential) -> bool {
+        self.inner.can_handle(credential)
+    }
+
+    fn verify_batch(&self, requests: &[(&AuthCredential, &AuthContext)]) -> Vec<AuthResult> {
+        let keys: Vec<Option<VerificationKey>> = requests
+            .iter()
+            .map(|(credential, context)| VerifiedSignatureCache::key(credential, context))
+            .collect();
+
+        // Only the requests the cache can't answer reach the inner authenticator
+        let mut results: Vec<Option<AuthResult>> = keys
+            .iter()
+            .map(|key| match key {
+                Some(key) if self.cache.contains(key) => Some(AuthResult::Success),
+                _ => None,
+            })
+            .collect();
+        let misses: Vec<usize> = (0..requests.len()).filter(|&i| results[i].is_none()).collect();
+        if !misses.is_empty() {
+            let batch: Vec<(&AuthCredential, &AuthContext)> = misses.iter().map(|&i| requests[i]).collect();
+            for (&i, result) in misses.iter().zip(self.inner.verify_batch(&batch)) {
+                if let (AuthResult::Success, Some(key)) = (&result, keys[i]) {
+                    self.cache.insert(key);
+                }
+                results[i] = Some(result);
+            }
+        }
+
+        results
+            .into_iter()
+            .map(|result| result.unwrap_or(AuthResult::Failed(AuthError::InvalidCredentials)))
+            .collect()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::auth::SignatureType;
+    use std::sync::atomic::AtomicUsize;
+    use units_kernel_sdk::UnitsObjectId;
+
+    /// Accepts signatures whose first byte is non-zero, counting calls
+    struct CountingAuthenticator(Arc<AtomicUsize>);
+
+    impl Authenticator for CountingAuthenticator {
+        fn verify(&self, credential: &AuthCredential, _context: &AuthContext) -> AuthResult {
+            self.0.fetch_add(1, Ordering::Relaxed);
+            match credential {
+                AuthCredential::Signature { signature_bytes, .. } if signature_bytes[0] != 0 => AuthResult::Success,
+                _ => AuthResult::Failed(AuthError::InvalidCredentials),
+            }
+        }
+
+        fn supported_factors(&self) -> Vec<AuthFactor> {
+            vec![AuthFactor::Signature(SignatureType::Ed25519)]
+        }
+
+        fn can_handle(&self, _credential: &AuthCredential) -> bool {
+            true
+        }
+    }
+
+    fn credential(signature: u8) -> AuthCredential {
+        AuthCredential::Signature {
+            signature_type: SignatureType::Ed25519,
+            signature_bytes: vec![signature; 64],
+            public_key: vec![7u8; 32],
+        }
+    }
+
+    fn context(timestamp: u64) -> AuthContext {
+        AuthContext {
+            operation: "update_account".into(),
+            target_account: UnitsObjectId::new([1u8; 32]),
+            requester: UnitsObjectId::new([2u8; 32]),
+            timestamp,
+            operation_data: vec![1, 2, 3],
+        }
+    }
+
+    #[test]
+    fn test_repeat_verifications_skip_the_authenticator() {
+        let calls = Arc::new(AtomicUsize::new(0));
+        let cache = Arc::new(VerifiedSignatureCache::new(64));
+        let auth = CachedAuthenticator::new(Box::new(CountingAuthenticator(calls.clone())), cache.clone());
+
+        let (good, bad) = (credential(1), credential(0));
+        for _ in 0..3 {
+            assert_eq!(auth.verify(&good, &context(10)), AuthResult::Success);
+            assert!(matches!(auth.verify(&bad, &context(10)), AuthResult::Failed(_)));
+        }
+        // Good once, bad every time
+        assert_eq!(calls.load(Ordering::Relaxed), 4);
+
+        // A different message is a different entry
+        assert_eq!(auth.verify(&good, &context(11)), AuthResult::Success);
+        assert_eq!(calls.load(Ordering::Relaxed), 5);
+        assert_eq!(cache.stats().entries, 2);
+    }
+
+    #[test]
+    fn test_capacity_bounds_entries() {
+        let cache = VerifiedSignatureCache::new(SHARDS * 2);
+        for i in 0..=255u8 {
+            cache.insert([i; 32]);
+        }
+        let stats = cache.stats();
+        assert_eq!(stats.entries, SHARDS * 2);
+        assert_eq!(stats.evictions, 256 - SHARDS as u64 * 2);
+
+        assert!(!VerifiedSignatureCache::new(0).contains(&[0u8; 32]));
+    }
+
+    #[test]
+    fn test_shared_cache_outlives_module_instances() {
+        let key = [0xa5u8; 32];
+        VerifiedSignatureCache::shared().insert(key);
+        assert!(Arc::ptr_eq(&VerifiedSignatureCache::shared(), &VerifiedSignatureCache::shared()));
+        assert!(VerifiedSignatureCache::shared().contains(&key));
+    }
+}
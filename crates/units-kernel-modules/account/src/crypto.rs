@@ -5,6 +5,7 @@ use alloc::vec::Vec;
 
 use curve25519_dalek::edwards::{CompressedEdwardsY, EdwardsPoint};
 use curve25519_dalek::scalar::Scalar;
+use curve25519_dalek::traits::{IsIdentity, VartimeMultiscalarMul};
 use sha2::{Sha512, Digest};
 use units_kernel_sdk::UnitsObjectId;
 use borsh::{BorshDeserialize, BorshSerialize};
@@ -15,6 +16,9 @@ pub const SIGNATURE_SIZE: usize = 64;
 /// Ed25519 public key size in bytes
 pub const PUBLIC_KEY_SIZE: usize = 32;
 
+/// Domain separator for deriving batch verification weights
+const BATCH_DOMAIN: &[u8] = b"units-account-ed25519-batch-v1";
+
 /// Ed25519 signature
 #[derive(Debug, Clone, Copy, PartialEq, Eq, BorshSerialize, BorshDeserialize)]
 pub struct Signature {
@@ -87,12 +91,12 @@ pub enum CryptoError {
     SignatureVerificationFailed,
 }
 
-/// Verify an Ed25519 signature
-pub fn verify_signature(
+/// Parse a signature into its R point and S scalar and compute H(R || A || M)
+fn verification_terms(
     public_key: &PublicKey,
     message: &[u8],
     signature: &Signature,
-) -> Result<(), CryptoError> {
+) -> Result<(EdwardsPoint, Scalar, Scalar), CryptoError> {
     // Extract R and S from signature
     let r_bytes = &signature.bytes[..32];
     let s_bytes = &signature.bytes[32..];
@@ -122,17 +126,115 @@ pub fn verify_signature(
     // Convert hash to scalar
     let h_scalar = Scalar::from_bytes_mod_order_wide(array_ref!(hash, 0, 64));
     
-    // Verify: [S]B = R + [H(R||A||M)]A
-    let left_side = s_scalar * constants::ED25519_BASEPOINT_POINT;
-    let right_side = r_point + (h_scalar * public_key.point);
+    Ok((r_point, s_scalar, h_scalar))
+}
+
+/// Verify an Ed25519 signature
+///
+/// Uses the cofactored equation [8][S]B = [8]R + [8][H(R||A||M)]A, so a
+/// signature is accepted here exactly when `verify_batch` accepts it.
+pub fn verify_signature(
+    public_key: &PublicKey,
+    message: &[u8],
+    signature: &Signature,
+) -> Result<(), CryptoError> {
+    let (r_point, s_scalar, h_scalar) = verification_terms(public_key, message, signature)?;
     
-    if left_side == right_side {
+    // [S]B - [H(R||A||M)]A - R must be a small-order point
+    let difference = EdwardsPoint::vartime_double_scalar_mul_basepoint(&(-h_scalar), &public_key.point, &s_scalar)
+        - r_point;
+    
+    if difference.mul_by_cofactor().is_identity() {
         Ok(())
     } else {
         Err(CryptoError::SignatureVerificationFailed)
     }
 }
 
+/// One signature to check as part of a batch
+#[derive(Debug, Clone, Copy)]
+pub struct BatchItem<'a> {
+    pub public_key: &'a PublicKey,
+    pub message: &'a [u8],
+    pub signature: &'a Signature,
+}
+
+/// Verify many Ed25519 signatures with a single multiscalar multiplication
+///
+/// Checks a random linear combination of the verification equations. The
+/// weights are derived from a hash over every signature, key and message,
+/// so a signer cannot choose them. Fails if any signature is invalid; use
+/// `verify_batch_each` to find out which.
+pub fn verify_batch(items: &[BatchItem<'_>]) -> Result<(), CryptoError> {
+    match items {
+        [] => return Ok(()),
+        [item] => return verify_signature(item.public_key, item.message, item.signature),
+        _ => {}
+    }
+    
+    let mut terms = Vec::with_capacity(items.len());
+    for item in items {
+        terms.push(verification_terms(item.public_key, item.message, item.signature)?);
+    }
+    
+    // Bind the weights to the whole batch
+    let mut transcript = Sha512::new();
+    transcript.update(BATCH_DOMAIN);
+    for (item, (_, _, h_scalar)) in items.iter().zip(&terms) {
+        transcript.update(&item.signature.bytes);
+        transcript.update(&item.public_key.to_bytes());
+        transcript.update(h_scalar.as_bytes());
+    }
+    let seed = transcript.finalize();
+    
+    // sum(z_i R_i) + sum(z_i h_i A_i) - [sum(z_i s_i)]B
+    let mut scalars = Vec::with_capacity(2 * items.len() + 1);
+    let mut points = Vec::with_capacity(2 * items.len() + 1);
+    let mut basepoint_scalar = Scalar::ZERO;
+    for (index, (item, (r_point, s_scalar, h_scalar))) in items.iter().zip(&terms).enumerate() {
+        let weight = batch_weight(&seed, index);
+        basepoint_scalar -= weight * s_scalar;
+        scalars.push(weight);
+        points.push(*r_point);
+        scalars.push(weight * h_scalar);
+        points.push(item.public_key.point);
+    }
+    scalars.push(basepoint_scalar);
+    points.push(constants::ED25519_BASEPOINT_POINT);
+    
+    let combined = EdwardsPoint::vartime_multiscalar_mul(scalars, points);
+    if combined.mul_by_cofactor().is_identity() {
+        Ok(())
+    } else {
+        Err(CryptoError::SignatureVerificationFailed)
+    }
+}
+
+/// Verify a batch and return a result per signature
+///
+/// Tries `verify_batch` first and only checks signatures one by one when
+/// the batch fails.
+pub fn verify_batch_each(items: &[BatchItem<'_>]) -> Vec<Result<(), CryptoError>> {
+    if verify_batch(items).is_ok() {
+        return items.iter().map(|_| Ok(())).collect();
+    }
+    items
+        .iter()
+        .map(|item| verify_signature(item.public_key, item.message, item.signature))
+        .collect()
+}
+
+/// 128-bit weight for the `index`th signature of a batch
+fn batch_weight(seed: &[u8], index: usize) -> Scalar {
+    let digest = Sha512::new()
+        .chain_update(seed)
+        .chain_update((index as u64).to_le_bytes())
+        .finalize();
+    let mut bytes = [0u8; 32];
+    bytes[..16].copy_from_slice(&digest[..16]);
+    Scalar::from_bytes_mod_order(bytes)
+}
+
 /// Create a message digest for signing account operations
 pub fn create_operation_message(
     operation: &str,
@@ -211,4 +313,49 @@ mod tests {
         
         assert_eq!(message, expected);
     }
+    
+    /// Sign `message` with the secret scalar derived from `seed`
+    fn sign(seed: u8, message: &[u8]) -> (PublicKey, Signature) {
+        let secret = Scalar::from_bytes_mod_order([seed; 32]);
+        let public_key = PublicKey::from_bytes(&(secret * ED25519_BASEPOINT_POINT).compress().to_bytes()).unwrap();
+        let nonce = Scalar::from_bytes_mod_order([seed.wrapping_add(100); 32]);
+        let r_bytes = (nonce * ED25519_BASEPOINT_POINT).compress().to_bytes();
+        
+        let mut hasher = Sha512::new();
+        hasher.update(&r_bytes);
+        hasher.update(&public_key.to_bytes());
+        hasher.update(message);
+        let hash = hasher.finalize();
+        let h_scalar = Scalar::from_bytes_mod_order_wide(array_ref!(hash, 0, 64));
+        
+        let mut bytes = [0u8; SIGNATURE_SIZE];
+        bytes[..32].copy_from_slice(&r_bytes);
+        bytes[32..].copy_from_slice((nonce + h_scalar * secret).as_bytes());
+        (public_key, Signature::new(bytes))
+    }
+    
+    #[test]
+    fn test_batch_verification_identifies_bad_signer() {
+        let messages: Vec<Vec<u8>> = (0..8u8).map(|i| vec![i; 16]).collect();
+        let signed: Vec<(PublicKey, Signature)> = messages.iter().enumerate()
+            .map(|(i, message)| sign(i as u8 + 1, message))
+            .collect();
+        let items: Vec<BatchItem> = signed.iter().zip(&messages)
+            .map(|((public_key, signature), message)| BatchItem { public_key, message, signature })
+            .collect();
+        
+        assert_eq!(verify_batch(&items), Ok(()));
+        for item in &items {
+            assert_eq!(verify_signature(item.public_key, item.message, item.signature), Ok(()));
+        }
+        
+        // Signature 5 now covers the wrong message
+        let mut items = items;
+        items[5].message = &messages[4];
+        assert!(verify_batch(&items).is_err());
+        
+        let results = verify_batch_each(&items);
+        assert_eq!(results.iter().filter(|r| r.is_err()).count(), 1);
+        assert!(results[5].is_err());
+    }
 }
\ No newline at end of file
@@ -19,8 +19,7 @@ use crate::{
     FlexDeactivateAccountParams, FlexReactivateAccountParams, GetAccountParams,
     validate_username,
     auth::{
-        AuthManager, AuthContext, AuthResult, AuthError,
-        signature_schemes::{create_default_signature_authenticators},
+        AuthManager, AuthContext, AuthResult, AuthError, Authenticator,
         multi_factor::{create_default_mfa_authenticators},
         policies::{StandardAccountPolicy, HighSecurityPolicy}
     }
@@ -43,13 +42,31 @@ pub struct EnhancedAccountModule {
     auth_manager: AuthManager,
 }
 
+/// Signature authenticators for the built-in configurations
+///
+/// With `std`, successful verifications are remembered in
+/// `VerifiedSignatureCache::shared()`, so a resubmitted transaction skips
+/// its curve operations.
+fn signature_authenticators() -> Vec<Box<dyn Authenticator>> {
+    #[cfg(feature = "std")]
+    {
+        crate::auth::signature_schemes::create_cached_signature_authenticators(
+            crate::auth::verification_cache::VerifiedSignatureCache::shared(),
+        )
+    }
+    #[cfg(not(feature = "std"))]
+    {
+        crate::auth::signature_schemes::create_default_signature_authenticators()
+    }
+}
+
 impl EnhancedAccountModule {
     /// Create a new enhanced account module with standard authentication
     pub fn new_standard() -> Self {
         let mut auth_manager = AuthManager::new();
         
         // Add all signature authenticators
-        for authenticator in create_default_signature_authenticators() {
+        for authenticator in signature_authenticators() {
             auth_manager.add_authenticator(authenticator);
         }
         
@@ -69,7 +86,7 @@ impl EnhancedAccountModule {
         let mut auth_manager = AuthManager::new();
         
         // Add all signature authenticators
-        for authenticator in create_default_signature_authenticators() {
+        for authenticator in signature_authenticators() {
             auth_manager.add_authenticator(authenticator);
         }
         
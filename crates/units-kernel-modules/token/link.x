@@ -4,8 +4,9 @@ ENTRY(_start)
 
 MEMORY
 {
-    /* Kernel modules are loaded at a fixed address in VM memory */
-    RAM : ORIGIN = 0x80000000, LENGTH = 64M
+    /* Kernel modules are loaded at abi::MODULE_BASE_ADDR; the heap starts
+       at DEFAULT_HEAP_START, MODULE_IMAGE_SIZE above it */
+    RAM : ORIGIN = 0x80000000, LENGTH = 1M
 }
 
 SECTIONS
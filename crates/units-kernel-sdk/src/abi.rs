@@ -0,0 +1,616 @@
+//! Fixed-layout host/guest ABI (version 1)
+//!
+//! The host maps the execution context into guest memory at
+//! `INPUT_BUFFER_ADDR` using the layout below. Kernel modules read it in
+//! place through `ContextView` instead of copying and decoding it, and write
+//! their effects into the output arena at `OUTPUT_BUFFER_ADDR` with an
+//! `EffectWriter`. The host reads the effect descriptors directly; object data
+//! is referenced by offset rather than serialized.
+//!
+//! All integers are little-endian and all offsets are relative to the start
+//! of the buffer they appear in. The 4 bytes just below each buffer hold the
+//! number of bytes used, so the buffers can also be streamed through
+//! `sys_read`/`sys_write`.
+//!
+//! ```text
+//! Input buffer
+//!   [0..88)   context header
+//!   targets   target_count  x [u8; 32]
+//!   objects   object_count  x object descriptor (80 bytes)
+//!   ...       function name, params and object data, 8-byte aligned
+//!
+//! Output buffer
+//!   [0..16)   effects header
+//!   effects   effect_count  x effect descriptor (120 bytes)
+//!   ...       object data for after-images
+//! ```
+
+use crate::{ObjectType, UnitsObjectId, VMType, OBJECT_ID_SIZE};
+
+/// Current ABI version
+pub const ABI_VERSION: u32 = 1;
+
+/// Guest address kernel modules are linked at (see `token/link.x`)
+///
+/// The host maps the VM's main memory here, so code, data, heap and stack
+/// all live in `[MODULE_BASE_ADDR, MODULE_BASE_ADDR + memory_limit)`.
+pub const MODULE_BASE_ADDR: u32 = 0x8000_0000;
+/// Bytes reserved for a module's code and static data above the link base
+pub const MODULE_IMAGE_SIZE: usize = 1024 * 1024;
+/// Guest address of the input buffer
+pub const INPUT_BUFFER_ADDR: u32 = 0x1000_0000;
+/// Guest address of the output arena
+pub const OUTPUT_BUFFER_ADDR: u32 = 0x2000_0000;
+/// Maximum size of either buffer
+pub const MAX_BUFFER_SIZE: usize = 1024 * 1024;
+
+/// Context header field offsets
+pub mod context {
+    pub const MAGIC: [u8; 4] = *b"UCTX";
+    pub const MAGIC_OFFSET: usize = 0;
+    pub const VERSION: usize = 4;
+    pub const SLOT: usize = 8;
+    pub const TIMESTAMP: usize = 16;
+    pub const CONTROLLER_ID: usize = 24;
+    /// `(offset: u32, len: u32)` of the UTF-8 target function name
+    pub const FUNCTION: usize = 56;
+    /// `(offset: u32, len: u32)` of the instruction params
+    pub const PARAMS: usize = 64;
+    /// `(offset: u32, count: u32)` of the target id array
+    pub const TARGETS: usize = 72;
+    /// `(offset: u32, count: u32)` of the object descriptor array
+    pub const OBJECTS: usize = 80;
+    pub const HEADER_SIZE: usize = 88;
+}
+
+/// Object descriptor field offsets
+pub mod object {
+    pub const ID: usize = 0;
+    pub const CONTROLLER_ID: usize = 32;
+    /// `u8`: 0 = data, 1 = executable
+    pub const TYPE: usize = 64;
+    /// `u8`: VM type of executables, 0 = RISC-V
+    pub const VM_TYPE: usize = 65;
+    /// `(offset: u32, len: u32)` of the object data
+    pub const DATA: usize = 68;
+    pub const DESCRIPTOR_SIZE: usize = 80;
+
+    pub const TYPE_DATA: u8 = 0;
+    pub const TYPE_EXECUTABLE: u8 = 1;
+    pub const VM_RISCV: u8 = 0;
+}
+
+/// Effects header field offsets
+pub mod effects {
+    pub const MAGIC: [u8; 4] = *b"UEFX";
+    pub const MAGIC_OFFSET: usize = 0;
+    pub const VERSION: usize = 4;
+    pub const COUNT: usize = 8;
+    /// `u32` peak guest heap usage in bytes, as reported by the SDK allocator
+    pub const HEAP_PEAK: usize = 12;
+    pub const HEADER_SIZE: usize = 16;
+}
+
+/// Effect descriptor field offsets
+pub mod effect {
+    pub const OBJECT_ID: usize = 0;
+    /// `u32` bit set of `HAS_BEFORE` / `HAS_AFTER`
+    pub const FLAGS: usize = 32;
+    /// Object descriptor of the after-image (ignored without `HAS_AFTER`)
+    pub const AFTER: usize = 40;
+    pub const DESCRIPTOR_SIZE: usize = 40 + super::object::DESCRIPTOR_SIZE;
+
+    /// The before-image is the input object with the same id
+    pub const HAS_BEFORE: u32 = 1;
+    /// An after-image follows; without it the object is deleted
+    pub const HAS_AFTER: u32 = 2;
+}
+
+/// Reasons a buffer does not match the ABI
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum AbiError {
+    /// Missing or wrong magic bytes
+    BadMagic,
+    /// Buffer written for a different ABI version
+    UnsupportedVersion(u32),
+    /// A header, descriptor or referenced range lies outside the buffer
+    OutOfBounds,
+    /// Unknown object or VM type tag
+    InvalidType,
+    /// Function name is not UTF-8
+    InvalidUtf8,
+    /// Not enough room left in the output arena
+    ArenaFull,
+}
+
+//==============================================================================
+// ENCODING HELPERS
+//==============================================================================
+
+pub fn read_u32(buf: &[u8], at: usize) -> u32 {
+    u32::from_le_bytes([buf[at], buf[at + 1], buf[at + 2], buf[at + 3]])
+}
+
+pub fn read_u64(buf: &[u8], at: usize) -> u64 {
+    let mut bytes = [0u8; 8];
+    bytes.copy_from_slice(&buf[at..at + 8]);
+    u64::from_le_bytes(bytes)
+}
+
+pub fn write_u32(buf: &mut [u8], at: usize, value: u32) {
+    buf[at..at + 4].copy_from_slice(&value.to_le_bytes());
+}
+
+pub fn write_u64(buf: &mut [u8], at: usize, value: u64) {
+    buf[at..at + 8].copy_from_slice(&value.to_le_bytes());
+}
+
+fn read_id(buf: &[u8], at: usize) -> UnitsObjectId {
+    let mut bytes = [0u8; OBJECT_ID_SIZE];
+    bytes.copy_from_slice(&buf[at..at + OBJECT_ID_SIZE]);
+    UnitsObjectId::new(bytes)
+}
+
+/// `(offset, len)` pair at `at`, checked to lie within `buf`
+fn range(buf: &[u8], at: usize, element_size: usize) -> Result<(usize, usize), AbiError> {
+    if at + 8 > buf.len() {
+        return Err(AbiError::OutOfBounds);
+    }
+    let offset = read_u32(buf, at) as usize;
+    let count = read_u32(buf, at + 4) as usize;
+    let end = count
+        .checked_mul(element_size)
+        .and_then(|len| offset.checked_add(len))
+        .ok_or(AbiError::OutOfBounds)?;
+    if end > buf.len() {
+        return Err(AbiError::OutOfBounds);
+    }
+    Ok((offset, count))
+}
+
+/// Round `offset` up to the next multiple of 8
+pub const fn align8(offset: usize) -> usize {
+    (offset + 7) & !7
+}
+
+/// ABI tags for an object type
+pub fn encode_object_type(object_type: &ObjectType) -> (u8, u8) {
+    match object_type {
+        ObjectType::Data => (object::TYPE_DATA, 0),
+        ObjectType::Executable(VMType::RiscV) => (object::TYPE_EXECUTABLE, object::VM_RISCV),
+    }
+}
+
+/// Object type from its ABI tags
+pub fn decode_object_type(type_tag: u8, vm_tag: u8) -> Result<ObjectType, AbiError> {
+    match (type_tag, vm_tag) {
+        (object::TYPE_DATA, _) => Ok(ObjectType::Data),
+        (object::TYPE_EXECUTABLE, object::VM_RISCV) => Ok(ObjectType::Executable(VMType::RiscV)),
+        _ => Err(AbiError::InvalidType),
+    }
+}
+
+/// Encode an object descriptor into `desc` (exactly `DESCRIPTOR_SIZE` bytes)
+pub fn write_object_descriptor(
+    desc: &mut [u8],
+    id: &[u8],
+    controller_id: &[u8],
+    type_tags: (u8, u8),
+    data_offset: u32,
+    data_len: u32,
+) {
+    desc.fill(0);
+    desc[object::ID..object::ID + OBJECT_ID_SIZE].copy_from_slice(id);
+    desc[object::CONTROLLER_ID..object::CONTROLLER_ID + OBJECT_ID_SIZE].copy_from_slice(controller_id);
+    desc[object::TYPE] = type_tags.0;
+    desc[object::VM_TYPE] = type_tags.1;
+    write_u32(desc, object::DATA, data_offset);
+    write_u32(desc, object::DATA + 4, data_len);
+}
+
+//==============================================================================
+// VIEWS
+//==============================================================================
+
+/// Borrowed view of an object descriptor and its data
+#[derive(Debug, Clone, Copy)]
+pub struct ObjectView<'a> {
+    desc: &'a [u8],
+    data: &'a [u8],
+}
+
+impl<'a> ObjectView<'a> {
+    /// Validate the descriptor at `at` in `buf`
+    fn parse(buf: &'a [u8], at: usize) -> Result<Self, AbiError> {
+        let desc = buf.get(at..at + object::DESCRIPTOR_SIZE).ok_or(AbiError::OutOfBounds)?;
+        decode_object_type(desc[object::TYPE], desc[object::VM_TYPE])?;
+        let (offset, len) = range(buf, at + object::DATA, 1)?;
+        Ok(Self { desc, data: &buf[offset..offset + len] })
+    }
+
+    pub fn id(&self) -> UnitsObjectId {
+        read_id(self.desc, object::ID)
+    }
+
+    pub fn controller_id(&self) -> UnitsObjectId {
+        read_id(self.desc, object::CONTROLLER_ID)
+    }
+
+    pub fn object_type(&self) -> ObjectType {
+        decode_object_type(self.desc[object::TYPE], self.desc[object::VM_TYPE])
+            .expect("validated on parse")
+    }
+
+    /// Object data, borrowed from the buffer
+    pub fn data(&self) -> &'a [u8] {
+        self.data
+    }
+
+    /// Copy the object out of the buffer
+    pub fn to_object(&self) -> crate::UnitsObject {
+        crate::UnitsObject {
+            id: self.id(),
+            controller_id: self.controller_id(),
+            object_type: self.object_type(),
+            data: self.data.into(),
+        }
+    }
+}
+
+/// Borrowed, validated view of an ABI execution context
+#[derive(Debug, Clone, Copy)]
+pub struct ContextView<'a> {
+    buf: &'a [u8],
+    function: &'a str,
+    params: &'a [u8],
+    targets: (usize, usize),
+    objects: (usize, usize),
+}
+
+impl<'a> ContextView<'a> {
+    /// Validate `buf` as a context; every accessor is then infallible
+    pub fn parse(buf: &'a [u8]) -> Result<Self, AbiError> {
+        if buf.len() < context::HEADER_SIZE {
+            return Err(AbiError::OutOfBounds);
+        }
+        if buf[context::MAGIC_OFFSET..context::MAGIC_OFFSET + 4] != context::MAGIC {
+            return Err(AbiError::BadMagic);
+        }
+        let version = read_u32(buf, context::VERSION);
+        if version != ABI_VERSION {
+            return Err(AbiError::UnsupportedVersion(version));
+        }
+
+        let (offset, len) = range(buf, context::FUNCTION, 1)?;
+        let function = core::str::from_utf8(&buf[offset..offset + len]).map_err(|_| AbiError::InvalidUtf8)?;
+        let (offset, len) = range(buf, context::PARAMS, 1)?;
+        let params = &buf[offset..offset + len];
+        let targets = range(buf, context::TARGETS, OBJECT_ID_SIZE)?;
+        let objects = range(buf, context::OBJECTS, object::DESCRIPTOR_SIZE)?;
+
+        for index in 0..objects.1 {
+            ObjectView::parse(buf, objects.0 + index * object::DESCRIPTOR_SIZE)?;
+        }
+
+        Ok(Self { buf, function, params, targets, objects })
+    }
+
+    pub fn slot(&self) -> u64 {
+        read_u64(self.buf, context::SLOT)
+    }
+
+    pub fn timestamp(&self) -> u64 {
+        read_u64(self.buf, context::TIMESTAMP)
+    }
+
+    pub fn controller_id(&self) -> UnitsObjectId {
+        read_id(self.buf, context::CONTROLLER_ID)
+    }
+
+    pub fn target_function(&self) -> &'a str {
+        self.function
+    }
+
+    pub fn params(&self) -> &'a [u8] {
+        self.params
+    }
+
+    pub fn target_count(&self) -> usize {
+        self.targets.1
+    }
+
+    pub fn target(&self, index: usize) -> Option<UnitsObjectId> {
+        (index < self.targets.1).then(|| read_id(self.buf, self.targets.0 + index * OBJECT_ID_SIZE))
+    }
+
+    pub fn targets(&self) -> impl Iterator<Item = UnitsObjectId> + 'a {
+        let (offset, count) = self.targets;
+        let buf = self.buf;
+        (0..count).map(move |index| read_id(buf, offset + index * OBJECT_ID_SIZE))
+    }
+
+    pub fn object_count(&self) -> usize {
+        self.objects.1
+    }
+
+    pub fn object(&self, index: usize) -> Option<ObjectView<'a>> {
+        (index < self.objects.1)
+            .then(|| ObjectView::parse(self.buf, self.objects.0 + index * object::DESCRIPTOR_SIZE).ok())
+            .flatten()
+    }
+
+    pub fn objects(&self) -> impl Iterator<Item = ObjectView<'a>> + 'a {
+        let view = *self;
+        (0..self.objects.1).filter_map(move |index| view.object(index))
+    }
+
+    /// Find an object by id
+    pub fn find_object(&self, id: &UnitsObjectId) -> Option<ObjectView<'a>> {
+        self.objects().find(|object| object.id() == *id)
+    }
+}
+
+/// Borrowed view of one effect descriptor
+#[derive(Debug, Clone, Copy)]
+pub struct EffectView<'a> {
+    desc: &'a [u8],
+    after: Option<ObjectView<'a>>,
+}
+
+impl<'a> EffectView<'a> {
+    pub fn object_id(&self) -> UnitsObjectId {
+        read_id(self.desc, effect::OBJECT_ID)
+    }
+
+    /// Whether the before-image is the input object with the same id
+    pub fn has_before(&self) -> bool {
+        read_u32(self.desc, effect::FLAGS) & effect::HAS_BEFORE != 0
+    }
+
+    /// The after-image, or None if the object was deleted
+    pub fn after(&self) -> Option<ObjectView<'a>> {
+        self.after
+    }
+}
+
+/// Borrowed, validated view of an output arena
+#[derive(Debug, Clone, Copy)]
+pub struct EffectsView<'a> {
+    buf: &'a [u8],
+    count: usize,
+}
+
+impl<'a> EffectsView<'a> {
+    /// Validate `buf` as an effects arena
+    pub fn parse(buf: &'a [u8]) -> Result<Self, AbiError> {
+        if buf.len() < effects::HEADER_SIZE {
+            return Err(AbiError::OutOfBounds);
+        }
+        if buf[effects::MAGIC_OFFSET..effects::MAGIC_OFFSET + 4] != effects::MAGIC {
+            return Err(AbiError::BadMagic);
+        }
+        let version = read_u32(buf, effects::VERSION);
+        if version != ABI_VERSION {
+            return Err(AbiError::UnsupportedVersion(version));
+        }
+
+        let count = read_u32(buf, effects::COUNT) as usize;
+        let end = count
+            .checked_mul(effect::DESCRIPTOR_SIZE)
+            .and_then(|len| len.checked_add(effects::HEADER_SIZE))
+            .ok_or(AbiError::OutOfBounds)?;
+        if end > buf.len() {
+            return Err(AbiError::OutOfBounds);
+        }
+
+        let view = Self { buf, count };
+        for index in 0..count {
+            view.parse_effect(index)?;
+        }
+        Ok(view)
+    }
+
+    fn parse_effect(&self, index: usize) -> Result<EffectView<'a>, AbiError> {
+        let at = effects::HEADER_SIZE + index * effect::DESCRIPTOR_SIZE;
+        let desc = &self.buf[at..at + effect::DESCRIPTOR_SIZE];
+        let after = if read_u32(desc, effect::FLAGS) & effect::HAS_AFTER != 0 {
+            Some(ObjectView::parse(self.buf, at + effect::AFTER)?)
+        } else {
+            None
+        };
+        Ok(EffectView { desc, after })
+    }
+
+    pub fn len(&self) -> usize {
+        self.count
+    }
+
+    /// Peak guest heap usage reported with the effects, in bytes
+    pub fn heap_peak(&self) -> u32 {
+        read_u32(self.buf, effects::HEAP_PEAK)
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.count == 0
+    }
+
+    pub fn iter(&self) -> impl Iterator<Item = EffectView<'a>> + 'a {
+        let view = *self;
+        (0..self.count).filter_map(move |index| view.parse_effect(index).ok())
+    }
+}
+
+//==============================================================================
+// EFFECT WRITER
+//==============================================================================
+
+/// Writes effects into an output arena in place
+///
+/// Space for `max_effects` descriptors is reserved after the header, and
+/// object data is appended after the descriptor table.
+pub struct EffectWriter<'a> {
+    buf: &'a mut [u8],
+    max_effects: usize,
+    count: usize,
+    data_end: usize,
+    heap_peak: u32,
+}
+
+impl<'a> EffectWriter<'a> {
+    pub fn new(buf: &'a mut [u8], max_effects: usize) -> Result<Self, AbiError> {
+        let data_start = effects::HEADER_SIZE + max_effects * effect::DESCRIPTOR_SIZE;
+        if data_start > buf.len() {
+            return Err(AbiError::ArenaFull);
+        }
+        Ok(Self { buf, max_effects, count: 0, data_end: align8(data_start), heap_peak: 0 })
+    }
+
+    /// Append an effect
+    ///
+    /// `after` is `(controller_id, object_type, data)`; `None` deletes the object.
+    pub fn push(
+        &mut self,
+        object_id: &UnitsObjectId,
+        has_before: bool,
+        after: Option<(&UnitsObjectId, &ObjectType, &[u8])>,
+    ) -> Result<(), AbiError> {
+        if self.count == self.max_effects {
+            return Err(AbiError::ArenaFull);
+        }
+
+        let mut flags = if has_before { effect::HAS_BEFORE } else { 0 };
+        let mut data_range = (0u32, 0u32);
+        if let Some((_, _, data)) = after {
+            let end = self.data_end + data.len();
+            if end > self.buf.len() {
+                return Err(AbiError::ArenaFull);
+            }
+            self.buf[self.data_end..end].copy_from_slice(data);
+            data_range = (self.data_end as u32, data.len() as u32);
+            self.data_end = align8(end).min(self.buf.len());
+            flags |= effect::HAS_AFTER;
+        }
+
+        let at = effects::HEADER_SIZE + self.count * effect::DESCRIPTOR_SIZE;
+        let desc = &mut self.buf[at..at + effect::DESCRIPTOR_SIZE];
+        desc.fill(0);
+        desc[effect::OBJECT_ID..effect::OBJECT_ID + OBJECT_ID_SIZE].copy_from_slice(object_id.bytes());
+        write_u32(desc, effect::FLAGS, flags);
+        if let Some((controller_id, object_type, _)) = after {
+            write_object_descriptor(
+                &mut desc[effect::AFTER..],
+                object_id.bytes(),
+                controller_id.bytes(),
+                encode_object_type(object_type),
+                data_range.0,
+                data_range.1,
+            );
+        }
+
+        self.count += 1;
+        Ok(())
+    }
+
+    /// Record the peak heap usage to report in the header
+    pub fn set_heap_peak(&mut self, bytes: usize) {
+        self.heap_peak = bytes.min(u32::MAX as usize) as u32;
+    }
+
+    /// Write the header and return the number of arena bytes used
+    pub fn finish(self) -> usize {
+        self.buf[effects::MAGIC_OFFSET..effects::MAGIC_OFFSET + 4].copy_from_slice(&effects::MAGIC);
+        write_u32(self.buf, effects::VERSION, ABI_VERSION);
+        write_u32(self.buf, effects::COUNT, self.count as u32);
+        write_u32(self.buf, effects::HEAP_PEAK, self.heap_peak);
+        self.data_end
+    }
+}
+
+#[cfg(all(test, feature = "std"))]
+mod tests {
+    use super::*;
+
+    /// Hand-build a context with one target and one object
+    fn sample_context() -> Vec<u8> {
+        let mut buf = vec![0u8; 512];
+        buf[0..4].copy_from_slice(&context::MAGIC);
+        write_u32(&mut buf, context::VERSION, ABI_VERSION);
+        write_u64(&mut buf, context::SLOT, 7);
+        write_u64(&mut buf, context::TIMESTAMP, 99);
+        buf[context::CONTROLLER_ID..context::CONTROLLER_ID + 32].copy_from_slice(&[9u8; 32]);
+
+        let targets = context::HEADER_SIZE;
+        buf[targets..targets + 32].copy_from_slice(&[1u8; 32]);
+        write_u32(&mut buf, context::TARGETS, targets as u32);
+        write_u32(&mut buf, context::TARGETS + 4, 1);
+
+        let objects = targets + 32;
+        write_u32(&mut buf, context::OBJECTS, objects as u32);
+        write_u32(&mut buf, context::OBJECTS + 4, 1);
+
+        let strings = objects + object::DESCRIPTOR_SIZE;
+        buf[strings..strings + 8].copy_from_slice(b"transfer");
+        write_u32(&mut buf, context::FUNCTION, strings as u32);
+        write_u32(&mut buf, context::FUNCTION + 4, 8);
+        write_u32(&mut buf, context::PARAMS, strings as u32 + 8);
+        write_u32(&mut buf, context::PARAMS + 4, 0);
+
+        let data = align8(strings + 8);
+        buf[data..data + 3].copy_from_slice(&[5, 6, 7]);
+        write_object_descriptor(
+            &mut buf[objects..objects + object::DESCRIPTOR_SIZE],
+            &[1u8; 32],
+            &[9u8; 32],
+            (object::TYPE_DATA, 0),
+            data as u32,
+            3,
+        );
+        buf
+    }
+
+    #[test]
+    fn test_context_view_reads_in_place() {
+        let buf = sample_context();
+        let view = ContextView::parse(&buf).unwrap();
+
+        assert_eq!((view.slot(), view.timestamp()), (7, 99));
+        assert_eq!(view.target_function(), "transfer");
+        assert_eq!(view.targets().collect::<Vec<_>>(), vec![UnitsObjectId::new([1u8; 32])]);
+
+        // Object data is borrowed from the buffer, not copied
+        let object = view.find_object(&UnitsObjectId::new([1u8; 32])).unwrap();
+        assert_eq!(object.data(), &[5, 6, 7]);
+        assert!(buf.as_ptr_range().contains(&object.data().as_ptr()));
+    }
+
+    #[test]
+    fn test_context_view_rejects_bad_ranges() {
+        let mut buf = sample_context();
+        write_u32(&mut buf, context::OBJECTS + 4, 1000);
+        assert_eq!(ContextView::parse(&buf).unwrap_err(), AbiError::OutOfBounds);
+
+        let mut buf = sample_context();
+        write_u32(&mut buf, context::VERSION, 2);
+        assert_eq!(ContextView::parse(&buf).unwrap_err(), AbiError::UnsupportedVersion(2));
+    }
+
+    #[test]
+    fn test_effect_writer_round_trip() {
+        let mut arena = vec![0u8; 1024];
+        let id = UnitsObjectId::new([3u8; 32]);
+        let controller = UnitsObjectId::new([9u8; 32]);
+
+        let mut writer = EffectWriter::new(&mut arena, 2).unwrap();
+        writer.push(&id, true, Some((&controller, &ObjectType::Data, &[1, 2, 3, 4]))).unwrap();
+        writer.push(&UnitsObjectId::new([4u8; 32]), true, None).unwrap();
+        assert_eq!(writer.push(&id, false, None), Err(AbiError::ArenaFull));
+        let used = writer.finish();
+
+        let effects = EffectsView::parse(&arena[..used]).unwrap();
+        let parsed: Vec<_> = effects.iter().collect();
+        assert_eq!(parsed.len(), 2);
+        let after = parsed[0].after().unwrap();
+        assert_eq!((after.id(), after.controller_id(), after.data()), (id, controller, &[1u8, 2, 3, 4][..]));
+        assert!(parsed[1].has_before() && parsed[1].after().is_none());
+    }
+}
@@ -2,8 +2,27 @@ use core::alloc::{GlobalAlloc, Layout};
 use core::sync::atomic::{AtomicUsize, Ordering};
 
 /// Default heap configuration for kernel modules
-pub const DEFAULT_HEAP_START: usize = 0x80100000;
-pub const DEFAULT_HEAP_SIZE: usize = 64 * 1024 * 1024; // 64MB
+///
+/// The heap starts right after the module image and leaves the top of the
+/// VM's default 16MB of main memory to the stack, which the host points at
+/// the end of memory.
+pub const DEFAULT_HEAP_START: usize = crate::abi::MODULE_BASE_ADDR as usize + crate::abi::MODULE_IMAGE_SIZE;
+pub const DEFAULT_HEAP_SIZE: usize = 8 * 1024 * 1024; // 8MB
+
+/// Highest heap usage seen by any allocator in this module, in bytes
+///
+/// Reported to the host with the effects so per-module memory limits can
+/// be sized from real usage.
+static HEAP_PEAK: AtomicUsize = AtomicUsize::new(0);
+
+/// Peak heap usage of this execution, in bytes
+pub fn heap_peak() -> usize {
+    HEAP_PEAK.load(Ordering::Relaxed)
+}
+
+fn record_heap_usage(bytes: usize) {
+    HEAP_PEAK.fetch_max(bytes, Ordering::Relaxed);
+}
 
 /// Simple bump allocator for kernel modules
 /// 
@@ -65,7 +84,10 @@ unsafe impl GlobalAlloc for BumpAllocator {
                 Ordering::Relaxed,
                 Ordering::Relaxed,
             ) {
-                Ok(_) => alloc_start as *mut u8,
+                Ok(_) => {
+                    record_heap_usage(alloc_end - self.heap_start);
+                    alloc_start as *mut u8
+                }
                 Err(_) => {
                     // Another thread allocated, retry
                     self.alloc(layout)
@@ -88,11 +110,167 @@ const fn align_up(addr: usize, align: usize) -> usize {
     (addr + align - 1) & !(align - 1)
 }
 
+/// Size classes served from free lists; larger requests are bump-allocated
+const SIZE_CLASSES: [usize; 9] = [16, 32, 64, 128, 256, 512, 1024, 2048, 4096];
+
+#[allow(clippy::declare_interior_mutable_const)]
+const EMPTY_LIST: AtomicUsize = AtomicUsize::new(0);
+
+/// Size-class slab allocator for kernel modules
+///
+/// Small requests are rounded up to a power-of-two size class and freed
+/// blocks go onto that class's free list, so modules that build and drop
+/// intermediate collections reuse memory instead of exhausting the heap.
+/// Blocks are carved from the heap on demand and aligned to their class
+/// size. Requests larger than the biggest class are bump-allocated; freeing
+/// the most recent one returns it, others are only reclaimed when the
+/// execution ends.
+///
+/// Free lists are intrusive (the next pointer lives in the freed block) and
+/// assume the single-threaded guest environment.
+pub struct SlabAllocator {
+    heap_start: usize,
+    heap_end: usize,
+    next: AtomicUsize,
+    free: [AtomicUsize; SIZE_CLASSES.len()],
+    in_use: AtomicUsize,
+    peak: AtomicUsize,
+}
+
+impl SlabAllocator {
+    /// Create a new slab allocator with default heap configuration
+    pub const fn new() -> Self {
+        Self::with_heap_range(DEFAULT_HEAP_START, DEFAULT_HEAP_SIZE)
+    }
+    
+    /// Create a new slab allocator with custom heap range
+    pub const fn with_heap_range(heap_start: usize, heap_size: usize) -> Self {
+        Self {
+            heap_start,
+            heap_end: heap_start + heap_size,
+            next: AtomicUsize::new(heap_start),
+            free: [EMPTY_LIST; SIZE_CLASSES.len()],
+            in_use: AtomicUsize::new(0),
+            peak: AtomicUsize::new(0),
+        }
+    }
+    
+    /// Get the total heap size
+    pub const fn heap_size(&self) -> usize {
+        self.heap_end - self.heap_start
+    }
+    
+    /// Bytes currently allocated (rounded up to size classes)
+    pub fn allocated(&self) -> usize {
+        self.in_use.load(Ordering::Relaxed)
+    }
+    
+    /// Highest value `allocated` has reached
+    pub fn peak(&self) -> usize {
+        self.peak.load(Ordering::Relaxed)
+    }
+    
+    /// Heap that has never been carved into blocks
+    pub fn remaining(&self) -> usize {
+        self.heap_end - self.next.load(Ordering::Relaxed)
+    }
+
+    /// Size class index for a layout, if it is small enough
+    fn class_for(layout: &Layout) -> Option<usize> {
+        let size = layout.size().max(layout.align());
+        SIZE_CLASSES.iter().position(|class| *class >= size)
+    }
+
+    /// Carve `size` bytes aligned to `align` from the untouched heap
+    fn carve(&self, size: usize, align: usize) -> *mut u8 {
+        let mut current = self.next.load(Ordering::Relaxed);
+        loop {
+            let start = align_up(current, align);
+            let end = match start.checked_add(size) {
+                Some(end) if end <= self.heap_end => end,
+                _ => return core::ptr::null_mut(),
+            };
+            match self.next.compare_exchange_weak(current, end, Ordering::Relaxed, Ordering::Relaxed) {
+                Ok(_) => return start as *mut u8,
+                Err(actual) => current = actual,
+            }
+        }
+    }
+
+    fn add_usage(&self, bytes: usize) {
+        let used = self.in_use.fetch_add(bytes, Ordering::Relaxed) + bytes;
+        self.peak.fetch_max(used, Ordering::Relaxed);
+        record_heap_usage(used);
+    }
+}
+
+unsafe impl GlobalAlloc for SlabAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        let (ptr, bytes) = match Self::class_for(&layout) {
+            Some(class) => {
+                let size = SIZE_CLASSES[class];
+                let head = &self.free[class];
+                let mut block = head.load(Ordering::Acquire);
+                while block != 0 {
+                    let next = *(block as *const usize);
+                    match head.compare_exchange_weak(block, next, Ordering::Acquire, Ordering::Relaxed) {
+                        Ok(_) => break,
+                        Err(actual) => block = actual,
+                    }
+                }
+                let ptr = if block != 0 { block as *mut u8 } else { self.carve(size, size) };
+                (ptr, size)
+            }
+            None => (self.carve(layout.size(), layout.align()), layout.size()),
+        };
+
+        if !ptr.is_null() {
+            self.add_usage(bytes);
+        }
+        ptr
+    }
+    
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        match Self::class_for(&layout) {
+            Some(class) => {
+                let head = &self.free[class];
+                let mut current = head.load(Ordering::Relaxed);
+                loop {
+                    *(ptr as *mut usize) = current;
+                    match head.compare_exchange_weak(current, ptr as usize, Ordering::Release, Ordering::Relaxed) {
+                        Ok(_) => break,
+                        Err(actual) => current = actual,
+                    }
+                }
+                self.in_use.fetch_sub(SIZE_CLASSES[class], Ordering::Relaxed);
+            }
+            None => {
+                // Only the most recent large block can be given back to the heap
+                let end = ptr as usize + layout.size();
+                let _ = self.next.compare_exchange(end, ptr as usize, Ordering::Relaxed, Ordering::Relaxed);
+                self.in_use.fetch_sub(layout.size(), Ordering::Relaxed);
+            }
+        }
+    }
+}
+
+// Unsafe implementation required for static initialization
+unsafe impl Sync for SlabAllocator {}
+
+/// Allocator used by `use_default_allocator!`
+///
+/// The `slab-allocator` feature switches it from `BumpAllocator` to
+/// `SlabAllocator`.
+#[cfg(not(feature = "slab-allocator"))]
+pub type DefaultAllocator = BumpAllocator;
+#[cfg(feature = "slab-allocator")]
+pub type DefaultAllocator = SlabAllocator;
+
 /// Default global allocator instance
 /// 
 /// This can be used directly by kernel modules by importing this crate
 /// and using the `use_default_allocator!` macro.
-pub static DEFAULT_ALLOCATOR: BumpAllocator = BumpAllocator::new();
+pub static DEFAULT_ALLOCATOR: DefaultAllocator = DefaultAllocator::new();
 
 /// Macro to set up the default allocator and error handler for kernel modules
 /// 
@@ -116,7 +294,7 @@ pub static DEFAULT_ALLOCATOR: BumpAllocator = BumpAllocator::new();
 macro_rules! use_default_allocator {
     () => {
         #[global_allocator]
-        static ALLOCATOR: &$crate::allocator::BumpAllocator = &$crate::allocator::DEFAULT_ALLOCATOR;
+        static ALLOCATOR: &$crate::allocator::DefaultAllocator = &$crate::allocator::DEFAULT_ALLOCATOR;
         
         #[alloc_error_handler]
         fn alloc_error_handler(_layout: core::alloc::Layout) -> ! {
@@ -150,4 +328,78 @@ macro_rules! use_custom_allocator {
             $crate::exit(-1)
         }
     };
-}
\ No newline at end of file
+}
+
+/// Macro to set up a slab allocator with a custom heap range
+/// 
+/// # Example
+/// 
+/// ```ignore
+/// use units_kernel_sdk::use_slab_allocator;
+/// 
+/// use_slab_allocator!(0x80200000, 8 * 1024 * 1024); // 8MB heap with free lists
+/// ```
+#[macro_export]
+macro_rules! use_slab_allocator {
+    ($heap_start:expr, $heap_size:expr) => {
+        static ALLOCATOR: $crate::allocator::SlabAllocator = 
+            $crate::allocator::SlabAllocator::with_heap_range($heap_start, $heap_size);
+        
+        #[global_allocator]
+        static GLOBAL_ALLOC: &$crate::allocator::SlabAllocator = &ALLOCATOR;
+        
+        #[alloc_error_handler]
+        fn alloc_error_handler(_layout: core::alloc::Layout) -> ! {
+            $crate::exit(-1)
+        }
+    };
+}
+
+#[cfg(all(test, feature = "std"))]
+mod tests {
+    use super::*;
+
+    /// A slab allocator over a leaked host buffer
+    fn slab(size: usize) -> SlabAllocator {
+        let heap = std::boxed::Box::leak(std::vec![0u8; size + 4096].into_boxed_slice());
+        SlabAllocator::with_heap_range(align_up(heap.as_ptr() as usize, 4096), size)
+    }
+
+    #[test]
+    fn test_slab_reuses_freed_blocks() {
+        let allocator = slab(64 * 1024);
+        let small = Layout::from_size_align(24, 8).unwrap();
+        unsafe {
+            let a = allocator.alloc(small);
+            assert_eq!(a as usize % 32, 0);
+            allocator.dealloc(a, small);
+
+            // Same size class comes back off the free list
+            let b = allocator.alloc(Layout::from_size_align(20, 4).unwrap());
+            assert_eq!(a, b);
+        }
+        assert_eq!(allocator.allocated(), 32);
+        assert_eq!(allocator.peak(), 32);
+    }
+
+    #[test]
+    fn test_slab_tracks_peak_and_large_blocks() {
+        let allocator = slab(64 * 1024);
+        let large = Layout::from_size_align(10_000, 8).unwrap();
+        unsafe {
+            let remaining = allocator.remaining();
+            let block = allocator.alloc(large);
+            assert!(!block.is_null());
+            allocator.dealloc(block, large);
+
+            // The most recent large block is returned to the heap
+            assert!(allocator.remaining() + 8 > remaining);
+            assert_eq!(allocator.allocated(), 0);
+            assert_eq!(allocator.peak(), 10_000);
+
+            // Exhausting the heap fails cleanly
+            assert!(allocator.alloc(Layout::from_size_align(1 << 20, 8).unwrap()).is_null());
+        }
+        assert!(heap_peak() >= 10_000);
+    }
+}
@@ -19,9 +19,15 @@
 //! 
 //! use_default_allocator!();
 //! ```
+//!
+//! The default is a bump allocator that never frees. Modules that allocate
+//! and drop many short-lived values can enable the `slab-allocator` feature
+//! (or call `use_slab_allocator!`) to get size-class free lists instead.
+//! Either way the peak heap usage is reported to the host with the effects.
 
 extern crate alloc;
 
+pub mod abi;
 pub mod allocator;
 
 use alloc::vec::Vec;
@@ -90,6 +96,26 @@ pub struct ExecutionContext {
     pub timestamp: u64,
 }
 
+impl ExecutionContext {
+    /// Copy a mapped context into owned form
+    ///
+    /// Modules that only need to read a few objects should use the
+    /// `abi::ContextView` from `context()` directly and avoid the copies.
+    pub fn from_view(view: &abi::ContextView<'_>) -> Self {
+        Self {
+            instruction: Instruction {
+                controller_id: view.controller_id(),
+                target_function: view.target_function().into(),
+                target_objects: view.targets().collect(),
+                params: view.params().into(),
+            },
+            objects: view.objects().map(|object| (object.id(), object.to_object())).collect(),
+            slot: view.slot(),
+            timestamp: view.timestamp(),
+        }
+    }
+}
+
 /// Effect of kernel execution on a single object
 #[derive(Debug, Clone, BorshSerialize, BorshDeserialize)]
 pub struct ObjectEffect {
@@ -149,100 +175,120 @@ pub trait KernelModule {
     fn execute(ctx: &ExecutionContext) -> Result<Vec<ObjectEffect>, KernelError>;
 }
 
+/// Syscall numbers passed in `a7`; these must match the host VM executor
+pub mod syscall_numbers {
+    pub const SYS_READ: usize = 63;
+    pub const SYS_WRITE: usize = 64;
+    pub const SYS_EXIT: usize = 93;
+}
+
 // System calls for no_std environment
+//
+// Modules read the context and write effects through the ABI buffers in
+// place, so `sys_exit` is the only call they make; the host still serves
+// `sys_read`/`sys_write` streams for guests built without the SDK.
 #[cfg(not(feature = "std"))]
 mod syscalls {
-    extern "C" {
-        fn sys_read(fd: i32, buf: *mut u8, count: usize) -> isize;
-        fn sys_write(fd: i32, buf: *const u8, count: usize) -> isize;
-        fn sys_exit(status: i32) -> !;
-    }
-    
-    pub unsafe fn read(fd: i32, buf: &mut [u8]) -> Result<usize, ()> {
-        let result = sys_read(fd, buf.as_mut_ptr(), buf.len());
-        if result < 0 {
-            Err(())
-        } else {
-            Ok(result as usize)
+    #[cfg(target_arch = "riscv32")]
+    mod ecall {
+        use super::super::syscall_numbers::SYS_EXIT;
+        use core::arch::asm;
+
+        pub unsafe fn sys_exit(status: i32) -> ! {
+            asm!("ecall", in("a0") status, in("a7") SYS_EXIT, options(noreturn));
         }
     }
-    
-    pub unsafe fn write(fd: i32, buf: &[u8]) -> Result<usize, ()> {
-        let result = sys_write(fd, buf.as_ptr(), buf.len());
-        if result < 0 {
-            Err(())
-        } else {
-            Ok(result as usize)
-        }
+    #[cfg(target_arch = "riscv32")]
+    use ecall::sys_exit;
+
+    #[cfg(not(target_arch = "riscv32"))]
+    extern "C" {
+        fn sys_exit(status: i32) -> !;
     }
-    
+
     pub unsafe fn exit(status: i32) -> ! {
         sys_exit(status)
     }
 }
 
-/// Read execution context from stdin
-pub fn read_context() -> Result<ExecutionContext, KernelError> {
+/// Borrow the execution context the host mapped at `abi::INPUT_BUFFER_ADDR`
+pub fn context() -> Result<abi::ContextView<'static>, KernelError> {
     #[cfg(not(feature = "std"))]
     {
-        // In no_std environment, read from stdin using syscalls
-        let mut size_buf = [0u8; 4];
-        unsafe {
-            syscalls::read(0, &mut size_buf).map_err(|_| KernelError::IOError)?;
-        }
-        let size = u32::from_le_bytes(size_buf) as usize;
-        
-        let mut data = alloc::vec![0u8; size];
-        let mut read = 0;
-        while read < size {
-            let n = unsafe {
-                syscalls::read(0, &mut data[read..]).map_err(|_| KernelError::IOError)?
-            };
-            if n == 0 {
-                return Err(KernelError::IOError);
+        // SAFETY: the host maps the input buffer and its length prefix before
+        // starting the guest and never changes them during execution
+        let buf = unsafe {
+            let len = core::ptr::read_volatile((abi::INPUT_BUFFER_ADDR - 4) as *const u32) as usize;
+            if len > abi::MAX_BUFFER_SIZE {
+                return Err(KernelError::InvalidData);
             }
-            read += n;
-        }
-        
-        borsh::from_slice(&data).map_err(|_| KernelError::InvalidData)
+            core::slice::from_raw_parts(abi::INPUT_BUFFER_ADDR as *const u8, len)
+        };
+        abi::ContextView::parse(buf).map_err(|_| KernelError::InvalidData)
     }
     
     #[cfg(feature = "std")]
     {
-        // In std environment, this would read from stdin
-        // This is mainly for testing
-        unimplemented!("read_context not implemented for std")
+        // The mapped buffer only exists inside the VM
+        unimplemented!("context not implemented for std")
     }
 }
 
-/// Write effects to stdout
-pub fn write_effects(effects: &[ObjectEffect]) -> Result<(), KernelError> {
-    let data = borsh::to_vec(effects).map_err(|_| KernelError::InvalidData)?;
-    let _size = (data.len() as u32).to_le_bytes();
-    
+/// Read execution context into owned form
+pub fn read_context() -> Result<ExecutionContext, KernelError> {
+    context().map(|view| ExecutionContext::from_view(&view))
+}
+
+/// Start writing effects into the output arena at `abi::OUTPUT_BUFFER_ADDR`
+///
+/// Call at most once per execution and publish with `commit_effects`.
+pub fn effect_writer(max_effects: usize) -> Result<abi::EffectWriter<'static>, KernelError> {
     #[cfg(not(feature = "std"))]
     {
-        unsafe {
-            syscalls::write(1, &size).map_err(|_| KernelError::IOError)?;
-            
-            let mut written = 0;
-            while written < data.len() {
-                let n = syscalls::write(1, &data[written..]).map_err(|_| KernelError::IOError)?;
-                if n == 0 {
-                    return Err(KernelError::IOError);
-                }
-                written += n;
-            }
-        }
-        Ok(())
+        // SAFETY: the output arena is guest memory reserved for this purpose;
+        // callers create a single writer per execution
+        let buf = unsafe {
+            core::slice::from_raw_parts_mut(abi::OUTPUT_BUFFER_ADDR as *mut u8, abi::MAX_BUFFER_SIZE)
+        };
+        abi::EffectWriter::new(buf, max_effects).map_err(|_| KernelError::IOError)
     }
     
     #[cfg(feature = "std")]
     {
-        // In std environment, this would write to stdout
-        // This is mainly for testing
-        unimplemented!("write_effects not implemented for std")
+        let _ = max_effects;
+        unimplemented!("effect_writer not implemented for std")
+    }
+}
+
+/// Publish the effects written so far to the host
+pub fn commit_effects(mut writer: abi::EffectWriter<'_>) {
+    writer.set_heap_peak(allocator::heap_peak());
+    let used = writer.finish() as u32;
+    
+    #[cfg(not(feature = "std"))]
+    // SAFETY: the length prefix sits just below the output arena
+    unsafe {
+        core::ptr::write_volatile((abi::OUTPUT_BUFFER_ADDR - 4) as *mut u32, used);
+    }
+    
+    #[cfg(feature = "std")]
+    let _ = used;
+}
+
+/// Write effects to the output arena
+pub fn write_effects(effects: &[ObjectEffect]) -> Result<(), KernelError> {
+    let mut writer = effect_writer(effects.len())?;
+    for effect in effects {
+        let after = effect
+            .after_image
+            .as_ref()
+            .map(|object| (&object.controller_id, &object.object_type, object.data.as_slice()));
+        writer
+            .push(&effect.object_id, effect.before_image.is_some(), after)
+            .map_err(|_| KernelError::IOError)?;
     }
+    commit_effects(writer);
+    Ok(())
 }
 
 /// Exit the program with a status code
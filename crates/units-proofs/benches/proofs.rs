@@ -0,0 +1,38 @@
+//! State proof generation over growing object sets
+//!
+//! Run with `cargo bench -p units-proofs`.
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use units_core_types::id::UnitsObjectId;
+use units_proofs::{hash_bytes, ProofEngine, UnitsObjectProof};
+
+/// One proof per object, as if each had been written once in slot 1
+fn object_proofs(count: u64) -> Vec<(UnitsObjectId, UnitsObjectProof)> {
+    (0..count)
+        .map(|index| {
+            let id = UnitsObjectId::new(hash_bytes(&index.to_le_bytes()));
+            let object_hash = hash_bytes(id.bytes());
+            (id, UnitsObjectProof::new(id, object_hash, 1, object_hash.to_vec(), None, None))
+        })
+        .collect()
+}
+
+fn bench_generate_state_proof(c: &mut Criterion) {
+    let engine = ProofEngine::new();
+    let mut group = c.benchmark_group("generate_state_proof");
+    group.sample_size(10);
+
+    for objects in [1_000u64, 100_000, 1_000_000] {
+        let proofs = object_proofs(objects);
+        let transactions: Vec<[u8; 32]> = (0..objects / 10).map(|index| hash_bytes(&index.to_be_bytes())).collect();
+
+        group.throughput(Throughput::Elements(objects));
+        group.bench_with_input(BenchmarkId::from_parameter(objects), &proofs, |b, proofs| {
+            b.iter(|| engine.generate_state_proof(proofs, &transactions, None, 2).unwrap())
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_generate_state_proof);
+criterion_main!(benches);
@@ -6,16 +6,31 @@
 
 use units_core_types::{Proof, SlotNumber, StateProof, UnitsObjectProof, VerificationResult, MerkleNode, ProofStorageError, UnitsObjectId};
 use blake3::Hasher;
+use rayon::prelude::*;
 use serde::{Deserialize, Serialize};
+use std::collections::HashMap;
+
+use crate::hashing::{hash_node, hash_serialized, merkle_root, PARALLEL_LEVEL_THRESHOLD};
+use crate::sparse_merkle::SparseMerkleTree;
+use crate::SlotClock;
 
 /// Proof engine using Blake3 hashing
+///
+/// Object proofs are stamped with the slot of the engine's `SlotClock`.
 #[derive(Debug, Clone, Default)]
-pub struct ProofEngine;
+pub struct ProofEngine {
+    clock: SlotClock,
+}
 
 impl ProofEngine {
     /// Create a new proof engine
     pub fn new() -> Self {
-        Self
+        Self::default()
+    }
+
+    /// Clock object proofs are stamped from
+    pub fn clock(&self) -> &SlotClock {
+        &self.clock
     }
 
     /// Generate a cryptographic proof for a UNITS object
@@ -26,7 +41,7 @@ impl ProofEngine {
         transaction_hash: Option<[u8; 32]>,
     ) -> Result<UnitsObjectProof, ProofStorageError> {
         // Get current slot
-        let current_slot = crate::current_slot();
+        let current_slot = self.clock.now();
         
         // Compute object hash
         let object_hash = self.hash_object(object)?;
@@ -91,16 +106,39 @@ impl ProofEngine {
             .map(|(id, _)| *id)
             .collect();
         
-        // Create state proof data
+        self.state_proof_from_roots(
+            slot,
+            self.compute_object_root(object_proofs)?,
+            self.compute_transaction_root(transaction_hashes),
+            object_ids,
+            prev_state_proof,
+        )
+    }
+
+    /// Create a state proof committing to roots computed elsewhere
+    ///
+    /// `object_root` must be the root of a `SparseMerkleTree` over
+    /// `object_leaf` leaves, such as a tree kept up to date slot by slot,
+    /// and `transaction_root` the `merkle_root` of the slot's transaction
+    /// hashes, so the proof reads back through `state_root` like one from
+    /// `generate_state_proof`.
+    pub fn state_proof_from_roots(
+        &self,
+        slot: SlotNumber,
+        object_root: [u8; 32],
+        transaction_root: [u8; 32],
+        object_ids: Vec<UnitsObjectId>,
+        prev_state_proof: Option<&StateProof>,
+    ) -> Result<StateProof, ProofStorageError> {
         let proof_data = StateProofData {
-            object_root: self.compute_object_root(object_proofs)?,
-            transaction_root: self.compute_transaction_root(transaction_hashes),
+            object_root,
+            transaction_root,
             slot,
         };
-        
+
         let serialized = bincode::serialize(&proof_data)
             .map_err(|e| ProofStorageError::Serialization(e.to_string()))?;
-        
+
         Ok(StateProof::new(
             slot,
             serialized,
@@ -109,6 +147,11 @@ impl ProofEngine {
         ))
     }
 
+    /// Leaf an object's latest proof contributes to a state root
+    pub fn object_leaf(proof: &UnitsObjectProof) -> [u8; 32] {
+        proof.hash()
+    }
+
     /// Verify that a state proof correctly commits to a collection of object proofs
     pub fn verify_state_proof(
         &self,
@@ -126,6 +169,17 @@ impl ProofEngine {
         Ok(expected_root == proof_data.object_root && state_proof.slot == proof_data.slot)
     }
 
+    /// Object root a state proof commits to
+    ///
+    /// This is the root of the sparse Merkle tree mapping each object id to
+    /// its `object_leaf`, as built by `generate_state_proof` or passed to
+    /// `state_proof_from_roots`.
+    pub fn state_root(&self, state_proof: &StateProof) -> Result<[u8; 32], ProofStorageError> {
+        let proof_data: StateProofData = bincode::deserialize(&state_proof.proof_data)
+            .map_err(|e| ProofStorageError::Serialization(e.to_string()))?;
+        Ok(proof_data.object_root)
+    }
+
     /// Verify transaction inclusion in a state proof
     pub fn verify_transaction_inclusion(
         &self,
@@ -148,12 +202,7 @@ impl ProofEngine {
     // Helper methods
 
     fn hash_object<T: Proof>(&self, object: &T) -> Result<[u8; 32], ProofStorageError> {
-        let serialized = bincode::serialize(object)
-            .map_err(|e| ProofStorageError::Serialization(e.to_string()))?;
-        
-        let mut hasher = Hasher::new();
-        hasher.update(&serialized);
-        Ok(*hasher.finalize().as_bytes())
+        hash_serialized(object).map_err(|e| ProofStorageError::Serialization(e.to_string()))
     }
 
     fn create_proof_data(
@@ -178,69 +227,44 @@ impl ProofEngine {
         hasher.finalize().as_bytes().to_vec()
     }
 
+    /// Root of a sparse Merkle tree mapping each object id to its proof hash
+    ///
+    /// The tree's shape depends only on the ids, so no sorting is needed and
+    /// any object can later be proven in or out of the root.
     fn compute_object_root(&self, object_proofs: &[(UnitsObjectId, UnitsObjectProof)]) -> Result<[u8; 32], ProofStorageError> {
-        let mut hasher = Hasher::new();
-        
-        // Sort by object ID for deterministic ordering
-        let mut sorted_proofs = object_proofs.to_vec();
-        sorted_proofs.sort_by_key(|(id, _)| *id);
-        
-        for (id, proof) in sorted_proofs {
-            hasher.update(id.bytes());
-            hasher.update(&proof.hash());
-        }
-        
-        Ok(*hasher.finalize().as_bytes())
+        Ok(SparseMerkleTree::root_of(
+            object_proofs.iter().map(|(id, proof)| (id, Self::object_leaf(proof))),
+        ))
     }
 
     fn compute_transaction_root(&self, transaction_hashes: &[[u8; 32]]) -> [u8; 32] {
-        if transaction_hashes.is_empty() {
-            return [0u8; 32];
-        }
-        
-        // Build simple merkle tree
-        let mut current_level: Vec<[u8; 32]> = transaction_hashes.to_vec();
-        
-        while current_level.len() > 1 {
-            let mut next_level = Vec::new();
-            
-            for chunk in current_level.chunks(2) {
-                let mut hasher = Hasher::new();
-                hasher.update(&chunk[0]);
-                if chunk.len() > 1 {
-                    hasher.update(&chunk[1]);
-                } else {
-                    hasher.update(&chunk[0]); // Duplicate if odd number
-                }
-                next_level.push(*hasher.finalize().as_bytes());
-            }
-            
-            current_level = next_level;
-        }
-        
-        current_level[0]
+        // Binary merkle tree, duplicating the last node of odd levels
+        merkle_root(transaction_hashes)
     }
 
-    fn verify_merkle_path(&self, leaf: &[u8; 32], path: &[MerkleNode]) -> Result<[u8; 32], ProofStorageError> {
+    /// Fold a leaf hash up a path of sibling nodes and return the resulting root
+    pub fn verify_merkle_path(&self, leaf: &[u8; 32], path: &[MerkleNode]) -> Result<[u8; 32], ProofStorageError> {
         let mut current_hash = *leaf;
         
         for node in path {
-            let mut hasher = Hasher::new();
-            if node.is_left {
-                hasher.update(&node.hash);
-                hasher.update(&current_hash);
+            current_hash = if node.is_left {
+                hash_node(&node.hash, &current_hash)
             } else {
-                hasher.update(&current_hash);
-                hasher.update(&node.hash);
-            }
-            current_hash = *hasher.finalize().as_bytes();
+                hash_node(&current_hash, &node.hash)
+            };
         }
         
         Ok(current_hash)
     }
 
     /// Verify an entire history of proofs for an object
-    pub fn verify_proof_history<T: Proof>(
+    ///
+    /// Each state is checked against the last proof made in its slot, found
+    /// through a slot index, so a slot rewritten several times is matched
+    /// with its final state. Long histories re-hash their states in
+    /// parallel. The first failing state, in the order given, is reported
+    /// before the chain links are checked.
+    pub fn verify_proof_history<T: Proof + Sync>(
         &self,
         object_states: &[(SlotNumber, T)],
         proofs: &[(SlotNumber, UnitsObjectProof)],
@@ -251,29 +275,32 @@ impl ProofEngine {
             );
         }
 
-        // Verify each state has a corresponding proof
-        for (slot, obj) in object_states {
-            let matching_proof = proofs.iter().find(|(proof_slot, _)| proof_slot == slot);
-
-            if let Some((_, proof)) = matching_proof {
-                match self.verify_object_proof(obj, proof) {
-                    Ok(true) => {}
-                    Ok(false) => {
-                        return VerificationResult::Invalid(format!(
-                            "Proof verification failed for slot {}",
-                            slot
-                        ))
-                    }
-                    Err(e) => {
-                        return VerificationResult::Invalid(format!(
-                            "Proof verification error at slot {}: {}",
-                            slot, e
-                        ))
-                    }
-                }
-            } else {
-                return VerificationResult::MissingData(format!("Missing proof for slot {}", slot));
+        let proofs_by_slot: HashMap<SlotNumber, &UnitsObjectProof> =
+            proofs.iter().map(|(slot, proof)| (*slot, proof)).collect();
+        let check = |(slot, obj): &(SlotNumber, T)| {
+            let Some(proof) = proofs_by_slot.get(slot) else {
+                return Some(VerificationResult::MissingData(format!("Missing proof for slot {}", slot)));
+            };
+            match self.verify_object_proof(obj, proof) {
+                Ok(true) => None,
+                Ok(false) => Some(VerificationResult::Invalid(format!(
+                    "Proof verification failed for slot {}",
+                    slot
+                ))),
+                Err(e) => Some(VerificationResult::Invalid(format!(
+                    "Proof verification error at slot {}: {}",
+                    slot, e
+                ))),
             }
+        };
+
+        let failure = if object_states.len() < PARALLEL_LEVEL_THRESHOLD {
+            object_states.iter().find_map(check)
+        } else {
+            object_states.par_iter().find_map_first(check)
+        };
+        if let Some(failure) = failure {
+            return failure;
         }
 
         // Verify proof chain links
@@ -299,6 +326,20 @@ impl ProofEngine {
 
         VerificationResult::Valid
     }
+
+    /// Verify the histories of many objects, in parallel across objects
+    ///
+    /// Each entry is an object's states and proofs as taken by
+    /// `verify_proof_history`; results are returned in the same order.
+    pub fn verify_proof_histories<T: Proof + Sync>(
+        &self,
+        histories: &[(Vec<(SlotNumber, T)>, Vec<(SlotNumber, UnitsObjectProof)>)],
+    ) -> Vec<VerificationResult> {
+        histories
+            .par_iter()
+            .map(|(states, proofs)| self.verify_proof_history(states, proofs))
+            .collect()
+    }
 }
 
 /// State proof data structure
@@ -371,4 +412,40 @@ mod tests {
         // Verify chain
         assert_eq!(proof2.prev_proof_hash, Some(proof1.hash()));
     }
+
+    #[test]
+    fn test_proofs_are_stamped_with_the_clock_slot() {
+        let engine = ProofEngine::new();
+        let object = TestObject { id: UnitsObjectId::from_bytes([4u8; 32]), data: vec![1] };
+        assert!(engine.generate_object_proof(&object, None, None).unwrap().slot >= 1_600_000_000);
+
+        // Clones of the engine share its clock
+        engine.clone().clock().set(7);
+        let proof = engine.generate_object_proof(&object, None, None).unwrap();
+        assert_eq!(proof.slot, 7);
+        assert!(engine.verify_object_proof(&object, &proof).unwrap());
+    }
+
+    #[test]
+    fn test_proof_history_matches_states_by_slot() {
+        let engine = ProofEngine::new();
+        let object_id = UnitsObjectId::from_bytes([3u8; 32]);
+        let state = |data: u8| TestObject { id: object_id, data: vec![data; 64] };
+
+        // Two writes share a slot; the state history keeps only the second
+        let mut proofs: Vec<(SlotNumber, UnitsObjectProof)> = Vec::new();
+        for (slot, data) in [(10, 1u8), (11, 2), (11, 3), (12, 4)] {
+            let mut proof = engine.generate_object_proof(&state(data), proofs.last().map(|(_, p)| p), None).unwrap();
+            proof.slot = slot;
+            proof.proof_data = engine.create_proof_data(&proof.object_hash, proof.prev_proof_hash, slot, None);
+            proofs.push((slot, proof));
+        }
+        let states = vec![(10, state(1)), (11, state(3)), (12, state(4))];
+        assert_eq!(engine.verify_proof_history(&states, &proofs), VerificationResult::Valid);
+
+        let tampered = vec![(10, state(1)), (11, state(2)), (12, state(4)), (13, state(5))];
+        assert!(matches!(engine.verify_proof_history(&tampered, &proofs), VerificationResult::Invalid(_)));
+        let results = engine.verify_proof_histories(&[(states, proofs.clone()), (vec![(13, state(5))], proofs)]);
+        assert!(matches!(results[..], [VerificationResult::Valid, VerificationResult::MissingData(_)]));
+    }
 }
\ No newline at end of file
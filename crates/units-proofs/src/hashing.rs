@@ -0,0 +1,126 @@
+//! Shared Merkle hashing primitives
+//!
+//! Every Merkle tree in UNITS combines two children with `hash_node`, which
+//! is BLAKE3 over the concatenated child hashes. Tree levels are hashed with
+//! `hash_level`, which spreads wide levels across the rayon thread pool;
+//! BLAKE3 itself picks the widest SIMD implementation the CPU supports, so
+//! each worker hashes with multiple lanes.
+
+use rayon::prelude::*;
+
+/// Levels narrower than this many parent nodes are hashed on the calling thread
+pub const PARALLEL_LEVEL_THRESHOLD: usize = 1024;
+
+/// Parent nodes hashed per rayon task
+const NODES_PER_TASK: usize = 256;
+
+/// Inputs at least this large are hashed with BLAKE3's multithreaded tree mode
+const PARALLEL_INPUT_THRESHOLD: usize = 128 * 1024;
+
+/// Hash two children into their parent
+pub fn hash_node(left: &[u8; 32], right: &[u8; 32]) -> [u8; 32] {
+    let mut hasher = blake3::Hasher::new();
+    hasher.update(left);
+    hasher.update(right);
+    *hasher.finalize().as_bytes()
+}
+
+/// Hash arbitrary bytes, using multiple threads for large inputs
+pub fn hash_bytes(data: &[u8]) -> [u8; 32] {
+    let mut hasher = blake3::Hasher::new();
+    if data.len() >= PARALLEL_INPUT_THRESHOLD {
+        hasher.update_rayon(data);
+    } else {
+        hasher.update(data);
+    }
+    *hasher.finalize().as_bytes()
+}
+
+/// Hash the bincode encoding of `value` without materialising it
+///
+/// The value is serialized straight into the hasher; encodings large enough
+/// for multithreaded hashing are buffered first. Either way the result equals
+/// `hash_bytes` over `bincode::serialize(value)`.
+pub fn hash_serialized<T: serde::Serialize + ?Sized>(value: &T) -> Result<[u8; 32], bincode::Error> {
+    if bincode::serialized_size(value)? as usize >= PARALLEL_INPUT_THRESHOLD {
+        return Ok(hash_bytes(&bincode::serialize(value)?));
+    }
+    let mut hasher = blake3::Hasher::new();
+    bincode::serialize_into(&mut hasher, value)?;
+    Ok(*hasher.finalize().as_bytes())
+}
+
+/// Hash many independent inputs, in parallel once there are enough of them
+pub fn hash_many<T: AsRef<[u8]> + Sync>(inputs: &[T]) -> Vec<[u8; 32]> {
+    if inputs.len() < PARALLEL_LEVEL_THRESHOLD {
+        return inputs.iter().map(|input| hash_bytes(input.as_ref())).collect();
+    }
+    inputs.par_iter().map(|input| hash_bytes(input.as_ref())).collect()
+}
+
+/// Hash one tree level into the next
+///
+/// Nodes are paired left to right; an odd last node is paired with itself.
+pub fn hash_level(level: &[[u8; 32]]) -> Vec<[u8; 32]> {
+    let pair = |chunk: &[[u8; 32]]| hash_node(&chunk[0], chunk.get(1).unwrap_or(&chunk[0]));
+
+    let parents = level.len().div_ceil(2);
+    if parents < PARALLEL_LEVEL_THRESHOLD {
+        return level.chunks(2).map(pair).collect();
+    }
+
+    let mut next = vec![[0u8; 32]; parents];
+    next.par_chunks_mut(NODES_PER_TASK)
+        .zip(level.par_chunks(NODES_PER_TASK * 2))
+        .for_each(|(out, children)| {
+            for (parent, chunk) in out.iter_mut().zip(children.chunks(2)) {
+                *parent = pair(chunk);
+            }
+        });
+    next
+}
+
+/// Root of a binary Merkle tree over `leaves`; zero for an empty tree
+pub fn merkle_root(leaves: &[[u8; 32]]) -> [u8; 32] {
+    match leaves.len() {
+        0 => [0u8; 32],
+        1 => leaves[0],
+        _ => {
+            let mut level = hash_level(leaves);
+            while level.len() > 1 {
+                level = hash_level(&level);
+            }
+            level[0]
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Level-by-level reference with no parallelism
+    fn sequential_root(leaves: &[[u8; 32]]) -> [u8; 32] {
+        let mut level = leaves.to_vec();
+        while level.len() > 1 {
+            level = level.chunks(2).map(|c| hash_node(&c[0], c.get(1).unwrap_or(&c[0]))).collect();
+        }
+        level[0]
+    }
+
+    #[test]
+    fn test_parallel_levels_match_sequential() {
+        for count in [2, 3, 7, PARALLEL_LEVEL_THRESHOLD * 2 + 1, PARALLEL_LEVEL_THRESHOLD * 5 + 3] {
+            let leaves: Vec<[u8; 32]> = (0..count as u32).map(|i| hash_bytes(&i.to_le_bytes())).collect();
+            assert_eq!(merkle_root(&leaves), sequential_root(&leaves), "{} leaves", count);
+        }
+        assert_eq!(merkle_root(&[]), [0u8; 32]);
+    }
+
+    #[test]
+    fn test_large_inputs_hash_like_small_ones() {
+        let data = vec![7u8; PARALLEL_INPUT_THRESHOLD * 2];
+        assert_eq!(hash_bytes(&data), *blake3::hash(&data).as_bytes());
+        assert_eq!(hash_many(&[&data[..10], &data[..]]), vec![hash_bytes(&data[..10]), hash_bytes(&data)]);
+    }
+}
@@ -1,10 +1,18 @@
 pub mod engine;
+pub mod hashing;
+pub mod sparse_merkle;
+pub mod subtree_cache;
 pub mod types;
 
 // Re-export main types and functions for convenience
 pub use engine::ProofEngine;
+pub use hashing::{hash_bytes, hash_level, hash_many, hash_node, hash_serialized, merkle_root};
+pub use sparse_merkle::{SparseMerkleProof, SparseMerkleTree};
+pub use subtree_cache::{SubtreeCache, SubtreeCacheStats};
 pub use types::{Proof, SlotNumber, StateProof, UnitsObjectProof, VerificationResult, MerkleNode};
 
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
 use std::time::{SystemTime, UNIX_EPOCH};
 
 /// Get the current slot number based on system time
@@ -16,4 +24,37 @@ pub fn current_slot() -> SlotNumber {
         .as_secs();
 
     now
-}
\ No newline at end of file
+}
+
+/// Stored by a `SlotClock` that still follows the system clock
+const UNSET_SLOT: SlotNumber = SlotNumber::MAX;
+
+/// Slot stamped on new object proofs
+///
+/// Reads `current_slot` until a slot is set. A node's transaction service
+/// sets it as slots advance, so object proofs carry the slot they were
+/// written in, the same slot their state proof is generated for. Clones
+/// share one slot.
+#[derive(Debug, Clone)]
+pub struct SlotClock(Arc<AtomicU64>);
+
+impl SlotClock {
+    /// Slot new proofs are stamped with
+    pub fn now(&self) -> SlotNumber {
+        match self.0.load(Ordering::Acquire) {
+            UNSET_SLOT => current_slot(),
+            slot => slot,
+        }
+    }
+
+    /// Stamp proofs with `slot` from now on instead of the system clock
+    pub fn set(&self, slot: SlotNumber) {
+        self.0.store(slot, Ordering::Release);
+    }
+}
+
+impl Default for SlotClock {
+    fn default() -> Self {
+        Self(Arc::new(AtomicU64::new(UNSET_SLOT)))
+    }
+}
@@ -0,0 +1,471 @@
+//! Incrementally updated sparse Merkle tree keyed by object id
+//!
+//! The tree has a leaf slot for every possible `UnitsObjectId`, addressed by
+//! the id's bits from the most significant down. Empty subtrees hash to zero
+//! and a subtree holding a single object collapses to that object's leaf, so
+//! depth and proof length grow with log(n) rather than with the key size.
+//!
+//! Updates are buffered and applied by `commit`, which re-hashes only the
+//! paths from changed leaves to the root; interior hashes of untouched
+//! subtrees are kept from earlier commits. The two halves of a subtree with
+//! enough changed leaves are re-hashed in parallel. Interior nodes use the
+//! shared `hash_node`, so proof paths can be checked with
+//! `ProofEngine::verify_merkle_path`.
+
+use std::collections::{BTreeMap, HashMap};
+
+use serde::{Deserialize, Serialize};
+use units_core_types::{MerkleNode, UnitsObjectId};
+
+use crate::engine::ProofEngine;
+use crate::hashing::hash_node;
+
+/// Hash of an empty subtree
+pub const EMPTY_HASH: [u8; 32] = [0u8; 32];
+
+/// Number of bits in a key
+const KEY_BITS: usize = 256;
+
+/// Domain tag for leaves, so a leaf can never be read as an interior node
+const LEAF_TAG: u8 = 0;
+
+/// Subtrees with fewer changed leaves than this are re-hashed on the calling thread
+const PARALLEL_COMMIT_THRESHOLD: usize = 256;
+
+/// Interior nodes are cached by depth and the smallest id under them
+type NodeKey = (u16, UnitsObjectId);
+
+/// Interior node changes found while re-hashing, applied once the pass ends
+#[derive(Default)]
+struct NodeChanges {
+    inserted: Vec<(NodeKey, [u8; 32])>,
+    removed: Vec<NodeKey>,
+}
+
+impl NodeChanges {
+    fn append(&mut self, mut other: NodeChanges) {
+        self.inserted.append(&mut other.inserted);
+        self.removed.append(&mut other.removed);
+    }
+}
+
+/// Hash of the leaf for `id` holding `value`
+pub fn leaf_hash(id: &UnitsObjectId, value: &[u8; 32]) -> [u8; 32] {
+    let mut hasher = blake3::Hasher::new();
+    hasher.update(&[LEAF_TAG]);
+    hasher.update(id.bytes());
+    hasher.update(value);
+    *hasher.finalize().as_bytes()
+}
+
+/// Bit of `id` that picks the child at `depth` (set means right)
+fn bit(id: &UnitsObjectId, depth: usize) -> bool {
+    (id[depth / 8] >> (7 - depth % 8)) & 1 == 1
+}
+
+/// Smallest and largest ids sharing the first `depth` bits of `id`
+fn prefix_bounds(id: &UnitsObjectId, depth: usize) -> (UnitsObjectId, UnitsObjectId) {
+    let (mut lo, mut hi) = (**id, **id);
+    for byte in 0..32 {
+        let start = byte * 8;
+        if start >= depth {
+            lo[byte] = 0;
+            hi[byte] = 0xff;
+        } else if start + 8 > depth {
+            let mask = 0xffu8 << (8 - (depth - start));
+            lo[byte] &= mask;
+            hi[byte] |= !mask;
+        }
+    }
+    (UnitsObjectId::new(lo), UnitsObjectId::new(hi))
+}
+
+/// Smallest ids of the left and right children of a node
+fn children(lo: &UnitsObjectId, depth: usize) -> (UnitsObjectId, UnitsObjectId) {
+    let mut right = **lo;
+    right[depth / 8] |= 1 << (7 - depth % 8);
+    (*lo, UnitsObjectId::new(right))
+}
+
+/// What occupies a subtree, for deciding whether it has interior nodes
+enum Occupancy {
+    Empty,
+    Leaf([u8; 32]),
+    Branch,
+}
+
+/// Membership or non-membership proof for one id
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct SparseMerkleProof {
+    /// Leaf found where the search for the id ended, if any
+    ///
+    /// For a non-membership proof this is either absent (the id's slot is an
+    /// empty subtree) or another object whose collapsed leaf occupies it.
+    pub leaf: Option<(UnitsObjectId, [u8; 32])>,
+    /// Sibling hashes from the leaf up to the root
+    pub siblings: Vec<MerkleNode>,
+}
+
+impl SparseMerkleProof {
+    /// Whether this proof shows `id` in the tree
+    pub fn is_membership(&self, id: &UnitsObjectId) -> bool {
+        matches!(&self.leaf, Some((leaf_id, _)) if leaf_id == id)
+    }
+
+    /// Check the proof against `root`
+    ///
+    /// With `Some(value)` this verifies that `id` maps to `value`; with `None`
+    /// it verifies that `id` is absent.
+    pub fn verify(&self, root: &[u8; 32], id: &UnitsObjectId, value: Option<&[u8; 32]>) -> bool {
+        let depth = self.siblings.len();
+        if depth > KEY_BITS {
+            return false;
+        }
+
+        // Siblings must sit on the opposite side of the id's own path
+        let on_path = self.siblings.iter().enumerate().all(|(i, node)| node.is_left == bit(id, depth - 1 - i));
+        if !on_path {
+            return false;
+        }
+
+        let start = match (value, &self.leaf) {
+            (Some(value), Some((leaf_id, leaf_value))) if leaf_id == id && leaf_value == value => leaf_hash(id, value),
+            (None, None) => EMPTY_HASH,
+            (None, Some((leaf_id, leaf_value)))
+                if leaf_id != id && prefix_bounds(leaf_id, depth).0 == prefix_bounds(id, depth).0 =>
+            {
+                leaf_hash(leaf_id, leaf_value)
+            }
+            _ => return false,
+        };
+
+        ProofEngine::new()
+            .verify_merkle_path(&start, &self.siblings)
+            .map_or(false, |computed| computed == *root)
+    }
+}
+
+/// Sparse Merkle tree with buffered, incremental updates
+#[derive(Debug, Clone, Default)]
+pub struct SparseMerkleTree {
+    /// Committed leaf values
+    leaves: BTreeMap<UnitsObjectId, [u8; 32]>,
+    /// Hashes of committed subtrees holding two or more leaves
+    nodes: HashMap<NodeKey, [u8; 32]>,
+    /// Updates since the last commit; `None` removes the id
+    pending: BTreeMap<UnitsObjectId, Option<[u8; 32]>>,
+    root: [u8; 32],
+}
+
+impl SparseMerkleTree {
+    /// Create an empty tree
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Root of `(id, value)` pairs, built in one pass
+    pub fn root_of<'a, I>(entries: I) -> [u8; 32]
+    where
+        I: IntoIterator<Item = (&'a UnitsObjectId, [u8; 32])>,
+    {
+        let mut tree = Self::new();
+        for (id, value) in entries {
+            tree.insert(*id, value);
+        }
+        tree.commit()
+    }
+
+    /// Root as of the last commit
+    pub fn root(&self) -> [u8; 32] {
+        self.root
+    }
+
+    /// Number of committed leaves
+    pub fn len(&self) -> usize {
+        self.leaves.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.leaves.is_empty()
+    }
+
+    /// Committed value for `id`
+    pub fn get(&self, id: &UnitsObjectId) -> Option<&[u8; 32]> {
+        self.leaves.get(id)
+    }
+
+    /// Set `id` to `value` at the next commit
+    pub fn insert(&mut self, id: UnitsObjectId, value: [u8; 32]) {
+        self.pending.insert(id, Some(value));
+    }
+
+    /// Remove `id` at the next commit
+    pub fn remove(&mut self, id: UnitsObjectId) {
+        self.pending.insert(id, None);
+    }
+
+    /// Number of ids changed since the last commit
+    pub fn pending_len(&self) -> usize {
+        self.pending.len()
+    }
+
+    /// Apply pending updates and return the new root
+    ///
+    /// Only subtrees containing a changed id are re-hashed.
+    pub fn commit(&mut self) -> [u8; 32] {
+        if self.pending.is_empty() {
+            return self.root;
+        }
+
+        let pending = std::mem::take(&mut self.pending);
+        let mut dirty = Vec::with_capacity(pending.len());
+        for (id, value) in pending {
+            match value {
+                Some(value) => self.leaves.insert(id, value),
+                None => self.leaves.remove(&id),
+            };
+            dirty.push(id);
+        }
+
+        // `dirty` is sorted, so each subtree's changes are a contiguous slice.
+        // The pass visits each node once, so reading the nodes as of the last
+        // commit and applying the changes afterwards matches updating in place.
+        let mut changes = NodeChanges::default();
+        self.root = self.update_subtree(0, UnitsObjectId::default(), &dirty, &mut changes);
+        for key in &changes.removed {
+            self.nodes.remove(key);
+        }
+        self.nodes.extend(changes.inserted);
+        self.root
+    }
+
+    /// Prove membership or non-membership of `id` against the committed root
+    pub fn prove(&self, id: &UnitsObjectId) -> SparseMerkleProof {
+        let mut siblings = Vec::new();
+        let mut depth = 0;
+        let leaf = loop {
+            let (lo, _) = prefix_bounds(id, depth);
+            match self.occupancy(&lo, depth) {
+                (Occupancy::Empty, _) => break None,
+                (Occupancy::Leaf(_), leaf) => break leaf,
+                (Occupancy::Branch, _) => {}
+            }
+
+            let (left, right) = children(&lo, depth);
+            let go_right = bit(id, depth);
+            let sibling = if go_right { left } else { right };
+            siblings.push(MerkleNode {
+                hash: self.subtree_hash(depth + 1, &sibling),
+                is_left: go_right,
+            });
+            depth += 1;
+        };
+
+        siblings.reverse();
+        SparseMerkleProof { leaf, siblings }
+    }
+
+    /// What the committed subtree at (`depth`, `lo`) holds
+    fn occupancy(&self, lo: &UnitsObjectId, depth: usize) -> (Occupancy, Option<(UnitsObjectId, [u8; 32])>) {
+        let (lo, hi) = prefix_bounds(lo, depth);
+        let mut range = self.leaves.range(lo..=hi);
+        match (range.next(), range.next()) {
+            (None, _) => (Occupancy::Empty, None),
+            (Some((id, value)), None) => (Occupancy::Leaf(leaf_hash(id, value)), Some((*id, *value))),
+            _ => (Occupancy::Branch, None),
+        }
+    }
+
+    /// Hash of a committed subtree
+    fn subtree_hash(&self, depth: usize, lo: &UnitsObjectId) -> [u8; 32] {
+        match self.occupancy(lo, depth).0 {
+            Occupancy::Empty => EMPTY_HASH,
+            Occupancy::Leaf(hash) => hash,
+            Occupancy::Branch => match self.nodes.get(&(depth as u16, *lo)) {
+                Some(hash) => *hash,
+                None => {
+                    let (left, right) = children(lo, depth);
+                    hash_node(&self.subtree_hash(depth + 1, &left), &self.subtree_hash(depth + 1, &right))
+                }
+            },
+        }
+    }
+
+    /// Re-hash the subtree at (`depth`, `lo`), descending only into `dirty` ids
+    fn update_subtree(
+        &self,
+        depth: usize,
+        lo: UnitsObjectId,
+        dirty: &[UnitsObjectId],
+        changes: &mut NodeChanges,
+    ) -> [u8; 32] {
+        let key = (depth as u16, lo);
+        let hash = match self.occupancy(&lo, depth).0 {
+            Occupancy::Empty => EMPTY_HASH,
+            Occupancy::Leaf(hash) => hash,
+            Occupancy::Branch => {
+                if dirty.is_empty() {
+                    if let Some(hash) = self.nodes.get(&key) {
+                        return *hash;
+                    }
+                }
+                let split = dirty.partition_point(|id| !bit(id, depth));
+                let (left, right) = children(&lo, depth);
+                let (left, right) = if dirty.len() >= PARALLEL_COMMIT_THRESHOLD {
+                    let mut right_changes = NodeChanges::default();
+                    let hashes = rayon::join(
+                        || self.update_subtree(depth + 1, left, &dirty[..split], changes),
+                        || self.update_subtree(depth + 1, right, &dirty[split..], &mut right_changes),
+                    );
+                    changes.append(right_changes);
+                    hashes
+                } else {
+                    (
+                        self.update_subtree(depth + 1, left, &dirty[..split], changes),
+                        self.update_subtree(depth + 1, right, &dirty[split..], changes),
+                    )
+                };
+                let hash = hash_node(&left, &right);
+                changes.inserted.push((key, hash));
+                return hash;
+            }
+        };
+
+        // The subtree collapsed; drop interior nodes left under it
+        self.evict_subtree(depth, lo, dirty, changes);
+        hash
+    }
+
+    /// Drop cached interior nodes of a collapsed subtree
+    ///
+    /// Every stale node held at least two of the old leaves, and all but one
+    /// of those were removed, so following the `dirty` ids reaches them all.
+    fn evict_subtree(&self, depth: usize, lo: UnitsObjectId, dirty: &[UnitsObjectId], changes: &mut NodeChanges) {
+        let key = (depth as u16, lo);
+        if dirty.is_empty() || !self.nodes.contains_key(&key) {
+            return;
+        }
+        changes.removed.push(key);
+        let split = dirty.partition_point(|id| !bit(id, depth));
+        let (left, right) = children(&lo, depth);
+        self.evict_subtree(depth + 1, left, &dirty[..split], changes);
+        self.evict_subtree(depth + 1, right, &dirty[split..], changes);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn id(byte: u8) -> UnitsObjectId {
+        let mut bytes = [0u8; 32];
+        bytes[0] = byte;
+        bytes[31] = byte;
+        UnitsObjectId::new(bytes)
+    }
+
+    #[test]
+    fn test_incremental_commit_matches_rebuild() {
+        let mut tree = SparseMerkleTree::new();
+        for byte in 0..64u8 {
+            tree.insert(id(byte), [byte; 32]);
+        }
+        tree.commit();
+
+        tree.insert(id(3), [99u8; 32]);
+        tree.remove(id(40));
+        tree.insert(id(200), [7u8; 32]);
+        let incremental = tree.commit();
+
+        let mut expected: BTreeMap<UnitsObjectId, [u8; 32]> = (0..64u8).map(|b| (id(b), [b; 32])).collect();
+        expected.insert(id(3), [99u8; 32]);
+        expected.remove(&id(40));
+        expected.insert(id(200), [7u8; 32]);
+        assert_eq!(incremental, SparseMerkleTree::root_of(expected.iter().map(|(id, v)| (id, *v))));
+        assert_eq!(tree.len(), 64);
+    }
+
+    #[test]
+    fn test_collapse_does_not_leave_stale_nodes() {
+        let mut tree = SparseMerkleTree::new();
+        // 0x00.., 0x01.., 0x02.. share a deep prefix; 0x80.. sits on the other side
+        for byte in [0x00, 0x01, 0x02, 0x80] {
+            tree.insert(id(byte), [byte; 32]);
+        }
+        tree.commit();
+
+        tree.remove(id(0x01));
+        tree.remove(id(0x02));
+        tree.commit();
+        tree.insert(id(0x40), [1u8; 32]);
+        let root = tree.commit();
+
+        let rebuilt = SparseMerkleTree::root_of([(&id(0x00), [0u8; 32]), (&id(0x40), [1u8; 32]), (&id(0x80), [0x80; 32])]);
+        assert_eq!(root, rebuilt);
+    }
+
+    /// Apply `updates`, committing after every `batch` of them
+    fn apply(tree: &mut SparseMerkleTree, updates: &[(UnitsObjectId, Option<[u8; 32]>)], batch: usize) {
+        for chunk in updates.chunks(batch) {
+            for (id, value) in chunk {
+                match value {
+                    Some(value) => tree.insert(*id, *value),
+                    None => tree.remove(*id),
+                }
+            }
+            tree.commit();
+        }
+    }
+
+    #[test]
+    fn test_parallel_commit_matches_serial_commits() {
+        let wide_id = |i: u32| UnitsObjectId::new(crate::hashing::hash_bytes(&i.to_le_bytes()));
+        let count = PARALLEL_COMMIT_THRESHOLD as u32 * 16;
+
+        let inserts: Vec<_> = (0..count).map(|i| (wide_id(i), Some([i as u8; 32]))).collect();
+        // Removals that collapse subtrees, mixed with changes and additions
+        let mixed: Vec<_> = (0..count + 1000)
+            .filter_map(|i| match i {
+                i if i >= count => Some((wide_id(i), Some([1u8; 32]))),
+                i if i % 4 == 0 => Some((wide_id(i), None)),
+                i if i % 4 == 1 => Some((wide_id(i), Some([0xee; 32]))),
+                _ => None,
+            })
+            .collect();
+
+        // One commit large enough to split across threads, against batches
+        // that each stay on one thread
+        let mut parallel = SparseMerkleTree::new();
+        let mut serial = SparseMerkleTree::new();
+        for updates in [&inserts, &mixed] {
+            apply(&mut parallel, updates, updates.len());
+            apply(&mut serial, updates, PARALLEL_COMMIT_THRESHOLD / 2);
+            assert_eq!(parallel.root(), serial.root());
+            assert_eq!(parallel.nodes, serial.nodes);
+        }
+        assert_eq!(parallel.len(), (count - count / 4 + 1000) as usize);
+    }
+
+    #[test]
+    fn test_membership_and_non_membership_proofs() {
+        let mut tree = SparseMerkleTree::new();
+        for byte in [1u8, 2, 3, 130] {
+            tree.insert(id(byte), [byte; 32]);
+        }
+        let root = tree.commit();
+
+        let proof = tree.prove(&id(2));
+        assert!(proof.is_membership(&id(2)));
+        assert!(proof.verify(&root, &id(2), Some(&[2u8; 32])));
+        assert!(!proof.verify(&root, &id(2), Some(&[9u8; 32])));
+        assert!(!proof.verify(&root, &id(2), None));
+
+        // Absent id landing in an empty subtree and one landing on another leaf
+        for absent in [id(64), id(131)] {
+            let proof = tree.prove(&absent);
+            assert!(!proof.is_membership(&absent));
+            assert!(proof.verify(&root, &absent, None));
+            assert!(!proof.verify(&root, &absent, Some(&[0u8; 32])));
+        }
+    }
+}
@@ -0,0 +1,341 @@
+//! Bounded cache of Merkle subtree roots
+//!
+//! Binary Merkle trees over leaf hashes are split into aligned blocks of
+//! `SUBTREE_LEAVES` leaves. The root of each full block is cached under a
+//! digest of the block's leaves, so rebuilding a tree, or proving a leaf in
+//! one, only hashes the blocks that changed: a cached block costs a single
+//! streaming BLAKE3 pass over its leaves instead of `SUBTREE_LEAVES - 1`
+//! node hashes. Trees are identical to `hashing::merkle_root`.
+//!
+//! The cache holds a fixed number of entries and evicts with the CLOCK
+//! algorithm, so hot blocks survive a stream of one-off lookups. Large
+//! caches are split into shards by key, each with its own lock and CLOCK
+//! ring, so blocks hashed in parallel rarely wait on one another.
+
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Mutex;
+
+use rayon::prelude::*;
+use units_core_types::MerkleNode;
+
+use crate::hashing::{hash_bytes, hash_level, merkle_root};
+
+/// Tree levels inside one cached block
+pub const SUBTREE_LEVELS: usize = 6;
+
+/// Leaves covered by one cached block
+pub const SUBTREE_LEAVES: usize = 1 << SUBTREE_LEVELS;
+
+/// Default memory budget for a subtree cache
+pub const DEFAULT_SUBTREE_CACHE_BYTES: usize = 16 * 1024 * 1024;
+
+/// Digest identifying a block of leaves
+pub type RangeKey = [u8; 32];
+
+/// Most shards a cache is split into
+const MAX_SHARDS: usize = 16;
+
+/// Fewest entries worth a shard of their own; smaller caches use fewer shards
+const MIN_SHARD_ENTRIES: usize = 1024;
+
+struct Slot {
+    key: RangeKey,
+    hash: [u8; 32],
+    referenced: bool,
+}
+
+/// Approximate memory held per entry: the slot plus its index entry
+const ENTRY_BYTES: usize = std::mem::size_of::<Slot>() + std::mem::size_of::<(RangeKey, usize)>();
+
+/// Subtree cache counters
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct SubtreeCacheStats {
+    /// Blocks served from the cache
+    pub hits: u64,
+    /// Blocks that had to be hashed
+    pub misses: u64,
+    /// Entries dropped to make room
+    pub evictions: u64,
+    /// Entries currently cached
+    pub entries: usize,
+    /// Approximate memory held by the entries
+    pub bytes: usize,
+}
+
+/// One CLOCK ring and its index
+struct ClockInner {
+    capacity: usize,
+    index: HashMap<RangeKey, usize>,
+    slots: Vec<Slot>,
+    hand: usize,
+}
+
+impl ClockInner {
+    fn new(capacity: usize) -> Self {
+        Self {
+            capacity,
+            index: HashMap::new(),
+            slots: Vec::new(),
+            hand: 0,
+        }
+    }
+
+    /// Cache `hash` under `key`, returning whether an entry was evicted
+    fn insert(&mut self, key: RangeKey, hash: [u8; 32]) -> bool {
+        if let Some(&position) = self.index.get(&key) {
+            self.slots[position].hash = hash;
+            return false;
+        }
+
+        let slot = Slot { key, hash, referenced: false };
+        if self.slots.len() < self.capacity {
+            self.index.insert(key, self.slots.len());
+            self.slots.push(slot);
+            return false;
+        }
+
+        // Sweep, giving referenced entries a second chance
+        let victim = loop {
+            let hand = self.hand;
+            self.hand = (hand + 1) % self.slots.len();
+            let candidate = &mut self.slots[hand];
+            if !candidate.referenced {
+                break hand;
+            }
+            candidate.referenced = false;
+        };
+        let evicted = std::mem::replace(&mut self.slots[victim], slot);
+        self.index.remove(&evicted.key);
+        self.index.insert(key, victim);
+        true
+    }
+}
+
+/// CLOCK-evicted cache of subtree roots keyed by range digest
+pub struct SubtreeCache {
+    /// Rings selected by key, splitting the capacity evenly
+    shards: Box<[Mutex<ClockInner>]>,
+    hits: AtomicU64,
+    misses: AtomicU64,
+    evictions: AtomicU64,
+}
+
+impl SubtreeCache {
+    /// Create a cache using roughly `max_bytes` of memory
+    pub fn new(max_bytes: usize) -> Self {
+        Self::with_capacity((max_bytes / ENTRY_BYTES).max(1))
+    }
+
+    /// Create a cache holding at most `capacity` entries
+    pub fn with_capacity(capacity: usize) -> Self {
+        let capacity = capacity.max(1);
+        let shards = (capacity / MIN_SHARD_ENTRIES).clamp(1, MAX_SHARDS);
+        Self {
+            shards: (0..shards).map(|_| Mutex::new(ClockInner::new(capacity / shards))).collect(),
+            hits: AtomicU64::new(0),
+            misses: AtomicU64::new(0),
+            evictions: AtomicU64::new(0),
+        }
+    }
+
+    /// Digest of a block of leaves
+    pub fn range_key(leaves: &[[u8; 32]]) -> RangeKey {
+        hash_bytes(leaves.as_flattened())
+    }
+
+    /// Shard holding `key`; digests are uniform, so any byte spreads them
+    fn shard(&self, key: &RangeKey) -> &Mutex<ClockInner> {
+        &self.shards[key[0] as usize % self.shards.len()]
+    }
+
+    /// Cached root for `key`, marking it recently used
+    pub fn get(&self, key: &RangeKey) -> Option<[u8; 32]> {
+        let mut inner = self.shard(key).lock().unwrap();
+        let position = *inner.index.get(key)?;
+        let slot = &mut inner.slots[position];
+        slot.referenced = true;
+        Some(slot.hash)
+    }
+
+    /// Cache `hash` under `key`, evicting an entry if the cache is full
+    pub fn insert(&self, key: RangeKey, hash: [u8; 32]) {
+        if self.shard(&key).lock().unwrap().insert(key, hash) {
+            self.evictions.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    /// Drop every cached entry
+    pub fn clear(&self) {
+        for shard in self.shards.iter() {
+            let mut inner = shard.lock().unwrap();
+            inner.index.clear();
+            inner.slots.clear();
+            inner.hand = 0;
+        }
+    }
+
+    /// Hit, miss, eviction and size counters
+    pub fn stats(&self) -> SubtreeCacheStats {
+        let entries = self.shards.iter().map(|shard| shard.lock().unwrap().slots.len()).sum::<usize>();
+        SubtreeCacheStats {
+            hits: self.hits.load(Ordering::Relaxed),
+            misses: self.misses.load(Ordering::Relaxed),
+            evictions: self.evictions.load(Ordering::Relaxed),
+            entries,
+            bytes: entries * ENTRY_BYTES,
+        }
+    }
+
+    /// Root of the binary Merkle tree over `leaves`
+    pub fn merkle_root(&self, leaves: &[[u8; 32]]) -> [u8; 32] {
+        if leaves.len() <= SUBTREE_LEAVES {
+            return merkle_root(leaves);
+        }
+        merkle_root(&self.block_roots(leaves))
+    }
+
+    /// Sibling path from `leaves[index]` to the root, for `verify_merkle_path`
+    pub fn merkle_path(&self, leaves: &[[u8; 32]], index: usize) -> Option<Vec<MerkleNode>> {
+        if index >= leaves.len() {
+            return None;
+        }
+
+        let mut path = Vec::new();
+        if leaves.len() <= SUBTREE_LEAVES {
+            push_path(leaves.to_vec(), index, None, &mut path);
+            return Some(path);
+        }
+
+        // Inside the leaf's block, then up through the block roots
+        let block = index / SUBTREE_LEAVES;
+        let start = block * SUBTREE_LEAVES;
+        let end = (start + SUBTREE_LEAVES).min(leaves.len());
+        push_path(leaves[start..end].to_vec(), index - start, Some(SUBTREE_LEVELS), &mut path);
+        push_path(self.block_roots(leaves), block, None, &mut path);
+        Some(path)
+    }
+
+    /// Level `SUBTREE_LEVELS` of the tree over `leaves`
+    fn block_roots(&self, leaves: &[[u8; 32]]) -> Vec<[u8; 32]> {
+        leaves.par_chunks(SUBTREE_LEAVES).map(|block| self.block_root(block)).collect()
+    }
+
+    fn block_root(&self, block: &[[u8; 32]]) -> [u8; 32] {
+        if block.len() < SUBTREE_LEAVES {
+            // The trailing partial block is hashed as it sits at the tree's
+            // right edge, duplicating odd nodes, and is not cached
+            let mut level = block.to_vec();
+            for _ in 0..SUBTREE_LEVELS {
+                level = hash_level(&level);
+            }
+            return level[0];
+        }
+
+        let key = Self::range_key(block);
+        if let Some(hash) = self.get(&key) {
+            self.hits.fetch_add(1, Ordering::Relaxed);
+            return hash;
+        }
+        self.misses.fetch_add(1, Ordering::Relaxed);
+        let hash = merkle_root(block);
+        self.insert(key, hash);
+        hash
+    }
+}
+
+impl Default for SubtreeCache {
+    fn default() -> Self {
+        Self::new(DEFAULT_SUBTREE_CACHE_BYTES)
+    }
+}
+
+/// Append the siblings of `index` while hashing `level` upward
+///
+/// Runs `levels` rounds, or until a single node remains when `None`.
+fn push_path(mut level: Vec<[u8; 32]>, mut index: usize, levels: Option<usize>, path: &mut Vec<MerkleNode>) {
+    let mut round = 0;
+    while levels.map_or(level.len() > 1, |levels| round < levels) {
+        let sibling = index ^ 1;
+        path.push(MerkleNode {
+            // The last node of an odd level is paired with itself
+            hash: *level.get(sibling).unwrap_or(&level[index]),
+            is_left: sibling < index,
+        });
+        level = hash_level(&level);
+        index /= 2;
+        round += 1;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::engine::ProofEngine;
+
+    fn leaves(count: usize) -> Vec<[u8; 32]> {
+        (0..count as u32).map(|i| hash_bytes(&i.to_le_bytes())).collect()
+    }
+
+    #[test]
+    fn test_cached_roots_and_paths_match_full_tree() {
+        let cache = SubtreeCache::with_capacity(64);
+        let engine = ProofEngine::new();
+
+        for count in [5, SUBTREE_LEAVES, SUBTREE_LEAVES * 3 + 7] {
+            let leaves = leaves(count);
+            let root = merkle_root(&leaves);
+            assert_eq!(cache.merkle_root(&leaves), root);
+
+            for index in [0, count / 2, count - 1] {
+                let path = cache.merkle_path(&leaves, index).unwrap();
+                assert_eq!(engine.verify_merkle_path(&leaves[index], &path).unwrap(), root);
+            }
+        }
+
+        // Rebuilding the same tree is served from the cache
+        let before = cache.stats();
+        cache.merkle_root(&leaves(SUBTREE_LEAVES * 3 + 7));
+        let after = cache.stats();
+        assert_eq!(after.hits - before.hits, 3);
+        assert_eq!(after.misses, before.misses);
+    }
+
+    #[test]
+    fn test_clock_eviction_keeps_referenced_entries() {
+        let cache = SubtreeCache::with_capacity(2);
+        cache.insert([1u8; 32], [1u8; 32]);
+        cache.insert([2u8; 32], [2u8; 32]);
+        assert!(cache.get(&[1u8; 32]).is_some());
+
+        cache.insert([3u8; 32], [3u8; 32]);
+        assert!(cache.get(&[1u8; 32]).is_some());
+        assert!(cache.get(&[2u8; 32]).is_none());
+
+        let stats = cache.stats();
+        assert_eq!((stats.entries, stats.evictions), (2, 1));
+        assert_eq!(stats.bytes, 2 * ENTRY_BYTES);
+    }
+
+    #[test]
+    fn test_sharded_cache_keeps_capacity_and_roots() {
+        let capacity = MIN_SHARD_ENTRIES * 4;
+        let cache = SubtreeCache::with_capacity(capacity);
+        assert_eq!(cache.shards.len(), 4);
+
+        // Fill well past capacity; each shard evicts within its own ring
+        for i in 0..capacity as u32 * 2 {
+            let key = hash_bytes(&i.to_le_bytes());
+            cache.insert(key, key);
+        }
+        let stats = cache.stats();
+        assert_eq!(stats.entries, capacity);
+        assert_eq!(stats.evictions, capacity as u64);
+
+        let leaves = leaves(SUBTREE_LEAVES * 40 + 3);
+        assert_eq!(cache.merkle_root(&leaves), merkle_root(&leaves));
+        let before = cache.stats();
+        assert_eq!(cache.merkle_root(&leaves), merkle_root(&leaves));
+        assert_eq!(cache.stats().hits - before.hits, 40);
+    }
+}
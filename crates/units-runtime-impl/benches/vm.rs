@@ -0,0 +1,75 @@
+//! RISC-V execution of the token and account kernel modules
+//!
+//! The modules are built for the guest target out of tree (see
+//! `crates/units-kernel-modules/README.md`); point `UNITS_TOKEN_ELF` and
+//! `UNITS_ACCOUNT_ELF` at the resulting executables and run
+//! `cargo bench -p units-runtime-impl`. A module whose variable is unset is
+//! skipped.
+
+use std::collections::HashMap;
+
+use criterion::{criterion_group, criterion_main, Criterion, Throughput};
+use units_core_types::id::UnitsObjectId;
+use units_core_types::{ExecutionContext, Instruction, VMExecutor};
+use units_runtime_impl::RiscVExecutor;
+
+const CONTROLLER_ID: UnitsObjectId = UnitsObjectId::new([0u8; 32]);
+
+/// Executable at the path in `variable`, if set
+fn module_elf(variable: &str) -> Option<Vec<u8>> {
+    let Ok(path) = std::env::var(variable) else {
+        eprintln!("{} is not set; skipping", variable);
+        return None;
+    };
+    Some(std::fs::read(&path).unwrap_or_else(|e| panic!("Failed to read {} ({}): {}", variable, path, e)))
+}
+
+fn context(target_function: &str, target_objects: Vec<UnitsObjectId>, params: Vec<u8>) -> ExecutionContext {
+    let instruction = Instruction::new(CONTROLLER_ID, target_function.to_string(), target_objects, params);
+    ExecutionContext::new(instruction, HashMap::new(), 1, 1_700_000_000)
+}
+
+fn bench_module(c: &mut Criterion, name: &str, elf: &[u8], context: &ExecutionContext) {
+    let executor = RiscVExecutor::new();
+    // Fail here rather than timing an error path
+    executor.load_and_execute(elf, context).unwrap();
+
+    let mut group = c.benchmark_group("riscv_load_and_execute");
+    group.throughput(Throughput::Elements(1));
+    group.bench_function(name, |b| b.iter(|| executor.load_and_execute(elf, context).unwrap()));
+    group.finish();
+}
+
+fn bench_token(c: &mut Criterion) {
+    let Some(elf) = module_elf("UNITS_TOKEN_ELF") else {
+        return;
+    };
+    let params = borsh::to_vec(&token::TokenizeParams {
+        initial_supply: 1_000_000,
+        decimals: 9,
+        name: "Bench Token".to_string(),
+        symbol: "BENCH".to_string(),
+    })
+    .unwrap();
+    let targets = vec![UnitsObjectId::new([1u8; 32]), UnitsObjectId::new([2u8; 32])];
+    bench_module(c, "token/create_token", &elf, &context("create_token", targets, params));
+}
+
+fn bench_account(c: &mut Criterion) {
+    let Some(elf) = module_elf("UNITS_ACCOUNT_ELF") else {
+        return;
+    };
+    let params = borsh::to_vec(&account::CreateAccountParams {
+        username: Some("bench_user".to_string()),
+        display_name: Some("Bench User".to_string()),
+        metadata: None,
+        recovery_addresses: None,
+        signature: None,
+    })
+    .unwrap();
+    let targets = vec![UnitsObjectId::new([3u8; 32])];
+    bench_module(c, "account/create_account", &elf, &context("create_account", targets, params));
+}
+
+criterion_group!(benches, bench_token, bench_account);
+criterion_main!(benches);
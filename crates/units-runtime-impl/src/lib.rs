@@ -1,11 +1,19 @@
+pub mod audit;
+pub mod memory_pool;
 pub mod mock_runtime;
+pub mod program_cache;
 pub mod riscv_executor;
 pub mod verification;
 
 // Re-export runtime implementations
+pub use memory_pool::{MemoryPool, MemoryPoolStats};
 pub use mock_runtime::MockRuntime;
+pub use program_cache::{ProgramCache, ProgramCacheStats, ProgramImage};
 pub use riscv_executor::{RiscVExecutor, RiscVExecutorConfig};
-pub use verification::{detect_double_spend, verify_transaction_included, ProofVerifier};
+pub use audit::{AuditEngine, AuditFailure, AuditReport};
+pub use verification::{
+    detect_double_spend, detect_double_spends, verify_transaction_included, DoubleSpend, ProofVerifier,
+};
 
 // Re-export storage implementations for convenience
 pub use units_storage_impl::InMemoryReceiptStorage;
\ No newline at end of file
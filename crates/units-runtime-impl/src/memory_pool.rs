@@ -0,0 +1,163 @@
+//! Pool of reusable RISC-V memory arenas
+//!
+//! Each execution needs an address space. Rather than building a fresh page
+//! table and allocating pages for every transaction, executions take an arena
+//! from the pool and give it back when they finish; the arena is reset over
+//! just the pages and stream bytes it touched.
+//!
+//! The pool is split into one shard per available core and threads pick a
+//! shard by thread id, so worker threads normally reuse their own arenas
+//! without contending on a shared lock.
+
+use std::collections::hash_map::DefaultHasher;
+use std::hash::{Hash, Hasher};
+use std::ops::{Deref, DerefMut};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Mutex;
+
+use crate::riscv_executor::RiscVMemory;
+
+thread_local! {
+    /// Stable per-thread value used to pick a shard
+    static THREAD_SLOT: usize = {
+        let mut hasher = DefaultHasher::new();
+        std::thread::current().id().hash(&mut hasher);
+        hasher.finish() as usize
+    };
+}
+
+/// Memory pool counters
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct MemoryPoolStats {
+    /// Acquisitions served by a pooled arena
+    pub hits: u64,
+    /// Acquisitions that had to allocate a new arena
+    pub misses: u64,
+    /// Idle arenas currently held
+    pub idle: usize,
+}
+
+/// Sharded pool of idle memory arenas
+pub struct MemoryPool {
+    shards: Box<[Mutex<Vec<RiscVMemory>>]>,
+    /// Idle arenas kept per shard
+    per_shard: usize,
+    hits: AtomicU64,
+    misses: AtomicU64,
+}
+
+impl MemoryPool {
+    /// Create a pool keeping up to roughly `capacity` idle arenas
+    ///
+    /// A capacity of zero disables pooling.
+    pub fn new(capacity: usize) -> Self {
+        let workers = std::thread::available_parallelism().map_or(1, |n| n.get());
+        let shards = workers.min(capacity).max(1);
+        Self {
+            shards: (0..shards).map(|_| Mutex::new(Vec::new())).collect(),
+            per_shard: capacity.div_ceil(shards),
+            hits: AtomicU64::new(0),
+            misses: AtomicU64::new(0),
+        }
+    }
+
+    fn shard(&self) -> &Mutex<Vec<RiscVMemory>> {
+        let slot = THREAD_SLOT.with(|slot| *slot);
+        &self.shards[slot % self.shards.len()]
+    }
+
+    /// Take an all-zero arena of `memory_limit` bytes, reusing a pooled one if possible
+    pub(crate) fn acquire(&self, memory_limit: usize) -> PooledMemory<'_> {
+        let pooled = {
+            let mut idle = self.shard().lock().unwrap();
+            let position = idle.iter().rposition(|memory| memory.memory_limit() == memory_limit);
+            position.map(|position| idle.swap_remove(position))
+        };
+
+        let memory = match pooled {
+            Some(memory) => {
+                self.hits.fetch_add(1, Ordering::Relaxed);
+                memory
+            }
+            None => {
+                self.misses.fetch_add(1, Ordering::Relaxed);
+                RiscVMemory::new(memory_limit)
+            }
+        };
+        PooledMemory { pool: self, memory: Some(memory) }
+    }
+
+    fn release(&self, mut memory: RiscVMemory) {
+        if self.per_shard == 0 {
+            return;
+        }
+        memory.reset();
+        let mut idle = self.shard().lock().unwrap();
+        if idle.len() < self.per_shard {
+            idle.push(memory);
+        }
+    }
+
+    /// Hit, miss and idle counters
+    pub fn stats(&self) -> MemoryPoolStats {
+        MemoryPoolStats {
+            hits: self.hits.load(Ordering::Relaxed),
+            misses: self.misses.load(Ordering::Relaxed),
+            idle: self.shards.iter().map(|shard| shard.lock().unwrap().len()).sum(),
+        }
+    }
+}
+
+/// An arena on loan from a `MemoryPool`; returned to the pool on drop
+pub(crate) struct PooledMemory<'a> {
+    pool: &'a MemoryPool,
+    memory: Option<RiscVMemory>,
+}
+
+impl Deref for PooledMemory<'_> {
+    type Target = RiscVMemory;
+
+    fn deref(&self) -> &RiscVMemory {
+        self.memory.as_ref().expect("memory is present until drop")
+    }
+}
+
+impl DerefMut for PooledMemory<'_> {
+    fn deref_mut(&mut self) -> &mut RiscVMemory {
+        self.memory.as_mut().expect("memory is present until drop")
+    }
+}
+
+impl Drop for PooledMemory<'_> {
+    fn drop(&mut self) {
+        if let Some(memory) = self.memory.take() {
+            self.pool.release(memory);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_pool_hits_after_release() {
+        let pool = MemoryPool::new(2);
+        drop(pool.acquire(1 << 16));
+        drop(pool.acquire(1 << 16));
+
+        // A different size can't reuse the idle arena
+        drop(pool.acquire(1 << 17));
+
+        let stats = pool.stats();
+        assert_eq!((stats.hits, stats.misses), (1, 2));
+    }
+
+    #[test]
+    fn test_zero_capacity_disables_pooling() {
+        let pool = MemoryPool::new(0);
+        drop(pool.acquire(1 << 16));
+        drop(pool.acquire(1 << 16));
+        assert_eq!(pool.stats(), MemoryPoolStats { hits: 0, misses: 2, idle: 0 });
+    }
+}
@@ -1,4 +1,5 @@
 use std::collections::HashMap;
+use std::sync::Arc;
 
 use units_core_types::error::RuntimeError;
 use units_core_types::id::UnitsObjectId;
@@ -9,7 +10,8 @@ use units_core_types::transaction::{
 use units_core_types::SlotNumber;
 
 use units_core_types::{Runtime, VMExecutor, Verifier};
-use crate::riscv_executor::RiscVExecutor;
+use crate::program_cache::ProgramCache;
+use crate::riscv_executor::{RiscVExecutor, RiscVExecutorConfig};
 use crate::verification::ProofVerifier;
 
 /// Mock implementation of the Runtime trait for testing purposes
@@ -24,6 +26,8 @@ pub struct MockRuntime {
     objects: HashMap<UnitsObjectId, UnitsObject>,
     /// Verifier for proof and transaction verification
     verifier: ProofVerifier,
+    /// Program images shared by the executors this runtime hands out
+    program_cache: Arc<ProgramCache>,
 }
 
 impl MockRuntime {
@@ -35,9 +39,19 @@ impl MockRuntime {
             current_slot: 0,
             objects: HashMap::new(),
             verifier: ProofVerifier::new(),
+            program_cache: Arc::new(ProgramCache::default()),
         }
     }
 
+    /// Program cache shared by this runtime's RISC-V executors
+    pub fn program_cache(&self) -> &Arc<ProgramCache> {
+        &self.program_cache
+    }
+
+    fn riscv_executor(&self) -> RiscVExecutor {
+        RiscVExecutor::with_cache(RiscVExecutorConfig::default(), Arc::clone(&self.program_cache))
+    }
+
     /// Add a transaction to the mock runtime's transaction store
     pub fn add_transaction(&mut self, transaction: Transaction) {
         self.transactions.insert(transaction.hash, transaction);
@@ -72,14 +86,14 @@ impl MockRuntime {
 impl Runtime for MockRuntime {
     fn get_vm_executor(&self, vm_type: VMType) -> Option<Box<dyn VMExecutor>> {
         match vm_type {
-            VMType::RiscV => Some(Box::new(RiscVExecutor::new())),
-            _ => Some(Box::new(RiscVExecutor::new())), // Future VM types default to RiscV
+            VMType::RiscV => Some(Box::new(self.riscv_executor())),
+            _ => Some(Box::new(self.riscv_executor())), // Future VM types default to RiscV
         }
     }
 
-    fn execute_transaction(&self, _transaction: Transaction) -> TransactionReceipt {
+    fn execute_transaction(&self, transaction: Transaction) -> TransactionReceipt {
         // Mock implementation - just return a basic receipt
-        TransactionReceipt::new([0u8; 32], self.current_slot, true, 0)
+        TransactionReceipt::new(transaction.hash, self.current_slot, true, 0)
     }
 
     fn check_conflicts(&self, _transaction: &Transaction) -> Result<ConflictResult, RuntimeError> {
@@ -119,6 +133,7 @@ impl Clone for MockRuntime {
             current_slot: self.current_slot,
             objects: self.objects.clone(),
             verifier: ProofVerifier::new(), // Create new verifier instance
+            program_cache: Arc::clone(&self.program_cache),
         }
     }
 }
@@ -0,0 +1,183 @@
+//! Cache of decoded RISC-V program images
+//!
+//! Parsing an ELF or RVBC executable and laying its segments out in guest
+//! memory only depends on the executable's bytes, so the result is kept as a
+//! `ProgramImage` keyed by the BLAKE3 hash of those bytes. Executions then
+//! start from the image's pages, which are shared copy-on-write rather than
+//! reloaded into a freshly zeroed address space.
+
+use std::collections::{HashMap, VecDeque};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex};
+
+use crate::riscv_executor::{Page, PAGE_SIZE};
+
+/// Default number of program images kept by a cache
+pub const DEFAULT_PROGRAM_CACHE_CAPACITY: usize = 64;
+
+/// Cache key: BLAKE3 hash of the executable bytes
+pub type ProgramHash = [u8; 32];
+
+/// A validated executable laid out in guest memory
+#[derive(Debug)]
+pub struct ProgramImage {
+    entry_point: u32,
+    /// Non-zero pages of the loaded program, by page index
+    pages: Vec<(usize, Arc<Page>)>,
+}
+
+impl ProgramImage {
+    pub(crate) fn new(entry_point: u32, pages: Vec<(usize, Arc<Page>)>) -> Self {
+        Self { entry_point, pages }
+    }
+
+    /// Address execution starts at
+    pub fn entry_point(&self) -> u32 {
+        self.entry_point
+    }
+
+    /// Number of pages the image occupies
+    pub fn page_count(&self) -> usize {
+        self.pages.len()
+    }
+
+    /// Lowest address above every page of the image
+    pub fn memory_end(&self) -> usize {
+        self.pages.last().map_or(0, |(index, _)| (index + 1) * PAGE_SIZE)
+    }
+
+    pub(crate) fn pages(&self) -> &[(usize, Arc<Page>)] {
+        &self.pages
+    }
+}
+
+/// Program cache counters
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ProgramCacheStats {
+    /// Lookups served from the cache
+    pub hits: u64,
+    /// Lookups that had to decode the program
+    pub misses: u64,
+    /// Images currently cached
+    pub entries: usize,
+}
+
+struct CacheInner {
+    images: HashMap<ProgramHash, Arc<ProgramImage>>,
+    /// Insertion order, oldest first, for eviction
+    order: VecDeque<ProgramHash>,
+}
+
+/// Bounded cache of program images shared between executors
+pub struct ProgramCache {
+    capacity: usize,
+    inner: Mutex<CacheInner>,
+    hits: AtomicU64,
+    misses: AtomicU64,
+}
+
+impl ProgramCache {
+    /// Create a cache holding at most `capacity` images
+    pub fn new(capacity: usize) -> Self {
+        Self {
+            capacity: capacity.max(1),
+            inner: Mutex::new(CacheInner {
+                images: HashMap::new(),
+                order: VecDeque::new(),
+            }),
+            hits: AtomicU64::new(0),
+            misses: AtomicU64::new(0),
+        }
+    }
+
+    /// Hash executable bytes into a cache key
+    pub fn hash_program(bytecode: &[u8]) -> ProgramHash {
+        *blake3::hash(bytecode).as_bytes()
+    }
+
+    /// Return the cached image for `hash`, decoding and inserting it on a miss
+    ///
+    /// Decoding runs outside the cache lock; failures are returned and not cached.
+    pub fn get_or_insert_with<E, F>(&self, hash: ProgramHash, decode: F) -> Result<Arc<ProgramImage>, E>
+    where
+        F: FnOnce() -> Result<ProgramImage, E>,
+    {
+        if let Some(image) = self.inner.lock().unwrap().images.get(&hash) {
+            self.hits.fetch_add(1, Ordering::Relaxed);
+            return Ok(Arc::clone(image));
+        }
+        self.misses.fetch_add(1, Ordering::Relaxed);
+
+        let image = Arc::new(decode()?);
+        let mut inner = self.inner.lock().unwrap();
+        if let Some(existing) = inner.images.get(&hash) {
+            // Another caller decoded the same program concurrently
+            return Ok(Arc::clone(existing));
+        }
+        while inner.images.len() >= self.capacity {
+            match inner.order.pop_front() {
+                Some(oldest) => {
+                    inner.images.remove(&oldest);
+                }
+                None => break,
+            }
+        }
+        inner.images.insert(hash, Arc::clone(&image));
+        inner.order.push_back(hash);
+        Ok(image)
+    }
+
+    /// Drop every cached image
+    pub fn clear(&self) {
+        let mut inner = self.inner.lock().unwrap();
+        inner.images.clear();
+        inner.order.clear();
+    }
+
+    /// Hit, miss and size counters
+    pub fn stats(&self) -> ProgramCacheStats {
+        ProgramCacheStats {
+            hits: self.hits.load(Ordering::Relaxed),
+            misses: self.misses.load(Ordering::Relaxed),
+            entries: self.inner.lock().unwrap().images.len(),
+        }
+    }
+}
+
+impl Default for ProgramCache {
+    fn default() -> Self {
+        Self::new(DEFAULT_PROGRAM_CACHE_CAPACITY)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn image(entry_point: u32) -> Result<ProgramImage, ()> {
+        Ok(ProgramImage::new(entry_point, vec![(1, Arc::new([0u8; PAGE_SIZE]))]))
+    }
+
+    #[test]
+    fn test_hits_misses_and_eviction() {
+        let cache = ProgramCache::new(2);
+        let (a, b, c) = ([1u8; 32], [2u8; 32], [3u8; 32]);
+
+        assert_eq!(cache.get_or_insert_with(a, || image(1)).unwrap().entry_point(), 1);
+        assert_eq!(cache.get_or_insert_with(a, || image(99)).unwrap().entry_point(), 1);
+        cache.get_or_insert_with(b, || image(2)).unwrap();
+        cache.get_or_insert_with(c, || image(3)).unwrap();
+
+        // The oldest entry was evicted to make room
+        assert_eq!(cache.get_or_insert_with(a, || image(4)).unwrap().entry_point(), 4);
+        assert_eq!(cache.stats(), ProgramCacheStats { hits: 1, misses: 4, entries: 2 });
+    }
+
+    #[test]
+    fn test_decode_errors_are_not_cached() {
+        let cache = ProgramCache::new(4);
+        assert!(cache.get_or_insert_with([7u8; 32], || Err::<ProgramImage, _>(())).is_err());
+        assert_eq!(cache.stats().entries, 0);
+        assert_eq!(cache.get_or_insert_with([7u8; 32], || image(8)).unwrap().memory_end(), 2 * PAGE_SIZE);
+    }
+}
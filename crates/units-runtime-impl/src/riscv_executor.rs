@@ -16,17 +16,67 @@
 //!
 //! The bytecode is loaded at address 0x1000, and the entry point is calculated
 //! as 0x1000 + entry_offset.
+//!
+//! ## Memory Layout
+//!
+//! Main memory is `RiscVExecutorConfig::memory_limit` bytes, visible both
+//! from address zero (where raw bytecode loads) and from
+//! `abi::MODULE_BASE_ADDR`, the base kernel modules are linked at. Modules
+//! keep code and data in the first `abi::MODULE_IMAGE_SIZE` bytes, the heap
+//! after that, and `sp` starts at the end of memory.
+//!
+//! ## Execution
+//!
+//! Programs run in chunks of `EXECUTION_CHUNK` steps. Every retired
+//! instruction is charged against `RiscVExecutorConfig::instruction_limit`,
+//! and the wall clock is checked against `timeout_ms` between chunks.
+//! `ecall` is dispatched on `a7` to the kernel SDK syscalls:
+//!
+//! | a7 | syscall     | effect                                           |
+//! |----|-------------|--------------------------------------------------|
+//! | 63 | `sys_read`  | fd 0 streams `[u32 len][context]` from the input buffer |
+//! | 64 | `sys_write` | fd 1 appends to the output buffer, fd 2 is logged |
+//! | 93 | `sys_exit`  | stops execution with exit code `a0`              |
 
-use units_core_types::{ExecutionContext, ObjectEffect, VMExecutionError, VMExecutor};
+use units_core_types::{ExecutionContext, ExecutionMetrics, ObjectEffect, VMExecutionError, VMExecutor};
 use rvsim::*;
-use std::time::Instant;
-use units_core_types::objects::VMType;
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+use std::borrow::Cow;
+use units_core_types::id::UnitsObjectId;
+use units_core_types::objects::{ObjectType, UnitsObject, VMType};
+use units_kernel_sdk::abi;
+use units_kernel_sdk::{self as abi_types, OBJECT_ID_SIZE};
 
-/// RISC-V VM memory layout constants
-const INPUT_BUFFER_ADDR: u32 = 0x10000000;
-const OUTPUT_BUFFER_ADDR: u32 = 0x20000000;
-const MAX_BUFFER_SIZE: u32 = 1024 * 1024; // 1MB limit
+use crate::memory_pool::MemoryPool;
+use crate::program_cache::{ProgramCache, ProgramImage};
+
+/// RISC-V VM memory layout constants (buffers are defined by the kernel SDK ABI)
+const INPUT_BUFFER_ADDR: u32 = abi::INPUT_BUFFER_ADDR;
+const OUTPUT_BUFFER_ADDR: u32 = abi::OUTPUT_BUFFER_ADDR;
+const MAX_BUFFER_SIZE: u32 = abi::MAX_BUFFER_SIZE as u32; // 1MB limit
 const CODE_BASE_ADDR: u32 = 0x1000; // Base address for loading bytecode
+const MODULE_BASE_ADDR: u32 = abi::MODULE_BASE_ADDR;
+
+/// The I/O streams start at the 4-byte length prefix just below each buffer
+const INPUT_STREAM_ADDR: u32 = INPUT_BUFFER_ADDR - 4;
+const OUTPUT_STREAM_ADDR: u32 = OUTPUT_BUFFER_ADDR - 4;
+const STREAM_CAPACITY: usize = MAX_BUFFER_SIZE as usize + 4;
+
+/// Steps executed between timeout checks
+const EXECUTION_CHUNK: u64 = 4096;
+
+/// Syscall numbers (in `a7`) understood by the executor
+const SYS_READ: u32 = 63;
+const SYS_WRITE: u32 = 64;
+const SYS_EXIT: u32 = 93;
+
+/// Argument and return registers
+const REG_SP: usize = 2;
+const REG_A0: usize = 10;
+const REG_A1: usize = 11;
+const REG_A2: usize = 12;
+const REG_A7: usize = 17;
 
 /// Raw bytecode format magic bytes
 const BYTECODE_MAGIC: &[u8; 4] = b"RVBC";
@@ -46,62 +96,296 @@ pub struct RiscVExecutorConfig {
     pub instruction_limit: u64,
     /// Maximum execution time in milliseconds
     pub timeout_ms: u64,
+    /// Number of idle memory arenas kept for reuse across executions
+    pub memory_pool_size: usize,
 }
 
+/// Size of a guest memory page
+pub(crate) const PAGE_SIZE: usize = 4096;
+
+/// One page of guest memory; pages are shared until written
+pub(crate) type Page = [u8; PAGE_SIZE];
+
+/// Zeroed pages a reset memory keeps for reuse (1MB)
+const MAX_SPARE_PAGES: usize = 256;
+
 /// Custom memory implementation for rvsim
-struct RiscVMemory {
-    data: Vec<u8>,
+///
+/// Guest memory is flat from address zero up to `memory_limit`, mapped a
+/// second time at `MODULE_BASE_ADDR` for linked kernel modules, plus two
+/// separately backed windows for the input and output streams so they can
+/// sit at fixed high addresses without allocating the space in between.
+///
+/// Main memory is a table of lazily allocated pages: untouched pages read as
+/// zero and cost nothing, and pages shared with a cached `ProgramImage` are
+/// copied only when the guest first writes to them.
+pub(crate) struct RiscVMemory {
+    pages: Vec<Option<Arc<Page>>>,
     memory_limit: usize,
+    /// Indices of every populated page, so a reset only visits those
+    touched: Vec<usize>,
+    /// Zeroed pages kept from earlier executions for reuse
+    spare: Vec<Arc<Page>>,
+    /// `[u32 len][context]`, mapped at `INPUT_STREAM_ADDR`
+    input: Vec<u8>,
+    /// `[u32 len][effects]`, mapped at `OUTPUT_STREAM_ADDR`; grows on write
+    output: Vec<u8>,
+}
+
+/// Which backing buffer an address resolves to
+enum Region {
+    Main(usize),
+    Input(usize),
+    Output(usize),
 }
 
 impl RiscVMemory {
-    fn new(memory_limit: usize) -> Self {
+    pub(crate) fn new(memory_limit: usize) -> Self {
         Self {
-            data: vec![0u8; memory_limit],
+            pages: vec![None; memory_limit.div_ceil(PAGE_SIZE)],
             memory_limit,
+            touched: Vec::new(),
+            spare: Vec::new(),
+            input: Vec::new(),
+            output: Vec::new(),
+        }
+    }
+
+    /// Memory whose initial contents share the pages of a program image
+    #[cfg(test)]
+    pub(crate) fn from_image(image: &ProgramImage, memory_limit: usize) -> Result<Self, VMExecutionError> {
+        let mut memory = Self::new(memory_limit);
+        memory.map_image(image)?;
+        Ok(memory)
+    }
+
+    /// Map a program image's pages into empty memory, shared copy-on-write
+    pub(crate) fn map_image(&mut self, image: &ProgramImage) -> Result<(), VMExecutionError> {
+        if image.memory_end() > self.memory_limit {
+            return Err(VMExecutionError::MemoryLimitExceeded);
+        }
+        for (index, page) in image.pages() {
+            if self.pages[*index].replace(Arc::clone(page)).is_none() {
+                self.touched.push(*index);
+            }
+        }
+        Ok(())
+    }
+
+    /// The first `len` bytes of the output arena, borrowed when fully written
+    fn output_arena(&self, len: usize) -> Cow<'_, [u8]> {
+        // `output` starts with the 4-byte length prefix
+        match self.output.get(4..4 + len) {
+            Some(arena) => Cow::Borrowed(arena),
+            None => {
+                let mut arena = self.output.get(4..).unwrap_or_default().to_vec();
+                arena.resize(len, 0);
+                Cow::Owned(arena)
+            }
+        }
+    }
+
+    /// Size of main memory in bytes
+    pub(crate) fn memory_limit(&self) -> usize {
+        self.memory_limit
+    }
+
+    /// Return the memory to its all-zero state for reuse
+    ///
+    /// Only populated pages and the written prefix of the I/O streams are
+    /// visited. Pages this memory owned outright are zeroed and kept as spares;
+    /// pages still shared with a program image are simply released.
+    pub(crate) fn reset(&mut self) {
+        for index in self.touched.drain(..) {
+            if let Some(mut page) = self.pages[index].take() {
+                if self.spare.len() < MAX_SPARE_PAGES {
+                    if let Some(data) = Arc::get_mut(&mut page) {
+                        data.fill(0);
+                        self.spare.push(page);
+                    }
+                }
+            }
+        }
+        self.input.clear();
+        self.output.clear();
+    }
+
+    /// Allocated pages and their indices, in address order
+    pub(crate) fn into_pages(self) -> Vec<(usize, Arc<Page>)> {
+        self.pages
+            .into_iter()
+            .enumerate()
+            .filter_map(|(index, page)| page.map(|page| (index, page)))
+            .collect()
+    }
+
+    /// Resolve `addr..addr + len` to a single region, if it fits in one
+    fn region(&self, addr: u32, len: usize) -> Option<Region> {
+        let addr = addr as usize;
+        let end = addr.checked_add(len)?;
+        let input_start = INPUT_STREAM_ADDR as usize;
+        let output_start = OUTPUT_STREAM_ADDR as usize;
+
+        let module_start = MODULE_BASE_ADDR as usize;
+
+        if end <= self.memory_limit {
+            Some(Region::Main(addr))
+        } else if addr >= module_start && end - module_start <= self.memory_limit {
+            Some(Region::Main(addr - module_start))
+        } else if addr >= input_start && end <= input_start + STREAM_CAPACITY {
+            Some(Region::Input(addr - input_start))
+        } else if addr >= output_start && end <= output_start + STREAM_CAPACITY {
+            Some(Region::Output(addr - output_start))
+        } else {
+            None
+        }
+    }
+
+    /// Copy guest memory into `buf`; unwritten bytes read as zero
+    fn load(&self, addr: u32, buf: &mut [u8]) -> bool {
+        let (source, offset) = match self.region(addr, buf.len()) {
+            Some(Region::Main(offset)) => {
+                self.load_pages(offset, buf);
+                return true;
+            }
+            Some(Region::Input(offset)) => (&self.input, offset),
+            Some(Region::Output(offset)) => (&self.output, offset),
+            None => return false,
+        };
+
+        let available = source.len().saturating_sub(offset).min(buf.len());
+        buf[..available].copy_from_slice(&source[offset..offset + available]);
+        buf[available..].fill(0);
+        true
+    }
+
+    /// Copy `bytes` into guest memory
+    fn store(&mut self, addr: u32, bytes: &[u8]) -> bool {
+        let (target, offset) = match self.region(addr, bytes.len()) {
+            Some(Region::Main(offset)) => {
+                self.store_pages(offset, bytes);
+                return true;
+            }
+            Some(Region::Input(offset)) => (&mut self.input, offset),
+            Some(Region::Output(offset)) => (&mut self.output, offset),
+            None => return false,
+        };
+
+        let end = offset + bytes.len();
+        if target.len() < end {
+            target.resize(end, 0);
+        }
+        target[offset..end].copy_from_slice(bytes);
+        true
+    }
+
+    fn load_pages(&self, mut addr: usize, buf: &mut [u8]) {
+        let mut done = 0;
+        while done < buf.len() {
+            let offset = addr % PAGE_SIZE;
+            let n = (PAGE_SIZE - offset).min(buf.len() - done);
+            match &self.pages[addr / PAGE_SIZE] {
+                Some(page) => buf[done..done + n].copy_from_slice(&page[offset..offset + n]),
+                None => buf[done..done + n].fill(0),
+            }
+            done += n;
+            addr += n;
+        }
+    }
+
+    fn store_pages(&mut self, mut addr: usize, bytes: &[u8]) {
+        let mut done = 0;
+        while done < bytes.len() {
+            let offset = addr % PAGE_SIZE;
+            let n = (PAGE_SIZE - offset).min(bytes.len() - done);
+            let index = addr / PAGE_SIZE;
+            let slot = &mut self.pages[index];
+            if slot.is_none() {
+                *slot = Some(self.spare.pop().unwrap_or_else(|| Arc::new([0u8; PAGE_SIZE])));
+                self.touched.push(index);
+            }
+            let page = slot.as_mut().expect("page was just populated");
+            // Copies the page first if it is still shared with a program image
+            Arc::make_mut(page)[offset..offset + n].copy_from_slice(&bytes[done..done + n]);
+            done += n;
+            addr += n;
         }
     }
     
     /// Write bytes to memory at the specified address
     fn write_bytes(&mut self, addr: u32, bytes: &[u8]) -> Result<(), VMExecutionError> {
-        let addr = addr as usize;
-        if addr + bytes.len() > self.memory_limit {
+        if !self.store(addr, bytes) {
             return Err(VMExecutionError::ExecutionFailed("Memory write out of bounds".to_string()));
         }
-        self.data[addr..addr + bytes.len()].copy_from_slice(bytes);
         Ok(())
     }
     
     /// Read bytes from memory at the specified address
     fn read_bytes(&self, addr: u32, len: usize) -> Result<Vec<u8>, VMExecutionError> {
-        let addr = addr as usize;
-        if addr + len > self.memory_limit {
+        let mut bytes = vec![0u8; len];
+        if !self.load(addr, &mut bytes) {
             return Err(VMExecutionError::ExecutionFailed("Memory read out of bounds".to_string()));
         }
-        Ok(self.data[addr..addr + len].to_vec())
+        Ok(bytes)
     }
 }
 
 impl Memory for RiscVMemory {
-    fn access<T: Copy>(&mut self, addr: u32, _access: MemoryAccess<T>) -> bool {
-        let addr = addr as usize;
+    fn access<T: Copy>(&mut self, addr: u32, access: MemoryAccess<T>) -> bool {
         let size = std::mem::size_of::<T>();
-        
-        if addr + size > self.memory_limit {
+        let mut buf = [0u8; 8];
+        if size > buf.len() {
             return false;
         }
-        
-        // For now, simplified implementation - just allow all accesses within bounds
-        true
+
+        match access {
+            MemoryAccess::Load(dest) | MemoryAccess::Exec(dest) => {
+                if !self.load(addr, &mut buf[..size]) {
+                    return false;
+                }
+                // SAFETY: `buf` holds `size_of::<T>()` initialized bytes and T is a plain integer type
+                *dest = unsafe { std::ptr::read_unaligned(buf.as_ptr() as *const T) };
+                true
+            }
+            MemoryAccess::Store(value) => {
+                // SAFETY: reading the bytes of a Copy value that lives for the whole call
+                let bytes = unsafe {
+                    std::slice::from_raw_parts(&value as *const T as *const u8, size)
+                };
+                self.store(addr, bytes)
+            }
+        }
     }
 }
 
+/// Raw bytes of a kernel SDK object id
+fn id_bytes(id: &abi_types::UnitsObjectId) -> [u8; OBJECT_ID_SIZE] {
+    let mut bytes = [0u8; OBJECT_ID_SIZE];
+    bytes.copy_from_slice(id.bytes());
+    bytes
+}
+
+/// Guest-side cursors for the syscall streams
+struct GuestIo {
+    /// Next input byte to hand out, relative to `INPUT_STREAM_ADDR`
+    read_pos: usize,
+    /// Bytes written to the output stream so far
+    write_pos: usize,
+}
+
+/// Outcome of running a program to completion
+struct ProgramExit {
+    exit_code: i32,
+    instructions: u64,
+}
+
 impl Default for RiscVExecutorConfig {
     fn default() -> Self {
         Self {
             memory_limit: 16 * 1024 * 1024, // 16MB
             instruction_limit: 1_000_000,   // 1M instructions
             timeout_ms: 5000,               // 5 seconds
+            memory_pool_size: 16,
         }
     }
 }
@@ -109,19 +393,57 @@ impl Default for RiscVExecutorConfig {
 /// RISC-V VM executor implementation using rvsim
 pub struct RiscVExecutor {
     config: RiscVExecutorConfig,
+    /// Decoded program images, possibly shared with other executors
+    programs: Arc<ProgramCache>,
+    /// Reusable memory arenas
+    memory_pool: MemoryPool,
 }
 
 impl RiscVExecutor {
     /// Create a new RISC-V executor with default configuration
     pub fn new() -> Self {
-        Self {
-            config: RiscVExecutorConfig::default(),
-        }
+        Self::with_config(RiscVExecutorConfig::default())
     }
 
     /// Create a new RISC-V executor with custom configuration
     pub fn with_config(config: RiscVExecutorConfig) -> Self {
-        Self { config }
+        Self::with_cache(config, Arc::new(ProgramCache::default()))
+    }
+
+    /// Create an executor that shares an existing program cache
+    pub fn with_cache(config: RiscVExecutorConfig, programs: Arc<ProgramCache>) -> Self {
+        let memory_pool = MemoryPool::new(config.memory_pool_size);
+        Self { config, programs, memory_pool }
+    }
+
+    /// The memory arena pool used by this executor
+    pub fn memory_pool(&self) -> &MemoryPool {
+        &self.memory_pool
+    }
+
+    /// The program cache used by this executor
+    pub fn program_cache(&self) -> &Arc<ProgramCache> {
+        &self.programs
+    }
+
+    /// Decode an ELF or RVBC executable into a program image
+    fn decode_image(&self, bytecode: &[u8]) -> Result<ProgramImage, VMExecutionError> {
+        let mut memory = RiscVMemory::new(self.config.memory_limit);
+
+        // Detect bytecode format and load appropriately
+        let entry_point = if bytecode.len() >= 4 && &bytecode[0..4] == BYTECODE_MAGIC {
+            // Raw bytecode format
+            self.load_raw_bytecode(bytecode, &mut memory)?
+        } else if bytecode.len() >= 4 && &bytecode[0..4] == ELF_MAGIC {
+            // ELF format
+            self.load_elf(bytecode, &mut memory)?
+        } else {
+            return Err(VMExecutionError::InvalidBytecode(
+                "Unknown bytecode format (expected RVBC or ELF)".to_string()
+            ));
+        };
+
+        Ok(ProgramImage::new(entry_point, memory.into_pages()))
     }
 
 
@@ -267,7 +589,7 @@ impl RiscVExecutor {
             }
             
             // Check memory bounds
-            if p_vaddr as usize + p_memsz > self.config.memory_limit {
+            if !matches!(memory.region(p_vaddr, p_memsz), Some(Region::Main(_))) {
                 return Err(VMExecutionError::MemoryLimitExceeded);
             }
             
@@ -295,37 +617,101 @@ impl RiscVExecutor {
         Ok(entry_point)
     }
 
-    /// Setup input buffer with execution context
+    /// Map the execution context into the input buffer using the ABI layout
+    ///
+    /// Only the header and descriptors are assembled on the host; each
+    /// object's data is copied once, straight to its offset in guest memory.
+    /// Objects are laid out in id order so the image is deterministic.
     fn setup_input_buffer(
         &self, 
         memory: &mut RiscVMemory, 
         context: &ExecutionContext
     ) -> Result<(), VMExecutionError> {
-        // Serialize the execution context
-        let context_bytes = bincode::serialize(context)
-            .map_err(|e| VMExecutionError::SerializationError(format!("Context serialization failed: {}", e)))?;
-        
-        // Check if serialized context fits in the buffer
-        if context_bytes.len() > MAX_BUFFER_SIZE as usize {
+        let instruction = &context.instruction;
+        let mut objects: Vec<&UnitsObject> = context.objects.values().collect();
+        objects.sort_unstable_by_key(|object| object.id);
+
+        // Lay out the metadata, then the object data after it
+        let targets_at = abi::context::HEADER_SIZE;
+        let objects_at = abi::align8(targets_at + instruction.target_objects.len() * OBJECT_ID_SIZE);
+        let function_at = objects_at + objects.len() * abi::object::DESCRIPTOR_SIZE;
+        let params_at = function_at + instruction.target_function.len();
+        let metadata_len = params_at + instruction.params.len();
+
+        let mut data_at = Vec::with_capacity(objects.len());
+        let mut total_len = abi::align8(metadata_len);
+        for object in &objects {
+            data_at.push(total_len);
+            total_len = abi::align8(total_len + object.data.len());
+        }
+
+        // Check if the mapped context fits in the buffer
+        if total_len > MAX_BUFFER_SIZE as usize {
             return Err(VMExecutionError::ExecutionFailed(
-                format!("Execution context too large: {} bytes", context_bytes.len())
+                format!("Execution context too large: {} bytes", total_len)
             ));
         }
-        
-        // Write context to input buffer location
-        memory.write_bytes(INPUT_BUFFER_ADDR, &context_bytes)?;
-        
-        // Write buffer size at the beginning of the buffer (for the VM program to know)
-        let size_bytes = (context_bytes.len() as u32).to_le_bytes();
-        memory.write_bytes(INPUT_BUFFER_ADDR - 4, &size_bytes)?;
-        
+
+        let mut metadata = vec![0u8; metadata_len];
+        metadata[..4].copy_from_slice(&abi::context::MAGIC);
+        abi::write_u32(&mut metadata, abi::context::VERSION, abi::ABI_VERSION);
+        abi::write_u64(&mut metadata, abi::context::SLOT, context.slot);
+        abi::write_u64(&mut metadata, abi::context::TIMESTAMP, context.timestamp);
+        metadata[abi::context::CONTROLLER_ID..abi::context::CONTROLLER_ID + OBJECT_ID_SIZE]
+            .copy_from_slice(instruction.controller_id.bytes());
+        for (field, offset, len) in [
+            (abi::context::FUNCTION, function_at, instruction.target_function.len()),
+            (abi::context::PARAMS, params_at, instruction.params.len()),
+            (abi::context::TARGETS, targets_at, instruction.target_objects.len()),
+            (abi::context::OBJECTS, objects_at, objects.len()),
+        ] {
+            abi::write_u32(&mut metadata, field, offset as u32);
+            abi::write_u32(&mut metadata, field + 4, len as u32);
+        }
+
+        for (i, id) in instruction.target_objects.iter().enumerate() {
+            let at = targets_at + i * OBJECT_ID_SIZE;
+            metadata[at..at + OBJECT_ID_SIZE].copy_from_slice(id.bytes());
+        }
+        for (i, object) in objects.iter().enumerate() {
+            let at = objects_at + i * abi::object::DESCRIPTOR_SIZE;
+            abi::write_object_descriptor(
+                &mut metadata[at..at + abi::object::DESCRIPTOR_SIZE],
+                object.id.bytes(),
+                object.controller_id.bytes(),
+                match &object.object_type {
+                    ObjectType::Data => (abi::object::TYPE_DATA, 0),
+                    ObjectType::Executable(VMType::RiscV) => (abi::object::TYPE_EXECUTABLE, abi::object::VM_RISCV),
+                },
+                data_at[i] as u32,
+                object.data.len() as u32,
+            );
+        }
+        metadata[function_at..params_at].copy_from_slice(instruction.target_function.as_bytes());
+        metadata[params_at..].copy_from_slice(&instruction.params);
+
+        // Write buffer size just below the buffer (for the VM program to know),
+        // so the stream read through fd 0 is [u32 len][context]
+        memory.write_bytes(INPUT_STREAM_ADDR, &(total_len as u32).to_le_bytes())?;
+        memory.write_bytes(INPUT_BUFFER_ADDR, &metadata)?;
+        for (object, at) in objects.iter().zip(&data_at) {
+            memory.write_bytes(INPUT_BUFFER_ADDR + *at as u32, &object.data)?;
+        }
+
         Ok(())
     }
 
-    /// Read output buffer and deserialize object effects
-    fn read_output_buffer(&self, memory: &RiscVMemory) -> Result<Vec<ObjectEffect>, VMExecutionError> {
+    /// Read object effects and the reported heap peak from the output arena
+    ///
+    /// Effect descriptors are read in place; before-images are the input
+    /// objects the effects refer to, so only after-image data is copied.
+    fn read_output_buffer(
+        &self,
+        memory: &RiscVMemory,
+        context: &ExecutionContext,
+    ) -> Result<(Vec<ObjectEffect>, u64), VMExecutionError> {
         // Read the output buffer size (stored at OUTPUT_BUFFER_ADDR - 4)
-        let size_bytes = memory.read_bytes(OUTPUT_BUFFER_ADDR - 4, 4)
+        let size_bytes = memory.read_bytes(OUTPUT_STREAM_ADDR, 4)
             .map_err(|e| VMExecutionError::ExecutionFailed(format!("Failed to read output size: {}", e)))?;
         
         let output_size = u32::from_le_bytes([
@@ -341,49 +727,152 @@ impl RiscVExecutor {
         
         // If no output, return empty vector
         if output_size == 0 {
-            return Ok(Vec::new());
+            return Ok((Vec::new(), 0));
         }
-        
-        // Read the output buffer
-        let output_bytes = memory.read_bytes(OUTPUT_BUFFER_ADDR, output_size)
-            .map_err(|e| VMExecutionError::ExecutionFailed(format!("Failed to read output buffer: {}", e)))?;
-        
-        // Deserialize object effects
-        let effects: Vec<ObjectEffect> = bincode::deserialize(&output_bytes)
-            .map_err(|e| VMExecutionError::SerializationError(format!("Failed to deserialize effects: {}", e)))?;
-        
-        Ok(effects)
+
+        let arena = memory.output_arena(output_size);
+        let view = abi::EffectsView::parse(&arena)
+            .map_err(|e| VMExecutionError::SerializationError(format!("Invalid effects arena: {:?}", e)))?;
+
+        let effects = view.iter()
+            .map(|effect| -> Result<ObjectEffect, VMExecutionError> {
+                let object_id = UnitsObjectId::new(id_bytes(&effect.object_id()));
+                let before_image = if effect.has_before() {
+                    let before = context.objects.get(&object_id).cloned().ok_or_else(|| {
+                        VMExecutionError::ExecutionFailed(
+                            format!("Effect on {:?} claims a before-image that was not an input", object_id)
+                        )
+                    })?;
+                    Some(before)
+                } else {
+                    None
+                };
+                let after_image = effect.after().map(|after| UnitsObject {
+                    id: object_id,
+                    controller_id: UnitsObjectId::new(id_bytes(&after.controller_id())),
+                    object_type: match after.object_type() {
+                        abi_types::ObjectType::Data => ObjectType::Data,
+                        abi_types::ObjectType::Executable(abi_types::VMType::RiscV) => ObjectType::Executable(VMType::RiscV),
+                    },
+                    data: after.data().to_vec(),
+                });
+                Ok(ObjectEffect { object_id, before_image, after_image })
+            })
+            .collect::<Result<Vec<_>, _>>()?;
+        Ok((effects, view.heap_peak() as u64))
     }
 
     /// Execute RISC-V program using rvsim
+    ///
+    /// Runs until the guest calls `sys_exit`, charging one unit of fuel per
+    /// retired instruction. Fails with `InstructionLimitExceeded` once the
+    /// budget is spent and `TimeoutExceeded` once `timeout_ms` has elapsed.
     fn execute_program(
         &self,
         memory: &mut RiscVMemory,
         entry_point: u32
-    ) -> Result<i32, VMExecutionError> {
+    ) -> Result<ProgramExit, VMExecutionError> {
         // Create CPU state with the entry point
         let mut cpu = CpuState::new(entry_point);
+        // The stack grows down from the end of the module window
+        cpu.x[REG_SP] = MODULE_BASE_ADDR.wrapping_add(memory.memory_limit() as u32) & !0xf;
         
         // Create a simple clock
         let mut clock = SimpleClock::new();
         
-        // Create interpreter
-        let mut interp = Interp::new(&mut cpu, memory, &mut clock);
-        
-        // For this simplified implementation, we'll run the program once
-        // In a full implementation, we'd have a proper execution loop with timeout and instruction limits
-        let _start_time = Instant::now();
-        
-        // Try to run one step
-        let _result = interp.run();
-        
-        // For now, use a simplified approach - assume the program runs once and terminates
-        // In a full implementation, we'd check for different CpuError types
-        // and handle them appropriately (halt, breakpoint, system calls, etc.)
-        
-        // If we reach here, consider the program executed (for basic testing)
-        // A proper implementation would loop until termination condition
-        Ok(0)
+        let start_time = Instant::now();
+        let timeout = Duration::from_millis(self.config.timeout_ms);
+        let mut io = GuestIo { read_pos: 0, write_pos: 0 };
+        let mut retired = 0u64;
+
+        loop {
+            let fuel = self.config.instruction_limit.saturating_sub(retired);
+            if fuel == 0 {
+                return Err(VMExecutionError::InstructionLimitExceeded);
+            }
+
+            // Step a chunk; the interpreter only borrows the CPU and memory for its duration
+            let mut trap = None;
+            {
+                let mut interp = Interp::new(&mut cpu, &mut *memory, &mut clock);
+                for _ in 0..fuel.min(EXECUTION_CHUNK) {
+                    match interp.step() {
+                        Ok(_) => retired += 1,
+                        Err((error, _)) => {
+                            trap = Some(error);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            match trap {
+                Some(CpuError::Ecall) => {
+                    retired += 1;
+                    if let Some(exit_code) = self.handle_ecall(&mut cpu, memory, &mut io)? {
+                        return Ok(ProgramExit { exit_code, instructions: retired });
+                    }
+                    // Resume after the ecall
+                    cpu.pc = cpu.pc.wrapping_add(4);
+                }
+                Some(error) => {
+                    return Err(VMExecutionError::ExecutionFailed(
+                        format!("CPU fault {:?} at pc {:#010x}", error, cpu.pc)
+                    ));
+                }
+                None => {}
+            }
+
+            if start_time.elapsed() >= timeout {
+                return Err(VMExecutionError::TimeoutExceeded);
+            }
+        }
+    }
+
+    /// Service an `ecall`; returns the exit code if the guest exited
+    fn handle_ecall(
+        &self,
+        cpu: &mut CpuState,
+        memory: &mut RiscVMemory,
+        io: &mut GuestIo,
+    ) -> Result<Option<i32>, VMExecutionError> {
+        let (fd, buf, count) = (cpu.x[REG_A0], cpu.x[REG_A1], cpu.x[REG_A2] as usize);
+
+        let result: i64 = match cpu.x[REG_A7] {
+            SYS_EXIT => return Ok(Some(cpu.x[REG_A0] as i32)),
+            SYS_READ if fd == 0 => {
+                let remaining = memory.input.len().saturating_sub(io.read_pos);
+                let n = count.min(remaining);
+                let chunk = memory.input[io.read_pos..io.read_pos + n].to_vec();
+                if memory.store(buf, &chunk) {
+                    io.read_pos += n;
+                    n as i64
+                } else {
+                    -1
+                }
+            }
+            SYS_WRITE if (fd == 1 || fd == 2) && count <= STREAM_CAPACITY => match memory.read_bytes(buf, count) {
+                Ok(bytes) if fd == 2 => {
+                    log::debug!("guest stderr: {}", String::from_utf8_lossy(&bytes));
+                    count as i64
+                }
+                Ok(bytes) if io.write_pos + bytes.len() <= STREAM_CAPACITY => {
+                    memory.write_bytes(OUTPUT_STREAM_ADDR + io.write_pos as u32, &bytes)?;
+                    io.write_pos += bytes.len();
+                    count as i64
+                }
+                _ => -1,
+            },
+            SYS_READ | SYS_WRITE => -1,
+            other => {
+                return Err(VMExecutionError::ExecutionFailed(
+                    format!("Unsupported syscall {}", other)
+                ));
+            }
+        };
+
+        cpu.x[REG_A0] = result as u32;
+        Ok(None)
     }
 }
 
@@ -403,40 +892,57 @@ impl VMExecutor for RiscVExecutor {
         bytecode: &[u8],
         context: &ExecutionContext,
     ) -> Result<Vec<ObjectEffect>, VMExecutionError> {
-        // 1. Create memory for the RISC-V VM
-        let mut memory = RiscVMemory::new(self.config.memory_limit);
+        self.load_and_execute_metered(bytecode, context)
+            .map(|(effects, _)| effects)
+    }
 
-        // 2. Detect bytecode format and load appropriately
-        let entry_point = if bytecode.len() >= 4 && &bytecode[0..4] == BYTECODE_MAGIC {
-            // Raw bytecode format
-            self.load_raw_bytecode(bytecode, &mut memory)?
-        } else if bytecode.len() >= 4 && &bytecode[0..4] == b"\x7fELF" {
-            // ELF format
-            self.load_elf(bytecode, &mut memory)?
-        } else {
-            return Err(VMExecutionError::InvalidBytecode(
-                "Unknown bytecode format (expected RVBC or ELF)".to_string()
-            ));
-        };
+    fn load_and_execute_metered(
+        &self,
+        bytecode: &[u8],
+        context: &ExecutionContext,
+    ) -> Result<(Vec<ObjectEffect>, ExecutionMetrics), VMExecutionError> {
+        let start_time = Instant::now();
+
+        // 1. Look up (or decode) the program image
+        let image = self.programs.get_or_insert_with(ProgramCache::hash_program(bytecode), || {
+            self.decode_image(bytecode)
+        })?;
+
+        // 2. Take a memory arena from the pool and map the image's pages copy-on-write;
+        //    the arena goes back to the pool when `memory` is dropped
+        let mut memory = self.memory_pool.acquire(self.config.memory_limit);
+        memory.map_image(&image)?;
+        let entry_point = image.entry_point();
 
         // 3. Set up input buffer with serialized ExecutionContext
         self.setup_input_buffer(&mut memory, context)?;
 
         // 4. Execute the program
-        let exit_code = self.execute_program(&mut memory, entry_point)?;
+        let exit = self.execute_program(&mut memory, entry_point)?;
+        let mut metrics = ExecutionMetrics {
+            instructions: exit.instructions,
+            wall_time_us: start_time.elapsed().as_micros() as u64,
+            heap_peak_bytes: 0,
+        };
+        log::debug!(
+            "RISC-V execution retired {} instructions in {}us",
+            metrics.instructions,
+            metrics.wall_time_us
+        );
 
         // 5. Check exit code
-        if exit_code != 0 {
-            return Err(VMExecutionError::ExecutionFailed(format!("Program exited with code: {}", exit_code)));
+        if exit.exit_code != 0 {
+            return Err(VMExecutionError::ExecutionFailed(format!("Program exited with code: {}", exit.exit_code)));
         }
 
         // 6. Read and deserialize ObjectEffects from output buffer
-        let effects = self.read_output_buffer(&memory)?;
+        let (effects, heap_peak_bytes) = self.read_output_buffer(&memory, context)?;
+        metrics.heap_peak_bytes = heap_peak_bytes;
 
         // 7. Validate effects (controller can only modify objects it controls)
         units_core_types::validate_object_effects(&effects, context.instruction.controller_id)?;
 
-        Ok(effects)
+        Ok((effects, metrics))
     }
 }
 
@@ -457,6 +963,7 @@ mod tests {
             memory_limit: 8 * 1024 * 1024,
             instruction_limit: 500_000,
             timeout_ms: 1000,
+            ..RiscVExecutorConfig::default()
         };
         
         let custom_executor = RiscVExecutor::with_config(custom_config.clone());
@@ -711,4 +1218,332 @@ mod tests {
             _ => panic!("Expected InvalidBytecode error for unknown format"),
         }
     }
-}
\ No newline at end of file
+
+    /// Encode `addi rd, rs1, imm`
+    fn addi(rd: u32, rs1: u32, imm: i32) -> [u8; 4] {
+        (((imm as u32) << 20) | (rs1 << 15) | (rd << 7) | 0x13).to_le_bytes()
+    }
+
+    /// Encode `lui rd, imm`
+    fn lui(rd: u32, imm: u32) -> [u8; 4] {
+        ((imm << 12) | (rd << 7) | 0x37).to_le_bytes()
+    }
+
+    /// Encode `lw rd, 0(rs1)`
+    fn lw(rd: u32, rs1: u32) -> [u8; 4] {
+        ((rs1 << 15) | (0b010 << 12) | (rd << 7) | 0x03).to_le_bytes()
+    }
+
+    /// Encode `sw rs2, 0(rs1)`
+    fn sw(rs2: u32, rs1: u32) -> [u8; 4] {
+        ((rs2 << 20) | (rs1 << 15) | (0b010 << 12) | 0x23).to_le_bytes()
+    }
+
+    const ECALL: [u8; 4] = [0x73, 0x00, 0x00, 0x00];
+    const JUMP_SELF: [u8; 4] = [0x6f, 0x00, 0x00, 0x00];
+
+    fn raw_program(instructions: &[[u8; 4]]) -> Vec<u8> {
+        let mut bytecode = Vec::new();
+        bytecode.extend_from_slice(BYTECODE_MAGIC);
+        bytecode.extend_from_slice(&0u32.to_le_bytes());
+        for instruction in instructions {
+            bytecode.extend_from_slice(instruction);
+        }
+        bytecode
+    }
+
+    /// An ELF32 executable with one segment linked at the module base, like `token/link.x`
+    fn linked_module(instructions: &[[u8; 4]]) -> Vec<u8> {
+        const CODE_OFFSET: usize = 128;
+        let code: Vec<u8> = instructions.concat();
+        let mut elf = vec![0u8; CODE_OFFSET];
+        elf[0..4].copy_from_slice(ELF_MAGIC);
+        elf[4] = 1; // 32-bit
+        elf[5] = 1; // Little-endian
+        elf[6] = 1; // ELF version
+        elf[24..28].copy_from_slice(&MODULE_BASE_ADDR.to_le_bytes()); // e_entry
+        elf[28..32].copy_from_slice(&(ELF32_HEADER_SIZE as u32).to_le_bytes()); // e_phoff
+        elf[42..44].copy_from_slice(&(ELF32_PHDR_SIZE as u16).to_le_bytes()); // e_phentsize
+        elf[44..46].copy_from_slice(&1u16.to_le_bytes()); // e_phnum
+
+        let ph = ELF32_HEADER_SIZE;
+        elf[ph..ph + 4].copy_from_slice(&PT_LOAD.to_le_bytes()); // p_type
+        elf[ph + 4..ph + 8].copy_from_slice(&(CODE_OFFSET as u32).to_le_bytes()); // p_offset
+        elf[ph + 8..ph + 12].copy_from_slice(&MODULE_BASE_ADDR.to_le_bytes()); // p_vaddr
+        elf[ph + 12..ph + 16].copy_from_slice(&MODULE_BASE_ADDR.to_le_bytes()); // p_paddr
+        elf[ph + 16..ph + 20].copy_from_slice(&(code.len() as u32).to_le_bytes()); // p_filesz
+        elf[ph + 20..ph + 24].copy_from_slice(&(code.len() as u32).to_le_bytes()); // p_memsz
+        elf.extend_from_slice(&code);
+        elf
+    }
+
+    fn test_context() -> ExecutionContext {
+        let instruction = Instruction::new(TOKEN_CONTROLLER_ID, "test".to_string(), vec![], vec![]);
+        ExecutionContext::new(instruction, HashMap::new(), 1, 2)
+    }
+
+    #[test]
+    fn test_sys_exit_reports_instruction_count() {
+        let executor = RiscVExecutor::new();
+        let program = raw_program(&[
+            addi(REG_A0 as u32, 0, 0),
+            addi(REG_A7 as u32, 0, SYS_EXIT as i32),
+            ECALL,
+        ]);
+
+        let (effects, metrics) = executor.load_and_execute_metered(&program, &test_context()).unwrap();
+        assert!(effects.is_empty());
+        assert_eq!(metrics.instructions, 3);
+    }
+
+    #[test]
+    fn test_nonzero_exit_code_fails() {
+        let executor = RiscVExecutor::new();
+        let program = raw_program(&[
+            addi(REG_A0 as u32, 0, 7),
+            addi(REG_A7 as u32, 0, SYS_EXIT as i32),
+            ECALL,
+        ]);
+
+        match executor.load_and_execute(&program, &test_context()) {
+            Err(VMExecutionError::ExecutionFailed(msg)) => assert!(msg.contains("code: 7")),
+            other => panic!("Expected exit code failure, got: {:?}", other),
+        }
+    }
+
+    #[test]
+    fn test_linked_module_uses_heap_and_stack() {
+        use units_kernel_sdk::allocator::DEFAULT_HEAP_START;
+        const T0: u32 = 5;
+        const T1: u32 = 6;
+        const T2: u32 = 7;
+        let sp = REG_SP as u32;
+        let a0 = REG_A0 as u32;
+
+        let executor = RiscVExecutor::new();
+        // Round-trip a value through the first heap word and the top of the stack
+        let module = linked_module(&[
+            lui(T0, DEFAULT_HEAP_START as u32 >> 12),
+            addi(T1, 0, 42),
+            sw(T1, T0),
+            lw(T2, T0),
+            addi(sp, sp, -16),
+            sw(T2, sp),
+            lw(a0, sp),
+            addi(a0, a0, -42),
+            addi(REG_A7 as u32, 0, SYS_EXIT as i32),
+            ECALL,
+        ]);
+
+        let (effects, metrics) = executor.load_and_execute_metered(&module, &test_context()).unwrap();
+        assert!(effects.is_empty());
+        assert_eq!(metrics.instructions, 10);
+    }
+
+    #[test]
+    fn test_module_segment_past_memory_limit_is_rejected() {
+        let executor = RiscVExecutor::new();
+        let mut memory = RiscVMemory::new(executor.config.memory_limit);
+        let mut module = linked_module(&[ECALL]);
+        // Stretch the segment's memory size one byte past the module window
+        let memsz = (executor.config.memory_limit + 1) as u32;
+        module[ELF32_HEADER_SIZE + 20..ELF32_HEADER_SIZE + 24].copy_from_slice(&memsz.to_le_bytes());
+
+        assert!(matches!(executor.load_elf(&module, &mut memory), Err(VMExecutionError::MemoryLimitExceeded)));
+    }
+
+    #[test]
+    fn test_sys_read_streams_input() {
+        let executor = RiscVExecutor::new();
+        let mut memory = RiscVMemory::new(executor.config.memory_limit);
+        let context = test_context();
+        executor.setup_input_buffer(&mut memory, &context).unwrap();
+
+        // read(0, 0x800, 4) returns the length prefix of the serialized context
+        let program = raw_program(&[
+            addi(REG_A0 as u32, 0, 0),
+            addi(REG_A1 as u32, 0, 0x400),
+            addi(REG_A1 as u32, REG_A1 as u32, 0x400),
+            addi(REG_A2 as u32, 0, 4),
+            addi(REG_A7 as u32, 0, SYS_READ as i32),
+            ECALL,
+            addi(REG_A7 as u32, 0, SYS_EXIT as i32),
+            ECALL,
+        ]);
+        let entry = executor.load_raw_bytecode(&program, &mut memory).unwrap();
+        let exit = executor.execute_program(&mut memory, entry).unwrap();
+
+        // a0 held the byte count returned by sys_read when the program exited
+        assert_eq!(exit.exit_code, 4);
+        let expected = memory.read_bytes(INPUT_STREAM_ADDR, 4).unwrap();
+        assert_ne!(expected, vec![0u8; 4]);
+        assert_eq!(memory.read_bytes(0x800, 4).unwrap(), expected);
+    }
+
+    #[test]
+    fn test_instruction_limit_is_enforced() {
+        let executor = RiscVExecutor::with_config(RiscVExecutorConfig {
+            instruction_limit: 10_000,
+            timeout_ms: 60_000,
+            ..RiscVExecutorConfig::default()
+        });
+        let program = raw_program(&[JUMP_SELF]);
+
+        match executor.load_and_execute(&program, &test_context()) {
+            Err(VMExecutionError::InstructionLimitExceeded) => {}
+            other => panic!("Expected InstructionLimitExceeded, got: {:?}", other),
+        }
+    }
+
+    #[test]
+    fn test_timeout_is_enforced() {
+        let executor = RiscVExecutor::with_config(RiscVExecutorConfig {
+            instruction_limit: u64::MAX,
+            timeout_ms: 20,
+            ..RiscVExecutorConfig::default()
+        });
+        let program = raw_program(&[JUMP_SELF]);
+
+        match executor.load_and_execute(&program, &test_context()) {
+            Err(VMExecutionError::TimeoutExceeded) => {}
+            other => panic!("Expected TimeoutExceeded, got: {:?}", other),
+        }
+    }
+
+    #[test]
+    fn test_program_image_is_cached_and_copy_on_write() {
+        let executor = RiscVExecutor::new();
+        // Overwrites its own first instruction before exiting:
+        // lui a1, 1; addi a0, x0, 0; sw a0, 0(a1)
+        let lui = ((1u32 << 12) | ((REG_A1 as u32) << 7) | 0x37).to_le_bytes();
+        let store_word = (((REG_A0 as u32) << 20) | ((REG_A1 as u32) << 15) | (0b010 << 12) | 0x23).to_le_bytes();
+        let program = raw_program(&[
+            lui,
+            addi(REG_A0 as u32, 0, 0),
+            store_word,
+            addi(REG_A7 as u32, 0, SYS_EXIT as i32),
+            ECALL,
+        ]);
+
+        for _ in 0..3 {
+            executor.load_and_execute(&program, &test_context()).unwrap();
+        }
+        let stats = executor.program_cache().stats();
+        assert_eq!((stats.hits, stats.misses, stats.entries), (2, 1, 1));
+
+        // The cached image was never written through
+        let image = executor
+            .program_cache()
+            .get_or_insert_with(ProgramCache::hash_program(&program), || Err(VMExecutionError::MemoryLimitExceeded))
+            .unwrap();
+        let memory = RiscVMemory::from_image(&image, executor.config.memory_limit).unwrap();
+        assert_eq!(memory.read_bytes(CODE_BASE_ADDR, 4).unwrap(), lui);
+    }
+
+    #[test]
+    fn test_lazy_pages_read_as_zero() {
+        let mut memory = RiscVMemory::new(1 << 20);
+        assert_eq!(memory.read_bytes(0x5000, 8).unwrap(), vec![0u8; 8]);
+
+        // A write straddling a page boundary allocates just the two pages it touches
+        memory.write_bytes(PAGE_SIZE as u32 - 2, &[1, 2, 3, 4]).unwrap();
+        assert_eq!(memory.read_bytes(PAGE_SIZE as u32 - 2, 4).unwrap(), vec![1, 2, 3, 4]);
+        assert_eq!(memory.into_pages().len(), 2);
+    }
+
+    #[test]
+    fn test_reset_zeroes_only_touched_pages() {
+        let mut memory = RiscVMemory::new(1 << 20);
+        memory.write_bytes(0x3000, &[0xAA; 16]).unwrap();
+        memory.write_bytes(INPUT_STREAM_ADDR, &[1, 2, 3, 4]).unwrap();
+        memory.reset();
+
+        assert_eq!(memory.read_bytes(0x3000, 16).unwrap(), vec![0u8; 16]);
+        assert_eq!(memory.read_bytes(INPUT_STREAM_ADDR, 4).unwrap(), vec![0u8; 4]);
+        assert_eq!(memory.spare.len(), 1);
+
+        // The spare page is reused for the next write
+        memory.write_bytes(0x8000, &[1]).unwrap();
+        assert!(memory.spare.is_empty());
+    }
+
+    #[test]
+    fn test_executions_reuse_pooled_memory() {
+        let executor = RiscVExecutor::new();
+        let program = raw_program(&[
+            addi(REG_A0 as u32, 0, 0),
+            addi(REG_A7 as u32, 0, SYS_EXIT as i32),
+            ECALL,
+        ]);
+
+        for _ in 0..4 {
+            executor.load_and_execute(&program, &test_context()).unwrap();
+        }
+        let stats = executor.memory_pool().stats();
+        assert_eq!((stats.hits, stats.misses), (3, 1));
+    }
+
+    fn context_with_object() -> (ExecutionContext, UnitsObject) {
+        let object = UnitsObject {
+            id: UnitsObjectId::new([5u8; 32]),
+            controller_id: TOKEN_CONTROLLER_ID,
+            object_type: ObjectType::Data,
+            data: vec![1, 2, 3],
+        };
+        let instruction = Instruction::new(
+            TOKEN_CONTROLLER_ID,
+            "transfer".to_string(),
+            vec![object.id],
+            vec![42],
+        );
+        let objects = HashMap::from([(object.id, object.clone())]);
+        (ExecutionContext::new(instruction, objects, 3, 4), object)
+    }
+
+    #[test]
+    fn test_input_buffer_uses_abi_layout() {
+        let executor = RiscVExecutor::new();
+        let mut memory = RiscVMemory::new(executor.config.memory_limit);
+        let (context, object) = context_with_object();
+        executor.setup_input_buffer(&mut memory, &context).unwrap();
+
+        let len = u32::from_le_bytes(memory.read_bytes(INPUT_STREAM_ADDR, 4).unwrap().try_into().unwrap());
+        let buffer = memory.read_bytes(INPUT_BUFFER_ADDR, len as usize).unwrap();
+        let view = abi::ContextView::parse(&buffer).unwrap();
+
+        assert_eq!((view.slot(), view.timestamp()), (3, 4));
+        assert_eq!(view.target_function(), "transfer");
+        assert_eq!(view.params(), &[42]);
+        assert_eq!(view.object_count(), 1);
+        assert_eq!(view.object(0).unwrap().data(), object.data.as_slice());
+    }
+
+    #[test]
+    fn test_output_arena_is_read_without_decoding() {
+        let executor = RiscVExecutor::new();
+        let mut memory = RiscVMemory::new(executor.config.memory_limit);
+        let (context, object) = context_with_object();
+
+        let mut arena = vec![0u8; 1024];
+        let mut writer = abi::EffectWriter::new(&mut arena, 1).unwrap();
+        let id = abi_types::UnitsObjectId::new([5u8; 32]);
+        let controller = abi_types::UnitsObjectId::new(id_bytes_of(&TOKEN_CONTROLLER_ID));
+        writer.push(&id, true, Some((&controller, &abi_types::ObjectType::Data, &[9, 9]))).unwrap();
+        writer.set_heap_peak(4096);
+        let used = writer.finish();
+        memory.write_bytes(OUTPUT_STREAM_ADDR, &(used as u32).to_le_bytes()).unwrap();
+        memory.write_bytes(OUTPUT_BUFFER_ADDR, &arena[..used]).unwrap();
+
+        let (effects, heap_peak) = executor.read_output_buffer(&memory, &context).unwrap();
+        assert_eq!(heap_peak, 4096);
+        assert_eq!(effects.len(), 1);
+        assert_eq!(effects[0].before_image.as_ref(), Some(&object));
+        assert_eq!(effects[0].after_image.as_ref().unwrap().data, vec![9, 9]);
+    }
+
+    fn id_bytes_of(id: &UnitsObjectId) -> [u8; 32] {
+        let mut bytes = [0u8; 32];
+        bytes.copy_from_slice(id.bytes());
+        bytes
+    }
+}
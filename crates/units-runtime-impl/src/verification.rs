@@ -3,6 +3,7 @@
 //! This module provides adapter functions for verifying transaction receipts against
 //! the underlying proof engine.
 
+use std::collections::hash_map::Entry;
 use std::collections::HashMap;
 use units_core_types::id::UnitsObjectId;
 use units_core_types::objects::UnitsObject;
@@ -67,6 +68,20 @@ impl ProofVerifier {
         self.engine.verify_proof_history(object_states, proofs)
     }
 
+    /// Verify the proof chains of many objects, in parallel across objects
+    ///
+    /// # Parameters
+    /// * `histories` - One (object states, object proofs) pair per object, each in ascending slot order
+    ///
+    /// # Returns
+    /// One VerificationResult per object, in the order given
+    pub fn verify_proof_chains(
+        &self,
+        histories: &[(Vec<(SlotNumber, UnitsObject)>, Vec<(SlotNumber, UnitsObjectProof)>)],
+    ) -> Vec<VerificationResult> {
+        self.engine.verify_proof_histories(histories)
+    }
+
     /// Verify a transaction receipt
     ///
     /// # Parameters
@@ -164,10 +179,22 @@ pub fn verify_transaction_included(
     ))
 }
 
+/// Two transactions that modified the same object in the same slot
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct DoubleSpend {
+    pub object_id: UnitsObjectId,
+    pub slot: SlotNumber,
+    /// The first transaction seen modifying the object in the slot
+    pub first: [u8; 32],
+    /// A later, different transaction modifying it in the same slot
+    pub second: [u8; 32],
+}
+
 /// Detect if any double spend exists for an object in a collection of receipts
 ///
 /// A double spend is detected if the same object is modified by two different
-/// transactions in the same slot.
+/// transactions in the same slot. The receipts are scanned once, in any order,
+/// and the earliest such slot is reported.
 ///
 /// # Parameters
 /// * `object_id` - ID of the object to check
@@ -179,36 +206,61 @@ pub fn detect_double_spend(
     object_id: &UnitsObjectId,
     receipts: &[TransactionReceipt],
 ) -> VerificationResult {
-    let mut last_writer: Option<[u8; 32]> = None;
-    let mut slots_by_transaction: HashMap<[u8; 32], SlotNumber> = HashMap::new();
-
-    // Sort receipts by slot
-    let mut sorted_receipts = receipts.to_vec();
-    sorted_receipts.sort_by_key(|r| r.slot);
-
-    for receipt in sorted_receipts {
-        if let Some(_proof) = receipt.object_proofs.get(object_id) {
-            let transaction_hash = receipt.transaction_hash;
-            let slot = receipt.slot;
-
-            if let Some(last_tx) = last_writer {
-                // Check if the previous modification was in an earlier slot
-                let last_slot = slots_by_transaction[&last_tx];
-
-                if last_slot == slot && last_tx != transaction_hash {
-                    return VerificationResult::Invalid(
-                        format!("Double spend detected: Object {:?} modified by two transactions in slot {}",
-                                object_id, slot)
-                    );
+    let mut writers: HashMap<SlotNumber, [u8; 32]> = HashMap::new();
+    let mut earliest: Option<SlotNumber> = None;
+
+    for receipt in receipts.iter().filter(|r| r.object_proofs.contains_key(object_id)) {
+        let first = *writers.entry(receipt.slot).or_insert(receipt.transaction_hash);
+        if first != receipt.transaction_hash {
+            earliest = Some(earliest.map_or(receipt.slot, |slot| slot.min(receipt.slot)));
+        }
+    }
+
+    match earliest {
+        Some(slot) => VerificationResult::Invalid(format!(
+            "Double spend detected: Object {:?} modified by two transactions in slot {}",
+            object_id, slot
+        )),
+        None => VerificationResult::Valid,
+    }
+}
+
+/// Detect every double spend across all objects in a collection of receipts
+///
+/// The receipts are scanned once, remembering the first transaction to
+/// modify each (slot, object) pair; every other transaction modifying the
+/// same pair is reported against it.
+///
+/// # Parameters
+/// * `receipts` - Collection of transaction receipts to analyze, in any order
+///
+/// # Returns
+/// The double spends found, ordered by slot and then object
+pub fn detect_double_spends(receipts: &[TransactionReceipt]) -> Vec<DoubleSpend> {
+    let mut writers: HashMap<(SlotNumber, UnitsObjectId), [u8; 32]> = HashMap::new();
+    let mut found = Vec::new();
+
+    for receipt in receipts {
+        for object_id in receipt.object_proofs.keys() {
+            match writers.entry((receipt.slot, *object_id)) {
+                Entry::Vacant(entry) => {
+                    entry.insert(receipt.transaction_hash);
+                }
+                Entry::Occupied(entry) if *entry.get() != receipt.transaction_hash => {
+                    found.push(DoubleSpend {
+                        object_id: *object_id,
+                        slot: receipt.slot,
+                        first: *entry.get(),
+                        second: receipt.transaction_hash,
+                    });
                 }
+                Entry::Occupied(_) => {}
             }
-
-            last_writer = Some(transaction_hash);
-            slots_by_transaction.insert(transaction_hash, slot);
         }
     }
 
-    VerificationResult::Valid
+    found.sort_by_key(|double_spend| (double_spend.slot, double_spend.object_id));
+    found
 }
 
 /// Implementation of the Verifier trait for ProofVerifier
@@ -348,4 +400,31 @@ mod tests {
         let missing_result = verifier.verify_transaction_receipt(&receipt, &missing_objects);
         assert!(matches!(missing_result, VerificationResult::MissingData(_)));
     }
+
+    #[test]
+    fn test_detect_double_spends_in_one_pass() {
+        let engine = ProofEngine::new();
+        let (shared, other) = (create_test_object(), create_test_object());
+        let receipt = |hash: u8, slot: SlotNumber, objects: &[&UnitsObject]| {
+            let mut receipt = TransactionReceipt::new([hash; 32], slot, true, 0);
+            for object in objects {
+                receipt.add_proof(*object.id(), engine.generate_object_proof(*object, None, Some([hash; 32])).unwrap());
+            }
+            receipt
+        };
+
+        // Out of slot order; only slot 5 has two writers of one object
+        let receipts = vec![
+            receipt(3, 7, &[&shared]),
+            receipt(1, 5, &[&shared, &other]),
+            receipt(2, 5, &[&shared]),
+            receipt(4, 6, &[&other]),
+        ];
+        assert_eq!(
+            detect_double_spends(&receipts),
+            vec![DoubleSpend { object_id: *shared.id(), slot: 5, first: [1u8; 32], second: [2u8; 32] }]
+        );
+        assert!(matches!(detect_double_spend(shared.id(), &receipts), VerificationResult::Invalid(_)));
+        assert_eq!(detect_double_spend(other.id(), &receipts), VerificationResult::Valid);
+    }
 }
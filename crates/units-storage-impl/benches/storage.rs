@@ -0,0 +1,113 @@
+//! Object storage and WAL hot paths
+//!
+//! Run with `cargo bench -p units-storage-impl`.
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use units_core_types::id::UnitsObjectId;
+use units_core_types::objects::UnitsObject;
+use units_core_types::UnitsObjectProof;
+use units_storage_impl::{FileWriteAheadLog, InMemoryObjectStorage, ObjectStorage, WALConfig, WriteAheadLog};
+
+const OBJECT_BYTES: usize = 256;
+
+/// Threads writing the log replayed by the replay benchmarks
+const SETUP_WRITERS: usize = 16;
+
+fn object_id(index: u64) -> UnitsObjectId {
+    let mut bytes = [0u8; 32];
+    bytes[..8].copy_from_slice(&index.to_le_bytes());
+    bytes[24..].copy_from_slice(&index.rotate_left(29).to_le_bytes());
+    UnitsObjectId::new(bytes)
+}
+
+fn object(index: u64) -> UnitsObject {
+    UnitsObject::new_data(object_id(index), UnitsObjectId::new([0xc0; 32]), vec![index as u8; OBJECT_BYTES])
+}
+
+/// Storage holding objects `0..count`, with the proof of each write
+fn populated(count: u64) -> (InMemoryObjectStorage, Vec<(UnitsObject, UnitsObjectProof)>) {
+    let storage = InMemoryObjectStorage::new();
+    let written = (0..count)
+        .map(|index| {
+            let object = object(index);
+            let proof = storage.set(&object, None).unwrap();
+            (object, proof)
+        })
+        .collect();
+    (storage, written)
+}
+
+fn bench_in_memory(c: &mut Criterion) {
+    let mut group = c.benchmark_group("in_memory_object_storage");
+    group.throughput(Throughput::Elements(1));
+
+    let (storage, _) = populated(100_000);
+    let mut next = 0u64;
+    group.bench_function("set", |b| {
+        b.iter(|| {
+            next = (next + 1) % 100_000;
+            storage.set(&object(next), None).unwrap()
+        })
+    });
+    group.bench_function("get", |b| {
+        b.iter(|| {
+            next = (next + 7919) % 100_000;
+            storage.get(&object_id(next)).unwrap()
+        })
+    });
+    group.finish();
+}
+
+fn bench_wal(c: &mut Criterion) {
+    let mut group = c.benchmark_group("file_wal");
+    let (_, written) = populated(10_000);
+
+    // Each append blocks until its group-commit batch is durable
+    let dir = tempfile::tempdir().unwrap();
+    let wal = FileWriteAheadLog::with_config(WALConfig::default());
+    wal.init(dir.path()).unwrap();
+    let mut next = 0;
+    group.throughput(Throughput::Elements(1));
+    group.bench_function("append", |b| {
+        b.iter(|| {
+            let (object, proof) = &written[next % written.len()];
+            next += 1;
+            wal.record_update(object, proof, None).unwrap()
+        })
+    });
+
+    for entries in [1_000usize, 10_000] {
+        let dir = tempfile::tempdir().unwrap();
+        let wal = FileWriteAheadLog::new();
+        wal.init(dir.path()).unwrap();
+        // Concurrent writers share fsyncs, keeping setup short
+        std::thread::scope(|scope| {
+            for chunk in written[..entries].chunks(entries / SETUP_WRITERS) {
+                let wal = &wal;
+                scope.spawn(move || {
+                    for (object, proof) in chunk {
+                        wal.record_update(object, proof, None).unwrap();
+                    }
+                });
+            }
+        });
+        wal.sync().unwrap();
+
+        group.throughput(Throughput::Elements(entries as u64));
+        group.bench_with_input(BenchmarkId::new("replay", entries), &wal, |b, wal| {
+            b.iter(|| {
+                let mut replayed = 0usize;
+                wal.replay(|_, _| {
+                    replayed += 1;
+                    Ok(())
+                })
+                .unwrap();
+                replayed
+            })
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_in_memory, bench_wal);
+criterion_main!(benches);
@@ -5,35 +5,297 @@
 
 use units_core_types::{ObjectStorage, HistoricalStorage, ProofStorage, WriteAheadLog, UnitsStorage as UnitsStorageTrait, ReceiptStorage, LockManager};
 use std::collections::HashMap;
-use std::sync::RwLock;
+use std::path::Path;
+use std::sync::{Arc, Mutex, MutexGuard, RwLock};
 use units_core_types::error::StorageError;
 use units_core_types::id::UnitsObjectId;
-use units_core_types::objects::UnitsObject;
-use units_core_types::{SlotNumber, StateProof, UnitsObjectProof};
-use units_proofs::ProofEngine;
+use units_core_types::objects::{ObjectType, UnitsObject};
+use units_core_types::{page_read_len, ObjectPage, SlotNumber, StateProof, UnitsObjectProof};
+use units_proofs::{ProofEngine, SlotClock};
 
-/// Simple in-memory object storage implementation with integrated proof generation
+use crate::delta_history::{DeltaHistory, PushUndo, DEFAULT_KEYFRAME_INTERVAL};
+use crate::log_store::{LogStoreConfig, LogStructuredStorage};
+use crate::object_index::ObjectIndex;
+use crate::snapshot::{latest_checkpoint, read_chunk, CheckpointPolicy, SnapshotEntry};
+use crate::wal::{FileWriteAheadLog, PendingAppend, WALEntryType};
+
+/// Default number of shards used by `InMemoryObjectStorage::new`
+pub const DEFAULT_SHARD_COUNT: usize = 64;
+
+/// Objects cloned per shard lock acquisition while iterating
+const ITER_CHUNK_SIZE: usize = 256;
+
+/// Everything stored for a single object id
+///
+/// The current state, its historical versions and its proof chain live
+/// together so a write only ever touches one shard lock.
+#[derive(Default)]
+struct ObjectEntry {
+    /// Current state, `None` once the object has been deleted
+    current: Option<Arc<UnitsObject>>,
+    /// Versions by the slot they were written in
+    history: DeltaHistory,
+    /// Proof chain, oldest first
+    proofs: Vec<UnitsObjectProof>,
+}
+
+type Shard = RwLock<HashMap<UnitsObjectId, ObjectEntry>>;
+
+/// A published write and what it replaced, for rolling it back should its
+/// log entry fail to become durable
+pub(crate) struct WriteUndo {
+    id: UnitsObjectId,
+    proof: UnitsObjectProof,
+    previous: Option<Arc<UnitsObject>>,
+    history: PushUndo,
+}
+
+/// Sharded in-memory object storage with integrated proof generation
+///
+/// Objects are spread across a fixed number of shards keyed by their id bytes.
+/// Each shard lock guards the object, its history and its proof chain, so
+/// reading the previous proof and appending the new one happen atomically and
+/// writers to different shards never contend.
+///
+/// Every shard also has a controller/type index over its live objects. It
+/// is only written while the shard's write lock is held and only read while
+/// its read lock is held, so it always agrees with the shard's objects.
+///
+/// History is delta-encoded between keyframes (see `delta_history`).
 pub struct InMemoryObjectStorage {
-    objects: RwLock<HashMap<UnitsObjectId, UnitsObject>>,
-    history: RwLock<HashMap<(UnitsObjectId, SlotNumber), UnitsObject>>,
-    proof_history: RwLock<HashMap<UnitsObjectId, Vec<UnitsObjectProof>>>,
+    shards: Box<[Shard]>,
+    indexes: Box<[RwLock<ObjectIndex>]>,
+    shard_mask: usize,
+    keyframe_interval: usize,
     proof_engine: ProofEngine,
 }
 
 impl InMemoryObjectStorage {
     pub fn new() -> Self {
+        Self::with_shards(DEFAULT_SHARD_COUNT)
+    }
+
+    /// Create storage with at least `shard_count` shards (rounded up to a power of two)
+    pub fn with_shards(shard_count: usize) -> Self {
+        let shard_count = shard_count.max(1).next_power_of_two();
+        let shards = (0..shard_count)
+            .map(|_| RwLock::new(HashMap::new()))
+            .collect::<Vec<_>>()
+            .into_boxed_slice();
+
         Self {
-            objects: RwLock::new(HashMap::new()),
-            history: RwLock::new(HashMap::new()),
-            proof_history: RwLock::new(HashMap::new()),
+            shards,
+            indexes: (0..shard_count).map(|_| RwLock::new(ObjectIndex::new())).collect(),
+            shard_mask: shard_count - 1,
+            keyframe_interval: DEFAULT_KEYFRAME_INTERVAL,
             proof_engine: ProofEngine::new(),
         }
     }
-    
+
+    /// Keep a full copy of every `interval`-th version of an object
+    ///
+    /// Versions in between are stored as deltas, so a larger interval uses
+    /// less memory and makes historical reads apply more deltas. An interval
+    /// of one (or zero) stores every version in full.
+    pub fn with_keyframe_interval(mut self, interval: usize) -> Self {
+        self.keyframe_interval = interval;
+        self
+    }
+
+    /// Number of shards backing this storage
+    pub fn shard_count(&self) -> usize {
+        self.shards.len()
+    }
+
+    /// Clock new proofs are stamped from
+    pub fn slot_clock(&self) -> &SlotClock {
+        self.proof_engine.clock()
+    }
+
     /// Get the most recent proof for an object
     pub fn get_latest_proof(&self, id: &UnitsObjectId) -> Option<UnitsObjectProof> {
-        let proof_history = self.proof_history.read().unwrap();
-        proof_history.get(id)?.last().cloned()
+        let shard = self.shard(id).read().unwrap();
+        shard.get(id)?.proofs.last().cloned()
+    }
+
+    /// Every object live at `slot`, with the proof of that version
+    pub fn states_at_slot(&self, slot: SlotNumber) -> Vec<SnapshotEntry> {
+        let mut states = Vec::new();
+        for shard in self.shards.iter() {
+            let shard = shard.read().unwrap();
+            states.extend(shard.values().filter_map(|entry| {
+                let object = entry.history.as_of(slot)?;
+                let proof = entry.proofs.iter().rev().find(|proof| proof.slot <= slot)?;
+                Some(SnapshotEntry { object, proof: proof.clone() })
+            }));
+        }
+        states
+    }
+
+    /// Install `object` with an existing proof, as recovered from a snapshot or log
+    ///
+    /// Unlike `set`, no proof is generated: `proof` becomes the head of the
+    /// object's chain and the version is filed under the proof's slot.
+    pub fn restore(&self, object: &UnitsObject, proof: &UnitsObjectProof) {
+        let mut shard = self.shard(object.id()).write().unwrap();
+        let entry = shard.entry(*object.id()).or_default();
+
+        let stored = Arc::new(object.clone());
+        entry.history.push(proof.slot, Arc::clone(&stored), false, self.keyframe_interval);
+        entry.current = Some(stored);
+        entry.proofs.push(proof.clone());
+        self.index(object.id()).write().unwrap().insert(object);
+    }
+
+    /// Re-apply a deletion of `id` with its existing proof, as recovered from the log
+    pub fn restore_delete(&self, id: &UnitsObjectId, proof: &UnitsObjectProof) {
+        let mut shard = self.shard(id).write().unwrap();
+        let Some(entry) = shard.get_mut(id) else {
+            return;
+        };
+
+        if let Some(object) = entry.current.take() {
+            entry.history.push(proof.slot, object, true, self.keyframe_interval);
+        }
+        entry.proofs.push(proof.clone());
+        self.index(id).write().unwrap().remove(id);
+    }
+
+    /// `set`, handing the new proof to `log` before the version is published
+    ///
+    /// `log` runs under the shard lock, so entries it queues for one object
+    /// are in the order the writes took effect. Nothing changes if it fails.
+    pub(crate) fn set_logged<T>(
+        &self,
+        object: &UnitsObject,
+        transaction_hash: Option<[u8; 32]>,
+        log: impl FnOnce(&UnitsObjectProof) -> Result<T, StorageError>,
+    ) -> Result<(UnitsObjectProof, T, WriteUndo), StorageError> {
+        let mut shard = self.shard(object.id()).write().unwrap();
+        let entry = shard.entry(*object.id()).or_default();
+
+        // Chain from the previous proof while holding the shard lock so
+        // concurrent writers to the same object cannot fork the chain
+        let proof = self.proof_engine.generate_object_proof(
+            object,
+            entry.proofs.last(),
+            transaction_hash,
+        )?;
+        let logged = log(&proof)?;
+
+        let stored = Arc::new(object.clone());
+        let history = entry.history.push(proof.slot, Arc::clone(&stored), false, self.keyframe_interval);
+        let previous = entry.current.replace(stored);
+        entry.proofs.push(proof.clone());
+        self.index(object.id()).write().unwrap().insert(object);
+
+        let undo = WriteUndo { id: *object.id(), proof: proof.clone(), previous, history };
+        Ok((proof, logged, undo))
+    }
+
+    /// `delete`, handing the removed state and the deletion proof to `log`
+    /// before the deletion is published
+    ///
+    /// As with `set_logged`, `log` runs under the shard lock and nothing
+    /// changes if it fails.
+    pub(crate) fn delete_logged<T>(
+        &self,
+        id: &UnitsObjectId,
+        transaction_hash: Option<[u8; 32]>,
+        log: impl FnOnce(&UnitsObject, &UnitsObjectProof) -> Result<T, StorageError>,
+    ) -> Result<(UnitsObjectProof, T, WriteUndo), StorageError> {
+        let mut shard = self.shard(id).write().unwrap();
+        let entry = shard
+            .get_mut(id)
+            .filter(|entry| entry.current.is_some())
+            .ok_or_else(|| StorageError::NotFound(format!("Object not found: {:?}", id)))?;
+
+        // Generate cryptographic proof for deletion against the last known state
+        let object = Arc::clone(entry.current.as_ref().expect("checked above"));
+        let proof = self.proof_engine.generate_object_proof(
+            object.as_ref(),
+            entry.proofs.last(),
+            transaction_hash,
+        )?;
+        let logged = log(&object, &proof)?;
+
+        // Record the deleted state in history at the deletion slot
+        let history = entry.history.push(proof.slot, Arc::clone(&object), true, self.keyframe_interval);
+        let previous = entry.current.take();
+        entry.proofs.push(proof.clone());
+        self.index(id).write().unwrap().remove(id);
+
+        let undo = WriteUndo { id: *id, proof: proof.clone(), previous, history };
+        Ok((proof, logged, undo))
+    }
+
+    /// Roll back a write published by `set_logged` or `delete_logged`
+    ///
+    /// Returns false, leaving the object alone, if a later write has been
+    /// built on top of it.
+    pub(crate) fn undo(&self, undo: WriteUndo) -> bool {
+        let mut shard = self.shard(&undo.id).write().unwrap();
+        let Some(entry) = shard.get_mut(&undo.id) else {
+            return false;
+        };
+        if entry.proofs.last() != Some(&undo.proof) {
+            return false;
+        }
+
+        entry.proofs.pop();
+        entry.history.undo(undo.history);
+        let mut index = self.index(&undo.id).write().unwrap();
+        match &undo.previous {
+            Some(previous) => index.insert(previous),
+            None => index.remove(&undo.id),
+        }
+        entry.current = undo.previous;
+        true
+    }
+
+    fn shard(&self, id: &UnitsObjectId) -> &Shard {
+        &self.shards[Self::shard_index(id, self.shard_mask)]
+    }
+
+    fn index(&self, id: &UnitsObjectId) -> &RwLock<ObjectIndex> {
+        &self.indexes[Self::shard_index(id, self.shard_mask)]
+    }
+
+    /// Page of objects whose ids `select` draws from each shard's index
+    ///
+    /// Each shard contributes up to `page_read_len(limit)` candidates under its read
+    /// lock; the candidates are merged in id order and only the page itself
+    /// is cloned.
+    fn indexed_page(
+        &self,
+        select: impl Fn(&ObjectIndex, Option<&UnitsObjectId>, usize) -> Vec<UnitsObjectId>,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> ObjectPage {
+        let wanted = page_read_len(limit);
+        let mut candidates: Vec<(UnitsObjectId, Arc<UnitsObject>)> = Vec::new();
+        for (shard, index) in self.shards.iter().zip(self.indexes.iter()) {
+            let shard = shard.read().unwrap();
+            let index = index.read().unwrap();
+            candidates.extend(select(&index, cursor, wanted).into_iter().filter_map(|id| {
+                let object = shard.get(&id)?.current.as_ref()?;
+                Some((id, Arc::clone(object)))
+            }));
+        }
+
+        candidates.sort_unstable_by_key(|(id, _)| *id);
+        candidates.truncate(wanted);
+        ObjectPage::from_sorted(
+            candidates.into_iter().map(|(_, object)| object.as_ref().clone()).collect(),
+            limit,
+        )
+    }
+
+    pub(crate) fn shard_index(id: &UnitsObjectId, mask: usize) -> usize {
+        // Ids are hashes, so the leading bytes are already uniformly distributed
+        let mut prefix = [0u8; 8];
+        prefix.copy_from_slice(&id.bytes()[..8]);
+        (u64::from_le_bytes(prefix) as usize) & mask
     }
 }
 
@@ -45,97 +307,134 @@ impl Default for InMemoryObjectStorage {
 
 impl ObjectStorage for InMemoryObjectStorage {
     fn get(&self, id: &UnitsObjectId) -> Result<Option<UnitsObject>, StorageError> {
-        let objects = self.objects.read().unwrap();
-        Ok(objects.get(id).cloned())
+        let shard = self.shard(id).read().unwrap();
+        Ok(shard
+            .get(id)
+            .and_then(|entry| entry.current.as_deref())
+            .cloned())
     }
-    
+
+    fn get_many(&self, ids: &[UnitsObjectId]) -> Result<Vec<Option<UnitsObject>>, StorageError> {
+        // Visit ids grouped by shard so each shard lock is taken once
+        let mut order: Vec<(usize, usize)> = ids
+            .iter()
+            .enumerate()
+            .map(|(position, id)| (Self::shard_index(id, self.shard_mask), position))
+            .collect();
+        order.sort_unstable();
+
+        let mut objects = vec![None; ids.len()];
+        for group in order.chunk_by(|a, b| a.0 == b.0) {
+            let shard = self.shards[group[0].0].read().unwrap();
+            for &(_, position) in group {
+                objects[position] = shard
+                    .get(&ids[position])
+                    .and_then(|entry| entry.current.as_deref())
+                    .cloned();
+            }
+        }
+        Ok(objects)
+    }
+
     fn set(
         &self,
         object: &UnitsObject,
         transaction_hash: Option<[u8; 32]>,
     ) -> Result<UnitsObjectProof, StorageError> {
-        // Get the previous proof for chaining
-        let prev_proof = self.get_latest_proof(object.id());
-        
-        // Generate cryptographic proof using the proof engine
-        let proof = self.proof_engine.generate_object_proof(
-            object,
-            prev_proof.as_ref(),
-            transaction_hash,
-        )?;
-        
-        // Store the object with current slot in history
-        {
-            let mut history = self.history.write().unwrap();
-            history.insert((*object.id(), proof.slot), object.clone());
-        }
-        
-        // Update current object state
-        {
-            let mut objects = self.objects.write().unwrap();
-            objects.insert(*object.id(), object.clone());
-        }
-        
-        // Store the proof in history
-        {
-            let mut proof_history = self.proof_history.write().unwrap();
-            proof_history.entry(*object.id())
-                .or_insert_with(Vec::new)
-                .push(proof.clone());
-        }
-        
-        Ok(proof)
+        self.set_logged(object, transaction_hash, |_| Ok(())).map(|(proof, _, _)| proof)
     }
-    
+
     fn delete(
         &self,
         id: &UnitsObjectId,
         transaction_hash: Option<[u8; 32]>,
     ) -> Result<UnitsObjectProof, StorageError> {
-        // Get the object before deletion for proof generation
-        let object = {
-            let objects = self.objects.read().unwrap();
-            objects.get(id).cloned()
-                .ok_or_else(|| StorageError::NotFound(format!("Object not found: {:?}", id)))?
-        };
-        
-        // Get the previous proof for chaining
-        let prev_proof = self.get_latest_proof(id);
-        
-        // Generate cryptographic proof for deletion
-        let proof = self.proof_engine.generate_object_proof(
-            &object,
-            prev_proof.as_ref(),
-            transaction_hash,
-        )?;
-        
-        // Store the deletion in history with current slot
-        {
-            let mut history = self.history.write().unwrap();
-            history.insert((*id, proof.slot), object.clone());
-        }
-        
-        // Remove from current object state
-        {
-            let mut objects = self.objects.write().unwrap();
-            objects.remove(id);
-        }
-        
-        // Store the deletion proof in history
-        {
-            let mut proof_history = self.proof_history.write().unwrap();
-            proof_history.entry(*id)
-                .or_insert_with(Vec::new)
-                .push(proof.clone());
-        }
-        
-        Ok(proof)
+        self.delete_logged(id, transaction_hash, |_, _| Ok(())).map(|(proof, _, _)| proof)
     }
-    
+
     fn iter(&self) -> Box<dyn Iterator<Item = Result<UnitsObject, StorageError>> + '_> {
-        let objects = self.objects.read().unwrap();
-        let objects_vec: Vec<_> = objects.values().cloned().collect();
-        Box::new(objects_vec.into_iter().map(Ok))
+        Box::new(ShardChunks {
+            storage: self,
+            shard: 0,
+            cursor: None,
+            chunk: Vec::new().into_iter(),
+        })
+    }
+
+    fn list(
+        &self,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        Ok(self.indexed_page(|index, cursor, limit| index.live(cursor, limit), cursor, limit))
+    }
+
+    fn get_by_controller(
+        &self,
+        controller_id: &UnitsObjectId,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        Ok(self.indexed_page(
+            |index, cursor, limit| index.controlled_by(controller_id, cursor, limit),
+            cursor,
+            limit,
+        ))
+    }
+
+    fn get_by_type(
+        &self,
+        object_type: &ObjectType,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        Ok(self.indexed_page(|index, cursor, limit| index.of_type(object_type, cursor, limit), cursor, limit))
+    }
+}
+
+/// Streaming iterator over `InMemoryObjectStorage`
+///
+/// Walks one shard at a time in id order, cloning `ITER_CHUNK_SIZE` objects
+/// per read lock, so memory stays bounded and writers are only blocked for
+/// one chunk. Each chunk is consistent; the walk as a whole is not a
+/// point-in-time snapshot.
+struct ShardChunks<'a> {
+    storage: &'a InMemoryObjectStorage,
+    shard: usize,
+    /// Last id yielded from the current shard
+    cursor: Option<UnitsObjectId>,
+    chunk: std::vec::IntoIter<UnitsObject>,
+}
+
+impl Iterator for ShardChunks<'_> {
+    type Item = Result<UnitsObject, StorageError>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        loop {
+            if let Some(object) = self.chunk.next() {
+                return Some(Ok(object));
+            }
+            if self.shard >= self.storage.shards.len() {
+                return None;
+            }
+
+            let chunk: Vec<UnitsObject> = {
+                let shard = self.storage.shards[self.shard].read().unwrap();
+                let index = self.storage.indexes[self.shard].read().unwrap();
+                index
+                    .live(self.cursor.as_ref(), ITER_CHUNK_SIZE)
+                    .iter()
+                    .filter_map(|id| shard.get(id)?.current.as_deref().cloned())
+                    .collect()
+            };
+            if chunk.len() < ITER_CHUNK_SIZE {
+                self.shard += 1;
+                self.cursor = None;
+            } else {
+                self.cursor = chunk.last().map(|object| object.id);
+            }
+            self.chunk = chunk.into_iter();
+        }
     }
 }
 
@@ -145,29 +444,34 @@ impl HistoricalStorage for InMemoryObjectStorage {
         id: &UnitsObjectId,
         slot: SlotNumber,
     ) -> Result<Option<UnitsObject>, StorageError> {
-        let history = self.history.read().unwrap();
-        Ok(history.get(&(*id, slot)).cloned())
+        let shard = self.shard(id).read().unwrap();
+        Ok(shard.get(id).and_then(|entry| entry.history.as_of(slot)))
     }
-    
+
     fn get_history(
         &self,
         id: &UnitsObjectId,
         start_slot: SlotNumber,
         end_slot: SlotNumber,
     ) -> Result<Vec<(SlotNumber, UnitsObject)>, StorageError> {
-        let history = self.history.read().unwrap();
-        Ok(history
-            .iter()
-            .filter(|((obj_id, slot), _)| {
-                *obj_id == *id && *slot >= start_slot && *slot <= end_slot
-            })
-            .map(|((_, slot), obj)| (*slot, obj.clone()))
-            .collect())
+        let shard = self.shard(id).read().unwrap();
+        Ok(shard
+            .get(id)
+            .map(|entry| entry.history.in_range(start_slot, end_slot))
+            .unwrap_or_default())
     }
-    
-    fn compact_history(&self, _before_slot: SlotNumber) -> Result<usize, StorageError> {
-        // Simple implementation - could compact history here
-        Ok(0)
+
+    /// Proof chains are left intact, so every retained version can still be
+    /// checked against the chain from its first proof.
+    fn compact_history(&self, before_slot: SlotNumber) -> Result<usize, StorageError> {
+        let mut dropped = 0;
+        for shard in self.shards.iter() {
+            let mut shard = shard.write().unwrap();
+            for entry in shard.values_mut() {
+                dropped += entry.history.compact(before_slot);
+            }
+        }
+        Ok(dropped)
     }
 }
 
@@ -184,6 +488,11 @@ impl InMemoryProofStorage {
             state_proofs: RwLock::new(HashMap::new()),
         }
     }
+
+    /// Latest slot with a stored state proof
+    pub fn latest_state_slot(&self) -> Option<SlotNumber> {
+        self.state_proofs.read().unwrap().keys().max().copied()
+    }
 }
 
 impl Default for InMemoryProofStorage {
@@ -260,7 +569,7 @@ impl ProofStorage for InMemoryProofStorage {
 }
 
 // Re-export from lock_manager module
-pub use crate::lock_manager::{InMemoryLockManager, SimpleLockGuard};
+pub use crate::lock_manager::{InMemoryLockManager, LockStats, StripeContention, StripedLockGuard};
 
 /// No-op write-ahead log implementation
 pub struct NoOpWriteAheadLog;
@@ -287,29 +596,417 @@ impl WriteAheadLog for NoOpWriteAheadLog {
     }
 }
 
+/// Object, history and proof backend selected when the storage is created
+pub enum StorageBackend {
+    /// In-memory storage, volatile unless changes are logged to `wal`
+    InMemory {
+        objects: InMemoryObjectStorage,
+        proofs: InMemoryProofStorage,
+        /// Log of every object change and state proof, replayed on open
+        wal: Option<FileWriteAheadLog>,
+    },
+    /// Persistent log-structured storage backed by segment files
+    LogStructured(LogStructuredStorage),
+}
+
+impl StorageBackend {
+    /// Create an in-memory backend
+    pub fn in_memory() -> Self {
+        Self::in_memory_with_keyframe_interval(DEFAULT_KEYFRAME_INTERVAL)
+    }
+
+    /// Create an in-memory backend keeping a full history version every `interval` writes
+    pub fn in_memory_with_keyframe_interval(interval: usize) -> Self {
+        Self::InMemory {
+            objects: InMemoryObjectStorage::new().with_keyframe_interval(interval),
+            proofs: InMemoryProofStorage::new(),
+            wal: None,
+        }
+    }
+
+    /// Create an in-memory backend recovered from, and logging to, `wal` in `dir`
+    ///
+    /// Object changes and state proofs after the log's latest checkpoint are
+    /// replayed, one thread per shard, before the writer starts accepting
+    /// new records. Durability of each write follows the log's `SyncPolicy`.
+    pub fn in_memory_with_wal(interval: usize, wal: FileWriteAheadLog, dir: &Path) -> Result<Self, StorageError> {
+        wal.init(dir)?;
+        let backend = Self::in_memory_with_keyframe_interval(interval);
+        wal.replay_parallel(backend.shard_count(), None, |record| backend.apply_logged(record))?;
+        Ok(backend.logging_to(wal))
+    }
+
+    /// Log an in-memory backend's changes to `wal` from now on
+    fn logging_to(self, wal: FileWriteAheadLog) -> Self {
+        let Self::InMemory { objects, proofs, .. } = self else {
+            unreachable!("only in-memory backends keep a write-ahead log");
+        };
+        Self::InMemory { objects, proofs, wal: Some(wal) }
+    }
+
+    /// Wait for a queued log entry, rolling its write back if it never becomes durable
+    fn await_logged(objects: &InMemoryObjectStorage, pending: PendingAppend, undo: WriteUndo) -> Result<(), StorageError> {
+        pending.wait().inspect_err(|e| {
+            let id = undo.id;
+            if !objects.undo(undo) {
+                log::error!("Write to {:?} was not logged ({}) and a later write already builds on it", id, e);
+            }
+        })
+    }
+
+    /// Shards that changes to different objects can be applied to concurrently
+    pub fn shard_count(&self) -> usize {
+        match self {
+            Self::InMemory { objects, .. } => objects.shard_count(),
+            Self::LogStructured(_) => 1,
+        }
+    }
+
+    /// Latest slot with a stored state proof, where a restarted node resumes from
+    pub fn latest_state_slot(&self) -> Option<SlotNumber> {
+        match self {
+            Self::InMemory { proofs, .. } => proofs.latest_state_slot(),
+            Self::LogStructured(store) => store.latest_state_slot(),
+        }
+    }
+
+    /// Clock new object proofs are stamped from
+    pub fn slot_clock(&self) -> &SlotClock {
+        match self {
+            Self::InMemory { objects, .. } => objects.slot_clock(),
+            Self::LogStructured(store) => store.slot_clock(),
+        }
+    }
+
+    /// The write-ahead log of an in-memory backend, if it has one
+    pub fn wal(&self) -> Option<&FileWriteAheadLog> {
+        match self {
+            Self::InMemory { wal, .. } => wal.as_ref(),
+            Self::LogStructured(_) => None,
+        }
+    }
+
+    /// Apply a record replayed from a write-ahead log without logging it again
+    pub fn apply_logged(&self, record: &WALEntryType) -> Result<(), StorageError> {
+        match (self, record) {
+            (_, WALEntryType::ObjectUpdate(entry)) => self.restore([(&entry.object, &entry.proof)]),
+            (Self::InMemory { objects, proofs, .. }, WALEntryType::ObjectDelete(entry)) => {
+                objects.restore_delete(entry.object.id(), &entry.proof);
+                proofs.store_object_proof(&entry.proof)
+            }
+            (Self::LogStructured(store), WALEntryType::ObjectDelete(entry)) => {
+                store.delete(entry.object.id(), entry.transaction_hash).map(|_| ())
+            }
+            (Self::InMemory { proofs, .. }, WALEntryType::StateProof(proof)) => proofs.store_state_proof(proof),
+            (Self::LogStructured(store), WALEntryType::StateProof(proof)) => store.store_state_proof(proof),
+            (_, WALEntryType::Checkpoint(_)) => Ok(()),
+        }
+    }
+
+    /// Every object live at `slot`, with the proof of that version
+    pub fn states_at_slot(&self, slot: SlotNumber) -> Result<Vec<SnapshotEntry>, StorageError> {
+        match self {
+            Self::InMemory { objects, .. } => Ok(objects.states_at_slot(slot)),
+            Self::LogStructured(store) => store.states_at_slot(slot),
+        }
+    }
+
+    /// Install objects with their existing proofs, as recovered from a snapshot or log
+    pub fn restore<'a>(
+        &self,
+        states: impl IntoIterator<Item = (&'a UnitsObject, &'a UnitsObjectProof)>,
+    ) -> Result<(), StorageError> {
+        match self {
+            Self::InMemory { objects, proofs, .. } => states.into_iter().try_for_each(|(object, proof)| {
+                objects.restore(object, proof);
+                proofs.store_object_proof(proof)
+            }),
+            Self::LogStructured(store) => store.restore(states),
+        }
+    }
+}
+
+impl ObjectStorage for StorageBackend {
+    fn get(&self, id: &UnitsObjectId) -> Result<Option<UnitsObject>, StorageError> {
+        match self {
+            Self::InMemory { objects, .. } => objects.get(id),
+            Self::LogStructured(store) => store.get(id),
+        }
+    }
+
+    fn get_many(&self, ids: &[UnitsObjectId]) -> Result<Vec<Option<UnitsObject>>, StorageError> {
+        match self {
+            Self::InMemory { objects, .. } => objects.get_many(ids),
+            Self::LogStructured(store) => store.get_many(ids),
+        }
+    }
+
+    fn set(
+        &self,
+        object: &UnitsObject,
+        transaction_hash: Option<[u8; 32]>,
+    ) -> Result<UnitsObjectProof, StorageError> {
+        match self {
+            Self::InMemory { objects, wal, .. } => {
+                let Some(wal) = wal else {
+                    return objects.set(object, transaction_hash);
+                };
+                // Queued under the shard lock, so the log orders writes to
+                // an object as they took effect
+                let (proof, pending, undo) =
+                    objects.set_logged(object, transaction_hash, |proof| wal.queue_update(object, proof, transaction_hash))?;
+                Self::await_logged(objects, pending, undo)?;
+                Ok(proof)
+            }
+            Self::LogStructured(store) => store.set(object, transaction_hash),
+        }
+    }
+
+    fn delete(
+        &self,
+        id: &UnitsObjectId,
+        transaction_hash: Option<[u8; 32]>,
+    ) -> Result<UnitsObjectProof, StorageError> {
+        match self {
+            Self::InMemory { objects, wal, .. } => {
+                let Some(wal) = wal else {
+                    return objects.delete(id, transaction_hash);
+                };
+                // The log keeps the last state, so recovery can file it in history
+                let (proof, pending, undo) = objects.delete_logged(id, transaction_hash, |object, proof| {
+                    wal.queue_delete(object, proof, transaction_hash)
+                })?;
+                Self::await_logged(objects, pending, undo)?;
+                Ok(proof)
+            }
+            Self::LogStructured(store) => store.delete(id, transaction_hash),
+        }
+    }
+
+    fn iter(&self) -> Box<dyn Iterator<Item = Result<UnitsObject, StorageError>> + '_> {
+        match self {
+            Self::InMemory { objects, .. } => objects.iter(),
+            Self::LogStructured(store) => store.iter(),
+        }
+    }
+
+    fn list(
+        &self,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        match self {
+            Self::InMemory { objects, .. } => objects.list(cursor, limit),
+            Self::LogStructured(store) => store.list(cursor, limit),
+        }
+    }
+
+    fn get_by_controller(
+        &self,
+        controller_id: &UnitsObjectId,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        match self {
+            Self::InMemory { objects, .. } => objects.get_by_controller(controller_id, cursor, limit),
+            Self::LogStructured(store) => store.get_by_controller(controller_id, cursor, limit),
+        }
+    }
+
+    fn get_by_type(
+        &self,
+        object_type: &ObjectType,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        match self {
+            Self::InMemory { objects, .. } => objects.get_by_type(object_type, cursor, limit),
+            Self::LogStructured(store) => store.get_by_type(object_type, cursor, limit),
+        }
+    }
+}
+
+impl HistoricalStorage for StorageBackend {
+    fn get_at_slot(
+        &self,
+        id: &UnitsObjectId,
+        slot: SlotNumber,
+    ) -> Result<Option<UnitsObject>, StorageError> {
+        match self {
+            Self::InMemory { objects, .. } => objects.get_at_slot(id, slot),
+            Self::LogStructured(store) => store.get_at_slot(id, slot),
+        }
+    }
+
+    fn get_history(
+        &self,
+        id: &UnitsObjectId,
+        start_slot: SlotNumber,
+        end_slot: SlotNumber,
+    ) -> Result<Vec<(SlotNumber, UnitsObject)>, StorageError> {
+        match self {
+            Self::InMemory { objects, .. } => objects.get_history(id, start_slot, end_slot),
+            Self::LogStructured(store) => store.get_history(id, start_slot, end_slot),
+        }
+    }
+
+    fn compact_history(&self, before_slot: SlotNumber) -> Result<usize, StorageError> {
+        match self {
+            Self::InMemory { objects, .. } => objects.compact_history(before_slot),
+            Self::LogStructured(store) => store.compact_history(before_slot),
+        }
+    }
+}
+
+impl ProofStorage for StorageBackend {
+    fn store_object_proof(&self, proof: &UnitsObjectProof) -> Result<(), StorageError> {
+        match self {
+            Self::InMemory { proofs, .. } => proofs.store_object_proof(proof),
+            Self::LogStructured(store) => store.store_object_proof(proof),
+        }
+    }
+
+    fn get_latest_proof(&self, id: &UnitsObjectId) -> Result<Option<UnitsObjectProof>, StorageError> {
+        match self {
+            // Writes extend the object's own chain; the proof store only holds restored and explicitly stored proofs
+            Self::InMemory { objects, proofs, .. } => match objects.get_latest_proof(id) {
+                Some(proof) => Ok(Some(proof)),
+                None => ProofStorage::get_latest_proof(proofs, id),
+            },
+            Self::LogStructured(store) => store.get_latest_proof(id),
+        }
+    }
+
+    fn get_proof_history(
+        &self,
+        id: &UnitsObjectId,
+        start_slot: Option<SlotNumber>,
+        end_slot: Option<SlotNumber>,
+    ) -> Result<Vec<(SlotNumber, UnitsObjectProof)>, StorageError> {
+        match self {
+            Self::InMemory { proofs, .. } => proofs.get_proof_history(id, start_slot, end_slot),
+            Self::LogStructured(store) => store.get_proof_history(id, start_slot, end_slot),
+        }
+    }
+
+    fn store_state_proof(&self, proof: &StateProof) -> Result<(), StorageError> {
+        match self {
+            Self::InMemory { proofs, wal, .. } => {
+                proofs.store_state_proof(proof)?;
+                // Seals the slot: under `SyncPolicy::PerSlot` this is where its changes become durable
+                match wal {
+                    Some(wal) => wal.record_state_proof(proof),
+                    None => Ok(()),
+                }
+            }
+            Self::LogStructured(store) => store.store_state_proof(proof),
+        }
+    }
+
+    fn get_state_proof(&self, slot: SlotNumber) -> Result<Option<StateProof>, StorageError> {
+        match self {
+            Self::InMemory { proofs, .. } => proofs.get_state_proof(slot),
+            Self::LogStructured(store) => store.get_state_proof(slot),
+        }
+    }
+
+    fn get_state_proof_history(
+        &self,
+        start_slot: SlotNumber,
+        end_slot: SlotNumber,
+    ) -> Result<Vec<StateProof>, StorageError> {
+        match self {
+            Self::InMemory { proofs, .. } => proofs.get_state_proof_history(start_slot, end_slot),
+            Self::LogStructured(store) => store.get_state_proof_history(start_slot, end_slot),
+        }
+    }
+}
+
 /// Complete consolidated storage implementation using composition
 pub struct ConsolidatedUnitsStorage {
-    objects: InMemoryObjectStorage,
-    proofs: InMemoryProofStorage,
-    wal: Option<NoOpWriteAheadLog>,
+    backend: StorageBackend,
     receipts: InMemoryReceiptStorage,
     locks: InMemoryLockManager,
+    /// Where finalized slots are snapshotted to checkpoint the WAL, if anywhere
+    checkpoints: Option<CheckpointPolicy>,
+    /// Held while a checkpoint is written, so checkpoints happen one at a time
+    checkpointing: Mutex<()>,
 }
 
 impl ConsolidatedUnitsStorage {
     pub fn create() -> Self {
+        Self::with_backend(StorageBackend::in_memory())
+    }
+
+    /// Create storage on top of an explicit backend
+    pub fn with_backend(backend: StorageBackend) -> Self {
         Self {
-            objects: InMemoryObjectStorage::new(),
-            proofs: InMemoryProofStorage::new(),
-            wal: Some(NoOpWriteAheadLog),
+            backend,
             receipts: InMemoryReceiptStorage::new(),
             locks: InMemoryLockManager::new(),
+            checkpoints: None,
+            checkpointing: Mutex::new(()),
         }
     }
-    
+
+    /// Checkpoint the WAL behind a snapshot of every slot `policy` makes due
+    pub fn with_checkpoints(mut self, policy: CheckpointPolicy) -> Self {
+        self.checkpoints = Some(policy);
+        self
+    }
+
+    /// Open persistent log-structured storage, recovering any existing segments
+    pub fn open_persistent(config: LogStoreConfig) -> Result<Self, StorageError> {
+        Ok(Self::with_backend(StorageBackend::LogStructured(LogStructuredStorage::open(config)?)))
+    }
+
+    /// Open in-memory storage logging to `wal` in `wal_dir` and checkpointing as `policy` asks
+    ///
+    /// Recovery imports the latest snapshot in the policy's directory, then
+    /// replays the WAL's changes for later slots on top, one thread per
+    /// shard. Fails if the WAL was checkpointed past every snapshot there.
+    pub fn open_in_memory(
+        interval: usize,
+        wal: FileWriteAheadLog,
+        wal_dir: &Path,
+        policy: CheckpointPolicy,
+    ) -> Result<Self, StorageError> {
+        wal.init(wal_dir)?;
+        let recovered = Self::with_backend(StorageBackend::in_memory_with_keyframe_interval(interval));
+        let snapshot = latest_checkpoint(&policy.dir)?;
+        let checkpointed = wal.checkpoint_slot()?;
+        if checkpointed > snapshot.as_ref().map(|(manifest, _)| manifest.slot) {
+            return Err(StorageError::NotFound(format!(
+                "No snapshot in {} for the WAL checkpoint at slot {:?}",
+                policy.dir.display(),
+                checkpointed
+            )));
+        }
+
+        match snapshot {
+            Some((manifest, dir)) => {
+                recovered.import_snapshot_from(&manifest, |chunk| read_chunk(&dir, chunk))?;
+                recovered.replay_wal_after(&wal, manifest.slot)?;
+            }
+            None => {
+                let backend = &recovered.backend;
+                wal.replay_parallel(backend.shard_count(), None, |record| backend.apply_logged(record))?;
+            }
+        }
+        Ok(Self::with_backend(recovered.backend.logging_to(wal)).with_checkpoints(policy))
+    }
+
     /// Get access to object storage
-    pub fn inner(&self) -> &InMemoryObjectStorage {
-        &self.objects
+    pub fn inner(&self) -> &StorageBackend {
+        &self.backend
+    }
+
+    pub(crate) fn checkpoint_policy(&self) -> Option<&CheckpointPolicy> {
+        self.checkpoints.as_ref()
+    }
+
+    pub(crate) fn checkpoint_lock(&self) -> MutexGuard<'_, ()> {
+        self.checkpointing.lock().unwrap()
     }
     
     /// Create in-memory storage for testing
@@ -383,27 +1080,27 @@ impl UnitsStorageTrait for UnitsStorageImpl {
 
 // Also implement for ConsolidatedUnitsStorage
 impl UnitsStorageTrait for ConsolidatedUnitsStorage {
-    type Objects = InMemoryObjectStorage;
-    type Historical = InMemoryObjectStorage;
-    type Proofs = InMemoryProofStorage;
-    type WAL = NoOpWriteAheadLog;
+    type Objects = StorageBackend;
+    type Historical = StorageBackend;
+    type Proofs = StorageBackend;
+    type WAL = FileWriteAheadLog;
     type Receipts = InMemoryReceiptStorage;
     type Locks = InMemoryLockManager;
     
     fn objects(&self) -> &Self::Objects {
-        &self.objects
+        &self.backend
     }
     
     fn historical(&self) -> &Self::Historical {
-        &self.objects
+        &self.backend
     }
     
     fn proofs(&self) -> &Self::Proofs {
-        &self.proofs
+        &self.backend
     }
     
     fn wal(&self) -> Option<&Self::WAL> {
-        self.wal.as_ref()
+        self.backend.wal()
     }
     
     fn receipts(&self) -> &Self::Receipts {
@@ -413,4 +1110,214 @@ impl UnitsStorageTrait for ConsolidatedUnitsStorage {
     fn locks(&self) -> &Self::Locks {
         &self.locks
     }
-}
\ No newline at end of file
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::thread;
+    use units_core_types::PagedObjects;
+
+    fn test_object(seed: u8, payload: Vec<u8>) -> UnitsObject {
+        let mut id = [0u8; 32];
+        id[0] = seed;
+        id[31] = seed;
+        UnitsObject::new_data(UnitsObjectId::new(id), UnitsObjectId::new([9u8; 32]), payload)
+    }
+
+    #[test]
+    fn test_set_get_delete() {
+        let storage = InMemoryObjectStorage::with_shards(4);
+        let object = test_object(1, vec![1, 2, 3]);
+
+        let proof = storage.set(&object, None).unwrap();
+        assert_eq!(storage.get(object.id()).unwrap(), Some(object.clone()));
+        assert_eq!(storage.get_latest_proof(object.id()).map(|p| p.hash()), Some(proof.hash()));
+
+        let delete_proof = storage.delete(object.id(), None).unwrap();
+        assert_eq!(delete_proof.prev_proof_hash, Some(proof.hash()));
+        assert_eq!(storage.get(object.id()).unwrap(), None);
+        assert!(storage.delete(object.id(), None).is_err());
+
+        // The deleted state remains in history
+        let history = storage.get_history(object.id(), 0, u64::MAX).unwrap();
+        assert_eq!(history.last().map(|(_, obj)| obj), Some(&object));
+        assert_eq!(storage.get_at_slot(object.id(), delete_proof.slot).unwrap(), None);
+    }
+
+    #[test]
+    fn test_shard_count_rounds_to_power_of_two() {
+        assert_eq!(InMemoryObjectStorage::with_shards(0).shard_count(), 1);
+        assert_eq!(InMemoryObjectStorage::with_shards(5).shard_count(), 8);
+        assert_eq!(InMemoryObjectStorage::new().shard_count(), DEFAULT_SHARD_COUNT);
+    }
+
+    #[test]
+    fn test_concurrent_writes_keep_proof_chain_linear() {
+        let storage = Arc::new(InMemoryObjectStorage::with_shards(8));
+        let object = test_object(7, vec![0]);
+
+        let handles: Vec<_> = (0..8u8)
+            .map(|i| {
+                let storage = Arc::clone(&storage);
+                let mut object = object.clone();
+                thread::spawn(move || {
+                    for j in 0..25u8 {
+                        object.data = vec![i, j];
+                        storage.set(&object, None).unwrap();
+                    }
+                })
+            })
+            .collect();
+        for handle in handles {
+            handle.join().unwrap();
+        }
+
+        let shard = storage.shard(object.id()).read().unwrap();
+        let proofs = &shard.get(object.id()).unwrap().proofs;
+        assert_eq!(proofs.len(), 200);
+        assert_eq!(proofs[0].prev_proof_hash, None);
+        for pair in proofs.windows(2) {
+            assert_eq!(pair[1].prev_proof_hash, Some(pair[0].hash()));
+        }
+    }
+
+    #[test]
+    fn test_iter_spans_all_shards() {
+        let storage = InMemoryObjectStorage::with_shards(4);
+        for seed in 0..32u8 {
+            storage.set(&test_object(seed, vec![seed]), None).unwrap();
+        }
+        storage.delete(test_object(3, vec![]).id(), None).unwrap();
+
+        let objects: Vec<_> = storage.iter().collect::<Result<_, _>>().unwrap();
+        assert_eq!(objects.len(), 31);
+
+        // Batched reads keep the caller's order and report missing ids
+        let ids = [*test_object(9, vec![]).id(), *test_object(3, vec![]).id(), *test_object(1, vec![]).id()];
+        let fetched = storage.get_many(&ids).unwrap();
+        assert_eq!(fetched, vec![Some(test_object(9, vec![9])), None, Some(test_object(1, vec![1]))]);
+    }
+
+    #[test]
+    fn test_iter_and_list_stream_in_chunks() {
+        let storage = InMemoryObjectStorage::with_shards(2);
+        for i in 0..(ITER_CHUNK_SIZE * 3) as u32 {
+            let mut id = [0u8; 32];
+            id[..4].copy_from_slice(&i.to_le_bytes());
+            storage.set(&UnitsObject::new_data(UnitsObjectId::new(id), UnitsObjectId::new([9u8; 32]), vec![]), None).unwrap();
+        }
+
+        let mut streamed: Vec<_> = storage.iter().map(|object| object.unwrap().id).collect();
+        assert_eq!(streamed.len(), ITER_CHUNK_SIZE * 3);
+
+        // Listing walks the same objects in global id order
+        let listed: Vec<_> = PagedObjects::new(&storage, 100).map(|object| object.unwrap().id).collect();
+        assert!(listed.windows(2).all(|pair| pair[0] < pair[1]));
+        streamed.sort();
+        assert_eq!(listed, streamed);
+    }
+
+    #[test]
+    fn test_controller_index_pages_across_shards() {
+        let storage = InMemoryObjectStorage::with_shards(4);
+        for seed in 0..30u8 {
+            storage.set(&test_object(seed, vec![seed]), None).unwrap();
+        }
+        storage.delete(test_object(3, vec![]).id(), None).unwrap();
+
+        // Moving an object to another controller takes it out of the old page set
+        let mut moved = test_object(4, vec![4]);
+        moved.controller_id = UnitsObjectId::new([8u8; 32]);
+        storage.set(&moved, None).unwrap();
+
+        let controller = UnitsObjectId::new([9u8; 32]);
+        let mut ids = Vec::new();
+        let mut cursor = None;
+        loop {
+            let page = storage.get_by_controller(&controller, cursor.as_ref(), 7).unwrap();
+            assert!(page.objects.len() <= 7);
+            ids.extend(page.objects.iter().map(|object| object.id));
+            cursor = page.next_cursor;
+            if cursor.is_none() {
+                break;
+            }
+        }
+
+        assert_eq!(ids.len(), 28);
+        assert!(ids.windows(2).all(|pair| pair[0] < pair[1]));
+        assert_eq!(storage.get_by_controller(&moved.controller_id, None, 10).unwrap().objects, vec![moved]);
+        assert_eq!(storage.get_by_type(&ObjectType::Data, None, 100).unwrap().objects.len(), 29);
+    }
+
+    #[test]
+    fn test_unlogged_writes_are_not_published_or_are_undone() {
+        let storage = InMemoryObjectStorage::with_shards(4);
+        let original = test_object(1, vec![1]);
+        let first = storage.set(&original, None).unwrap();
+
+        // A log that refuses the entry leaves nothing behind
+        let mut moved = test_object(1, vec![2]);
+        moved.controller_id = UnitsObjectId::new([7u8; 32]);
+        let refused = storage.set_logged(&moved, None, |_| Err::<(), _>(StorageError::WAL("full".to_string())));
+        assert!(refused.is_err());
+        assert_eq!(storage.get(original.id()).unwrap(), Some(original.clone()));
+
+        // A published write and a published delete roll back to the prior state
+        let (_, (), undo) = storage.set_logged(&moved, None, |_| Ok(())).unwrap();
+        assert_eq!(storage.get(original.id()).unwrap(), Some(moved.clone()));
+        assert!(storage.undo(undo));
+        let (_, (), undo) = storage.delete_logged(original.id(), None, |_, _| Ok(())).unwrap();
+        assert_eq!(storage.get(original.id()).unwrap(), None);
+        assert!(storage.undo(undo));
+
+        assert_eq!(storage.get(original.id()).unwrap(), Some(original.clone()));
+        assert_eq!(storage.get_by_controller(&moved.controller_id, None, 10).unwrap().objects, Vec::new());
+        assert_eq!(storage.get_by_controller(&original.controller_id, None, 10).unwrap().objects, vec![original.clone()]);
+        assert_eq!(storage.get_latest_proof(original.id()), Some(first.clone()));
+        assert_eq!(storage.set(&moved, None).unwrap().prev_proof_hash, Some(first.hash()));
+
+        // A write another one already builds on stays
+        let (_, (), undo) = storage.set_logged(&original, None, |_| Ok(())).unwrap();
+        storage.set(&moved, None).unwrap();
+        assert!(!storage.undo(undo));
+        assert_eq!(storage.get(original.id()).unwrap(), Some(moved));
+    }
+
+    #[test]
+    fn test_in_memory_wal_recovers_changes_after_reopen() {
+        let dir = tempfile::tempdir().unwrap();
+        let open = || {
+            StorageBackend::in_memory_with_wal(DEFAULT_KEYFRAME_INTERVAL, FileWriteAheadLog::new(), dir.path()).unwrap()
+        };
+
+        let kept = test_object(1, vec![1]);
+        let deleted = test_object(2, vec![2]);
+        let (kept_proof, state_proof) = {
+            let backend = open();
+            backend.set(&kept, None).unwrap();
+            let kept_proof = backend.set(&kept, None).unwrap();
+            backend.set(&deleted, None).unwrap();
+            backend.delete(deleted.id(), None).unwrap();
+            let state_proof = StateProof {
+                slot: kept_proof.slot,
+                prev_state_proof_hash: None,
+                object_ids: vec![kept.id, deleted.id],
+                proof_data: Vec::new(),
+            };
+            backend.store_state_proof(&state_proof).unwrap();
+            (kept_proof, state_proof)
+        };
+
+        let backend = open();
+        assert_eq!(backend.get(kept.id()).unwrap(), Some(kept.clone()));
+        assert_eq!(backend.get(deleted.id()).unwrap(), None);
+        let history = backend.get_history(deleted.id(), 0, u64::MAX).unwrap();
+        assert_eq!(history.last().map(|(_, object)| object), Some(&deleted));
+        assert_eq!(backend.get_state_proof(state_proof.slot).unwrap().map(|proof| proof.object_ids), Some(state_proof.object_ids));
+
+        // New writes chain from the recovered proofs
+        let next = backend.set(&kept, None).unwrap();
+        assert_eq!(next.prev_proof_hash, Some(kept_proof.hash()));
+    }
+}
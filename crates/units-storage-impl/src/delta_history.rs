@@ -0,0 +1,366 @@
+//! Delta-encoded object history
+//!
+//! Consecutive versions of an object usually differ in a few bytes of its
+//! data, so most versions are stored as an `ObjectDelta` against the version
+//! before them. A full keyframe is kept every `keyframe_interval` versions,
+//! and whenever a delta would not be smaller than the data itself, so
+//! rebuilding any version applies at most `keyframe_interval - 1` deltas to
+//! the nearest earlier keyframe. The oldest retained version is always a
+//! keyframe.
+
+use std::sync::Arc;
+
+use units_core_types::id::UnitsObjectId;
+use units_core_types::objects::{ObjectType, UnitsObject};
+use units_core_types::SlotNumber;
+
+use crate::history::{self, Version, VersionChain};
+
+/// Default number of versions per keyframe
+pub const DEFAULT_KEYFRAME_INTERVAL: usize = 16;
+
+/// Unchanged bytes a patch absorbs rather than starting a new one
+const PATCH_GAP: usize = 8;
+
+/// Bookkeeping charged per patch when choosing between a delta and a keyframe
+const PATCH_OVERHEAD: usize = std::mem::size_of::<(usize, Vec<u8>)>();
+
+/// Changes from one version of an object to the next
+#[derive(Debug, Clone, PartialEq)]
+struct ObjectDelta {
+    controller_id: Option<UnitsObjectId>,
+    object_type: Option<ObjectType>,
+    /// Length of the new data
+    len: usize,
+    /// Byte runs to write, by offset into the new data
+    patches: Vec<(usize, Vec<u8>)>,
+}
+
+impl ObjectDelta {
+    fn between(base: &UnitsObject, next: &UnitsObject) -> Self {
+        let (old, new) = (&base.data, &next.data);
+        let shared = old.len().min(new.len());
+
+        let mut patches = Vec::new();
+        let mut start = 0;
+        while start < shared {
+            if old[start] == new[start] {
+                start += 1;
+                continue;
+            }
+            let mut last = start;
+            let mut next_byte = start + 1;
+            while next_byte < shared && next_byte - last <= PATCH_GAP {
+                if old[next_byte] != new[next_byte] {
+                    last = next_byte;
+                }
+                next_byte += 1;
+            }
+            patches.push((start, new[start..=last].to_vec()));
+            start = last + 1;
+        }
+        if new.len() > shared {
+            patches.push((shared, new[shared..].to_vec()));
+        }
+
+        Self {
+            controller_id: (next.controller_id != base.controller_id).then_some(next.controller_id),
+            object_type: (next.object_type != base.object_type).then(|| next.object_type.clone()),
+            len: new.len(),
+            patches,
+        }
+    }
+
+    /// Approximate bytes held by the delta
+    fn cost(&self) -> usize {
+        self.patches.iter().map(|(_, bytes)| bytes.len() + PATCH_OVERHEAD).sum()
+    }
+
+    /// Turn the base version in `object` into the next version
+    fn apply(&self, object: &mut UnitsObject) {
+        if let Some(controller_id) = self.controller_id {
+            object.controller_id = controller_id;
+        }
+        if let Some(object_type) = &self.object_type {
+            object.object_type = object_type.clone();
+        }
+        object.data.resize(self.len, 0);
+        for (offset, bytes) in &self.patches {
+            object.data[*offset..*offset + bytes.len()].copy_from_slice(bytes);
+        }
+    }
+}
+
+/// How a single version is held
+#[derive(Debug, Clone)]
+enum Stored {
+    Keyframe(Arc<UnitsObject>),
+    Delta(ObjectDelta),
+}
+
+/// What a `push` replaced, so the history can be put back if the write is abandoned
+pub(crate) struct PushUndo {
+    slot: SlotNumber,
+    replaced: Option<Version<Stored>>,
+    tip: Option<Arc<UnitsObject>>,
+    since_keyframe: usize,
+}
+
+/// One object's versions by slot, delta-encoded between keyframes
+#[derive(Default)]
+pub(crate) struct DeltaHistory {
+    versions: VersionChain<Stored>,
+    /// Full state of the newest version, shared with the caller's copy
+    tip: Option<Arc<UnitsObject>>,
+    /// Deltas written since the newest keyframe
+    since_keyframe: usize,
+}
+
+impl DeltaHistory {
+    /// Record `object` as the version written at `slot`
+    pub fn push(&mut self, slot: SlotNumber, object: Arc<UnitsObject>, deleted: bool, keyframe_interval: usize) -> PushUndo {
+        let undo = PushUndo {
+            slot,
+            replaced: self.versions.get(&slot).cloned(),
+            tip: self.tip.clone(),
+            since_keyframe: self.since_keyframe,
+        };
+        let newest = self.versions.last_key_value().map(|(slot, _)| *slot);
+        let in_order = newest.map_or(true, |newest| slot >= newest);
+        let base = match newest {
+            Some(newest) if slot > newest => self.tip.clone(),
+            Some(newest) if slot == newest => {
+                // Rewritten within a slot: encode against the version before it
+                self.versions.pop_last();
+                self.tip = None;
+                self.since_keyframe = self.trailing_deltas();
+                self.versions.last_key_value().map(|(&previous, _)| self.state(previous))
+            }
+            Some(_) => {
+                // Written behind the newest version: make its successor independent of it
+                if let Some(next) = self.versions.range(slot + 1..).next().map(|(slot, _)| *slot) {
+                    self.pin(next);
+                }
+                None
+            }
+            None => None,
+        };
+
+        let delta = base
+            .filter(|_| self.since_keyframe + 1 < keyframe_interval)
+            .map(|base| ObjectDelta::between(&base, &object))
+            .filter(|delta| delta.cost() < object.data.len());
+        let stored = match delta {
+            Some(delta) => {
+                self.since_keyframe += 1;
+                Stored::Delta(delta)
+            }
+            None => {
+                if in_order {
+                    self.since_keyframe = 0;
+                }
+                Stored::Keyframe(Arc::clone(&object))
+            }
+        };
+
+        self.versions.insert(slot, Version { value: stored, deleted });
+        if in_order {
+            self.tip = Some(object);
+        }
+        undo
+    }
+
+    /// Put the history back as it was before the `push` that returned `undo`
+    ///
+    /// Only valid while that push is the newest change to the history.
+    pub fn undo(&mut self, undo: PushUndo) {
+        match undo.replaced {
+            Some(version) => self.versions.insert(undo.slot, version),
+            None => self.versions.remove(&undo.slot),
+        };
+        self.tip = undo.tip;
+        self.since_keyframe = undo.since_keyframe;
+    }
+
+    /// The version that was current at `slot`, unless the object was deleted by then
+    pub fn as_of(&self, slot: SlotNumber) -> Option<UnitsObject> {
+        let (&found, version) = self.versions.range(..=slot).next_back()?;
+        (!version.deleted).then(|| Arc::unwrap_or_clone(self.state(found)))
+    }
+
+    /// Versions written between `start_slot` and `end_slot` inclusive, oldest first
+    ///
+    /// Only the first version is rebuilt from its keyframe; each later one
+    /// applies its own delta to the version before it.
+    pub fn in_range(&self, start_slot: SlotNumber, end_slot: SlotNumber) -> Vec<(SlotNumber, UnitsObject)> {
+        let mut versions = history::in_range(&self.versions, start_slot, end_slot);
+        let Some((first, _)) = versions.next() else {
+            return Vec::new();
+        };
+
+        let mut object = Arc::unwrap_or_clone(self.state(first));
+        let mut rebuilt = vec![(first, object.clone())];
+        for (slot, stored) in versions {
+            match stored {
+                Stored::Keyframe(keyframe) => object = keyframe.as_ref().clone(),
+                Stored::Delta(delta) => delta.apply(&mut object),
+            }
+            rebuilt.push((slot, object.clone()));
+        }
+        rebuilt
+    }
+
+    /// Drop versions unreachable from `before_slot` onwards, returning how many
+    ///
+    /// The oldest surviving version is turned into a keyframe first, since
+    /// the versions it was encoded against are about to go.
+    pub fn compact(&mut self, before_slot: SlotNumber) -> usize {
+        let anchor = self
+            .versions
+            .range(..before_slot)
+            .next_back()
+            .filter(|(_, version)| !version.deleted)
+            .or_else(|| self.versions.range(before_slot..).next())
+            .map(|(slot, _)| *slot);
+        if let Some(anchor) = anchor {
+            self.pin(anchor);
+        }
+
+        let dropped = history::compact(&mut self.versions, before_slot);
+        self.since_keyframe = self.trailing_deltas();
+        if self.versions.is_empty() {
+            self.tip = None;
+        }
+        dropped
+    }
+
+    /// Full state of the version at `slot`, which must exist
+    fn state(&self, slot: SlotNumber) -> Arc<UnitsObject> {
+        if let (Some(tip), Some((&newest, _))) = (&self.tip, self.versions.last_key_value()) {
+            if newest == slot {
+                return Arc::clone(tip);
+            }
+        }
+
+        let mut deltas = Vec::new();
+        for (_, version) in self.versions.range(..=slot).rev() {
+            match &version.value {
+                Stored::Keyframe(keyframe) => {
+                    if deltas.is_empty() {
+                        return Arc::clone(keyframe);
+                    }
+                    let mut object = keyframe.as_ref().clone();
+                    for delta in deltas.iter().rev() {
+                        delta.apply(&mut object);
+                    }
+                    return Arc::new(object);
+                }
+                Stored::Delta(delta) => deltas.push(delta),
+            }
+        }
+        unreachable!("the oldest version is always a keyframe")
+    }
+
+    /// Store the version at `slot` as a keyframe if it is a delta
+    fn pin(&mut self, slot: SlotNumber) {
+        if let Some(Version { value: Stored::Delta(_), .. }) = self.versions.get(&slot) {
+            let keyframe = self.state(slot);
+            if let Some(version) = self.versions.get_mut(&slot) {
+                version.value = Stored::Keyframe(keyframe);
+            }
+        }
+    }
+
+    fn trailing_deltas(&self) -> usize {
+        self.versions
+            .values()
+            .rev()
+            .take_while(|version| matches!(version.value, Stored::Delta(_)))
+            .count()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn balance(amount: u64) -> Arc<UnitsObject> {
+        let mut data = vec![7u8; 120];
+        data[40..48].copy_from_slice(&amount.to_le_bytes());
+        Arc::new(UnitsObject::new_data(UnitsObjectId::new([1u8; 32]), UnitsObjectId::new([2u8; 32]), data))
+    }
+
+    fn keyframes(history: &DeltaHistory) -> usize {
+        history.versions.values().filter(|version| matches!(version.value, Stored::Keyframe(_))).count()
+    }
+
+    #[test]
+    fn test_versions_rebuild_from_keyframes_and_deltas() {
+        let mut history = DeltaHistory::default();
+        for slot in 0..40u64 {
+            history.push(slot, balance(slot * 1000), false, 4);
+        }
+        assert_eq!(keyframes(&history), 10);
+
+        for slot in 0..40u64 {
+            assert_eq!(history.as_of(slot), Some(balance(slot * 1000).as_ref().clone()));
+        }
+        let range = history.in_range(5, 14);
+        assert_eq!(range.len(), 10);
+        assert!(range.iter().all(|(slot, object)| *object == *balance(slot * 1000)));
+
+        // Data, length and controller changes all round-trip
+        let base = balance(1);
+        let mut next = base.as_ref().clone();
+        next.data.truncate(30);
+        next.data[3] = 0;
+        next.controller_id = UnitsObjectId::new([9u8; 32]);
+        let mut rebuilt = base.as_ref().clone();
+        ObjectDelta::between(&base, &next).apply(&mut rebuilt);
+        assert_eq!(rebuilt, next);
+    }
+
+    #[test]
+    fn test_rewrites_and_compaction_keep_versions_intact() {
+        let mut history = DeltaHistory::default();
+        for slot in [10u64, 20, 30] {
+            history.push(slot, balance(slot), false, 8);
+        }
+        // Same-slot rewrite, then a write behind the newest version
+        history.push(30, balance(31), false, 8);
+        history.push(15, balance(15), false, 8);
+        history.push(40, balance(31), true, 8);
+
+        assert_eq!(history.as_of(25), Some(balance(20).as_ref().clone()));
+        assert_eq!(history.as_of(35), Some(balance(31).as_ref().clone()));
+        assert_eq!(history.as_of(40), None);
+
+        // 10 and 15 go; 20 is still the answer at the cutoff
+        assert_eq!(history.compact(25), 2);
+        assert!(matches!(history.versions.first_key_value(), Some((&20, Version { value: Stored::Keyframe(_), .. }))));
+        assert_eq!(history.as_of(25), Some(balance(20).as_ref().clone()));
+        let slots: Vec<_> = history.in_range(0, 50).into_iter().map(|(slot, _)| slot).collect();
+        assert_eq!(slots, vec![20, 30, 40]);
+    }
+
+    #[test]
+    fn test_undo_restores_replaced_versions() {
+        let mut history = DeltaHistory::default();
+        history.push(10, balance(10), false, 8);
+        history.push(20, balance(20), false, 8);
+
+        // A new slot, then a rewrite within the newest slot
+        let undo = history.push(30, balance(30), false, 8);
+        history.undo(undo);
+        assert_eq!(history.as_of(30), Some(balance(20).as_ref().clone()));
+        let undo = history.push(20, balance(21), true, 8);
+        history.undo(undo);
+        assert_eq!(history.as_of(25), Some(balance(20).as_ref().clone()));
+
+        // Later pushes still encode against the restored tip
+        history.push(30, balance(31), false, 8);
+        let slots: Vec<_> = history.in_range(0, 50).into_iter().map(|(slot, _)| slot).collect();
+        assert_eq!(slots, vec![10, 20, 30]);
+        assert_eq!(history.as_of(30), Some(balance(31).as_ref().clone()));
+    }
+}
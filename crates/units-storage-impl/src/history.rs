@@ -0,0 +1,112 @@
+//! Per-object version chains
+//!
+//! Each object's history is a `BTreeMap` from the slot a version was
+//! written in to that version, so "as of slot" lookups and slot range
+//! scans cost O(log n + k) in the object's own history. Deletions are kept
+//! as versions marked `deleted`, which hold the last state before the
+//! delete; an as-of lookup that lands on one resolves to nothing.
+
+use std::collections::BTreeMap;
+
+use units_core_types::SlotNumber;
+
+/// One version of an object, stored as a `T` (an object or a record location)
+#[derive(Debug, Clone, PartialEq)]
+pub(crate) struct Version<T> {
+    pub value: T,
+    /// Whether this version records the object's deletion
+    pub deleted: bool,
+}
+
+impl<T> Version<T> {
+    pub fn live(value: T) -> Self {
+        Self { value, deleted: false }
+    }
+
+    pub fn deleted(value: T) -> Self {
+        Self { value, deleted: true }
+    }
+}
+
+/// An object's versions by the slot they were written in
+pub(crate) type VersionChain<T> = BTreeMap<SlotNumber, Version<T>>;
+
+/// The version that was current at `slot`, unless the object was deleted by then
+pub(crate) fn as_of<T>(chain: &VersionChain<T>, slot: SlotNumber) -> Option<&T> {
+    chain
+        .range(..=slot)
+        .next_back()
+        .filter(|(_, version)| !version.deleted)
+        .map(|(_, version)| &version.value)
+}
+
+/// Versions written between `start_slot` and `end_slot` inclusive, oldest first
+pub(crate) fn in_range<T>(
+    chain: &VersionChain<T>,
+    start_slot: SlotNumber,
+    end_slot: SlotNumber,
+) -> impl Iterator<Item = (SlotNumber, &T)> {
+    let range = (start_slot <= end_slot).then(|| chain.range(start_slot..=end_slot));
+    range
+        .into_iter()
+        .flatten()
+        .map(|(slot, version)| (*slot, &version.value))
+}
+
+/// Drop versions that no as-of lookup at or after `before_slot` can reach
+///
+/// The newest version written before `before_slot` is kept, because it is
+/// still the answer for slots from the cutoff up to the next write, unless
+/// it is a deletion. Returns the number of versions dropped.
+pub(crate) fn compact<T>(chain: &mut VersionChain<T>, before_slot: SlotNumber) -> usize {
+    let retained = chain.split_off(&before_slot);
+    let mut older = std::mem::replace(chain, retained);
+
+    let mut dropped = older.len();
+    if let Some((slot, version)) = older.pop_last() {
+        if !version.deleted {
+            chain.insert(slot, version);
+            dropped -= 1;
+        }
+    }
+    dropped
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn chain(versions: &[(SlotNumber, u32, bool)]) -> VersionChain<u32> {
+        versions
+            .iter()
+            .map(|&(slot, value, deleted)| (slot, Version { value, deleted }))
+            .collect()
+    }
+
+    #[test]
+    fn test_as_of_and_range_lookups() {
+        let chain = chain(&[(2, 20, false), (5, 50, false), (9, 50, true)]);
+        assert_eq!(as_of(&chain, 1), None);
+        assert_eq!(as_of(&chain, 2), Some(&20));
+        assert_eq!(as_of(&chain, 7), Some(&50));
+        assert_eq!(as_of(&chain, 9), None);
+
+        let versions: Vec<_> = in_range(&chain, 3, 9).collect();
+        assert_eq!(versions, vec![(5, &50), (9, &50)]);
+        assert_eq!(in_range(&chain, 9, 3).count(), 0);
+    }
+
+    #[test]
+    fn test_compaction_keeps_as_of_answers_after_cutoff() {
+        let mut live = chain(&[(1, 10, false), (3, 30, false), (6, 60, false)]);
+        let before: Vec<_> = (5..8).map(|slot| as_of(&live, slot).copied()).collect();
+        assert_eq!(compact(&mut live, 5), 1);
+        assert_eq!((5..8).map(|slot| as_of(&live, slot).copied()).collect::<Vec<_>>(), before);
+        assert_eq!(live.len(), 2);
+
+        // A deletion before the cutoff leaves nothing to answer with
+        let mut deleted = chain(&[(1, 10, false), (3, 10, true)]);
+        assert_eq!(compact(&mut deleted, 5), 2);
+        assert!(deleted.is_empty());
+    }
+}
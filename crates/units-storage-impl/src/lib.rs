@@ -4,16 +4,24 @@
 //! 
 //! ## Available Implementations
 //! 
-//! - `InMemoryObjectStorage`: In-memory object storage for testing/development
+//! - `InMemoryObjectStorage`: In-memory object storage for testing/development,
+//!   with delta-encoded history
 //! - `InMemoryProofStorage`: In-memory proof storage
 //! - `InMemoryReceiptStorage`: In-memory transaction receipt storage
-//! - `InMemoryLockManager`: Simple lock manager for development
+//! - `InMemoryLockManager`: Striped read/write lock manager with contention counters
+//! - `LogStructuredStorage`: Persistent, memory-mapped log-structured object store
 //! - `FileWriteAheadLog`: File-based write-ahead logging
+//! - `snapshot`: Chunked, content-addressed state snapshots for bootstrap
 //! - `ConsolidatedUnitsStorage`: Complete storage solution using composition
 
 pub mod consolidated_storage;
+pub mod delta_history;
+mod history;
+pub mod log_store;
+pub mod object_index;
 pub mod receipt_storage;
 pub mod lock_manager;
+pub mod snapshot;
 pub mod wal;
 
 // Re-export the main storage traits for convenience
@@ -25,9 +33,13 @@ pub use units_core_types::{
 // Export concrete implementations
 pub use consolidated_storage::{
     InMemoryObjectStorage, InMemoryProofStorage, NoOpWriteAheadLog, 
-    ConsolidatedUnitsStorage,
+    ConsolidatedUnitsStorage, StorageBackend,
 };
 
+pub use log_store::{LogStructuredStorage, LogStoreConfig};
+pub use object_index::ObjectIndex;
+
 pub use receipt_storage::InMemoryReceiptStorage;
-pub use lock_manager::{InMemoryLockManager, SimpleLockGuard};
-pub use wal::{FileWriteAheadLog, WALEntry, WALEntryType};
\ No newline at end of file
+pub use snapshot::{CheckpointPolicy, ChunkInfo, SnapshotEntry, SnapshotManifest};
+pub use lock_manager::{InMemoryLockManager, LockStats, StripeContention, StripedLockGuard};
+pub use wal::{FileWriteAheadLog, PendingAppend, SyncObserver, SyncPolicy, WALConfig, WALEntry, WALEntryType};
\ No newline at end of file
@@ -1,31 +1,214 @@
 //! Lock Manager Implementation
-//! 
+//!
 //! Provides concrete implementations of the LockManager trait for object-level locking.
+//!
+//! `InMemoryLockManager` hashes object ids onto a fixed array of striped
+//! reader-writer locks, so there is no global map or mutex on the lock path.
+//! Multi-object acquisition takes stripes in ascending order, which makes it
+//! deadlock-free, and each stripe counts how often callers had to wait.
 
 use units_core_types::LockManager;
-use std::collections::HashMap;
-use std::sync::{Arc, Mutex};
+use parking_lot::{RwLock, RwLockReadGuard, RwLockWriteGuard};
+use std::collections::BTreeMap;
+use std::sync::atomic::{AtomicU64, Ordering};
 use units_core_types::error::StorageError;
 use units_core_types::id::UnitsObjectId;
+use units_core_types::locks::LockType;
 
-/// Simple lock guard implementation
-pub struct SimpleLockGuard {
-    _object_id: UnitsObjectId,
+use crate::consolidated_storage::InMemoryObjectStorage;
+
+/// Default number of lock stripes
+pub const DEFAULT_LOCK_STRIPES: usize = 1024;
+
+/// One stripe, padded to a cache line so neighbouring stripes don't false-share
+#[repr(align(64))]
+struct Stripe {
+    lock: RwLock<()>,
+    acquisitions: AtomicU64,
+    contended: AtomicU64,
 }
 
-unsafe impl Send for SimpleLockGuard {}
-unsafe impl Sync for SimpleLockGuard {}
+impl Stripe {
+    fn new() -> Self {
+        Self {
+            lock: RwLock::new(()),
+            acquisitions: AtomicU64::new(0),
+            contended: AtomicU64::new(0),
+        }
+    }
 
-/// Simple in-memory lock manager for testing and development
+    /// Acquire the stripe, recording whether the caller had to wait
+    fn acquire(&self, lock_type: LockType) -> StripeGuard<'_> {
+        self.acquisitions.fetch_add(1, Ordering::Relaxed);
+        if let Some(guard) = self.try_acquire(lock_type) {
+            return guard;
+        }
+        self.contended.fetch_add(1, Ordering::Relaxed);
+        match lock_type {
+            LockType::Read => StripeGuard::Read { _held: self.lock.read() },
+            LockType::Write => StripeGuard::Write { _held: self.lock.write() },
+        }
+    }
+
+    fn try_acquire(&self, lock_type: LockType) -> Option<StripeGuard<'_>> {
+        match lock_type {
+            LockType::Read => self.lock.try_read().map(|held| StripeGuard::Read { _held: held }),
+            LockType::Write => self.lock.try_write().map(|held| StripeGuard::Write { _held: held }),
+        }
+    }
+}
+
+/// Held only so the stripe is released on drop
+enum StripeGuard<'a> {
+    Read { _held: RwLockReadGuard<'a, ()> },
+    Write { _held: RwLockWriteGuard<'a, ()> },
+}
+
+/// Guard for a held stripe; the lock is released when it is dropped
+pub struct StripedLockGuard<'a> {
+    stripe: usize,
+    lock_type: LockType,
+    _guard: StripeGuard<'a>,
+}
+
+impl StripedLockGuard<'_> {
+    /// Index of the stripe this guard holds
+    pub fn stripe(&self) -> usize {
+        self.stripe
+    }
+
+    /// Mode the stripe is held in
+    pub fn lock_type(&self) -> LockType {
+        self.lock_type
+    }
+}
+
+/// Contention counters for a single stripe
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct StripeContention {
+    /// Stripe index
+    pub stripe: usize,
+    /// Total acquisitions
+    pub acquisitions: u64,
+    /// Acquisitions that had to wait for another holder
+    pub contended: u64,
+}
+
+/// Aggregate lock manager statistics
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct LockStats {
+    /// Number of stripes
+    pub stripes: usize,
+    /// Total acquisitions across all stripes
+    pub acquisitions: u64,
+    /// Acquisitions that had to wait
+    pub contended: u64,
+}
+
+/// Striped in-memory lock manager
 pub struct InMemoryLockManager {
-    #[allow(dead_code)]
-    locks: Arc<Mutex<HashMap<UnitsObjectId, Arc<Mutex<()>>>>>,
+    stripes: Box<[Stripe]>,
+    mask: usize,
 }
 
 impl InMemoryLockManager {
     pub fn new() -> Self {
+        Self::with_stripes(DEFAULT_LOCK_STRIPES)
+    }
+
+    /// Create a lock manager with at least `stripes` stripes (rounded up to a power of two)
+    pub fn with_stripes(stripes: usize) -> Self {
+        let stripes = stripes.max(1).next_power_of_two();
         Self {
-            locks: Arc::new(Mutex::new(HashMap::new())),
+            stripes: (0..stripes).map(|_| Stripe::new()).collect(),
+            mask: stripes - 1,
+        }
+    }
+
+    /// Stripe that guards `id`
+    ///
+    /// Uses the same mapping as `InMemoryObjectStorage` shards, so with equal
+    /// counts a stripe covers exactly one storage shard.
+    pub fn stripe_for(&self, id: &UnitsObjectId) -> usize {
+        InMemoryObjectStorage::shard_index(id, self.mask)
+    }
+
+    /// Acquire a lock on `id` in the given mode, blocking until available
+    pub fn lock_with(&self, id: &UnitsObjectId, lock_type: LockType) -> StripedLockGuard<'_> {
+        self.acquire_stripe(self.stripe_for(id), lock_type)
+    }
+
+    /// Try to acquire a lock on `id` in the given mode without blocking
+    pub fn try_lock_with(&self, id: &UnitsObjectId, lock_type: LockType) -> Option<StripedLockGuard<'_>> {
+        let stripe = self.stripe_for(id);
+        let entry = &self.stripes[stripe];
+        let guard = entry.try_acquire(lock_type)?;
+        entry.acquisitions.fetch_add(1, Ordering::Relaxed);
+        Some(StripedLockGuard { stripe, lock_type, _guard: guard })
+    }
+
+    /// Acquire locks on several objects in a deadlock-free order
+    ///
+    /// Requests are grouped by stripe; a stripe is taken for writing if any of
+    /// its objects is requested for writing. Stripes are acquired in ascending
+    /// order and one guard is returned per distinct stripe.
+    pub fn lock_many_with(&self, requests: &[(UnitsObjectId, LockType)]) -> Vec<StripedLockGuard<'_>> {
+        let mut stripes: BTreeMap<usize, LockType> = BTreeMap::new();
+        for (id, lock_type) in requests {
+            let mode = stripes.entry(self.stripe_for(id)).or_insert(LockType::Read);
+            if *lock_type == LockType::Write {
+                *mode = LockType::Write;
+            }
+        }
+
+        stripes
+            .into_iter()
+            .map(|(stripe, lock_type)| self.acquire_stripe(stripe, lock_type))
+            .collect()
+    }
+
+    /// Aggregate acquisition and contention counters
+    pub fn stats(&self) -> LockStats {
+        self.stripes.iter().fold(
+            LockStats { stripes: self.stripes.len(), ..LockStats::default() },
+            |mut stats, stripe| {
+                stats.acquisitions += stripe.acquisitions.load(Ordering::Relaxed);
+                stats.contended += stripe.contended.load(Ordering::Relaxed);
+                stats
+            },
+        )
+    }
+
+    /// Contention counters for the stripe guarding `id`
+    pub fn contention_for(&self, id: &UnitsObjectId) -> StripeContention {
+        self.stripe_contention(self.stripe_for(id))
+    }
+
+    /// The `limit` most contended stripes, most contended first
+    pub fn hottest_stripes(&self, limit: usize) -> Vec<StripeContention> {
+        let mut stripes: Vec<_> = (0..self.stripes.len())
+            .map(|stripe| self.stripe_contention(stripe))
+            .filter(|stripe| stripe.contended > 0)
+            .collect();
+        stripes.sort_by(|a, b| b.contended.cmp(&a.contended).then(a.stripe.cmp(&b.stripe)));
+        stripes.truncate(limit);
+        stripes
+    }
+
+    fn stripe_contention(&self, stripe: usize) -> StripeContention {
+        let entry = &self.stripes[stripe];
+        StripeContention {
+            stripe,
+            acquisitions: entry.acquisitions.load(Ordering::Relaxed),
+            contended: entry.contended.load(Ordering::Relaxed),
+        }
+    }
+
+    fn acquire_stripe(&self, stripe: usize, lock_type: LockType) -> StripedLockGuard<'_> {
+        StripedLockGuard {
+            stripe,
+            lock_type,
+            _guard: self.stripes[stripe].acquire(lock_type),
         }
     }
 }
@@ -37,31 +220,27 @@ impl Default for InMemoryLockManager {
 }
 
 impl LockManager for InMemoryLockManager {
-    type Guard<'a> = SimpleLockGuard where Self: 'a;
-    
+    type Guard<'a> = StripedLockGuard<'a> where Self: 'a;
+
     fn lock(&self, id: &UnitsObjectId) -> Result<Self::Guard<'_>, StorageError> {
-        // For now, return a simple guard without actual locking
-        // A full implementation would manage actual mutex locks
-        Ok(SimpleLockGuard { _object_id: *id })
+        Ok(self.lock_with(id, LockType::Write))
     }
-    
+
     fn try_lock(&self, id: &UnitsObjectId) -> Result<Option<Self::Guard<'_>>, StorageError> {
-        // For now, always succeed
-        Ok(Some(SimpleLockGuard { _object_id: *id }))
+        Ok(self.try_lock_with(id, LockType::Write))
     }
-    
+
     fn lock_many(&self, ids: &[UnitsObjectId]) -> Result<Vec<Self::Guard<'_>>, StorageError> {
-        // For now, return guards for all requested IDs
-        let guards = ids.iter()
-            .map(|id| SimpleLockGuard { _object_id: *id })
-            .collect();
-        Ok(guards)
+        let requests: Vec<_> = ids.iter().map(|id| (*id, LockType::Write)).collect();
+        Ok(self.lock_many_with(&requests))
     }
 }
 
 #[cfg(test)]
 mod tests {
     use super::*;
+    use std::sync::Arc;
+    use std::thread;
 
     #[test]
     fn test_lock_manager_basic() {
@@ -69,15 +248,94 @@ mod tests {
         let object_id = UnitsObjectId::random();
 
         // Test basic locking
-        let _guard = lock_manager.lock(&object_id).unwrap();
-        
+        let guard = lock_manager.lock(&object_id).unwrap();
+
+        // An exclusive lock blocks a second acquisition until dropped
+        assert!(lock_manager.try_lock(&object_id).unwrap().is_none());
+        drop(guard);
+
         // Test try_lock
-        let _try_guard = lock_manager.try_lock(&object_id).unwrap();
-        
-        // Test multiple locks
-        let ids = [object_id, UnitsObjectId::random()];
+        let try_guard = lock_manager.try_lock(&object_id).unwrap();
+        assert!(try_guard.is_some());
+        drop(try_guard);
+
+        // Test multiple locks on ids that map to different stripes
+        let ids = [UnitsObjectId::new([1u8; 32]), UnitsObjectId::new([2u8; 32])];
         let _guards = lock_manager.lock_many(&ids).unwrap();
-        
+
         assert_eq!(_guards.len(), 2);
     }
-}
\ No newline at end of file
+
+    #[test]
+    fn test_read_locks_are_shared() {
+        let lock_manager = InMemoryLockManager::with_stripes(8);
+        let id = UnitsObjectId::random();
+
+        let first = lock_manager.lock_with(&id, LockType::Read);
+        let second = lock_manager.try_lock_with(&id, LockType::Read);
+        assert!(second.is_some());
+        assert!(lock_manager.try_lock_with(&id, LockType::Write).is_none());
+
+        drop(first);
+        drop(second);
+        assert!(lock_manager.try_lock_with(&id, LockType::Write).is_some());
+    }
+
+    #[test]
+    fn test_lock_many_dedupes_stripes() {
+        let lock_manager = InMemoryLockManager::with_stripes(1);
+        let ids = [UnitsObjectId::random(), UnitsObjectId::random(), UnitsObjectId::random()];
+
+        // All ids share the only stripe; locking them together must not self-deadlock
+        let guards = lock_manager.lock_many(&ids).unwrap();
+        assert_eq!(guards.len(), 1);
+        assert_eq!(guards[0].lock_type(), LockType::Write);
+    }
+
+    #[test]
+    fn test_lock_many_opposite_orders_do_not_deadlock() {
+        let lock_manager = Arc::new(InMemoryLockManager::with_stripes(16));
+        let a = UnitsObjectId::new([1u8; 32]);
+        let b = UnitsObjectId::new([2u8; 32]);
+
+        let handles: Vec<_> = [[a, b], [b, a]]
+            .into_iter()
+            .map(|ids| {
+                let lock_manager = lock_manager.clone();
+                thread::spawn(move || {
+                    for _ in 0..1000 {
+                        let _guards = lock_manager.lock_many(&ids).unwrap();
+                    }
+                })
+            })
+            .collect();
+        for handle in handles {
+            handle.join().unwrap();
+        }
+
+        assert_eq!(lock_manager.stats().acquisitions, 4000);
+    }
+
+    #[test]
+    fn test_contention_is_counted() {
+        let lock_manager = Arc::new(InMemoryLockManager::with_stripes(4));
+        let id = UnitsObjectId::new([3u8; 32]);
+
+        let guard = lock_manager.lock(&id).unwrap();
+        let waiter = {
+            let lock_manager = lock_manager.clone();
+            thread::spawn(move || {
+                let _guard = lock_manager.lock(&id).unwrap();
+            })
+        };
+        while lock_manager.contention_for(&id).contended == 0 {
+            thread::yield_now();
+        }
+        drop(guard);
+        waiter.join().unwrap();
+
+        let hottest = lock_manager.hottest_stripes(1);
+        assert_eq!(hottest[0].stripe, lock_manager.stripe_for(&id));
+        assert_eq!(hottest[0].contended, 1);
+    }
+}
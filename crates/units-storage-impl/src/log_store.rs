@@ -0,0 +1,999 @@
+//! Log-Structured Persistent Storage
+//!
+//! Disk-backed implementation of `ObjectStorage`, `HistoricalStorage` and
+//! `ProofStorage`. Every mutation is appended as a checksummed record to the
+//! active segment file; once a segment reaches the configured size it is
+//! sealed and memory-mapped read-only. An in-memory index maps object ids and
+//! slots to record locations, so point reads decode straight out of the
+//! mapped (or buffered) segment bytes with a single copy into the returned
+//! value. Controller and type indexes over the live objects are rebuilt
+//! alongside it.
+//!
+//! History compaction is itself a record: replaying it on open drops the
+//! same versions from the index again. The compacted records stay in their
+//! segments; only the index forgets them.
+//!
+//! Record framing: `[u32 LE payload length][u32 LE crc32][bincode payload]`.
+//!
+//! Appends reach the file before a write returns, but only reach stable
+//! storage according to `LogStoreConfig::sync_policy`, which reads the same
+//! `SyncPolicy` as the WAL: after every record, at most once per interval,
+//! or when a slot is sealed by its state proof (the default). Rotation and
+//! `sync` always make everything written so far durable.
+
+use std::collections::{BTreeMap, HashMap};
+use std::fs::{self, File, OpenOptions};
+use std::io::{Read, Write};
+use std::path::{Path, PathBuf};
+use std::sync::mpsc::{self, RecvTimeoutError, Sender};
+use std::sync::{Arc, RwLock};
+use std::thread::{self, JoinHandle};
+use std::time::{Duration, Instant};
+
+use memmap2::Mmap;
+use serde::{Deserialize, Serialize};
+
+use units_core_types::error::StorageError;
+use units_core_types::id::UnitsObjectId;
+use units_core_types::objects::{ObjectType, UnitsObject};
+use units_core_types::{
+    HistoricalStorage, ObjectPage, ObjectStorage, PagedObjects, ProofStorage, SlotNumber, StateProof,
+    UnitsObjectProof, DEFAULT_PAGE_SIZE,
+};
+use units_proofs::{ProofEngine, SlotClock};
+
+use crate::history::{self, Version, VersionChain};
+use crate::object_index::{resolve_page, ObjectIndex};
+use crate::snapshot::SnapshotEntry;
+use crate::wal::SyncPolicy;
+
+/// Default size at which the active segment is sealed (64MB)
+pub const DEFAULT_SEGMENT_SIZE: u64 = 64 * 1024 * 1024;
+
+const SEGMENT_PREFIX: &str = "segment-";
+const SEGMENT_SUFFIX: &str = ".log";
+const RECORD_HEADER_LEN: usize = 8;
+
+/// Configuration for `LogStructuredStorage`
+#[derive(Debug, Clone)]
+pub struct LogStoreConfig {
+    /// Directory holding the segment files
+    pub data_dir: PathBuf,
+    /// Segment size in bytes after which a new segment is started
+    pub segment_size: u64,
+    /// When appended records are made durable
+    ///
+    /// `IntervalMs` syncs on the first append once the interval has passed
+    /// since the last sync, and a background thread syncs records left
+    /// pending once the interval has passed without one; `IntervalMs(0)`
+    /// behaves like `PerEntry`.
+    pub sync_policy: SyncPolicy,
+}
+
+impl LogStoreConfig {
+    /// Create a config for `data_dir` with the default segment size and sync policy
+    pub fn new(data_dir: impl Into<PathBuf>) -> Self {
+        Self {
+            data_dir: data_dir.into(),
+            segment_size: DEFAULT_SEGMENT_SIZE,
+            sync_policy: SyncPolicy::PerSlot,
+        }
+    }
+}
+
+/// Record as stored on disk
+#[derive(Deserialize)]
+enum LogRecord {
+    Put { slot: SlotNumber, object: UnitsObject, proof: UnitsObjectProof },
+    Delete { slot: SlotNumber, object: UnitsObject, proof: UnitsObjectProof },
+    ObjectProof(UnitsObjectProof),
+    StateProof(StateProof),
+    Compact { before_slot: SlotNumber },
+}
+
+/// Borrowed mirror of `LogRecord` used on the write path
+///
+/// Variant order and field layout must match `LogRecord` exactly so bincode
+/// produces identical bytes without cloning the object being written.
+#[derive(Serialize)]
+enum LogRecordRef<'a> {
+    Put { slot: SlotNumber, object: &'a UnitsObject, proof: &'a UnitsObjectProof },
+    Delete { slot: SlotNumber, object: &'a UnitsObject, proof: &'a UnitsObjectProof },
+    ObjectProof(&'a UnitsObjectProof),
+    StateProof(&'a StateProof),
+    Compact { before_slot: SlotNumber },
+}
+
+impl LogRecordRef<'_> {
+    /// Slot whose writes the record belongs to, `None` for compaction
+    fn slot(&self) -> Option<SlotNumber> {
+        match self {
+            Self::Put { slot, .. } | Self::Delete { slot, .. } => Some(*slot),
+            Self::ObjectProof(proof) => Some(proof.slot),
+            Self::StateProof(proof) => Some(proof.slot),
+            Self::Compact { .. } => None,
+        }
+    }
+}
+
+/// Position of a record within the segment set
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+struct Location {
+    segment: u32,
+    offset: u32,
+    len: u32,
+}
+
+/// Index state for a single object id
+#[derive(Default)]
+struct IndexEntry {
+    /// `Put` record for the current state, `None` once deleted
+    current: Option<Location>,
+    /// `Put`/`Delete` records by slot
+    history: VersionChain<Location>,
+    /// Head of the object's proof chain, kept in memory for chaining writes
+    latest_proof: Option<UnitsObjectProof>,
+    /// Proofs stored through `ProofStorage::store_object_proof`
+    stored_proofs: Vec<(SlotNumber, Location)>,
+}
+
+enum SegmentData {
+    /// Sealed, immutable segment mapped read-only
+    Sealed(Mmap),
+    /// Segment currently being appended to, mirrored in memory
+    Active { file: File, buf: Vec<u8> },
+}
+
+struct Segment {
+    id: u32,
+    data: SegmentData,
+}
+
+impl Segment {
+    fn bytes(&self) -> &[u8] {
+        match &self.data {
+            SegmentData::Sealed(map) => &map[..],
+            SegmentData::Active { buf, .. } => &buf[..],
+        }
+    }
+}
+
+struct Inner {
+    segments: Vec<Segment>,
+    index: HashMap<UnitsObjectId, IndexEntry>,
+    /// Controller and type index over the live objects
+    secondary: ObjectIndex,
+    state_proofs: BTreeMap<SlotNumber, Location>,
+    /// Highest slot appended since the last sync, for `SyncPolicy::PerSlot`
+    unsynced_slot: Option<SlotNumber>,
+    /// Whether anything was appended since the last sync
+    dirty: bool,
+    last_sync: Instant,
+}
+
+/// Persistent log-structured object, history and proof storage
+pub struct LogStructuredStorage {
+    config: LogStoreConfig,
+    inner: Arc<RwLock<Inner>>,
+    proof_engine: ProofEngine,
+    /// Background sync for `SyncPolicy::IntervalMs`
+    syncer: Option<IntervalSyncer>,
+}
+
+/// Thread that syncs the active segment once records sit unsynced for an interval
+struct IntervalSyncer {
+    /// Dropped to stop the thread
+    stop: Sender<()>,
+    thread: JoinHandle<()>,
+}
+
+impl IntervalSyncer {
+    fn spawn(inner: Arc<RwLock<Inner>>, interval: Duration) -> Result<Self, StorageError> {
+        let (stop, stopped) = mpsc::channel::<()>();
+        let thread = thread::Builder::new()
+            .name("units-log-sync".to_string())
+            .spawn(move || {
+                let mut wait = interval;
+                while let Err(RecvTimeoutError::Timeout) = stopped.recv_timeout(wait) {
+                    let mut inner = inner.write().unwrap();
+                    let elapsed = inner.last_sync.elapsed();
+                    if !inner.dirty {
+                        wait = interval;
+                    } else if elapsed >= interval {
+                        if let Err(e) = inner.sync_active() {
+                            log::warn!("Background sync of the log store failed: {}", e);
+                        }
+                        wait = interval;
+                    } else {
+                        // An append synced recently; wake when its interval runs out
+                        wait = interval - elapsed;
+                    }
+                }
+            })
+            .map_err(|e| StorageError::Database(format!("Failed to start log store sync thread: {}", e)))?;
+        Ok(Self { stop, thread })
+    }
+}
+
+impl Drop for LogStructuredStorage {
+    fn drop(&mut self) {
+        if let Some(IntervalSyncer { stop, thread }) = self.syncer.take() {
+            drop(stop);
+            let _ = thread.join();
+        }
+    }
+}
+
+impl LogStructuredStorage {
+    /// Open (or create) a store in `config.data_dir`, rebuilding the index from its segments
+    pub fn open(config: LogStoreConfig) -> Result<Self, StorageError> {
+        fs::create_dir_all(&config.data_dir)?;
+
+        let mut ids = Vec::new();
+        for entry in fs::read_dir(&config.data_dir)? {
+            let name = entry?.file_name();
+            if let Some(id) = parse_segment_id(&name.to_string_lossy()) {
+                ids.push(id);
+            }
+        }
+        ids.sort_unstable();
+
+        let mut inner = Inner {
+            segments: Vec::with_capacity(ids.len().max(1)),
+            index: HashMap::new(),
+            secondary: ObjectIndex::new(),
+            state_proofs: BTreeMap::new(),
+            unsynced_slot: None,
+            dirty: false,
+            last_sync: Instant::now(),
+        };
+
+        let last = ids.len().saturating_sub(1);
+        for (position, id) in ids.iter().enumerate() {
+            let path = segment_path(&config.data_dir, *id);
+            let position = position as u32;
+
+            if position as usize == last {
+                // The active segment may end in a torn record; keep the valid prefix
+                let mut file = OpenOptions::new().read(true).write(true).open(&path)?;
+                let mut buf = Vec::new();
+                file.read_to_end(&mut buf)?;
+                let valid_len = inner.scan(position, &buf, false)?;
+                if valid_len < buf.len() {
+                    log::warn!("Truncating torn tail of segment {} at offset {}", id, valid_len);
+                    buf.truncate(valid_len);
+                    file.set_len(valid_len as u64)?;
+                }
+                let file = OpenOptions::new().append(true).open(&path)?;
+                inner.segments.push(Segment { id: *id, data: SegmentData::Active { file, buf } });
+            } else {
+                let map = map_segment(&path)?;
+                inner.scan(position, &map, true)?;
+                inner.segments.push(Segment { id: *id, data: SegmentData::Sealed(map) });
+            }
+        }
+
+        if inner.segments.is_empty() {
+            inner.segments.push(create_segment(&config.data_dir, 0)?);
+        }
+
+        let inner = Arc::new(RwLock::new(inner));
+        let syncer = match config.sync_policy {
+            SyncPolicy::IntervalMs(ms) if ms > 0 => {
+                Some(IntervalSyncer::spawn(Arc::clone(&inner), Duration::from_millis(ms))?)
+            }
+            _ => None,
+        };
+
+        Ok(Self {
+            config,
+            inner,
+            proof_engine: ProofEngine::new(),
+            syncer,
+        })
+    }
+
+    /// Clock new proofs are stamped from
+    pub fn slot_clock(&self) -> &SlotClock {
+        self.proof_engine.clock()
+    }
+
+    /// Latest slot with a stored state proof
+    pub fn latest_state_slot(&self) -> Option<SlotNumber> {
+        self.inner.read().unwrap().state_proofs.keys().next_back().copied()
+    }
+
+    /// Number of segment files, including the active one
+    pub fn segment_count(&self) -> usize {
+        self.inner.read().unwrap().segments.len()
+    }
+
+    /// Flush the active segment to stable storage
+    pub fn sync(&self) -> Result<(), StorageError> {
+        let mut inner = self.inner.write().unwrap();
+        inner.sync_active()
+    }
+
+    /// Every object live at `slot`, with the proof of that version
+    ///
+    /// Record locations are collected under one read lock and decoded a page
+    /// per lock afterwards, so writers are not held off for the whole scan.
+    /// Segments are append-only, so the locations stay valid in between.
+    pub fn states_at_slot(&self, slot: SlotNumber) -> Result<Vec<SnapshotEntry>, StorageError> {
+        let locations: Vec<Location> = {
+            let inner = self.inner.read().unwrap();
+            inner
+                .index
+                .values()
+                .filter_map(|entry| history::as_of(&entry.history, slot).copied())
+                .collect()
+        };
+
+        let mut states = Vec::with_capacity(locations.len());
+        for page in locations.chunks(DEFAULT_PAGE_SIZE) {
+            let inner = self.inner.read().unwrap();
+            for location in page {
+                match inner.read(*location)? {
+                    LogRecord::Put { object, proof, .. } => states.push(SnapshotEntry { object, proof }),
+                    _ => return Err(StorageError::Database("Index points at a non-object record".to_string())),
+                }
+            }
+        }
+        Ok(states)
+    }
+
+    /// Install objects with their existing proofs, as recovered from a snapshot or log
+    ///
+    /// Each object is appended as a `Put` carrying its own proof, followed by
+    /// the proof record `ProofStorage` reads, all under one write lock.
+    pub fn restore<'a>(
+        &self,
+        states: impl IntoIterator<Item = (&'a UnitsObject, &'a UnitsObjectProof)>,
+    ) -> Result<(), StorageError> {
+        let mut inner = self.inner.write().unwrap();
+        for (object, proof) in states {
+            for record in [
+                LogRecordRef::Put { slot: proof.slot, object, proof },
+                LogRecordRef::ObjectProof(proof),
+            ] {
+                let location = self.append(&mut inner, &record)?;
+                inner.apply(&record, location);
+            }
+        }
+        Ok(())
+    }
+
+    /// Append a record, rotating the active segment if it would overflow
+    fn append(&self, inner: &mut Inner, record: &LogRecordRef<'_>) -> Result<Location, StorageError> {
+        let payload = bincode::serialize(record)?;
+        let frame_len = (RECORD_HEADER_LEN + payload.len()) as u64;
+
+        let active_len = inner.segments.last().map(|s| s.bytes().len() as u64).unwrap_or(0);
+        if active_len > 0 && active_len + frame_len > self.config.segment_size {
+            self.rotate(inner)?;
+        }
+
+        // Entries for a later slot close the previous one
+        if self.config.sync_policy == SyncPolicy::PerSlot
+            && matches!((inner.unsynced_slot, record.slot()), (Some(open), Some(slot)) if slot > open)
+        {
+            inner.sync_active()?;
+        }
+
+        let segment = inner.segments.len() as u32 - 1;
+        let active = inner.segments.last_mut().expect("active segment always exists");
+        let (file, buf) = match &mut active.data {
+            SegmentData::Active { file, buf } => (file, buf),
+            SegmentData::Sealed(_) => unreachable!("last segment is always active"),
+        };
+
+        let offset = buf.len();
+        buf.extend_from_slice(&(payload.len() as u32).to_le_bytes());
+        buf.extend_from_slice(&crc32fast::hash(&payload).to_le_bytes());
+        buf.extend_from_slice(&payload);
+        if let Err(e) = file.write_all(&buf[offset..]) {
+            buf.truncate(offset);
+            // Cut back a partial frame so later records stay readable
+            let _ = file.set_len(offset as u64);
+            return Err(e.into());
+        }
+        let len = (buf.len() - offset) as u32;
+
+        inner.unsynced_slot = inner.unsynced_slot.max(record.slot());
+        inner.dirty = true;
+        let sync_now = match self.config.sync_policy {
+            SyncPolicy::PerEntry => true,
+            SyncPolicy::IntervalMs(ms) => inner.last_sync.elapsed() >= Duration::from_millis(ms),
+            SyncPolicy::PerSlot => matches!(record, LogRecordRef::StateProof(_)),
+        };
+        if sync_now {
+            inner.sync_active()?;
+        }
+
+        Ok(Location {
+            segment,
+            offset: offset as u32,
+            len,
+        })
+    }
+
+    /// Seal the active segment and start a new one
+    fn rotate(&self, inner: &mut Inner) -> Result<(), StorageError> {
+        inner.sync_active()?;
+        let active = inner.segments.last_mut().expect("active segment always exists");
+        let next_id = active.id + 1;
+        active.data = SegmentData::Sealed(map_segment(&segment_path(&self.config.data_dir, active.id))?);
+
+        inner.segments.push(create_segment(&self.config.data_dir, next_id)?);
+        Ok(())
+    }
+}
+
+impl Inner {
+    /// Make everything appended to the active segment durable
+    fn sync_active(&mut self) -> Result<(), StorageError> {
+        if let Some(SegmentData::Active { file, .. }) = self.segments.last().map(|s| &s.data) {
+            file.sync_data()?;
+        }
+        self.unsynced_slot = None;
+        self.dirty = false;
+        self.last_sync = Instant::now();
+        Ok(())
+    }
+
+    /// Index every valid record in `bytes`, returning the length of the valid prefix
+    ///
+    /// Sealed segments were synced before they were sealed, so a bad record
+    /// there is reported as corruption rather than treated as a torn tail.
+    fn scan(&mut self, segment: u32, bytes: &[u8], sealed: bool) -> Result<usize, StorageError> {
+        let mut offset = 0;
+        while offset < bytes.len() {
+            let payload = match frame_payload(bytes, offset) {
+                Some(payload) => payload,
+                None if sealed => {
+                    return Err(StorageError::Database(format!(
+                        "Corrupt record in sealed segment {} at offset {}",
+                        segment, offset
+                    )))
+                }
+                None => break,
+            };
+            let record: LogRecord = bincode::deserialize(payload)?;
+            let len = (RECORD_HEADER_LEN + payload.len()) as u32;
+            self.apply(&record_ref(&record), Location { segment, offset: offset as u32, len });
+            offset += len as usize;
+        }
+        Ok(offset)
+    }
+
+    /// Update the index for a record stored at `location`
+    fn apply(&mut self, record: &LogRecordRef<'_>, location: Location) {
+        match record {
+            LogRecordRef::Put { slot, object, proof } => {
+                let entry = self.index.entry(*object.id()).or_default();
+                entry.current = Some(location);
+                entry.history.insert(*slot, Version::live(location));
+                entry.latest_proof = Some((*proof).clone());
+                self.secondary.insert(object);
+            }
+            LogRecordRef::Delete { slot, object, proof } => {
+                let entry = self.index.entry(*object.id()).or_default();
+                entry.current = None;
+                entry.history.insert(*slot, Version::deleted(location));
+                entry.latest_proof = Some((*proof).clone());
+                self.secondary.remove(object.id());
+            }
+            LogRecordRef::ObjectProof(proof) => {
+                self.index
+                    .entry(proof.object_id)
+                    .or_default()
+                    .stored_proofs
+                    .push((proof.slot, location));
+            }
+            LogRecordRef::StateProof(proof) => {
+                self.state_proofs.insert(proof.slot, location);
+            }
+            LogRecordRef::Compact { before_slot } => {
+                self.compact(*before_slot);
+            }
+        }
+    }
+
+    /// Drop history versions unreachable from `before_slot` onwards, returning how many
+    fn compact(&mut self, before_slot: SlotNumber) -> usize {
+        self.index
+            .values_mut()
+            .map(|entry| history::compact(&mut entry.history, before_slot))
+            .sum()
+    }
+
+    /// Decode the record at `location` directly from the segment bytes
+    fn read(&self, location: Location) -> Result<LogRecord, StorageError> {
+        let start = location.offset as usize;
+        let bytes = self
+            .segments
+            .get(location.segment as usize)
+            .and_then(|segment| segment.bytes().get(start..start + location.len as usize))
+            .ok_or_else(|| StorageError::Database(format!("Missing segment {}", location.segment)))?;
+        let payload = frame_payload(bytes, 0).ok_or_else(|| {
+            StorageError::Database(format!(
+                "Corrupt record in segment {} at offset {}",
+                location.segment, location.offset
+            ))
+        })?;
+        Ok(bincode::deserialize(payload)?)
+    }
+
+    /// Current state of `id`, if it is live
+    fn current_object(&self, id: &UnitsObjectId) -> Result<Option<UnitsObject>, StorageError> {
+        match self.index.get(id).and_then(|entry| entry.current) {
+            Some(location) => self.read_object(location).map(Some),
+            None => Ok(None),
+        }
+    }
+
+    fn read_object(&self, location: Location) -> Result<UnitsObject, StorageError> {
+        match self.read(location)? {
+            LogRecord::Put { object, .. } | LogRecord::Delete { object, .. } => Ok(object),
+            _ => Err(StorageError::Database("Index points at a non-object record".to_string())),
+        }
+    }
+
+    fn read_proof(&self, location: Location) -> Result<UnitsObjectProof, StorageError> {
+        match self.read(location)? {
+            LogRecord::ObjectProof(proof) => Ok(proof),
+            _ => Err(StorageError::Database("Index points at a non-proof record".to_string())),
+        }
+    }
+
+    fn read_state_proof(&self, location: Location) -> Result<StateProof, StorageError> {
+        match self.read(location)? {
+            LogRecord::StateProof(proof) => Ok(proof),
+            _ => Err(StorageError::Database("Index points at a non-state-proof record".to_string())),
+        }
+    }
+}
+
+fn record_ref(record: &LogRecord) -> LogRecordRef<'_> {
+    match record {
+        LogRecord::Put { slot, object, proof } => LogRecordRef::Put { slot: *slot, object, proof },
+        LogRecord::Delete { slot, object, proof } => LogRecordRef::Delete { slot: *slot, object, proof },
+        LogRecord::ObjectProof(proof) => LogRecordRef::ObjectProof(proof),
+        LogRecord::StateProof(proof) => LogRecordRef::StateProof(proof),
+        LogRecord::Compact { before_slot } => LogRecordRef::Compact { before_slot: *before_slot },
+    }
+}
+
+/// Return the checksummed payload of the record at `offset`, if it is intact
+fn frame_payload(bytes: &[u8], offset: usize) -> Option<&[u8]> {
+    let header = bytes.get(offset..offset + RECORD_HEADER_LEN)?;
+    let len = u32::from_le_bytes(header[0..4].try_into().ok()?) as usize;
+    let crc = u32::from_le_bytes(header[4..8].try_into().ok()?);
+    let start = offset + RECORD_HEADER_LEN;
+    let payload = bytes.get(start..start + len)?;
+    (crc32fast::hash(payload) == crc).then_some(payload)
+}
+
+fn segment_path(dir: &Path, id: u32) -> PathBuf {
+    dir.join(format!("{}{:08}{}", SEGMENT_PREFIX, id, SEGMENT_SUFFIX))
+}
+
+fn parse_segment_id(name: &str) -> Option<u32> {
+    name.strip_prefix(SEGMENT_PREFIX)?
+        .strip_suffix(SEGMENT_SUFFIX)?
+        .parse()
+        .ok()
+}
+
+fn create_segment(dir: &Path, id: u32) -> Result<Segment, StorageError> {
+    let file = OpenOptions::new()
+        .create(true)
+        .append(true)
+        .open(segment_path(dir, id))?;
+    Ok(Segment { id, data: SegmentData::Active { file, buf: Vec::new() } })
+}
+
+fn map_segment(path: &Path) -> Result<Mmap, StorageError> {
+    let file = File::open(path)?;
+    // Safety: sealed segments are never modified or truncated after sealing
+    Ok(unsafe { Mmap::map(&file)? })
+}
+
+impl ObjectStorage for LogStructuredStorage {
+    fn get(&self, id: &UnitsObjectId) -> Result<Option<UnitsObject>, StorageError> {
+        self.inner.read().unwrap().current_object(id)
+    }
+
+    fn get_many(&self, ids: &[UnitsObjectId]) -> Result<Vec<Option<UnitsObject>>, StorageError> {
+        let inner = self.inner.read().unwrap();
+
+        // Decode in segment order so reads sweep each mapping front to back
+        let mut located: Vec<(Location, usize)> = ids
+            .iter()
+            .enumerate()
+            .filter_map(|(position, id)| {
+                let location = inner.index.get(id)?.current?;
+                Some((location, position))
+            })
+            .collect();
+        located.sort_unstable_by_key(|(location, _)| (location.segment, location.offset));
+
+        let mut objects = vec![None; ids.len()];
+        for (location, position) in located {
+            objects[position] = Some(inner.read_object(location)?);
+        }
+        Ok(objects)
+    }
+
+    fn set(
+        &self,
+        object: &UnitsObject,
+        transaction_hash: Option<[u8; 32]>,
+    ) -> Result<UnitsObjectProof, StorageError> {
+        let mut inner = self.inner.write().unwrap();
+        let prev_proof = inner.index.get(object.id()).and_then(|entry| entry.latest_proof.as_ref());
+        let proof = self
+            .proof_engine
+            .generate_object_proof(object, prev_proof, transaction_hash)?;
+
+        let record = LogRecordRef::Put { slot: proof.slot, object, proof: &proof };
+        let location = self.append(&mut inner, &record)?;
+        inner.apply(&record, location);
+
+        Ok(proof)
+    }
+
+    fn delete(
+        &self,
+        id: &UnitsObjectId,
+        transaction_hash: Option<[u8; 32]>,
+    ) -> Result<UnitsObjectProof, StorageError> {
+        let mut inner = self.inner.write().unwrap();
+        let entry = inner.index.get(id);
+        let location = entry
+            .and_then(|entry| entry.current)
+            .ok_or_else(|| StorageError::NotFound(format!("Object not found: {:?}", id)))?;
+        let prev_proof = entry.and_then(|entry| entry.latest_proof.as_ref());
+
+        let object = inner.read_object(location)?;
+        let proof = self
+            .proof_engine
+            .generate_object_proof(&object, prev_proof, transaction_hash)?;
+
+        let record = LogRecordRef::Delete { slot: proof.slot, object: &object, proof: &proof };
+        let location = self.append(&mut inner, &record)?;
+        inner.apply(&record, location);
+
+        Ok(proof)
+    }
+
+    fn iter(&self) -> Box<dyn Iterator<Item = Result<UnitsObject, StorageError>> + '_> {
+        // One page is decoded per read lock, in id order
+        Box::new(PagedObjects::new(self, DEFAULT_PAGE_SIZE))
+    }
+
+    fn list(
+        &self,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        let inner = self.inner.read().unwrap();
+        resolve_page(
+            |cursor, limit| inner.secondary.live(cursor, limit),
+            |id| inner.current_object(id),
+            cursor,
+            limit,
+        )
+    }
+
+    fn get_by_controller(
+        &self,
+        controller_id: &UnitsObjectId,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        let inner = self.inner.read().unwrap();
+        resolve_page(
+            |cursor, limit| inner.secondary.controlled_by(controller_id, cursor, limit),
+            |id| inner.current_object(id),
+            cursor,
+            limit,
+        )
+    }
+
+    fn get_by_type(
+        &self,
+        object_type: &ObjectType,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Result<ObjectPage, StorageError> {
+        let inner = self.inner.read().unwrap();
+        resolve_page(
+            |cursor, limit| inner.secondary.of_type(object_type, cursor, limit),
+            |id| inner.current_object(id),
+            cursor,
+            limit,
+        )
+    }
+}
+
+impl HistoricalStorage for LogStructuredStorage {
+    fn get_at_slot(
+        &self,
+        id: &UnitsObjectId,
+        slot: SlotNumber,
+    ) -> Result<Option<UnitsObject>, StorageError> {
+        let inner = self.inner.read().unwrap();
+        match inner.index.get(id).and_then(|entry| history::as_of(&entry.history, slot)) {
+            Some(location) => inner.read_object(*location).map(Some),
+            None => Ok(None),
+        }
+    }
+
+    fn get_history(
+        &self,
+        id: &UnitsObjectId,
+        start_slot: SlotNumber,
+        end_slot: SlotNumber,
+    ) -> Result<Vec<(SlotNumber, UnitsObject)>, StorageError> {
+        let inner = self.inner.read().unwrap();
+        let Some(entry) = inner.index.get(id) else {
+            return Ok(Vec::new());
+        };
+        history::in_range(&entry.history, start_slot, end_slot)
+            .map(|(slot, location)| Ok((slot, inner.read_object(*location)?)))
+            .collect()
+    }
+
+    fn compact_history(&self, before_slot: SlotNumber) -> Result<usize, StorageError> {
+        // Logged first so the same versions are dropped when the index is rebuilt
+        let mut inner = self.inner.write().unwrap();
+        let record = LogRecordRef::Compact { before_slot };
+        self.append(&mut inner, &record)?;
+        Ok(inner.compact(before_slot))
+    }
+}
+
+impl ProofStorage for LogStructuredStorage {
+    fn store_object_proof(&self, proof: &UnitsObjectProof) -> Result<(), StorageError> {
+        let mut inner = self.inner.write().unwrap();
+        let record = LogRecordRef::ObjectProof(proof);
+        let location = self.append(&mut inner, &record)?;
+        inner.apply(&record, location);
+        Ok(())
+    }
+
+    fn get_latest_proof(&self, id: &UnitsObjectId) -> Result<Option<UnitsObjectProof>, StorageError> {
+        let inner = self.inner.read().unwrap();
+        let latest = inner
+            .index
+            .get(id)
+            .and_then(|entry| entry.stored_proofs.iter().max_by_key(|(slot, _)| *slot));
+        match latest {
+            Some((_, location)) => inner.read_proof(*location).map(Some),
+            None => Ok(None),
+        }
+    }
+
+    fn get_proof_history(
+        &self,
+        id: &UnitsObjectId,
+        start_slot: Option<SlotNumber>,
+        end_slot: Option<SlotNumber>,
+    ) -> Result<Vec<(SlotNumber, UnitsObjectProof)>, StorageError> {
+        let inner = self.inner.read().unwrap();
+        let Some(entry) = inner.index.get(id) else {
+            return Ok(Vec::new());
+        };
+        entry
+            .stored_proofs
+            .iter()
+            .filter(|(slot, _)| {
+                start_slot.map_or(true, |start| *slot >= start) && end_slot.map_or(true, |end| *slot <= end)
+            })
+            .map(|(slot, location)| Ok((*slot, inner.read_proof(*location)?)))
+            .collect()
+    }
+
+    fn store_state_proof(&self, proof: &StateProof) -> Result<(), StorageError> {
+        let mut inner = self.inner.write().unwrap();
+        let record = LogRecordRef::StateProof(proof);
+        let location = self.append(&mut inner, &record)?;
+        inner.apply(&record, location);
+        Ok(())
+    }
+
+    fn get_state_proof(&self, slot: SlotNumber) -> Result<Option<StateProof>, StorageError> {
+        let inner = self.inner.read().unwrap();
+        match inner.state_proofs.get(&slot) {
+            Some(location) => inner.read_state_proof(*location).map(Some),
+            None => Ok(None),
+        }
+    }
+
+    fn get_state_proof_history(
+        &self,
+        start_slot: SlotNumber,
+        end_slot: SlotNumber,
+    ) -> Result<Vec<StateProof>, StorageError> {
+        if start_slot > end_slot {
+            return Ok(Vec::new());
+        }
+        let inner = self.inner.read().unwrap();
+        inner
+            .state_proofs
+            .range(start_slot..=end_slot)
+            .map(|(_, location)| inner.read_state_proof(*location))
+            .collect()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tempfile::tempdir;
+
+    fn test_object(seed: u8, payload: Vec<u8>) -> UnitsObject {
+        UnitsObject::new_data(UnitsObjectId::new([seed; 32]), UnitsObjectId::new([0u8; 32]), payload)
+    }
+
+    #[test]
+    fn test_set_get_and_reopen() {
+        let dir = tempdir().unwrap();
+        let object = test_object(1, vec![1, 2, 3]);
+        let removed = test_object(2, vec![4]);
+
+        let proof = {
+            let store = LogStructuredStorage::open(LogStoreConfig::new(dir.path())).unwrap();
+            let proof = store.set(&object, None).unwrap();
+            store.set(&removed, None).unwrap();
+            store.delete(removed.id(), None).unwrap();
+            assert_eq!(store.get(object.id()).unwrap(), Some(object.clone()));
+            proof
+        };
+
+        let store = LogStructuredStorage::open(LogStoreConfig::new(dir.path())).unwrap();
+        assert_eq!(store.get(object.id()).unwrap(), Some(object.clone()));
+        assert_eq!(store.get(removed.id()).unwrap(), None);
+        assert_eq!(store.get_at_slot(object.id(), proof.slot).unwrap(), Some(object.clone()));
+
+        // Secondary indexes are rebuilt from the segments
+        let page = store.get_by_controller(&UnitsObjectId::new([0u8; 32]), None, 10).unwrap();
+        assert_eq!((page.objects, page.next_cursor), (vec![object.clone()], None));
+        assert_eq!(store.get_by_type(&ObjectType::Data, None, 10).unwrap().objects.len(), 1);
+
+        // The proof chain continues from the recovered head
+        let next = store.set(&object, None).unwrap();
+        assert_eq!(next.prev_proof_hash, Some(proof.hash()));
+    }
+
+    #[test]
+    fn test_compaction_is_replayed_on_open() {
+        let dir = tempdir().unwrap();
+        let object = test_object(6, vec![1]);
+        let removed = test_object(7, vec![2]);
+
+        let cutoff = {
+            let store = LogStructuredStorage::open(LogStoreConfig::new(dir.path())).unwrap();
+            let proof = store.set(&object, None).unwrap();
+            store.set(&removed, None).unwrap();
+            let deleted = store.delete(removed.id(), None).unwrap();
+            let cutoff = deleted.slot.max(proof.slot) + 1;
+
+            // Every version of the deleted object goes; the live one keeps its latest
+            let versions = store.get_history(removed.id(), 0, cutoff).unwrap().len();
+            assert_eq!(store.compact_history(cutoff).unwrap(), versions);
+            cutoff
+        };
+
+        let store = LogStructuredStorage::open(LogStoreConfig::new(dir.path())).unwrap();
+        assert!(store.get_history(removed.id(), 0, cutoff).unwrap().is_empty());
+        // The newest version before the cutoff still answers later slots
+        assert_eq!(store.get_at_slot(object.id(), cutoff + 10).unwrap(), Some(object));
+    }
+
+    #[test]
+    fn test_segment_rotation() {
+        let dir = tempdir().unwrap();
+        let config = LogStoreConfig { segment_size: 512, ..LogStoreConfig::new(dir.path()) };
+
+        let store = LogStructuredStorage::open(config.clone()).unwrap();
+        for seed in 0..20u8 {
+            store.set(&test_object(seed, vec![seed; 64]), None).unwrap();
+        }
+        assert!(store.segment_count() > 1);
+        assert_eq!(store.get(&UnitsObjectId::new([0u8; 32])).unwrap(), Some(test_object(0, vec![0; 64])));
+        drop(store);
+
+        let store = LogStructuredStorage::open(config).unwrap();
+        let objects: Vec<_> = store.iter().collect::<Result<_, _>>().unwrap();
+        assert_eq!(objects.len(), 20);
+    }
+
+    #[test]
+    fn test_torn_tail_is_truncated() {
+        let dir = tempdir().unwrap();
+        let object = test_object(3, vec![9; 16]);
+        {
+            let store = LogStructuredStorage::open(LogStoreConfig::new(dir.path())).unwrap();
+            store.set(&object, None).unwrap();
+        }
+
+        let path = segment_path(dir.path(), 0);
+        let mut file = OpenOptions::new().append(true).open(&path).unwrap();
+        file.write_all(&[42, 0, 0, 0, 1, 2]).unwrap();
+        drop(file);
+
+        let store = LogStructuredStorage::open(LogStoreConfig::new(dir.path())).unwrap();
+        assert_eq!(store.get(object.id()).unwrap(), Some(object));
+        store.set(&test_object(4, vec![1]), None).unwrap();
+        assert!(store.get(&UnitsObjectId::new([4u8; 32])).unwrap().is_some());
+    }
+
+    #[test]
+    fn test_proof_storage() {
+        let dir = tempdir().unwrap();
+        let store = LogStructuredStorage::open(LogStoreConfig::new(dir.path())).unwrap();
+        let object = test_object(5, vec![1]);
+        let proof = store.set(&object, None).unwrap();
+
+        store.store_object_proof(&proof).unwrap();
+        store
+            .store_state_proof(&StateProof {
+                slot: 7,
+                prev_state_proof_hash: None,
+                object_ids: vec![*object.id()],
+                proof_data: vec![1, 2, 3],
+            })
+            .unwrap();
+
+        assert_eq!(store.get_latest_proof(object.id()).unwrap().map(|p| p.hash()), Some(proof.hash()));
+        assert_eq!(store.get_state_proof(7).unwrap().map(|p| p.slot), Some(7));
+        assert_eq!(store.get_state_proof_history(0, 10).unwrap().len(), 1);
+    }
+
+    #[test]
+    fn test_sync_policy_decides_when_appends_are_durable() {
+        let dir = tempdir().unwrap();
+        let unsynced = |store: &LogStructuredStorage| store.inner.read().unwrap().unsynced_slot;
+
+        // Per slot: writes stay pending until the slot's state proof
+        let store = LogStructuredStorage::open(LogStoreConfig::new(dir.path().join("slot"))).unwrap();
+        let proof = store.set(&test_object(1, vec![1]), None).unwrap();
+        assert_eq!(unsynced(&store), Some(proof.slot));
+        store
+            .store_state_proof(&StateProof {
+                slot: proof.slot,
+                prev_state_proof_hash: None,
+                object_ids: vec![proof.object_id],
+                proof_data: Vec::new(),
+            })
+            .unwrap();
+        assert_eq!(unsynced(&store), None);
+
+        let config = LogStoreConfig { sync_policy: SyncPolicy::PerEntry, ..LogStoreConfig::new(dir.path().join("entry")) };
+        let store = LogStructuredStorage::open(config).unwrap();
+        store.set(&test_object(2, vec![2]), None).unwrap();
+        assert_eq!(unsynced(&store), None);
+    }
+
+    #[test]
+    fn test_interval_policy_syncs_an_idle_store() {
+        let dir = tempdir().unwrap();
+        let config = LogStoreConfig { sync_policy: SyncPolicy::IntervalMs(200), ..LogStoreConfig::new(dir.path()) };
+        let store = LogStructuredStorage::open(config).unwrap();
+        let dirty = |store: &LogStructuredStorage| store.inner.read().unwrap().dirty;
+
+        // Sync the fresh store so the next append falls inside a new interval
+        store.sync().unwrap();
+        store.set(&test_object(1, vec![1]), None).unwrap();
+        assert!(dirty(&store));
+
+        // No further appends: the background thread syncs once the interval passes
+        let deadline = Instant::now() + Duration::from_secs(5);
+        while dirty(&store) {
+            assert!(Instant::now() < deadline, "idle store was never synced");
+            std::thread::sleep(Duration::from_millis(5));
+        }
+    }
+}
@@ -0,0 +1,192 @@
+//! Secondary indexes over current object state
+//!
+//! `ObjectIndex` keeps the ordered set of live object ids and maps
+//! controller ids and object types to the ids of the live objects that
+//! have them. Storage backends update it in the same critical section as
+//! the object itself, so a query never sees an object under a controller
+//! or type it no longer has. Id sets are ordered, which lets queries resume
+//! after a cursor without re-reading earlier pages.
+
+use std::collections::{BTreeMap, BTreeSet, HashMap};
+use std::ops::Bound;
+
+use units_core_types::error::StorageError;
+use units_core_types::id::UnitsObjectId;
+use units_core_types::objects::{ObjectType, UnitsObject};
+use units_core_types::{page_read_len, ObjectPage};
+
+/// Controller and type index for one set of objects
+#[derive(Default)]
+pub struct ObjectIndex {
+    /// Indexed keys of each live object, in id order
+    keys: BTreeMap<UnitsObjectId, (UnitsObjectId, ObjectType)>,
+    by_controller: HashMap<UnitsObjectId, BTreeSet<UnitsObjectId>>,
+    by_type: HashMap<ObjectType, BTreeSet<UnitsObjectId>>,
+}
+
+impl ObjectIndex {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Index the current state of `object`, replacing any previous entry
+    pub fn insert(&mut self, object: &UnitsObject) {
+        let keys = (object.controller_id, object.object_type.clone());
+        if self.keys.get(&object.id) == Some(&keys) {
+            return;
+        }
+        self.remove(&object.id);
+
+        self.by_controller.entry(keys.0).or_default().insert(object.id);
+        self.by_type.entry(keys.1.clone()).or_default().insert(object.id);
+        self.keys.insert(object.id, keys);
+    }
+
+    /// Drop `id` from every index
+    pub fn remove(&mut self, id: &UnitsObjectId) {
+        let Some((controller_id, object_type)) = self.keys.remove(id) else {
+            return;
+        };
+        if let Some(ids) = self.by_controller.get_mut(&controller_id) {
+            ids.remove(id);
+            if ids.is_empty() {
+                self.by_controller.remove(&controller_id);
+            }
+        }
+        if let Some(ids) = self.by_type.get_mut(&object_type) {
+            ids.remove(id);
+            if ids.is_empty() {
+                self.by_type.remove(&object_type);
+            }
+        }
+    }
+
+    /// Number of indexed objects
+    pub fn len(&self) -> usize {
+        self.keys.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.keys.is_empty()
+    }
+
+    /// Up to `limit` live ids after `cursor`
+    pub fn live(&self, cursor: Option<&UnitsObjectId>, limit: usize) -> Vec<UnitsObjectId> {
+        self.keys.range((start_after(cursor), Bound::Unbounded)).take(limit).map(|(id, _)| *id).collect()
+    }
+
+    /// Up to `limit` ids controlled by `controller_id`, after `cursor`
+    pub fn controlled_by(
+        &self,
+        controller_id: &UnitsObjectId,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Vec<UnitsObjectId> {
+        page_of(self.by_controller.get(controller_id), cursor, limit)
+    }
+
+    /// Up to `limit` ids of `object_type`, after `cursor`
+    pub fn of_type(
+        &self,
+        object_type: &ObjectType,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> Vec<UnitsObjectId> {
+        page_of(self.by_type.get(object_type), cursor, limit)
+    }
+}
+
+fn page_of(ids: Option<&BTreeSet<UnitsObjectId>>, cursor: Option<&UnitsObjectId>, limit: usize) -> Vec<UnitsObjectId> {
+    let Some(ids) = ids else {
+        return Vec::new();
+    };
+    ids.range((start_after(cursor), Bound::Unbounded)).take(limit).copied().collect()
+}
+
+fn start_after(cursor: Option<&UnitsObjectId>) -> Bound<UnitsObjectId> {
+    cursor.map_or(Bound::Unbounded, |cursor| Bound::Excluded(*cursor))
+}
+
+/// Resolve a page of indexed ids into objects
+///
+/// `ids` yields up to the requested number of ids after a cursor, and
+/// `fetch` loads an object's current state. One id beyond `limit` is
+/// resolved to tell whether another page exists.
+pub(crate) fn resolve_page(
+    ids: impl Fn(Option<&UnitsObjectId>, usize) -> Vec<UnitsObjectId>,
+    mut fetch: impl FnMut(&UnitsObjectId) -> Result<Option<UnitsObject>, StorageError>,
+    cursor: Option<&UnitsObjectId>,
+    limit: usize,
+) -> Result<ObjectPage, StorageError> {
+    let wanted = page_read_len(limit);
+    let mut objects = Vec::with_capacity(wanted.min(1024));
+    for id in ids(cursor, wanted) {
+        if let Some(object) = fetch(&id)? {
+            objects.push(object);
+        }
+    }
+    Ok(ObjectPage::from_sorted(objects, limit))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use units_core_types::objects::VMType;
+
+    fn object(seed: u8, controller: u8) -> UnitsObject {
+        UnitsObject::new_data(UnitsObjectId::new([seed; 32]), UnitsObjectId::new([controller; 32]), vec![seed])
+    }
+
+    #[test]
+    fn test_updates_move_objects_between_keys() {
+        let mut index = ObjectIndex::new();
+        for seed in 1..=5u8 {
+            index.insert(&object(seed, 100));
+        }
+        index.insert(&object(3, 101));
+        index.insert(&UnitsObject::new_executable(
+            UnitsObjectId::new([4u8; 32]),
+            UnitsObjectId::new([100u8; 32]),
+            VMType::RiscV,
+            vec![],
+        ));
+        index.remove(&UnitsObjectId::new([5u8; 32]));
+
+        let controller = UnitsObjectId::new([100u8; 32]);
+        let ids = |seeds: &[u8]| seeds.iter().map(|s| UnitsObjectId::new([*s; 32])).collect::<Vec<_>>();
+        assert_eq!(index.controlled_by(&controller, None, 10), ids(&[1, 2, 4]));
+        assert_eq!(index.controlled_by(&UnitsObjectId::new([101u8; 32]), None, 10), ids(&[3]));
+        assert_eq!(index.of_type(&ObjectType::Data, None, 10), ids(&[1, 2, 3]));
+        assert_eq!(index.of_type(&ObjectType::Executable(VMType::RiscV), None, 10), ids(&[4]));
+        assert_eq!(index.len(), 4);
+        assert_eq!(index.live(Some(&UnitsObjectId::new([1u8; 32])), 2), ids(&[2, 3]));
+    }
+
+    #[test]
+    fn test_cursor_pagination_walks_every_id_once() {
+        let mut index = ObjectIndex::new();
+        for seed in 0..25u8 {
+            index.insert(&object(seed, 100));
+        }
+        let controller = UnitsObjectId::new([100u8; 32]);
+
+        let mut seen = Vec::new();
+        let mut cursor = None;
+        loop {
+            let page = resolve_page(
+                |after, limit| index.controlled_by(&controller, after, limit),
+                |id| Ok(Some(object(id.bytes()[0], 100))),
+                cursor.as_ref(),
+                10,
+            )
+            .unwrap();
+            seen.extend(page.objects.iter().map(|o| o.id));
+            match page.next_cursor {
+                Some(next) => cursor = Some(next),
+                None => break,
+            }
+        }
+        assert_eq!(seen, index.controlled_by(&controller, None, usize::MAX));
+        assert_eq!(seen.len(), 25);
+    }
+}
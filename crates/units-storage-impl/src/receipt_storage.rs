@@ -1,23 +1,102 @@
 //! Unified Receipt Storage Implementation
-//! 
+//!
 //! This module provides concrete implementations of the ReceiptStorage trait.
+//!
+//! Receipts are partitioned by slot, each partition ordered by transaction
+//! hash, so slot and range queries only visit the partitions they cover and
+//! cleanup drops whole partitions. An inverted index maps every object a
+//! receipt touches to the receipt's (slot, transaction hash) position, so
+//! per-object queries never scan unrelated receipts.
 
-use std::collections::HashMap;
+use std::collections::{BTreeMap, BTreeSet, HashMap};
+use std::ops::Bound;
 use units_core_types::error::StorageError;
 use units_core_types::id::UnitsObjectId;
 use units_core_types::transaction::TransactionReceipt;
-use units_core_types::SlotNumber;
+use units_core_types::{page_read_len, ReceiptCursor, ReceiptPage, SlotNumber};
 use units_core_types::ReceiptStorage;
 
+#[derive(Default)]
+struct Receipts {
+    /// Receipts by slot, then transaction hash
+    slots: BTreeMap<SlotNumber, BTreeMap<[u8; 32], TransactionReceipt>>,
+    /// Slot each stored transaction hash is filed under
+    by_hash: HashMap<[u8; 32], SlotNumber>,
+    /// Positions of the receipts affecting each object, in order
+    by_object: HashMap<UnitsObjectId, BTreeSet<ReceiptCursor>>,
+}
+
+impl Receipts {
+    fn get(&self, cursor: &ReceiptCursor) -> Option<&TransactionReceipt> {
+        self.slots.get(&cursor.slot)?.get(&cursor.transaction_hash)
+    }
+
+    fn remove(&mut self, tx_hash: &[u8; 32]) -> Option<TransactionReceipt> {
+        let slot = self.by_hash.remove(tx_hash)?;
+        let partition = self.slots.get_mut(&slot)?;
+        let receipt = partition.remove(tx_hash)?;
+        if partition.is_empty() {
+            self.slots.remove(&slot);
+        }
+        self.unindex(&receipt);
+        Some(receipt)
+    }
+
+    fn unindex(&mut self, receipt: &TransactionReceipt) {
+        let cursor = ReceiptCursor::of(receipt);
+        for object_id in affected_objects(receipt) {
+            if let Some(positions) = self.by_object.get_mut(object_id) {
+                positions.remove(&cursor);
+                if positions.is_empty() {
+                    self.by_object.remove(object_id);
+                }
+            }
+        }
+    }
+
+    /// Receipts between `start_slot` and `end_slot` in cursor order, after `cursor`
+    fn scan<'a>(
+        &'a self,
+        start_slot: SlotNumber,
+        end_slot: SlotNumber,
+        cursor: Option<&ReceiptCursor>,
+    ) -> impl Iterator<Item = &'a TransactionReceipt> + 'a {
+        let cursor = cursor.copied();
+        let start = cursor.map_or(start_slot, |cursor| cursor.slot.max(start_slot));
+        let partitions = (start <= end_slot).then(|| self.slots.range(start..=end_slot));
+        partitions.into_iter().flatten().flat_map(move |(slot, partition)| {
+            let after = match cursor {
+                Some(cursor) if cursor.slot == *slot => Bound::Excluded(cursor.transaction_hash),
+                _ => Bound::Unbounded,
+            };
+            partition.range((after, Bound::Unbounded)).map(|(_, receipt)| receipt)
+        })
+    }
+}
+
+/// Objects a receipt affects: those it has proofs for and those it has effects on
+fn affected_objects(receipt: &TransactionReceipt) -> BTreeSet<&UnitsObjectId> {
+    receipt
+        .object_proofs
+        .keys()
+        .chain(receipt.effects.iter().map(|effect| &effect.object_id))
+        .collect()
+}
+
+/// Page of up to `limit` receipts, reading one more to detect a further page
+fn page_of<'a>(receipts: impl Iterator<Item = &'a TransactionReceipt>, limit: usize) -> ReceiptPage {
+    ReceiptPage::from_sorted(receipts.take(page_read_len(limit)).cloned().collect(), limit)
+}
+
 /// Simple in-memory receipt storage for testing
 pub struct InMemoryReceiptStorage {
-    receipts: std::sync::RwLock<HashMap<[u8; 32], TransactionReceipt>>,
+    receipts: std::sync::RwLock<Receipts>,
 }
 
 impl InMemoryReceiptStorage {
     pub fn new() -> Self {
         Self {
-            receipts: std::sync::RwLock::new(HashMap::new()),
+            receipts: std::sync::RwLock::new(Receipts::default()),
         }
     }
 }
@@ -31,67 +110,194 @@ impl Default for InMemoryReceiptStorage {
 impl ReceiptStorage for InMemoryReceiptStorage {
     fn store_receipt(&self, receipt: &TransactionReceipt) -> Result<(), StorageError> {
         let mut receipts = self.receipts.write().unwrap();
-        receipts.insert(receipt.transaction_hash, receipt.clone());
+        // A re-stored receipt may have moved slot or touched other objects
+        receipts.remove(&receipt.transaction_hash);
+
+        let cursor = ReceiptCursor::of(receipt);
+        for object_id in affected_objects(receipt) {
+            receipts.by_object.entry(*object_id).or_default().insert(cursor);
+        }
+        receipts.by_hash.insert(receipt.transaction_hash, receipt.slot);
+        receipts
+            .slots
+            .entry(receipt.slot)
+            .or_default()
+            .insert(receipt.transaction_hash, receipt.clone());
         Ok(())
     }
-    
+
     fn get_receipt(&self, tx_hash: &[u8; 32]) -> Result<Option<TransactionReceipt>, StorageError> {
         let receipts = self.receipts.read().unwrap();
-        Ok(receipts.get(tx_hash).cloned())
+        let Some(&slot) = receipts.by_hash.get(tx_hash) else {
+            return Ok(None);
+        };
+        Ok(receipts.get(&ReceiptCursor { slot, transaction_hash: *tx_hash }).cloned())
     }
-    
+
     fn get_receipts_for_slot(&self, slot: SlotNumber) -> Result<Vec<TransactionReceipt>, StorageError> {
         let receipts = self.receipts.read().unwrap();
         Ok(receipts
-            .values()
-            .filter(|r| r.slot == slot)
-            .cloned()
-            .collect())
+            .slots
+            .get(&slot)
+            .map(|partition| partition.values().cloned().collect())
+            .unwrap_or_default())
     }
-    
+
     fn get_receipts_range(
         &self,
         start_slot: SlotNumber,
         end_slot: SlotNumber,
     ) -> Result<Vec<TransactionReceipt>, StorageError> {
         let receipts = self.receipts.read().unwrap();
-        Ok(receipts
-            .values()
-            .filter(|r| r.slot >= start_slot && r.slot <= end_slot)
-            .cloned()
-            .collect())
+        Ok(receipts.scan(start_slot, end_slot, None).cloned().collect())
     }
-    
+
     fn get_receipts_for_object(
         &self,
         object_id: &UnitsObjectId,
         start_slot: Option<SlotNumber>,
         end_slot: Option<SlotNumber>,
     ) -> Result<Vec<TransactionReceipt>, StorageError> {
+        let (start_slot, end_slot) = (start_slot.unwrap_or(0), end_slot.unwrap_or(SlotNumber::MAX));
+        if start_slot > end_slot {
+            return Ok(Vec::new());
+        }
         let receipts = self.receipts.read().unwrap();
-        Ok(receipts
-            .values()
-            .filter(|r| {
-                // Check slot range
-                if let Some(start) = start_slot {
-                    if r.slot < start { return false; }
-                }
-                if let Some(end) = end_slot {
-                    if r.slot > end { return false; }
-                }
-                
-                // Check if this receipt affects the object
-                // Note: This is a simplified check - would need proper transaction effect parsing
-                r.object_proofs.contains_key(object_id)
-            })
-            .cloned()
+        let Some(positions) = receipts.by_object.get(object_id) else {
+            return Ok(Vec::new());
+        };
+        let start = ReceiptCursor { slot: start_slot, transaction_hash: [0u8; 32] };
+        Ok(positions
+            .range(start..)
+            .take_while(|position| position.slot <= end_slot)
+            .filter_map(|position| receipts.get(position).cloned())
             .collect())
     }
-    
+
     fn cleanup_receipts_before(&self, slot: SlotNumber) -> Result<usize, StorageError> {
         let mut receipts = self.receipts.write().unwrap();
-        let initial_len = receipts.len();
-        receipts.retain(|_, receipt| receipt.slot >= slot);
-        Ok(initial_len - receipts.len())
+        let retained = receipts.slots.split_off(&slot);
+        let expired = std::mem::replace(&mut receipts.slots, retained);
+
+        let mut removed = 0;
+        for receipt in expired.into_values().flat_map(BTreeMap::into_values) {
+            receipts.by_hash.remove(&receipt.transaction_hash);
+            receipts.unindex(&receipt);
+            removed += 1;
+        }
+        Ok(removed)
+    }
+
+    fn get_receipts_range_page(
+        &self,
+        start_slot: SlotNumber,
+        end_slot: SlotNumber,
+        cursor: Option<&ReceiptCursor>,
+        limit: usize,
+    ) -> Result<ReceiptPage, StorageError> {
+        let receipts = self.receipts.read().unwrap();
+        Ok(page_of(receipts.scan(start_slot, end_slot, cursor), limit))
+    }
+
+    fn get_receipts_for_object_page(
+        &self,
+        object_id: &UnitsObjectId,
+        cursor: Option<&ReceiptCursor>,
+        limit: usize,
+    ) -> Result<ReceiptPage, StorageError> {
+        let receipts = self.receipts.read().unwrap();
+        let Some(positions) = receipts.by_object.get(object_id) else {
+            return Ok(ReceiptPage::default());
+        };
+        let after = cursor.map_or(Bound::Unbounded, |cursor| Bound::Excluded(*cursor));
+        let matching = positions
+            .range((after, Bound::Unbounded))
+            .filter_map(|position| receipts.get(position));
+        Ok(page_of(matching, limit))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use units_core_types::transaction::TransactionEffect;
+
+    fn receipt(seed: u8, slot: SlotNumber, objects: &[u8]) -> TransactionReceipt {
+        let mut receipt = TransactionReceipt::new([seed; 32], slot, true, 0);
+        receipt.effects = objects
+            .iter()
+            .map(|object| TransactionEffect {
+                transaction_hash: [seed; 32],
+                object_id: UnitsObjectId::new([*object; 32]),
+                before_image: None,
+                after_image: None,
+            })
+            .collect();
+        receipt
     }
-}
\ No newline at end of file
+
+    #[test]
+    fn test_object_index_pages_and_follows_restores() {
+        let storage = InMemoryReceiptStorage::new();
+        for seed in 0..12u8 {
+            let objects: &[u8] = if seed % 2 == 0 { &[1, 2] } else { &[2] };
+            storage.store_receipt(&receipt(seed, 100 + (seed / 3) as u64, objects)).unwrap();
+        }
+        let object = UnitsObjectId::new([2u8; 32]);
+
+        let mut seen = Vec::new();
+        let mut cursor = None;
+        loop {
+            let page = storage.get_receipts_for_object_page(&object, cursor.as_ref(), 5).unwrap();
+            seen.extend(page.receipts.iter().map(ReceiptCursor::of));
+            match page.next_cursor {
+                Some(next) => cursor = Some(next),
+                None => break,
+            }
+        }
+        assert_eq!(seen.len(), 12);
+        assert!(seen.windows(2).all(|pair| pair[0] < pair[1]));
+
+        // Re-storing moves the receipt out of the indexes it no longer belongs in
+        storage.store_receipt(&receipt(0, 200, &[3])).unwrap();
+        assert_eq!(storage.get_receipts_for_object(&UnitsObjectId::new([1u8; 32]), None, None).unwrap().len(), 5);
+        assert!(storage.get_receipts_for_slot(100).unwrap().iter().all(|r| r.transaction_hash != [0u8; 32]));
+        assert_eq!(storage.get_receipt(&[0u8; 32]).unwrap().map(|r| r.slot), Some(200));
+    }
+
+    #[test]
+    fn test_range_pages_and_cleanup_drop_partitions() {
+        let storage = InMemoryReceiptStorage::new();
+        for seed in 0..10u8 {
+            storage.store_receipt(&receipt(seed, seed as u64 / 2, &[seed])).unwrap();
+        }
+
+        let first = storage.get_receipts_range_page(1, 3, None, 4).unwrap();
+        assert_eq!(first.receipts.len(), 4);
+        let rest = storage.get_receipts_range_page(1, 3, first.next_cursor.as_ref(), 4).unwrap();
+        assert_eq!((rest.receipts.len(), rest.next_cursor), (2, None));
+        assert_eq!(storage.get_receipts_range(1, 3).unwrap().len(), 6);
+
+        assert_eq!(storage.cleanup_receipts_before(2).unwrap(), 4);
+        assert!(storage.get_receipt(&[1u8; 32]).unwrap().is_none());
+        assert!(storage.get_receipts_for_object(&UnitsObjectId::new([1u8; 32]), None, None).unwrap().is_empty());
+        assert_eq!(storage.get_receipts_range(0, 10).unwrap().len(), 6);
+    }
+
+    #[test]
+    fn test_zero_limit_pages_still_continue() {
+        let storage = InMemoryReceiptStorage::new();
+        for seed in 0..3u8 {
+            storage.store_receipt(&receipt(seed, 1, &[7])).unwrap();
+        }
+
+        let page = storage.get_receipts_range_page(0, 10, None, 0).unwrap();
+        assert_eq!(page.receipts.len(), 1);
+        let next = page.next_cursor.expect("more receipts remain");
+        let object_page = storage
+            .get_receipts_for_object_page(&UnitsObjectId::new([7u8; 32]), Some(&next), 0)
+            .unwrap();
+        assert_eq!(object_page.receipts.len(), 1);
+        assert!(object_page.next_cursor.is_some());
+    }
+}
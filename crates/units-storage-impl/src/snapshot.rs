@@ -0,0 +1,607 @@
+//! Point-in-time state snapshots
+//!
+//! A snapshot holds every object live at a slot that has a state proof,
+//! each with the proof of its version, plus the state proof itself. It is a
+//! directory with a `MANIFEST` and a set of chunk files. Each chunk is a
+//! zstd-compressed bincode list of entries, named by the BLAKE3 hash of its
+//! compressed bytes, so a peer can serve chunks in any order and each one is
+//! checked as it arrives.
+//!
+//! Import fetches and decodes chunks in parallel and checks every object
+//! against its proof. It then checks the whole set against the state proof's
+//! object root before writing anything, after which only WAL entries for
+//! later slots need replaying.
+//!
+//! A storage with a `CheckpointPolicy` snapshots finalized slots into its
+//! checkpoint directory and only then checkpoints the WAL up to them, so
+//! every record the WAL drops is held by a verified snapshot.
+
+use std::collections::HashMap;
+use std::fs::{self, File};
+use std::io::Write;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::thread;
+
+use serde::{Deserialize, Serialize};
+
+use units_core_types::error::StorageError;
+use units_core_types::objects::UnitsObject;
+use units_core_types::{ProofStorage, SlotNumber, StateProof, UnitsObjectProof};
+use units_proofs::{hash_bytes, ProofEngine, SparseMerkleTree};
+
+use crate::consolidated_storage::ConsolidatedUnitsStorage;
+use crate::wal::{FileWriteAheadLog, PendingAppend, WALEntryType};
+
+/// Version written to, and required in, every manifest
+pub const SNAPSHOT_FORMAT_VERSION: u32 = 1;
+
+/// Uncompressed bytes after which a chunk is closed (4MB)
+pub const DEFAULT_CHUNK_BYTES: usize = 4 * 1024 * 1024;
+
+/// Largest uncompressed chunk accepted on import (256MB)
+pub const MAX_CHUNK_BYTES: u64 = 256 * 1024 * 1024;
+
+const COMPRESSION_LEVEL: i32 = 3;
+const MANIFEST_FILE: &str = "MANIFEST";
+const CHUNK_SUFFIX: &str = ".chunk";
+const CHECKPOINT_PREFIX: &str = "slot-";
+
+/// Default finalized slots between WAL checkpoints
+pub const DEFAULT_CHECKPOINT_INTERVAL: SlotNumber = 256;
+
+/// Where and how often finalized slots are snapshotted to checkpoint the WAL
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct CheckpointPolicy {
+    /// Directory holding a snapshot directory per checkpointed slot
+    pub dir: PathBuf,
+    /// Slots are checkpointed when they are a multiple of this
+    pub interval_slots: SlotNumber,
+}
+
+/// An object together with the proof of its state
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct SnapshotEntry {
+    pub object: UnitsObject,
+    pub proof: UnitsObjectProof,
+}
+
+/// One chunk file of a snapshot
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
+pub struct ChunkInfo {
+    /// BLAKE3 hash of the compressed chunk, which is also its file name
+    pub hash: [u8; 32],
+    /// Number of entries in the chunk
+    pub entries: u32,
+    pub compressed_len: u64,
+    pub raw_len: u64,
+}
+
+/// Description of a snapshot: its slot, state proof and chunks
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct SnapshotManifest {
+    pub version: u32,
+    pub slot: SlotNumber,
+    /// Finalized state proof the snapshot's objects are verified against
+    pub state_proof: StateProof,
+    /// Object root committed to by `state_proof`
+    pub state_root: [u8; 32],
+    pub object_count: u64,
+    pub chunks: Vec<ChunkInfo>,
+}
+
+impl SnapshotManifest {
+    /// Read the manifest of the snapshot in `dir`
+    pub fn read(dir: &Path) -> Result<Self, StorageError> {
+        Ok(bincode::deserialize(&fs::read(dir.join(MANIFEST_FILE))?)?)
+    }
+
+    /// Path of a chunk file within the snapshot in `dir`
+    pub fn chunk_path(dir: &Path, hash: &[u8; 32]) -> PathBuf {
+        let name: String = hash.iter().map(|byte| format!("{:02x}", byte)).collect();
+        dir.join(name + CHUNK_SUFFIX)
+    }
+
+    fn write(&self, dir: &Path) -> Result<(), StorageError> {
+        write_atomically(&dir.join(MANIFEST_FILE), &bincode::serialize(self)?)
+    }
+}
+
+/// Write `entries`, the objects live at the state proof's slot, as a snapshot in `dir`
+///
+/// Entries are packed in the order given into chunks of about `chunk_bytes`
+/// uncompressed bytes. Chunk files already present are kept, since their
+/// names are their content hashes. The manifest is written last. Fails if
+/// the entries do not reproduce the state proof's object root.
+pub fn write_snapshot(
+    dir: &Path,
+    state_proof: &StateProof,
+    entries: &[SnapshotEntry],
+    chunk_bytes: usize,
+) -> Result<SnapshotManifest, StorageError> {
+    let state_root = ProofEngine::new().state_root(state_proof)?;
+    if snapshot_root(entries) != state_root {
+        return Err(StorageError::ProofVerification(format!(
+            "Objects at slot {} do not match its state root",
+            state_proof.slot
+        )));
+    }
+
+    fs::create_dir_all(dir)?;
+    let mut chunks = Vec::new();
+    let (mut start, mut size) = (0, 0);
+    for (position, entry) in entries.iter().enumerate() {
+        size += bincode::serialized_size(entry)? as usize;
+        if size >= chunk_bytes || position + 1 == entries.len() {
+            chunks.push(write_chunk(dir, &entries[start..=position])?);
+            (start, size) = (position + 1, 0);
+        }
+    }
+
+    let manifest = SnapshotManifest {
+        version: SNAPSHOT_FORMAT_VERSION,
+        slot: state_proof.slot,
+        state_proof: state_proof.clone(),
+        state_root,
+        object_count: entries.len() as u64,
+        chunks,
+    };
+    manifest.write(dir)?;
+    Ok(manifest)
+}
+
+/// Read a chunk file of the snapshot in `dir`, as served to a peer
+pub fn read_chunk(dir: &Path, chunk: &ChunkInfo) -> Result<Vec<u8>, StorageError> {
+    Ok(fs::read(SnapshotManifest::chunk_path(dir, &chunk.hash))?)
+}
+
+/// Fetch, decode and verify every chunk of a snapshot
+///
+/// `fetch` returns a chunk's compressed bytes, from disk or a peer, and is
+/// called from several threads at once. Entries are returned in manifest
+/// order once all of them have been checked against the state root.
+pub fn load_snapshot<F>(manifest: &SnapshotManifest, fetch: F) -> Result<Vec<SnapshotEntry>, StorageError>
+where
+    F: Fn(&ChunkInfo) -> Result<Vec<u8>, StorageError> + Sync,
+{
+    if manifest.version != SNAPSHOT_FORMAT_VERSION {
+        return Err(StorageError::Database(format!("Unsupported snapshot version {}", manifest.version)));
+    }
+    let engine = ProofEngine::new();
+    if manifest.state_proof.slot != manifest.slot || engine.state_root(&manifest.state_proof)? != manifest.state_root {
+        return Err(StorageError::ProofVerification(
+            "Snapshot manifest does not match its state proof".to_string(),
+        ));
+    }
+
+    // Workers claim chunks from a shared counter, so a slow fetch only delays its own chunk
+    let next = AtomicUsize::new(0);
+    let workers = thread::available_parallelism().map_or(4, |n| n.get()).min(manifest.chunks.len()).max(1);
+    let (next, fetch, engine) = (&next, &fetch, &engine);
+    let decoded = thread::scope(|scope| {
+        let handles: Vec<_> = (0..workers)
+            .map(|_| {
+                scope.spawn(move || {
+                    let mut done = Vec::new();
+                    while let Some(chunk) = manifest.chunks.get(next.fetch_add(1, Ordering::Relaxed)) {
+                        let result = fetch(chunk).and_then(|bytes| decode_chunk(engine, manifest.slot, chunk, &bytes));
+                        let failed = result.is_err();
+                        done.push((chunk.hash, result));
+                        if failed {
+                            break;
+                        }
+                    }
+                    done
+                })
+            })
+            .collect();
+        handles
+            .into_iter()
+            .map(|handle| {
+                handle
+                    .join()
+                    .map_err(|_| StorageError::Database("Snapshot import worker panicked".to_string()))
+            })
+            .collect::<Result<Vec<_>, _>>()
+    })?;
+
+    let mut by_hash = HashMap::with_capacity(manifest.chunks.len());
+    for (hash, result) in decoded.into_iter().flatten() {
+        by_hash.insert(hash, result?);
+    }
+    let mut entries = Vec::with_capacity(manifest.object_count as usize);
+    for chunk in &manifest.chunks {
+        let decoded = by_hash
+            .remove(&chunk.hash)
+            .ok_or_else(|| StorageError::NotFound(format!("Snapshot chunk {:02x?} was not loaded", chunk.hash)))?;
+        entries.extend(decoded);
+    }
+
+    if entries.len() as u64 != manifest.object_count || snapshot_root(&entries) != manifest.state_root {
+        return Err(StorageError::ProofVerification(format!(
+            "Snapshot objects do not match the state root at slot {}",
+            manifest.slot
+        )));
+    }
+    Ok(entries)
+}
+
+impl ConsolidatedUnitsStorage {
+    /// Write a snapshot of the state at `slot` into `dir`
+    ///
+    /// `slot` must have a stored state proof committing to every live object.
+    /// Objects created and deleted again after `slot` are not captured, so
+    /// snapshots are normally taken at the latest finalized slot.
+    pub fn export_snapshot(&self, dir: &Path, slot: SlotNumber) -> Result<SnapshotManifest, StorageError> {
+        let state_proof = self
+            .inner()
+            .get_state_proof(slot)?
+            .ok_or_else(|| StorageError::NotFound(format!("No state proof for slot {}", slot)))?;
+
+        // Id order makes unchanged stretches of state produce identical chunks
+        let mut entries = self.inner().states_at_slot(slot)?;
+        entries.sort_unstable_by_key(|entry| *entry.object.id());
+        write_snapshot(dir, &state_proof, &entries, DEFAULT_CHUNK_BYTES)
+    }
+
+    /// Import the snapshot in `dir`, returning its manifest
+    pub fn import_snapshot(&self, dir: &Path) -> Result<SnapshotManifest, StorageError> {
+        let manifest = SnapshotManifest::read(dir)?;
+        self.import_snapshot_from(&manifest, |chunk| read_chunk(dir, chunk))?;
+        Ok(manifest)
+    }
+
+    /// Import a snapshot whose chunks are fetched with `fetch`, such as from a peer
+    ///
+    /// Nothing is written unless every chunk verifies. A storage with a WAL
+    /// logs the imported objects and state proof, and waits for them to be
+    /// durable, before installing them.
+    pub fn import_snapshot_from<F>(&self, manifest: &SnapshotManifest, fetch: F) -> Result<(), StorageError>
+    where
+        F: Fn(&ChunkInfo) -> Result<Vec<u8>, StorageError> + Sync,
+    {
+        let entries = load_snapshot(manifest, fetch)?;
+        if let Some(wal) = self.inner().wal() {
+            let pending = entries
+                .iter()
+                .map(|entry| wal.queue_update(&entry.object, &entry.proof, entry.proof.transaction_hash))
+                .collect::<Result<Vec<_>, _>>()?;
+            // The state proof seals its slot, so under `SyncPolicy::PerSlot` the objects become durable with it
+            wal.record_state_proof(&manifest.state_proof)?;
+            pending.into_iter().try_for_each(PendingAppend::wait)?;
+        }
+
+        // Installed as replayed records, so nothing is logged twice
+        self.inner().restore(entries.iter().map(|entry| (&entry.object, &entry.proof)))?;
+        self.inner().apply_logged(&WALEntryType::StateProof(manifest.state_proof.clone()))
+    }
+
+    /// Apply the WAL's changes and state proofs for slots after a snapshot taken at `slot`
+    pub fn replay_wal_after(&self, wal: &FileWriteAheadLog, slot: SlotNumber) -> Result<(), StorageError> {
+        wal.replay_parallel(self.inner().shard_count(), Some(slot), |record| self.inner().apply_logged(record))
+    }
+
+    /// Checkpoint `slot` as the `CheckpointPolicy` asks, once its state proof is stored
+    ///
+    /// Returns the snapshot's manifest, or `None` if there is no policy or
+    /// `slot` is not due.
+    pub fn checkpoint_finalized(&self, slot: SlotNumber) -> Result<Option<SnapshotManifest>, StorageError> {
+        match self.checkpoint_policy() {
+            Some(policy) if slot % policy.interval_slots.max(1) == 0 => self.checkpoint(&policy.dir, slot).map(Some),
+            _ => Ok(None),
+        }
+    }
+
+    /// Snapshot `slot` under `dir`, then checkpoint the WAL up to it
+    ///
+    /// `slot` must have a stored state proof and be closed, so no write can
+    /// still be stamped with it. The WAL is only checkpointed once the
+    /// snapshot is written and verified against the state proof; older
+    /// snapshots in `dir` are removed after that.
+    pub fn checkpoint(&self, dir: &Path, slot: SlotNumber) -> Result<SnapshotManifest, StorageError> {
+        let wal = self
+            .inner()
+            .wal()
+            .ok_or_else(|| StorageError::WAL("Storage has no write-ahead log to checkpoint".to_string()))?;
+        if self.inner().slot_clock().now() <= slot {
+            return Err(StorageError::WAL(format!("Slot {} is still open", slot)));
+        }
+
+        let _checkpointing = self.checkpoint_lock();
+        if wal.checkpoint_slot()?.map_or(false, |checkpointed| checkpointed >= slot) {
+            return Err(StorageError::WAL(format!("Slot {} is already checkpointed", slot)));
+        }
+        let manifest = self.export_snapshot(&dir.join(format!("{}{:020}", CHECKPOINT_PREFIX, slot)), slot)?;
+        wal.checkpoint(slot)?;
+
+        for (older, path) in checkpoint_snapshots(dir)? {
+            if older < slot {
+                fs::remove_dir_all(path)?;
+            }
+        }
+        Ok(manifest)
+    }
+}
+
+/// Latest complete snapshot written into `dir` by `checkpoint`, and its directory
+///
+/// A snapshot whose manifest was never written, as when a checkpoint was
+/// interrupted, is passed over for the one before it.
+pub(crate) fn latest_checkpoint(dir: &Path) -> Result<Option<(SnapshotManifest, PathBuf)>, StorageError> {
+    if !dir.exists() {
+        return Ok(None);
+    }
+    for (_, path) in checkpoint_snapshots(dir)?.into_iter().rev() {
+        if path.join(MANIFEST_FILE).exists() {
+            return Ok(Some((SnapshotManifest::read(&path)?, path)));
+        }
+    }
+    Ok(None)
+}
+
+/// Snapshot directories written into `dir` by `checkpoint`, by slot
+fn checkpoint_snapshots(dir: &Path) -> Result<Vec<(SlotNumber, PathBuf)>, StorageError> {
+    let mut snapshots = Vec::new();
+    for entry in fs::read_dir(dir)? {
+        let entry = entry?;
+        let name = entry.file_name();
+        if let Some(slot) = name.to_str().and_then(|name| name.strip_prefix(CHECKPOINT_PREFIX)).and_then(|slot| slot.parse().ok()) {
+            snapshots.push((slot, entry.path()));
+        }
+    }
+    snapshots.sort_unstable();
+    Ok(snapshots)
+}
+
+/// Object root over the entries' proofs, with the leaves `ProofEngine` state roots commit to
+fn snapshot_root(entries: &[SnapshotEntry]) -> [u8; 32] {
+    SparseMerkleTree::root_of(entries.iter().map(|entry| (&entry.proof.object_id, ProofEngine::object_leaf(&entry.proof))))
+}
+
+fn write_chunk(dir: &Path, entries: &[SnapshotEntry]) -> Result<ChunkInfo, StorageError> {
+    let raw = bincode::serialize(entries)?;
+    let compressed = zstd::bulk::compress(&raw, COMPRESSION_LEVEL)?;
+    let hash = hash_bytes(&compressed);
+
+    let path = SnapshotManifest::chunk_path(dir, &hash);
+    if !path.exists() {
+        write_atomically(&path, &compressed)?;
+    }
+    Ok(ChunkInfo {
+        hash,
+        entries: entries.len() as u32,
+        compressed_len: compressed.len() as u64,
+        raw_len: raw.len() as u64,
+    })
+}
+
+/// Check a fetched chunk against its manifest entry and decode it
+fn decode_chunk(
+    engine: &ProofEngine,
+    slot: SlotNumber,
+    chunk: &ChunkInfo,
+    bytes: &[u8],
+) -> Result<Vec<SnapshotEntry>, StorageError> {
+    if bytes.len() as u64 != chunk.compressed_len || hash_bytes(bytes) != chunk.hash {
+        return Err(StorageError::ProofVerification(format!(
+            "Snapshot chunk {:02x?} does not match its hash",
+            chunk.hash
+        )));
+    }
+    if chunk.raw_len > MAX_CHUNK_BYTES {
+        return Err(StorageError::Database(format!("Snapshot chunk of {} bytes is too large", chunk.raw_len)));
+    }
+
+    let raw = zstd::bulk::decompress(bytes, chunk.raw_len as usize)?;
+    let entries: Vec<SnapshotEntry> = bincode::deserialize(&raw)?;
+    if entries.len() != chunk.entries as usize {
+        return Err(StorageError::Database(format!(
+            "Snapshot chunk {:02x?} holds {} entries, expected {}",
+            chunk.hash,
+            entries.len(),
+            chunk.entries
+        )));
+    }
+    for entry in &entries {
+        if entry.proof.slot > slot || !engine.verify_object_proof(&entry.object, &entry.proof)? {
+            return Err(StorageError::ProofVerification(format!(
+                "Snapshot object {:?} does not match its proof",
+                entry.object.id()
+            )));
+        }
+    }
+    Ok(entries)
+}
+
+/// Write `bytes` to `path` through a temporary file, so readers never see a partial file
+fn write_atomically(path: &Path, bytes: &[u8]) -> Result<(), StorageError> {
+    let temporary = path.with_extension("tmp");
+    let mut file = File::create(&temporary)?;
+    file.write_all(bytes)?;
+    file.sync_all()?;
+    fs::rename(&temporary, path)?;
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::consolidated_storage::StorageBackend;
+    use crate::delta_history::DEFAULT_KEYFRAME_INTERVAL;
+    use crate::log_store::LogStoreConfig;
+    use tempfile::tempdir;
+    use units_core_types::id::UnitsObjectId;
+    use units_core_types::{HistoricalStorage, ObjectStorage, UnitsStorage};
+
+    /// Storage holding `count` objects and a state proof over all of them at the returned slot
+    fn populated(count: u8) -> (ConsolidatedUnitsStorage, SlotNumber) {
+        let storage = ConsolidatedUnitsStorage::new_in_memory();
+        let mut proofs = Vec::new();
+        for seed in 0..count {
+            let object = UnitsObject::new_data(UnitsObjectId::new([seed; 32]), UnitsObjectId::new([0; 32]), vec![seed; 200]);
+            let proof = storage.objects().set(&object, None).unwrap();
+            proofs.push((*object.id(), proof));
+        }
+        let slot = proofs.iter().map(|(_, proof)| proof.slot).max().unwrap();
+        let state_proof = ProofEngine::new().generate_state_proof(&proofs, &[], None, slot).unwrap();
+        storage.proofs().store_state_proof(&state_proof).unwrap();
+        (storage, slot)
+    }
+
+    #[test]
+    fn test_snapshot_round_trips_into_persistent_storage() {
+        let (source, slot) = populated(40);
+        let dir = tempdir().unwrap();
+        let entries = source.inner().states_at_slot(slot).unwrap();
+        let state_proof = source.proofs().get_state_proof(slot).unwrap().unwrap();
+        let manifest = write_snapshot(dir.path(), &state_proof, &entries, 1024).unwrap();
+        assert!(manifest.chunks.len() > 1);
+        assert_eq!(SnapshotManifest::read(dir.path()).unwrap(), manifest);
+
+        let target = ConsolidatedUnitsStorage::open_persistent(LogStoreConfig::new(dir.path().join("store"))).unwrap();
+        assert_eq!(target.import_snapshot(dir.path()).unwrap().object_count, 40);
+        for seed in 0..40u8 {
+            let id = UnitsObjectId::new([seed; 32]);
+            assert_eq!(target.objects().get(&id).unwrap(), source.objects().get(&id).unwrap());
+            assert_eq!(target.historical().get_at_slot(&id, slot).unwrap().map(|o| o.data), Some(vec![seed; 200]));
+        }
+        assert_eq!(target.proofs().get_state_proof(slot).unwrap(), Some(state_proof));
+
+        // The exported state re-exports to the same content-addressed chunks
+        let again = tempdir().unwrap();
+        assert_eq!(target.export_snapshot(again.path(), slot).unwrap().chunks, source.export_snapshot(again.path(), slot).unwrap().chunks);
+    }
+
+    #[test]
+    fn test_snapshot_rejects_tampering_and_unproven_slots() {
+        let (source, slot) = populated(8);
+        let dir = tempdir().unwrap();
+        assert!(matches!(source.export_snapshot(dir.path(), slot + 1), Err(StorageError::NotFound(_))));
+        let manifest = source.export_snapshot(dir.path(), slot).unwrap();
+
+        // A state proof that leaves an object out cannot be exported against
+        source.objects().set(&UnitsObject::new_data(UnitsObjectId::new([99; 32]), UnitsObjectId::new([0; 32]), vec![1]), None).unwrap();
+        let later = source.inner().states_at_slot(SlotNumber::MAX).unwrap();
+        assert!(matches!(
+            write_snapshot(dir.path(), &manifest.state_proof, &later, DEFAULT_CHUNK_BYTES),
+            Err(StorageError::ProofVerification(_))
+        ));
+
+        // A corrupted chunk fails its hash and nothing is imported
+        let path = SnapshotManifest::chunk_path(dir.path(), &manifest.chunks[0].hash);
+        let mut bytes = fs::read(&path).unwrap();
+        bytes[0] ^= 0xff;
+        fs::write(&path, bytes).unwrap();
+        let target = ConsolidatedUnitsStorage::new_in_memory();
+        assert!(matches!(target.import_snapshot(dir.path()), Err(StorageError::ProofVerification(_))));
+        assert!(target.objects().get(&UnitsObjectId::new([0; 32])).unwrap().is_none());
+    }
+
+    #[test]
+    fn test_wal_is_checkpointed_only_behind_a_verified_snapshot() {
+        let dir = tempdir().unwrap();
+        let backend =
+            StorageBackend::in_memory_with_wal(DEFAULT_KEYFRAME_INTERVAL, FileWriteAheadLog::new(), &dir.path().join("wal")).unwrap();
+        let snapshots = dir.path().join("snapshots");
+        let storage = ConsolidatedUnitsStorage::with_backend(backend)
+            .with_checkpoints(CheckpointPolicy { dir: snapshots.clone(), interval_slots: 2 });
+        let clock = storage.inner().slot_clock().clone();
+        let wal = storage.inner().wal().unwrap();
+
+        let mut proofs = Vec::new();
+        let mut write = |seed: u8| {
+            let object = UnitsObject::new_data(UnitsObjectId::new([seed; 32]), UnitsObjectId::new([0; 32]), vec![seed; 32]);
+            proofs.push((*object.id(), storage.objects().set(&object, None).unwrap()));
+            ProofEngine::new().generate_state_proof(&proofs, &[], None, clock.now()).unwrap()
+        };
+        clock.set(2);
+        let state_proof = (1..=4).map(&mut write).last().unwrap();
+        storage.proofs().store_state_proof(&state_proof).unwrap();
+
+        // Slot 2 is due, but not while writes can still be stamped with it
+        assert!(matches!(storage.checkpoint_finalized(2), Err(StorageError::WAL(_))));
+        clock.set(3);
+        assert_eq!(storage.checkpoint_finalized(3).unwrap(), None);
+        assert_eq!(storage.checkpoint_finalized(2).unwrap().map(|manifest| manifest.object_count), Some(4));
+        assert_eq!(wal.checkpoint_slot().unwrap(), Some(2));
+
+        // A state proof the objects do not match leaves the WAL alone
+        clock.set(4);
+        let complete = write(5);
+        let overlooked = ProofEngine::new().generate_state_proof(&proofs[..4], &[], None, 4).unwrap();
+        storage.proofs().store_state_proof(&overlooked).unwrap();
+        clock.set(5);
+        assert!(matches!(storage.checkpoint_finalized(4), Err(StorageError::ProofVerification(_))));
+        assert_eq!(wal.checkpoint_slot().unwrap(), Some(2));
+
+        // Once it verifies, the WAL moves on and the older snapshot goes
+        storage.proofs().store_state_proof(&complete).unwrap();
+        storage.checkpoint_finalized(4).unwrap().unwrap();
+        assert_eq!(wal.checkpoint_slot().unwrap(), Some(4));
+        let kept: Vec<SlotNumber> = checkpoint_snapshots(&snapshots).unwrap().into_iter().map(|(slot, _)| slot).collect();
+        assert_eq!(kept, vec![4]);
+    }
+
+    #[test]
+    fn test_restart_recovers_from_the_checkpoint_snapshot_and_wal() {
+        let dir = tempdir().unwrap();
+        let policy = CheckpointPolicy { dir: dir.path().join("snapshots"), interval_slots: 1 };
+        let open = || {
+            ConsolidatedUnitsStorage::open_in_memory(DEFAULT_KEYFRAME_INTERVAL, FileWriteAheadLog::new(), &dir.path().join("wal"), policy.clone())
+                .unwrap()
+        };
+        let id = |seed: u8| UnitsObjectId::new([seed; 32]);
+        let object = |seed: u8, data: u8| UnitsObject::new_data(id(seed), UnitsObjectId::new([0; 32]), vec![data; 32]);
+
+        {
+            let storage = open();
+            let clock = storage.inner().slot_clock();
+            clock.set(1);
+            let proofs: Vec<_> = (1..=3).map(|seed| (id(seed), storage.objects().set(&object(seed, 1), None).unwrap())).collect();
+            storage.proofs().store_state_proof(&ProofEngine::new().generate_state_proof(&proofs, &[], None, 1).unwrap()).unwrap();
+            clock.set(2);
+            storage.checkpoint_finalized(1).unwrap().unwrap();
+
+            // Changes in slot 2 are only in the WAL
+            storage.objects().set(&object(1, 2), None).unwrap();
+            storage.objects().delete(&id(2), None).unwrap();
+        }
+
+        let storage = open();
+        assert_eq!(storage.inner().wal().unwrap().checkpoint_slot().unwrap(), Some(1));
+        assert_eq!(storage.inner().latest_state_slot(), Some(1));
+        assert_eq!(storage.objects().get(&id(1)).unwrap(), Some(object(1, 2)));
+        assert_eq!(storage.historical().get_at_slot(&id(1), 1).unwrap(), Some(object(1, 1)));
+        assert_eq!(storage.objects().get(&id(2)).unwrap(), None);
+        assert_eq!(storage.objects().get(&id(3)).unwrap(), Some(object(3, 1)));
+
+        // Recovery needs the snapshot the WAL was checkpointed behind
+        drop(storage);
+        fs::remove_dir_all(&policy.dir).unwrap();
+        assert!(matches!(
+            ConsolidatedUnitsStorage::open_in_memory(DEFAULT_KEYFRAME_INTERVAL, FileWriteAheadLog::new(), &dir.path().join("wal"), policy.clone()),
+            Err(StorageError::NotFound(_))
+        ));
+    }
+
+    #[test]
+    fn test_imported_snapshot_is_logged_to_the_wal() {
+        let (source, slot) = populated(6);
+        let dir = tempdir().unwrap();
+        source.export_snapshot(&dir.path().join("snapshot"), slot).unwrap();
+
+        let open = || {
+            ConsolidatedUnitsStorage::with_backend(
+                StorageBackend::in_memory_with_wal(DEFAULT_KEYFRAME_INTERVAL, FileWriteAheadLog::new(), &dir.path().join("wal")).unwrap(),
+            )
+        };
+        open().import_snapshot(&dir.path().join("snapshot")).unwrap();
+
+        let target = open();
+        for seed in 0..6u8 {
+            let id = UnitsObjectId::new([seed; 32]);
+            assert_eq!(target.objects().get(&id).unwrap(), source.objects().get(&id).unwrap());
+        }
+        assert_eq!(target.proofs().get_state_proof(slot).unwrap(), source.proofs().get_state_proof(slot).unwrap());
+    }
+}
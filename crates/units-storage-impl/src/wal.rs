@@ -1,19 +1,53 @@
 //! Write-Ahead Log Implementation
-//! 
+//!
 //! Provides concrete implementations of the WriteAheadLog trait for durability.
+//!
+//! `FileWriteAheadLog` uses group commit: callers serialize their entry and
+//! hand it to a dedicated writer thread, which drains the queue, writes the
+//! pending entries with a single `write_all` and issues one `sync_data` per
+//! batch according to the configured `SyncPolicy`. Callers block until the
+//! batch containing their entry is durable; under `SyncPolicy::PerSlot` that
+//! is the batch sealed by their slot's state proof. Entries can also be
+//! queued and waited on separately, so a caller can fix its place in the log
+//! while holding a lock and wait for durability after releasing it.
+//!
+//! The log is a directory of segment files that rotate at a size threshold.
+//! Every record is framed as `[u32 LE payload length][u32 LE crc32][payload]`
+//! so a torn tail can be told apart from corruption. `checkpoint(slot)`
+//! seals the active segment, opens the next one with a checkpoint record and
+//! publishes a `CHECKPOINT` manifest. Replay skips updates logged before the
+//! latest checkpoint record for its slot or earlier, keeping those for later
+//! slots, and decodes the remaining segments in parallel. A segment is only
+//! deleted once every entry in it is for the checkpoint slot or earlier.
+//!
+//! Earlier versions kept the log in a single file of
+//! `[u64 LE payload length][payload]` records. `init` on such a file
+//! migrates it in place into a directory whose first segment holds the same
+//! records.
 
 use units_core_types::WriteAheadLog;
 use bincode;
 use serde::{Deserialize, Serialize};
-use std::fs::{File, OpenOptions};
-use std::io::{BufReader, BufWriter, Read, Write};
+use std::collections::BTreeMap;
+use std::fs::{self, File, OpenOptions};
+use std::io::{self, Write};
 use std::path::{Path, PathBuf};
-use std::sync::{Arc, Mutex};
-use std::time::{SystemTime, UNIX_EPOCH};
+use std::sync::mpsc::{self, Receiver, RecvTimeoutError, Sender, SyncSender};
+use std::sync::{Arc, Mutex, RwLock};
+use std::thread::{self, JoinHandle};
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
 use units_core_types::error::StorageError;
 use units_core_types::objects::UnitsObject;
 use units_core_types::{StateProof, UnitsObjectProof, SlotNumber};
 
+use crate::consolidated_storage::InMemoryObjectStorage;
+
+const SEGMENT_PREFIX: &str = "wal-";
+const SEGMENT_SUFFIX: &str = ".log";
+const CHECKPOINT_FILE: &str = "CHECKPOINT";
+const LEGACY_SUFFIX: &str = ".legacy";
+const RECORD_HEADER_LEN: usize = 8;
+
 /// WAL entry for object updates
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct WALEntry {
@@ -31,44 +65,220 @@ pub enum WALEntryType {
     ObjectUpdate(WALEntry),
     /// State proof for a slot
     StateProof(StateProof),
+    /// Everything before this record is reflected up to the given slot
+    Checkpoint(SlotNumber),
+    /// Deletion of an object, carrying its last state and the deletion proof
+    ObjectDelete(WALEntry),
+}
+
+impl WALEntryType {
+    /// Slot the record belongs to
+    pub fn slot(&self) -> SlotNumber {
+        match self {
+            Self::ObjectUpdate(entry) | Self::ObjectDelete(entry) => entry.slot,
+            Self::StateProof(proof) => proof.slot,
+            Self::Checkpoint(slot) => *slot,
+        }
+    }
+}
+
+/// Borrowed mirrors of `WALEntry`/`WALEntryType` used on the write path
+///
+/// Field and variant order must match the owned types so bincode produces
+/// identical bytes without cloning the object being logged.
+#[derive(Serialize)]
+struct WALEntryRef<'a> {
+    object: &'a UnitsObject,
+    slot: SlotNumber,
+    proof: &'a UnitsObjectProof,
+    timestamp: u64,
+    transaction_hash: Option<[u8; 32]>,
+}
+
+#[derive(Serialize)]
+enum WALEntryTypeRef<'a> {
+    ObjectUpdate(WALEntryRef<'a>),
+    StateProof(&'a StateProof),
+    Checkpoint(SlotNumber),
+    ObjectDelete(WALEntryRef<'a>),
+}
+
+/// When the writer thread makes a batch durable
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize, Deserialize)]
+pub enum SyncPolicy {
+    /// `sync_data` after every entry
+    PerEntry,
+    /// Gather entries for up to this many milliseconds, then sync once
+    ///
+    /// `0` commits whatever is queued as soon as the writer is free.
+    IntervalMs(u64),
+    /// Sync when a slot is sealed by its state proof, or when entries for a
+    /// later slot arrive
+    ///
+    /// Object changes wait for that sync, so their slot's changes share one
+    /// `sync_data`.
+    PerSlot,
 }
 
-/// A basic file-based write-ahead log implementation
+/// Configuration for `FileWriteAheadLog`
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct WALConfig {
+    /// Fsync policy of the writer thread
+    pub sync_policy: SyncPolicy,
+    /// Maximum number of entries gathered into one write
+    pub max_batch_entries: usize,
+    /// Segment size in bytes after which the writer starts a new segment
+    pub segment_size: u64,
+}
+
+impl Default for WALConfig {
+    fn default() -> Self {
+        Self {
+            sync_policy: SyncPolicy::IntervalMs(0),
+            max_batch_entries: 1024,
+            segment_size: 64 * 1024 * 1024,
+        }
+    }
+}
+
+/// Callback told how long each `sync_data` of a committed batch took
+pub type SyncObserver = Arc<dyn Fn(Duration) + Send + Sync>;
+
+/// Acknowledgement sent back to a blocked caller once its batch is durable
+type Ack = SyncSender<Result<(), String>>;
+
+/// An entry queued with the writer thread, durable once `wait` returns `Ok`
+///
+/// Entries are written in the order they were queued.
+#[must_use = "the entry may not be durable until `wait` returns"]
+pub struct PendingAppend {
+    done: Receiver<Result<(), String>>,
+}
+
+impl PendingAppend {
+    /// Block until the batch holding the entry is durable
+    pub fn wait(self) -> Result<(), StorageError> {
+        self.done
+            .recv()
+            .map_err(|_| StorageError::WAL("WAL writer has stopped".to_string()))?
+            .map_err(StorageError::WAL)
+    }
+}
+
+enum WriterCommand {
+    /// Append a pre-framed entry
+    Append {
+        frame: Vec<u8>,
+        slot: SlotNumber,
+        seals_slot: bool,
+        ack: Ack,
+    },
+    /// Make everything written so far durable
+    Sync { ack: Ack },
+    /// Seal the segment, write a checkpoint record and publish the manifest
+    Checkpoint {
+        frame: Vec<u8>,
+        slot: SlotNumber,
+        ack: Ack,
+    },
+}
+
+struct WriterHandle {
+    sender: Sender<WriterCommand>,
+    thread: JoinHandle<()>,
+}
+
+/// Latest published checkpoint: replay starts at `segment`, the oldest segment kept
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+struct CheckpointManifest {
+    slot: SlotNumber,
+    segment: u64,
+}
+
+/// A segmented, checksummed write-ahead log with a group-commit writer thread
 pub struct FileWriteAheadLog {
-    /// Path to the WAL file
-    path: Arc<Mutex<PathBuf>>,
-    /// File handle for writing
-    file: Arc<Mutex<Option<BufWriter<File>>>>,
+    /// Group-commit and rotation settings
+    config: WALConfig,
+    /// Directory holding the WAL segments
+    path: Mutex<PathBuf>,
+    /// Queue to the writer thread, `None` until initialized
+    writer: RwLock<Option<WriterHandle>>,
+    /// Handed to the writer thread on `init`
+    sync_observer: Option<SyncObserver>,
 }
 
 impl FileWriteAheadLog {
     /// Create a new file-based WAL
     pub fn new() -> Self {
+        Self::with_config(WALConfig::default())
+    }
+
+    /// Create a new file-based WAL with explicit group-commit settings
+    pub fn with_config(config: WALConfig) -> Self {
         Self {
-            path: Arc::new(Mutex::new(PathBuf::new())),
-            file: Arc::new(Mutex::new(None)),
+            config,
+            path: Mutex::new(PathBuf::new()),
+            writer: RwLock::new(None),
+            sync_observer: None,
         }
     }
-    
-    /// Initialize the WAL with a file path
+
+    /// Report the latency of every batch fsync to `observer`
+    ///
+    /// Takes effect for writer threads started by later calls to `init`.
+    pub fn with_sync_observer(mut self, observer: SyncObserver) -> Self {
+        self.sync_observer = Some(observer);
+        self
+    }
+
+    /// Initialize the WAL in the directory `path` and start the writer thread
+    ///
+    /// A torn record at the end of the newest existing segment is truncated
+    /// and writing continues in a fresh segment. If `path` is a single-file
+    /// log from an earlier version, it is first migrated into a directory at
+    /// the same path.
     pub fn init(&self, path: &Path) -> Result<(), StorageError> {
-        let mut file_guard = self
-            .file
-            .lock()
-            .map_err(|e| StorageError::WAL(format!("Failed to acquire lock: {}", e)))?;
+        let legacy = legacy_path(path);
+        if path.is_file() {
+            // Move the file aside so the directory can take its place
+            fs::rename(path, &legacy)
+                .map_err(|e| StorageError::WAL(format!("Failed to move legacy WAL file aside: {}", e)))?;
+        }
+        fs::create_dir_all(path)
+            .map_err(|e| StorageError::WAL(format!("Failed to create WAL directory: {}", e)))?;
+        if legacy.is_file() {
+            migrate_legacy_file(&legacy, path)?;
+        }
 
-        // Create or open the WAL file
-        let file = OpenOptions::new()
-            .create(true)
-            .append(true)
-            .read(true)
-            .open(path)
-            .map_err(|e| StorageError::WAL(format!("Failed to open WAL file: {}", e)))?;
+        let segments = list_segments(path)?;
+        if let Some(&last) = segments.last() {
+            truncate_torn_tail(&segment_path(path, last))?;
+        }
+        let mut max_slots = BTreeMap::new();
+        for &id in &segments {
+            max_slots.insert(id, segment_max_slot(&segment_path(path, id))?);
+        }
+        let next = segments.last().map_or(0, |last| last + 1);
+        let mut segment = SegmentWriter::open(path, next, self.config.segment_size, max_slots)
+            .map_err(|e| StorageError::WAL(format!("Failed to open WAL segment: {}", e)))?;
+        segment.sync_observer = self.sync_observer.clone();
 
-        let writer = BufWriter::new(file);
+        let (sender, receiver) = mpsc::channel();
+        let config = self.config.clone();
+        let thread = thread::Builder::new()
+            .name("units-wal-writer".to_string())
+            .spawn(move || run_writer(segment, config, receiver))
+            .map_err(|e| StorageError::WAL(format!("Failed to start WAL writer: {}", e)))?;
 
-        // Store the file writer
-        *file_guard = Some(writer);
+        // Replace any previous writer; it drains its queue before exiting
+        let previous = self
+            .writer
+            .write()
+            .map_err(|e| StorageError::WAL(format!("Failed to acquire lock: {}", e)))?
+            .replace(WriterHandle { sender, thread });
+        if let Some(previous) = previous {
+            previous.shutdown();
+        }
 
         // Store the path
         let mut path_guard = self
@@ -79,30 +289,230 @@ impl FileWriteAheadLog {
 
         Ok(())
     }
-    
-    /// Write a WAL entry to storage
-    fn write_wal_entry(&self, entry: &WALEntryType) -> Result<(), StorageError> {
-        let mut file_guard = self
-            .file
-            .lock()
-            .map_err(|e| StorageError::WAL(format!("Failed to acquire lock: {}", e)))?;
 
-        let file = file_guard
-            .as_mut()
+    /// Block until every entry recorded so far is durable
+    pub fn sync(&self) -> Result<(), StorageError> {
+        let (ack, done) = mpsc::sync_channel(1);
+        self.enqueue(WriterCommand::Sync { ack }, done)?.wait()
+    }
+
+    /// Mark everything recorded so far as applied up to `slot`
+    ///
+    /// Called by `ConsolidatedUnitsStorage::checkpoint` once a snapshot of
+    /// `slot` is written, so nothing it drops is lost. Replay
+    /// then skips every update recorded so far for `slot` or earlier, while
+    /// updates already recorded for later slots, as written by a pipelined
+    /// next slot, survive. Sealed segments holding nothing after `slot` are
+    /// deleted.
+    pub fn checkpoint(&self, slot: SlotNumber) -> Result<(), StorageError> {
+        let frame = frame_record(&WALEntryTypeRef::Checkpoint(slot))?;
+        let (ack, done) = mpsc::sync_channel(1);
+        self.enqueue(WriterCommand::Checkpoint { frame, slot, ack }, done)?.wait()
+    }
+
+    /// Slot of the latest published checkpoint, if any
+    pub fn checkpoint_slot(&self) -> Result<Option<SlotNumber>, StorageError> {
+        Ok(read_manifest(&self.wal_dir()?)?.map(|manifest| manifest.slot))
+    }
+
+    /// Replay every object change and state proof after the latest
+    /// checkpoint in parallel
+    ///
+    /// With `after` set, records for that slot or earlier are skipped too, as
+    /// for a store restored from a snapshot taken at `after`. Unlike `replay`,
+    /// deletions are reported, so this is what rebuilds a store from the log.
+    ///
+    /// Segments are decoded concurrently and object updates and deletions
+    /// routed into `shard_count` per-shard queues using the same id-to-shard
+    /// mapping as `InMemoryObjectStorage`. Each queue is applied on its own
+    /// thread, so changes to one object are always applied in log order;
+    /// state proofs are applied on the calling thread meanwhile.
+    pub fn replay_parallel<F>(&self, shard_count: usize, after: Option<SlotNumber>, callback: F) -> Result<(), StorageError>
+    where
+        F: Fn(&WALEntryType) -> Result<(), StorageError> + Sync,
+    {
+        let shard_count = shard_count.max(1).next_power_of_two();
+        let mut queues: Vec<Vec<WALEntryType>> = (0..shard_count).map(|_| Vec::new()).collect();
+        let mut state_proofs = Vec::new();
+        for record in self.live_records()? {
+            if after.map_or(false, |after| record.slot() <= after) {
+                continue;
+            }
+            let shard = match &record {
+                WALEntryType::ObjectUpdate(entry) | WALEntryType::ObjectDelete(entry) => {
+                    Some(InMemoryObjectStorage::shard_index(entry.object.id(), shard_count - 1))
+                }
+                WALEntryType::StateProof(_) | WALEntryType::Checkpoint(_) => None,
+            };
+            match shard {
+                Some(shard) => queues[shard].push(record),
+                None => state_proofs.push(record),
+            }
+        }
+
+        let callback = &callback;
+        thread::scope(|scope| {
+            let workers: Vec<_> = queues
+                .iter()
+                .filter(|queue| !queue.is_empty())
+                .map(|queue| scope.spawn(move || queue.iter().try_for_each(callback)))
+                .collect();
+            let applied = state_proofs.iter().try_for_each(callback);
+            workers.into_iter().try_for_each(|worker| {
+                worker
+                    .join()
+                    .map_err(|_| StorageError::WAL("WAL replay worker panicked".to_string()))?
+            })?;
+            applied
+        })
+    }
+
+    /// Log a deletion; `object` is the state it removed and `proof` the deletion proof
+    pub fn record_delete(
+        &self,
+        object: &UnitsObject,
+        proof: &UnitsObjectProof,
+        transaction_hash: Option<[u8; 32]>,
+    ) -> Result<(), StorageError> {
+        self.queue_delete(object, proof, transaction_hash)?.wait()
+    }
+
+    /// Queue an object update without waiting for it to become durable
+    pub fn queue_update(
+        &self,
+        object: &UnitsObject,
+        proof: &UnitsObjectProof,
+        transaction_hash: Option<[u8; 32]>,
+    ) -> Result<PendingAppend, StorageError> {
+        let entry = WALEntryRef {
+            object,
+            slot: proof.slot,
+            proof,
+            timestamp: Self::current_timestamp(),
+            transaction_hash,
+        };
+        self.queue_entry(&WALEntryTypeRef::ObjectUpdate(entry), proof.slot)
+    }
+
+    /// Queue a deletion without waiting for it to become durable
+    pub fn queue_delete(
+        &self,
+        object: &UnitsObject,
+        proof: &UnitsObjectProof,
+        transaction_hash: Option<[u8; 32]>,
+    ) -> Result<PendingAppend, StorageError> {
+        let entry = WALEntryRef {
+            object,
+            slot: proof.slot,
+            proof,
+            timestamp: Self::current_timestamp(),
+            transaction_hash,
+        };
+        self.queue_entry(&WALEntryTypeRef::ObjectDelete(entry), proof.slot)
+    }
+
+    /// Frame a WAL entry and hand it to the writer thread
+    fn queue_entry(&self, entry: &WALEntryTypeRef<'_>, slot: SlotNumber) -> Result<PendingAppend, StorageError> {
+        // Serialize on the caller's thread so the writer only does I/O
+        let frame = frame_record(entry)?;
+        let (ack, done) = mpsc::sync_channel(1);
+        let seals_slot = matches!(entry, WALEntryTypeRef::StateProof(_));
+        self.enqueue(WriterCommand::Append { frame, slot, seals_slot, ack }, done)
+    }
+
+    fn enqueue(
+        &self,
+        command: WriterCommand,
+        done: Receiver<Result<(), String>>,
+    ) -> Result<PendingAppend, StorageError> {
+        let writer = self
+            .writer
+            .read()
+            .map_err(|e| StorageError::WAL(format!("Failed to acquire lock: {}", e)))?;
+        let writer = writer
+            .as_ref()
             .ok_or_else(|| StorageError::WAL("WAL has not been initialized".to_string()))?;
+        writer
+            .sender
+            .send(command)
+            .map_err(|_| StorageError::WAL("WAL writer has stopped".to_string()))?;
+        Ok(PendingAppend { done })
+    }
 
-        // Serialize the entry
-        let serialized = bincode::serialize(entry)?;
+    fn wal_dir(&self) -> Result<PathBuf, StorageError> {
+        let path_guard = self.path.lock()
+            .map_err(|e| StorageError::WAL(format!("Failed to acquire path lock: {}", e)))?;
+        Ok(path_guard.clone())
+    }
 
-        // Write the entry length and data
-        let entry_len = serialized.len() as u64;
-        file.write_all(&entry_len.to_le_bytes())?;
-        file.write_all(&serialized)?;
-        file.flush()?;
+    /// Object updates after the latest checkpoint, in log order
+    fn live_updates(&self) -> Result<Vec<WALEntry>, StorageError> {
+        Ok(self
+            .live_records()?
+            .into_iter()
+            .filter_map(|record| match record {
+                WALEntryType::ObjectUpdate(entry) => Some(entry),
+                _ => None,
+            })
+            .collect())
+    }
 
-        Ok(())
+    /// Decode every segment after the latest checkpoint, in log order
+    fn live_records(&self) -> Result<Vec<WALEntryType>, StorageError> {
+        let dir = self.wal_dir()?;
+        let first_live = read_manifest(&dir)?.map_or(0, |manifest| manifest.segment);
+        let segments: Vec<u64> = list_segments(&dir)?
+            .into_iter()
+            .filter(|id| *id >= first_live)
+            .collect();
+
+        // Decode segments concurrently, a bounded number at a time
+        let parallelism = thread::available_parallelism().map_or(4, |n| n.get());
+        let last = segments.last().copied();
+        let mut decoded = Vec::with_capacity(segments.len());
+        for chunk in segments.chunks(parallelism) {
+            let results: Vec<Result<DecodedSegment, StorageError>> = thread::scope(|scope| {
+                let workers: Vec<_> = chunk
+                    .iter()
+                    .map(|id| {
+                        let path = segment_path(&dir, *id);
+                        let tolerate_torn_tail = Some(*id) == last;
+                        scope.spawn(move || decode_segment(&path, tolerate_torn_tail))
+                    })
+                    .collect();
+                workers
+                    .into_iter()
+                    .map(|worker| {
+                        worker
+                            .join()
+                            .map_err(|_| StorageError::WAL("WAL decode worker panicked".to_string()))?
+                    })
+                    .collect()
+            });
+            for result in results {
+                decoded.push(result?);
+            }
+        }
+
+        // The latest checkpoint record, published or not, covers the records
+        // logged before it for its slot or earlier
+        let checkpoint = decoded.iter().enumerate().rev().find_map(|(position, segment)| {
+            segment.checkpoint.map(|(at, slot)| (position, at, slot))
+        });
+        let mut records = Vec::new();
+        for (position, segment) in decoded.into_iter().enumerate() {
+            for (index, record) in segment.records.into_iter().enumerate() {
+                let covered = checkpoint.map_or(false, |(checkpoint_position, at, slot)| {
+                    (position, index) < (checkpoint_position, at) && record.slot() <= slot
+                });
+                if !covered {
+                    records.push(record);
+                }
+            }
+        }
+        Ok(records)
     }
-    
+
     /// Get the current timestamp in milliseconds
     fn current_timestamp() -> u64 {
         SystemTime::now()
@@ -112,12 +522,450 @@ impl FileWriteAheadLog {
     }
 }
 
+impl WriterHandle {
+    /// Close the queue and wait for the writer to drain it
+    fn shutdown(self) {
+        drop(self.sender);
+        if self.thread.join().is_err() {
+            log::error!("WAL writer thread panicked");
+        }
+    }
+}
+
+impl Drop for FileWriteAheadLog {
+    fn drop(&mut self) {
+        if let Ok(writer) = self.writer.get_mut() {
+            if let Some(writer) = writer.take() {
+                writer.shutdown();
+            }
+        }
+    }
+}
+
 impl Default for FileWriteAheadLog {
     fn default() -> Self {
         Self::new()
     }
 }
 
+/// Object changes and state proofs decoded from one segment
+struct DecodedSegment {
+    records: Vec<WALEntryType>,
+    /// Number of records preceding the last checkpoint record in this segment, and its slot
+    checkpoint: Option<(usize, SlotNumber)>,
+}
+
+/// Serialize and frame a record with its length and checksum
+fn frame_record(entry: &WALEntryTypeRef<'_>) -> Result<Vec<u8>, StorageError> {
+    let payload = bincode::serialize(entry)?;
+    let mut frame = Vec::with_capacity(RECORD_HEADER_LEN + payload.len());
+    frame.extend_from_slice(&(payload.len() as u32).to_le_bytes());
+    frame.extend_from_slice(&crc32fast::hash(&payload).to_le_bytes());
+    frame.extend_from_slice(&payload);
+    Ok(frame)
+}
+
+/// Return the payload of the record at `offset` if it is complete and its checksum matches
+fn frame_payload(bytes: &[u8], offset: usize) -> Option<&[u8]> {
+    let header = bytes.get(offset..offset + RECORD_HEADER_LEN)?;
+    let len = u32::from_le_bytes(header[0..4].try_into().ok()?) as usize;
+    let crc = u32::from_le_bytes(header[4..8].try_into().ok()?);
+    let start = offset + RECORD_HEADER_LEN;
+    let payload = bytes.get(start..start + len)?;
+    (crc32fast::hash(payload) == crc).then_some(payload)
+}
+
+/// Length of the prefix of `bytes` made of intact records
+fn valid_prefix_len(bytes: &[u8]) -> usize {
+    let mut offset = 0;
+    while let Some(payload) = frame_payload(bytes, offset) {
+        offset += RECORD_HEADER_LEN + payload.len();
+    }
+    offset
+}
+
+/// Decode one segment, reading the file with a single allocation
+///
+/// Only the newest segment may end in a torn record; anywhere else a bad
+/// record means corruption.
+fn decode_segment(path: &Path, tolerate_torn_tail: bool) -> Result<DecodedSegment, StorageError> {
+    let bytes = fs::read(path)
+        .map_err(|e| StorageError::WAL(format!("Failed to read WAL segment {}: {}", path.display(), e)))?;
+
+    let mut decoded = DecodedSegment { records: Vec::new(), checkpoint: None };
+    let mut offset = 0;
+    while offset < bytes.len() {
+        let Some(payload) = frame_payload(&bytes, offset) else {
+            if tolerate_torn_tail {
+                log::warn!("Ignoring torn WAL tail in {} at offset {}", path.display(), offset);
+                break;
+            }
+            return Err(StorageError::WAL(format!(
+                "Corrupt WAL record in {} at offset {}",
+                path.display(),
+                offset
+            )));
+        };
+        match bincode::deserialize::<WALEntryType>(payload)? {
+            WALEntryType::Checkpoint(slot) => decoded.checkpoint = Some((decoded.records.len(), slot)),
+            record => decoded.records.push(record),
+        }
+        offset += RECORD_HEADER_LEN + payload.len();
+    }
+    Ok(decoded)
+}
+
+/// Highest slot of the object changes and state proofs in a segment, `None` if it has none
+///
+/// Reading stops at the first bad record; a record that fails to decode
+/// pins the segment so no checkpoint deletes it.
+fn segment_max_slot(path: &Path) -> Result<Option<SlotNumber>, StorageError> {
+    let bytes = fs::read(path)?;
+    let mut max_slot = None;
+    let mut offset = 0;
+    while let Some(payload) = frame_payload(&bytes, offset) {
+        let slot = match bincode::deserialize::<WALEntryType>(payload) {
+            Ok(WALEntryType::Checkpoint(_)) => None,
+            Ok(record) => Some(record.slot()),
+            Err(_) => Some(SlotNumber::MAX),
+        };
+        max_slot = max_slot.max(slot);
+        offset += RECORD_HEADER_LEN + payload.len();
+    }
+    Ok(max_slot)
+}
+
+fn truncate_torn_tail(path: &Path) -> Result<(), StorageError> {
+    let bytes = fs::read(path)?;
+    let valid = valid_prefix_len(&bytes);
+    if valid < bytes.len() {
+        log::warn!("Truncating torn WAL tail in {} at offset {}", path.display(), valid);
+        OpenOptions::new().write(true).open(path)?.set_len(valid as u64)?;
+    }
+    Ok(())
+}
+
+/// Where `init` moves a single-file log from an earlier version while migrating it
+fn legacy_path(path: &Path) -> PathBuf {
+    let mut name = path.file_name().unwrap_or_default().to_os_string();
+    name.push(LEGACY_SUFFIX);
+    path.with_file_name(name)
+}
+
+/// Rewrite the records of a single-file log as the first segment of `dir`,
+/// then remove the file
+///
+/// The old writer flushed without syncing, so a torn last record is
+/// dropped. The segment is written under a temporary name and renamed into
+/// place, so a crash part way leaves the file to migrate again.
+fn migrate_legacy_file(legacy: &Path, dir: &Path) -> Result<(), StorageError> {
+    let first = segment_path(dir, 0);
+    if !first.exists() {
+        let bytes = fs::read(legacy)?;
+        let mut segment = Vec::with_capacity(bytes.len());
+        let mut offset = 0;
+        let mut records = 0;
+        while let Some(header) = bytes.get(offset..offset + 8) {
+            let len = u64::from_le_bytes(header.try_into().expect("slice of 8 bytes")) as usize;
+            let Some(payload) = bytes.get(offset + 8..).and_then(|rest| rest.get(..len)) else {
+                break;
+            };
+            // Old records decode as the first variants of the current type
+            bincode::deserialize::<WALEntryType>(payload)?;
+            segment.extend_from_slice(&(payload.len() as u32).to_le_bytes());
+            segment.extend_from_slice(&crc32fast::hash(payload).to_le_bytes());
+            segment.extend_from_slice(payload);
+            offset += 8 + len;
+            records += 1;
+        }
+        if offset < bytes.len() {
+            log::warn!("Dropping torn record at offset {} of legacy WAL {}", offset, legacy.display());
+        }
+
+        let tmp = dir.join(format!("{}{:016}{}.tmp", SEGMENT_PREFIX, 0, SEGMENT_SUFFIX));
+        let mut file = File::create(&tmp)?;
+        file.write_all(&segment)?;
+        file.sync_data()?;
+        fs::rename(&tmp, &first)?;
+        log::info!("Migrated {} records from legacy WAL {}", records, legacy.display());
+    }
+    fs::remove_file(legacy)?;
+    Ok(())
+}
+
+fn segment_path(dir: &Path, id: u64) -> PathBuf {
+    dir.join(format!("{}{:016}{}", SEGMENT_PREFIX, id, SEGMENT_SUFFIX))
+}
+
+/// Segment ids in `dir`, oldest first
+fn list_segments(dir: &Path) -> Result<Vec<u64>, StorageError> {
+    let mut ids = Vec::new();
+    for entry in fs::read_dir(dir)? {
+        let name = entry?.file_name();
+        let id = name
+            .to_str()
+            .and_then(|name| name.strip_prefix(SEGMENT_PREFIX))
+            .and_then(|name| name.strip_suffix(SEGMENT_SUFFIX))
+            .and_then(|id| id.parse().ok());
+        if let Some(id) = id {
+            ids.push(id);
+        }
+    }
+    ids.sort_unstable();
+    Ok(ids)
+}
+
+/// Read the manifest, ignoring one that is missing or fails its checksum
+fn read_manifest(dir: &Path) -> Result<Option<CheckpointManifest>, StorageError> {
+    let bytes = match fs::read(dir.join(CHECKPOINT_FILE)) {
+        Ok(bytes) => bytes,
+        Err(e) if e.kind() == io::ErrorKind::NotFound => return Ok(None),
+        Err(e) => return Err(e.into()),
+    };
+    if bytes.len() != 20 || crc32fast::hash(&bytes[..16]).to_le_bytes() != bytes[16..20] {
+        log::warn!("Ignoring invalid WAL checkpoint manifest in {}", dir.display());
+        return Ok(None);
+    }
+    Ok(Some(CheckpointManifest {
+        slot: u64::from_le_bytes(bytes[0..8].try_into().expect("length checked")),
+        segment: u64::from_le_bytes(bytes[8..16].try_into().expect("length checked")),
+    }))
+}
+
+/// Open segment `id` for appending, returning it with its current length
+fn open_segment_file(dir: &Path, id: u64) -> io::Result<(File, u64)> {
+    let file = OpenOptions::new()
+        .create(true)
+        .append(true)
+        .open(segment_path(dir, id))?;
+    let len = file.metadata()?.len();
+    Ok((file, len))
+}
+
+/// Atomically replace the manifest via write-then-rename
+fn write_manifest(dir: &Path, manifest: CheckpointManifest) -> io::Result<()> {
+    let mut bytes = Vec::with_capacity(20);
+    bytes.extend_from_slice(&manifest.slot.to_le_bytes());
+    bytes.extend_from_slice(&manifest.segment.to_le_bytes());
+    let crc = crc32fast::hash(&bytes);
+    bytes.extend_from_slice(&crc.to_le_bytes());
+
+    let tmp = dir.join(format!("{}.tmp", CHECKPOINT_FILE));
+    let mut file = File::create(&tmp)?;
+    file.write_all(&bytes)?;
+    file.sync_data()?;
+    fs::rename(&tmp, dir.join(CHECKPOINT_FILE))
+}
+
+/// Active segment owned by the writer thread
+struct SegmentWriter {
+    dir: PathBuf,
+    id: u64,
+    file: File,
+    len: u64,
+    segment_size: u64,
+    sync_observer: Option<SyncObserver>,
+    /// Highest slot logged in each segment on disk, `None` while it holds no entries
+    max_slots: BTreeMap<u64, Option<SlotNumber>>,
+}
+
+impl SegmentWriter {
+    fn open(
+        dir: &Path,
+        id: u64,
+        segment_size: u64,
+        mut max_slots: BTreeMap<u64, Option<SlotNumber>>,
+    ) -> io::Result<Self> {
+        let (file, len) = open_segment_file(dir, id)?;
+        max_slots.entry(id).or_insert(None);
+        Ok(Self { dir: dir.to_path_buf(), id, file, len, segment_size, sync_observer: None, max_slots })
+    }
+
+    /// Record that the active segment holds an entry for `slot`
+    fn note_slot(&mut self, slot: SlotNumber) {
+        let max_slot = self.max_slots.entry(self.id).or_insert(None);
+        *max_slot = (*max_slot).max(Some(slot));
+    }
+
+    /// Append `bytes` and make them durable
+    ///
+    /// On failure the segment is cut back to its last durable length, so a
+    /// partial frame never ends up in front of later records.
+    fn write_durable(&mut self, bytes: &[u8]) -> io::Result<()> {
+        let written = self.file.write_all(bytes).and_then(|()| {
+            let started = Instant::now();
+            self.file.sync_data()?;
+            if let Some(observer) = &self.sync_observer {
+                observer(started.elapsed());
+            }
+            Ok(())
+        });
+        if let Err(e) = written {
+            self.discard_unsynced();
+            return Err(e);
+        }
+        self.len += bytes.len() as u64;
+        Ok(())
+    }
+
+    /// Drop whatever follows the last durable record of the active segment
+    ///
+    /// Falls back to starting a fresh segment if the file cannot be
+    /// truncated; appends never land behind a torn frame.
+    fn discard_unsynced(&mut self) {
+        let truncated = self.file.set_len(self.len).and_then(|()| self.file.sync_data());
+        if let Err(e) = truncated {
+            log::error!("Failed to truncate WAL segment {} to {} bytes: {}", self.id, self.len, e);
+            if let Err(e) = self.rotate() {
+                log::error!("Failed to rotate WAL segment {}: {}", self.id, e);
+            }
+        }
+    }
+
+    /// Start the next segment; the current one is already synced
+    fn rotate(&mut self) -> io::Result<()> {
+        let id = self.id + 1;
+        let (file, len) = open_segment_file(&self.dir, id)?;
+        (self.id, self.file, self.len) = (id, file, len);
+        self.max_slots.entry(id).or_insert(None);
+        Ok(())
+    }
+
+    fn rotate_if_full(&mut self) {
+        if self.len >= self.segment_size {
+            if let Err(e) = self.rotate() {
+                log::error!("Failed to rotate WAL segment {}: {}", self.id, e);
+            }
+        }
+    }
+
+    /// Seal the active segment, open the next with a checkpoint record and
+    /// drop the sealed segments the checkpoint fully covers
+    ///
+    /// The record goes at the head of the new segment, so it outlives every
+    /// segment this checkpoint deletes.
+    fn checkpoint(&mut self, frame: &[u8], slot: SlotNumber) -> io::Result<()> {
+        self.rotate()?;
+        self.write_durable(frame)?;
+
+        let mut obsolete = Vec::new();
+        let mut first_kept = self.id;
+        for (&id, max_slot) in &self.max_slots {
+            if id == self.id {
+                continue;
+            }
+            if max_slot.map_or(true, |max_slot| max_slot <= slot) {
+                obsolete.push(id);
+            } else {
+                first_kept = first_kept.min(id);
+            }
+        }
+        write_manifest(&self.dir, CheckpointManifest { slot, segment: first_kept })?;
+
+        // Replay skips everything in the covered segments; remove them
+        for id in obsolete {
+            fs::remove_file(segment_path(&self.dir, id))?;
+            self.max_slots.remove(&id);
+        }
+        Ok(())
+    }
+}
+
+/// Entries written but not yet synced, with the callers waiting on them
+struct PendingBatch {
+    buf: Vec<u8>,
+    acks: Vec<Ack>,
+    open_slot: Option<SlotNumber>,
+}
+
+impl PendingBatch {
+    /// Write the buffered frames with one `write_all`, sync once and wake every waiter
+    fn commit(&mut self, segment: &mut SegmentWriter) {
+        if self.acks.is_empty() && self.buf.is_empty() {
+            return;
+        }
+        if let Some(slot) = self.open_slot {
+            segment.note_slot(slot);
+        }
+        let result = segment
+            .write_durable(&self.buf)
+            .map_err(|e| format!("Failed to commit WAL batch: {}", e));
+        if let Err(e) = &result {
+            log::error!("{}", e);
+        }
+
+        self.buf.clear();
+        self.open_slot = None;
+        for ack in self.acks.drain(..) {
+            // A caller that gave up waiting is not an error
+            let _ = ack.send(result.clone());
+        }
+        segment.rotate_if_full();
+    }
+}
+
+/// Writer thread: gather queued commands into batches and commit them per policy
+fn run_writer(mut segment: SegmentWriter, config: WALConfig, receiver: Receiver<WriterCommand>) {
+    let max_batch = config.max_batch_entries.max(1);
+    let mut pending = PendingBatch { buf: Vec::new(), acks: Vec::new(), open_slot: None };
+    let mut batch = Vec::with_capacity(max_batch);
+
+    // Block for the first command of each batch; exit once every sender is gone
+    while let Ok(first) = receiver.recv() {
+        batch.push(first);
+        match config.sync_policy {
+            SyncPolicy::IntervalMs(ms) if ms > 0 => {
+                let deadline = Instant::now() + Duration::from_millis(ms);
+                while batch.len() < max_batch {
+                    match receiver.recv_timeout(deadline.saturating_duration_since(Instant::now())) {
+                        Ok(command) => batch.push(command),
+                        Err(RecvTimeoutError::Timeout) | Err(RecvTimeoutError::Disconnected) => break,
+                    }
+                }
+            }
+            _ => batch.extend(receiver.try_iter().take(max_batch - 1)),
+        }
+
+        for command in batch.drain(..) {
+            match command {
+                WriterCommand::Append { frame, slot, seals_slot, ack } => {
+                    // Entries for a later slot close the previous one
+                    if config.sync_policy == SyncPolicy::PerSlot
+                        && pending.open_slot.map_or(false, |open| slot > open)
+                    {
+                        pending.commit(&mut segment);
+                    }
+                    pending.buf.extend_from_slice(&frame);
+                    pending.acks.push(ack);
+                    pending.open_slot = Some(pending.open_slot.map_or(slot, |open| open.max(slot)));
+
+                    if config.sync_policy == SyncPolicy::PerEntry || seals_slot {
+                        pending.commit(&mut segment);
+                    }
+                }
+                WriterCommand::Sync { ack } => {
+                    pending.acks.push(ack);
+                    pending.commit(&mut segment);
+                }
+                WriterCommand::Checkpoint { frame, slot, ack } => {
+                    pending.commit(&mut segment);
+                    let result = segment
+                        .checkpoint(&frame, slot)
+                        .map_err(|e| format!("Failed to checkpoint WAL at slot {}: {}", slot, e));
+                    let _ = ack.send(result);
+                }
+            }
+        }
+
+        if matches!(config.sync_policy, SyncPolicy::IntervalMs(_)) {
+            pending.commit(&mut segment);
+        }
+    }
+
+    // Make anything still pending durable before the thread exits
+    pending.commit(&mut segment);
+}
+
 impl WriteAheadLog for FileWriteAheadLog {
     fn record_update(
         &self,
@@ -125,56 +973,20 @@ impl WriteAheadLog for FileWriteAheadLog {
         proof: &UnitsObjectProof,
         transaction_hash: Option<[u8; 32]>,
     ) -> Result<(), StorageError> {
-        let entry = WALEntry {
-            object: object.clone(),
-            slot: proof.slot,
-            proof: proof.clone(),
-            timestamp: Self::current_timestamp(),
-            transaction_hash,
-        };
-
-        self.write_wal_entry(&WALEntryType::ObjectUpdate(entry))
+        self.queue_update(object, proof, transaction_hash)?.wait()
     }
 
     fn record_state_proof(&self, state_proof: &StateProof) -> Result<(), StorageError> {
-        self.write_wal_entry(&WALEntryType::StateProof(state_proof.clone()))
+        self.queue_entry(&WALEntryTypeRef::StateProof(state_proof), state_proof.slot)?.wait()
     }
 
     fn replay<F>(&self, mut callback: F) -> Result<(), StorageError>
     where
         F: FnMut(&UnitsObject, &UnitsObjectProof) -> Result<(), StorageError>,
     {
-        let path_guard = self.path.lock()
-            .map_err(|e| StorageError::WAL(format!("Failed to acquire path lock: {}", e)))?;
-        let path = path_guard.clone();
-        drop(path_guard);
-
-        let file = File::open(&path)
-            .map_err(|e| StorageError::WAL(format!("Failed to open WAL file: {}", e)))?;
-        let mut reader = BufReader::new(file);
-
-        loop {
-            // Read the entry length
-            let mut len_buf = [0u8; 8];
-            match reader.read_exact(&mut len_buf) {
-                Ok(_) => {},
-                Err(e) if e.kind() == std::io::ErrorKind::UnexpectedEof => break,
-                Err(e) => return Err(StorageError::from(e)),
-            }
-
-            let entry_len = u64::from_le_bytes(len_buf);
-
-            // Read the entry data
-            let mut entry_data = vec![0u8; entry_len as usize];
-            reader.read_exact(&mut entry_data)?;
-
-            // Deserialize the entry
-            let entry_type: WALEntryType = bincode::deserialize(&entry_data)?;
-
-            // Only replay object updates
-            if let WALEntryType::ObjectUpdate(entry) = entry_type {
-                callback(&entry.object, &entry.proof)?;
-            }
+        // Segments are still decoded in parallel; only the apply step is sequential
+        for entry in self.live_updates()? {
+            callback(&entry.object, &entry.proof)?;
         }
 
         Ok(())
@@ -184,6 +996,8 @@ impl WriteAheadLog for FileWriteAheadLog {
 #[cfg(test)]
 mod tests {
     use super::*;
+    use std::sync::atomic::{AtomicUsize, Ordering};
+    use std::sync::Arc;
     use tempfile::tempdir;
     use units_core_types::id::UnitsObjectId;
     use units_core_types::objects::UnitsObject;
@@ -213,6 +1027,15 @@ mod tests {
         }
     }
 
+    fn count_replayed(wal: &FileWriteAheadLog) -> usize {
+        let mut count = 0;
+        wal.replay(|_, _| {
+            count += 1;
+            Ok(())
+        }).unwrap();
+        count
+    }
+
     #[test]
     fn test_wal_object_updates() {
         let temp_dir = tempdir().unwrap();
@@ -240,4 +1063,383 @@ mod tests {
         assert_eq!(entries[0].0.id(), obj1.id());
         assert_eq!(entries[1].0.id(), obj2.id());
     }
-}
\ No newline at end of file
+
+    #[test]
+    fn test_group_commit_concurrent_writers() {
+        let temp_dir = tempdir().unwrap();
+        let wal_path = temp_dir.path().join("group.wal");
+
+        let wal = Arc::new(FileWriteAheadLog::with_config(WALConfig {
+            sync_policy: SyncPolicy::IntervalMs(2),
+            max_batch_entries: 64,
+            ..WALConfig::default()
+        }));
+        wal.init(&wal_path).unwrap();
+
+        let handles: Vec<_> = (0..4)
+            .map(|_| {
+                let wal = wal.clone();
+                std::thread::spawn(move || {
+                    for _ in 0..25 {
+                        wal.record_update(&create_test_object(), &create_test_proof(), None).unwrap();
+                    }
+                })
+            })
+            .collect();
+        for handle in handles {
+            handle.join().unwrap();
+        }
+
+        assert_eq!(count_replayed(&wal), 100);
+    }
+
+    #[test]
+    fn test_per_slot_updates_wait_for_the_seal() {
+        let temp_dir = tempdir().unwrap();
+        let wal_path = temp_dir.path().join("slot.wal");
+
+        let wal = Arc::new(FileWriteAheadLog::with_config(WALConfig {
+            sync_policy: SyncPolicy::PerSlot,
+            max_batch_entries: 16,
+            ..WALConfig::default()
+        }));
+        wal.init(&wal_path).unwrap();
+
+        // Writers are held until the state proof seals their slot
+        let writers: Vec<_> = (0..2)
+            .map(|_| {
+                let wal = Arc::clone(&wal);
+                thread::spawn(move || wal.record_update(&create_test_object(), &create_test_proof(), None))
+            })
+            .collect();
+        thread::sleep(Duration::from_millis(50));
+        assert!(writers.iter().all(|writer| !writer.is_finished()));
+
+        wal.record_state_proof(&StateProof {
+            slot: 1234,
+            prev_state_proof_hash: None,
+            object_ids: Vec::new(),
+            proof_data: Vec::new(),
+        }).unwrap();
+        for writer in writers {
+            writer.join().unwrap().unwrap();
+        }
+        assert_eq!(count_replayed(&wal), 2);
+    }
+
+    #[test]
+    fn test_queued_entries_keep_queue_order() {
+        let temp_dir = tempdir().unwrap();
+        let wal = FileWriteAheadLog::new();
+        wal.init(temp_dir.path()).unwrap();
+
+        let objects: Vec<UnitsObject> = (0..3u8)
+            .map(|seed| UnitsObject::new_data(UnitsObjectId::new([seed; 32]), UnitsObjectId::new([0; 32]), vec![seed]))
+            .collect();
+        let pending: Vec<PendingAppend> = objects
+            .iter()
+            .map(|object| wal.queue_update(object, &create_test_proof(), None).unwrap())
+            .collect();
+        for append in pending.into_iter().rev() {
+            append.wait().unwrap();
+        }
+
+        let mut replayed = Vec::new();
+        wal.replay(|object, _| {
+            replayed.push(object.clone());
+            Ok(())
+        }).unwrap();
+        assert_eq!(replayed, objects);
+    }
+
+    #[test]
+    fn test_legacy_single_file_is_migrated() {
+        let temp_dir = tempdir().unwrap();
+        let wal_path = temp_dir.path().join("legacy.wal");
+
+        // Two records in the old `[u64 length][payload]` layout, plus a torn third
+        let mut legacy = Vec::new();
+        for _ in 0..2 {
+            let proof = create_test_proof();
+            let payload = bincode::serialize(&WALEntryType::ObjectUpdate(WALEntry {
+                object: create_test_object(),
+                slot: proof.slot,
+                proof,
+                timestamp: 0,
+                transaction_hash: None,
+            })).unwrap();
+            legacy.extend_from_slice(&(payload.len() as u64).to_le_bytes());
+            legacy.extend_from_slice(&payload);
+        }
+        legacy.extend_from_slice(&64u64.to_le_bytes());
+        legacy.extend_from_slice(&[0u8; 10]);
+        fs::write(&wal_path, &legacy).unwrap();
+
+        let wal = FileWriteAheadLog::new();
+        wal.init(&wal_path).unwrap();
+        assert!(wal_path.is_dir());
+        assert!(!legacy_path(&wal_path).exists());
+        assert_eq!(count_replayed(&wal), 2);
+
+        wal.record_update(&create_test_object(), &create_test_proof(), None).unwrap();
+        assert_eq!(count_replayed(&wal), 3);
+    }
+
+    #[test]
+    fn test_uninitialized_wal_rejects_writes() {
+        let wal = FileWriteAheadLog::new();
+        assert!(wal.record_update(&create_test_object(), &create_test_proof(), None).is_err());
+    }
+
+    #[test]
+    fn test_rotation_and_checkpoint_skip() {
+        let temp_dir = tempdir().unwrap();
+        let wal_path = temp_dir.path().join("segments");
+
+        let wal = FileWriteAheadLog::with_config(WALConfig {
+            segment_size: 256,
+            ..WALConfig::default()
+        });
+        wal.init(&wal_path).unwrap();
+
+        for _ in 0..10 {
+            wal.record_update(&create_test_object(), &create_test_proof(), None).unwrap();
+        }
+        assert!(list_segments(&wal_path).unwrap().len() > 1);
+        assert_eq!(count_replayed(&wal), 10);
+
+        wal.checkpoint(1234).unwrap();
+        assert_eq!(wal.checkpoint_slot().unwrap(), Some(1234));
+        assert_eq!(list_segments(&wal_path).unwrap().len(), 1);
+
+        for _ in 0..3 {
+            wal.record_update(&create_test_object(), &create_test_proof(), None).unwrap();
+        }
+        assert_eq!(count_replayed(&wal), 3);
+    }
+
+    #[test]
+    fn test_checkpoint_keeps_updates_for_later_slots() {
+        let temp_dir = tempdir().unwrap();
+        let config = WALConfig { segment_size: 256, ..WALConfig::default() };
+        let wal = FileWriteAheadLog::with_config(config.clone());
+        wal.init(temp_dir.path()).unwrap();
+
+        // The next slot starts writing before slot 10 is checkpointed
+        for slot in [10u64, 11, 10, 11, 11, 10] {
+            let mut proof = create_test_proof();
+            proof.slot = slot;
+            wal.record_update(&create_test_object(), &proof, None).unwrap();
+        }
+        wal.checkpoint(10).unwrap();
+        wal.record_update(&create_test_object(), &create_test_proof(), None).unwrap();
+
+        let mut slots = Vec::new();
+        wal.replay(|_, proof| {
+            slots.push(proof.slot);
+            Ok(())
+        }).unwrap();
+        assert_eq!(slots, vec![11, 11, 11, 1234]);
+
+        // The surviving updates outlive a restart
+        drop(wal);
+        let wal = FileWriteAheadLog::with_config(config);
+        wal.init(temp_dir.path()).unwrap();
+        assert_eq!(count_replayed(&wal), 4);
+
+        // Once slot 11 is covered too, only the post-checkpoint update and the active segment remain
+        wal.checkpoint(11).unwrap();
+        assert_eq!(count_replayed(&wal), 1);
+        wal.checkpoint(1234).unwrap();
+        assert_eq!(count_replayed(&wal), 0);
+        assert_eq!(list_segments(temp_dir.path()).unwrap().len(), 1);
+    }
+
+    #[test]
+    fn test_sync_observer_sees_every_fsync_across_rotations() {
+        let temp_dir = tempdir().unwrap();
+        let syncs = Arc::new(AtomicUsize::new(0));
+
+        let observed = syncs.clone();
+        let wal = FileWriteAheadLog::with_config(WALConfig {
+            sync_policy: SyncPolicy::PerEntry,
+            segment_size: 256,
+            ..WALConfig::default()
+        })
+        .with_sync_observer(Arc::new(move |_| {
+            observed.fetch_add(1, Ordering::Relaxed);
+        }));
+        wal.init(temp_dir.path()).unwrap();
+
+        for _ in 0..10 {
+            wal.record_update(&create_test_object(), &create_test_proof(), None).unwrap();
+        }
+        assert!(list_segments(temp_dir.path()).unwrap().len() > 1);
+        assert_eq!(syncs.load(Ordering::Relaxed), 10);
+    }
+
+    #[test]
+    fn test_failed_write_is_cut_back_before_next_append() {
+        let temp_dir = tempdir().unwrap();
+        let frame = frame_record(&WALEntryTypeRef::Checkpoint(7)).unwrap();
+        let mut segment = SegmentWriter::open(temp_dir.path(), 0, 1 << 20, BTreeMap::new()).unwrap();
+        segment.write_durable(&frame).unwrap();
+
+        // Half a frame reached the file before the write failed
+        segment.file.write_all(&frame[..frame.len() / 2]).unwrap();
+        segment.discard_unsynced();
+        segment.write_durable(&frame).unwrap();
+
+        let bytes = fs::read(segment_path(temp_dir.path(), 0)).unwrap();
+        assert_eq!(bytes.len() as u64, segment.len);
+        assert_eq!(valid_prefix_len(&bytes), bytes.len());
+        decode_segment(&segment_path(temp_dir.path(), 0), false).unwrap();
+    }
+
+    #[test]
+    fn test_torn_tail_is_ignored_and_truncated() {
+        let temp_dir = tempdir().unwrap();
+        let wal_path = temp_dir.path().join("torn");
+
+        {
+            let wal = FileWriteAheadLog::new();
+            wal.init(&wal_path).unwrap();
+            wal.record_update(&create_test_object(), &create_test_proof(), None).unwrap();
+        }
+
+        // Simulate a crash in the middle of writing a record
+        let last = *list_segments(&wal_path).unwrap().last().unwrap();
+        let mut file = OpenOptions::new().append(true).open(segment_path(&wal_path, last)).unwrap();
+        file.write_all(&[64, 0, 0, 0, 1, 2, 3, 4, 5]).unwrap();
+        drop(file);
+
+        let wal = FileWriteAheadLog::new();
+        wal.init(&wal_path).unwrap();
+        wal.record_update(&create_test_object(), &create_test_proof(), None).unwrap();
+        assert_eq!(count_replayed(&wal), 2);
+    }
+
+    #[test]
+    fn test_corrupt_sealed_segment_is_an_error() {
+        let temp_dir = tempdir().unwrap();
+        let wal_path = temp_dir.path().join("corrupt");
+
+        let wal = FileWriteAheadLog::with_config(WALConfig {
+            segment_size: 128,
+            ..WALConfig::default()
+        });
+        wal.init(&wal_path).unwrap();
+        for _ in 0..4 {
+            wal.record_update(&create_test_object(), &create_test_proof(), None).unwrap();
+        }
+
+        // Flip a payload byte in the oldest segment
+        let first = list_segments(&wal_path).unwrap()[0];
+        let path = segment_path(&wal_path, first);
+        let mut bytes = fs::read(&path).unwrap();
+        bytes[RECORD_HEADER_LEN] ^= 0xff;
+        fs::write(&path, bytes).unwrap();
+
+        assert!(wal.replay(|_, _| Ok(())).is_err());
+    }
+
+    #[test]
+    fn test_replay_parallel_preserves_per_object_order() {
+        let temp_dir = tempdir().unwrap();
+        let wal_path = temp_dir.path().join("parallel");
+
+        let wal = FileWriteAheadLog::with_config(WALConfig {
+            segment_size: 512,
+            ..WALConfig::default()
+        });
+        wal.init(&wal_path).unwrap();
+
+        let object = create_test_object();
+        for slot in 0..20u64 {
+            let mut proof = create_test_proof();
+            proof.slot = slot;
+            wal.record_update(&object, &proof, None).unwrap();
+            wal.record_update(&create_test_object(), &create_test_proof(), None).unwrap();
+        }
+
+        let total = AtomicUsize::new(0);
+        let last_slot = Mutex::new(None);
+        wal.replay_parallel(8, None, |record| {
+            let WALEntryType::ObjectUpdate(entry) = record else {
+                unreachable!("only updates were logged");
+            };
+            total.fetch_add(1, Ordering::SeqCst);
+            if entry.object.id() == object.id() {
+                let mut last = last_slot.lock().unwrap();
+                assert!(last.map_or(true, |prev| prev < entry.proof.slot));
+                *last = Some(entry.proof.slot);
+            }
+            Ok(())
+        }).unwrap();
+
+        assert_eq!(total.load(Ordering::SeqCst), 40);
+        assert_eq!(*last_slot.lock().unwrap(), Some(19));
+    }
+
+    #[test]
+    fn test_replay_parallel_after_skips_snapshotted_slots() {
+        let temp_dir = tempdir().unwrap();
+        let wal = FileWriteAheadLog::new();
+        wal.init(&temp_dir.path().join("after.wal")).unwrap();
+
+        for slot in [5u64, 10, 10, 15, 20] {
+            let mut proof = create_test_proof();
+            proof.slot = slot;
+            wal.record_update(&create_test_object(), &proof, None).unwrap();
+        }
+
+        let replayed = Mutex::new(Vec::new());
+        wal.replay_parallel(1, Some(10), |record| {
+            replayed.lock().unwrap().push(record.slot());
+            Ok(())
+        }).unwrap();
+        assert_eq!(replayed.into_inner().unwrap(), vec![15, 20]);
+    }
+
+    #[test]
+    fn test_replay_parallel_reports_deletes_and_state_proofs() {
+        let temp_dir = tempdir().unwrap();
+        let wal = FileWriteAheadLog::new();
+        wal.init(temp_dir.path()).unwrap();
+
+        let object = create_test_object();
+        let proof = create_test_proof();
+        wal.record_update(&object, &proof, None).unwrap();
+        wal.record_delete(&object, &proof, None).unwrap();
+        wal.record_state_proof(&StateProof {
+            slot: 1234,
+            prev_state_proof_hash: None,
+            object_ids: vec![*object.id()],
+            proof_data: Vec::new(),
+        }).unwrap();
+
+        // Deletions are not object updates
+        assert_eq!(count_replayed(&wal), 1);
+
+        // Changes to the object keep their order; the state proof is applied alongside
+        let (changes, state_proofs) = (Mutex::new(Vec::new()), Mutex::new(Vec::new()));
+        wal.replay_parallel(4, None, |record| {
+            match record {
+                WALEntryType::ObjectUpdate(entry) => changes.lock().unwrap().push(("update", *entry.object.id())),
+                WALEntryType::ObjectDelete(entry) => changes.lock().unwrap().push(("delete", *entry.object.id())),
+                WALEntryType::StateProof(proof) => state_proofs.lock().unwrap().push(proof.object_ids[0]),
+                WALEntryType::Checkpoint(_) => unreachable!("checkpoints are not replayed"),
+            }
+            Ok(())
+        }).unwrap();
+        assert_eq!(changes.into_inner().unwrap(), vec![("update", *object.id()), ("delete", *object.id())]);
+        assert_eq!(state_proofs.into_inner().unwrap(), vec![*object.id()]);
+
+        let after = AtomicUsize::new(0);
+        wal.replay_parallel(4, Some(1234), |_| {
+            after.fetch_add(1, Ordering::SeqCst);
+            Ok(())
+        }).unwrap();
+        assert_eq!(after.into_inner(), 0);
+    }
+}
@@ -0,0 +1,94 @@
+//! Transaction submission throughput
+//!
+//! `json_rpc` drives `submitTransaction` end to end through a local HTTP
+//! JSON-RPC server into the service's transaction pool; `transaction_pool`
+//! submits straight to a `TransactionService` to isolate validation and
+//! pool intake. Slots are not advanced, so the pool only fills. Run with
+//! `cargo bench -p units-core-service`.
+
+use std::net::SocketAddr;
+use std::sync::Arc;
+
+use criterion::{criterion_group, criterion_main, Criterion, Throughput};
+use jsonrpsee::core::client::ClientT;
+use jsonrpsee::http_client::HttpClientBuilder;
+use jsonrpsee::rpc_params;
+use units_core_service::json_rpc::JsonRpcServerImpl;
+use units_core_service::services::TransactionService;
+use units_core_service::{Config, UnitsService};
+use units_core_types::id::UnitsObjectId;
+use units_core_types::transaction::{Instruction, Transaction};
+use units_core_types::Runtime;
+use units_runtime_impl::MockRuntime;
+use units_storage_impl::ConsolidatedUnitsStorage;
+
+/// Distinct transactions cycled through by each benchmark
+const DISTINCT_TRANSACTIONS: u64 = 10_000;
+
+fn transaction(index: u64) -> Transaction {
+    let mut hash = [0u8; 32];
+    hash[..8].copy_from_slice(&index.to_le_bytes());
+    let instruction = Instruction::new(
+        UnitsObjectId::new([0u8; 32]),
+        "transfer_token".to_string(),
+        vec![UnitsObjectId::new([1u8; 32]), UnitsObjectId::new([2u8; 32])],
+        100u64.to_le_bytes().to_vec(),
+    );
+    Transaction::new(vec![instruction], hash)
+}
+
+fn runtime() -> tokio::runtime::Runtime {
+    tokio::runtime::Builder::new_multi_thread().enable_all().build().unwrap()
+}
+
+fn bench_json_rpc(c: &mut Criterion) {
+    let runtime = runtime();
+    let addr: SocketAddr = {
+        // Borrow a free port for the server
+        let probe = std::net::TcpListener::bind("127.0.0.1:0").unwrap();
+        probe.local_addr().unwrap()
+    };
+    let client = runtime.block_on(async {
+        let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+        let mut config = Config::default();
+        config.server.transaction_pool_size = DISTINCT_TRANSACTIONS as usize * 2;
+        let service = UnitsService::new(storage, Arc::new(MockRuntime::new()), config);
+        let server = JsonRpcServerImpl::new(service).start(addr).await.unwrap();
+        tokio::spawn(server);
+        HttpClientBuilder::default().build(format!("http://{}", addr)).unwrap()
+    });
+
+    let mut group = c.benchmark_group("submit_transaction");
+    group.throughput(Throughput::Elements(1));
+    let mut next = 0u64;
+    group.bench_function("json_rpc", |b| {
+        b.to_async(&runtime).iter(|| {
+            next = (next + 1) % DISTINCT_TRANSACTIONS;
+            let (client, transaction) = (&client, transaction(next));
+            async move { client.request::<String, _>("submitTransaction", rpc_params![transaction]).await.unwrap() }
+        })
+    });
+    group.finish();
+}
+
+fn bench_transaction_pool(c: &mut Criterion) {
+    let runtime = runtime();
+    let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+    let vm: Arc<dyn Runtime + Send + Sync> = Arc::new(MockRuntime::new());
+    let service = TransactionService::new(vm, storage, DISTINCT_TRANSACTIONS as usize * 2);
+
+    let mut group = c.benchmark_group("submit_transaction");
+    group.throughput(Throughput::Elements(1));
+    let mut next = 0u64;
+    group.bench_function("transaction_pool", |b| {
+        b.to_async(&runtime).iter(|| {
+            next = (next + 1) % DISTINCT_TRANSACTIONS;
+            let (service, transaction) = (&service, transaction(next));
+            async move { service.submit_transaction(transaction).await.unwrap() }
+        })
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_json_rpc, bench_transaction_pool);
+criterion_main!(benches);
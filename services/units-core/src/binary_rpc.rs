@@ -0,0 +1,225 @@
+//! Length-prefixed bincode transport
+//!
+//! A compact alternative to JSON-RPC for high-volume clients such as bulk
+//! ingest. Each connection carries a sequence of frames, each
+//! `[u32 LE payload length][bincode payload]`. The client sends one
+//! `BinaryRequest` per frame and gets one `BinaryResponse` frame back for it,
+//! in order, so requests can be pipelined without waiting for each reply.
+//! Ids and hashes travel as raw bytes rather than hex strings.
+
+use anyhow::Result;
+use serde::{Deserialize, Serialize};
+use std::net::SocketAddr;
+use tokio::io::{AsyncReadExt, AsyncWriteExt, BufReader, BufWriter};
+use tokio::net::{TcpListener, TcpStream};
+
+use units_core_types::id::UnitsObjectId;
+use units_core_types::objects::UnitsObject;
+use units_core_types::transaction::{Transaction, TransactionHash};
+use units_core_types::SlotNumber;
+
+use crate::service::UnitsService;
+
+/// Largest frame accepted in either direction (16MB)
+pub const MAX_FRAME_LEN: usize = 16 * 1024 * 1024;
+
+/// Request carried in one frame
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub enum BinaryRequest {
+    SubmitTransactions(Vec<Transaction>),
+    GetObjects(Vec<UnitsObjectId>),
+    GetCurrentSlot,
+}
+
+/// Response to the request in the matching frame
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub enum BinaryResponse {
+    TransactionHashes(Vec<TransactionHash>),
+    Objects(Vec<Option<UnitsObject>>),
+    CurrentSlot(SlotNumber),
+    Error(String),
+}
+
+/// Binary transport server
+#[derive(Clone)]
+pub struct BinaryRpcServer {
+    service: UnitsService,
+}
+
+impl BinaryRpcServer {
+    pub fn new(service: UnitsService) -> Self {
+        Self { service }
+    }
+
+    /// Bind `addr` and return a future serving connections until dropped
+    pub async fn start(&self, addr: SocketAddr) -> Result<impl std::future::Future<Output = ()>> {
+        let listener = TcpListener::bind(addr).await?;
+        let server = self.clone();
+
+        Ok(async move {
+            loop {
+                match listener.accept().await {
+                    Ok((stream, peer)) => {
+                        let server = server.clone();
+                        tokio::spawn(async move {
+                            if let Err(e) = server.serve(stream).await {
+                                log::debug!("Binary RPC connection from {} closed: {}", peer, e);
+                            }
+                        });
+                    }
+                    Err(e) => log::warn!("Binary RPC accept failed: {}", e),
+                }
+            }
+        })
+    }
+
+    /// Answer frames on one connection until the client hangs up
+    async fn serve(&self, stream: TcpStream) -> Result<()> {
+        let (reader, writer) = stream.into_split();
+        let (mut reader, mut writer) = (BufReader::new(reader), BufWriter::new(writer));
+
+        while let Some(payload) = read_frame(&mut reader).await? {
+            let response = match bincode::deserialize::<BinaryRequest>(&payload) {
+                Ok(request) => self.handle(request).await,
+                Err(e) => BinaryResponse::Error(format!("Malformed request: {}", e)),
+            };
+            let mut encoded = bincode::serialize(&response)?;
+            if encoded.len() > MAX_FRAME_LEN {
+                let error = BinaryResponse::Error("Response exceeds the frame size limit".to_string());
+                encoded = bincode::serialize(&error)?;
+            }
+            write_frame(&mut writer, &encoded).await?;
+
+            // Flush once the client has no more pipelined requests buffered
+            if reader.buffer().is_empty() {
+                writer.flush().await?;
+            }
+        }
+        writer.flush().await?;
+        Ok(())
+    }
+
+    async fn handle(&self, request: BinaryRequest) -> BinaryResponse {
+        let response = match request {
+            BinaryRequest::SubmitTransactions(transactions) => self
+                .service
+                .submit_transactions(transactions)
+                .await
+                .map(BinaryResponse::TransactionHashes),
+            BinaryRequest::GetObjects(ids) => self.service.get_objects(&ids).await.map(BinaryResponse::Objects),
+            BinaryRequest::GetCurrentSlot => self.service.get_current_slot().await.map(BinaryResponse::CurrentSlot),
+        };
+        response.unwrap_or_else(|e| BinaryResponse::Error(e.to_string()))
+    }
+}
+
+/// Read one frame's payload, or `None` if the stream ended between frames
+pub async fn read_frame<R: AsyncReadExt + Unpin>(reader: &mut R) -> Result<Option<Vec<u8>>> {
+    let mut header = [0u8; 4];
+    match reader.read_exact(&mut header).await {
+        Ok(_) => {}
+        Err(e) if e.kind() == std::io::ErrorKind::UnexpectedEof => return Ok(None),
+        Err(e) => return Err(e.into()),
+    }
+
+    let len = u32::from_le_bytes(header) as usize;
+    if len > MAX_FRAME_LEN {
+        anyhow::bail!("Frame of {} bytes exceeds the {} byte limit", len, MAX_FRAME_LEN);
+    }
+    let mut payload = vec![0u8; len];
+    reader.read_exact(&mut payload).await?;
+    Ok(Some(payload))
+}
+
+/// Write `payload` as one frame
+pub async fn write_frame<W: AsyncWriteExt + Unpin>(writer: &mut W, payload: &[u8]) -> Result<()> {
+    if payload.len() > MAX_FRAME_LEN {
+        anyhow::bail!("Frame of {} bytes exceeds the {} byte limit", payload.len(), MAX_FRAME_LEN);
+    }
+    writer.write_all(&(payload.len() as u32).to_le_bytes()).await?;
+    writer.write_all(payload).await?;
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::Arc;
+    use units_core_types::transaction::Instruction;
+    use units_runtime_impl::MockRuntime;
+    use units_storage_impl::ConsolidatedUnitsStorage;
+
+    use crate::config::Config;
+
+    /// A connection to a fresh server
+    async fn connect() -> TcpStream {
+        let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+        let service = UnitsService::new(storage, Arc::new(MockRuntime::new()), Config::default());
+        let addr = {
+            // Borrow a free port for the server
+            let probe = std::net::TcpListener::bind("127.0.0.1:0").unwrap();
+            probe.local_addr().unwrap()
+        };
+        tokio::spawn(BinaryRpcServer::new(service).start(addr).await.unwrap());
+        TcpStream::connect(addr).await.unwrap()
+    }
+
+    async fn send(stream: &mut TcpStream, request: &BinaryRequest) {
+        write_frame(stream, &bincode::serialize(request).unwrap()).await.unwrap();
+    }
+
+    async fn receive(stream: &mut TcpStream) -> BinaryResponse {
+        let payload = read_frame(stream).await.unwrap().expect("server hung up");
+        bincode::deserialize(&payload).unwrap()
+    }
+
+    #[tokio::test]
+    async fn test_frames_round_trip() {
+        let mut buffer = Vec::new();
+        write_frame(&mut buffer, b"first").await.unwrap();
+        write_frame(&mut buffer, b"").await.unwrap();
+
+        let mut reader = &buffer[..];
+        assert_eq!(read_frame(&mut reader).await.unwrap(), Some(b"first".to_vec()));
+        assert_eq!(read_frame(&mut reader).await.unwrap(), Some(Vec::new()));
+        assert_eq!(read_frame(&mut reader).await.unwrap(), None);
+    }
+
+    #[tokio::test]
+    async fn test_oversized_frames_are_refused() {
+        assert!(write_frame(&mut Vec::new(), &vec![0u8; MAX_FRAME_LEN + 1]).await.is_err());
+        let header = (MAX_FRAME_LEN as u32 + 1).to_le_bytes();
+        assert!(read_frame(&mut &header[..]).await.is_err());
+
+        // The server hangs up on a client announcing one
+        let mut stream = connect().await;
+        stream.write_all(&header).await.unwrap();
+        assert_eq!(read_frame(&mut stream).await.unwrap(), None);
+    }
+
+    #[tokio::test]
+    async fn test_pipelined_requests_are_answered_in_order() {
+        let mut stream = connect().await;
+        let target = UnitsObjectId::new([2u8; 32]);
+        let instruction = Instruction::new(UnitsObjectId::new([1u8; 32]), "transfer".to_string(), vec![target], vec![1]);
+        let transaction = Transaction::new(vec![instruction], [9u8; 32]);
+
+        send(&mut stream, &BinaryRequest::SubmitTransactions(vec![transaction])).await;
+        send(&mut stream, &BinaryRequest::GetObjects(vec![target])).await;
+        send(&mut stream, &BinaryRequest::GetCurrentSlot).await;
+
+        assert!(matches!(receive(&mut stream).await, BinaryResponse::TransactionHashes(hashes) if hashes == vec![[9u8; 32]]));
+        assert!(matches!(receive(&mut stream).await, BinaryResponse::Objects(objects) if objects == vec![None]));
+        assert!(matches!(receive(&mut stream).await, BinaryResponse::CurrentSlot(0)));
+    }
+
+    #[tokio::test]
+    async fn test_malformed_request_keeps_the_connection() {
+        let mut stream = connect().await;
+        write_frame(&mut stream, &[0xff, 0xff]).await.unwrap();
+        assert!(matches!(receive(&mut stream).await, BinaryResponse::Error(_)));
+
+        send(&mut stream, &BinaryRequest::GetCurrentSlot).await;
+        assert!(matches!(receive(&mut stream).await, BinaryResponse::CurrentSlot(0)));
+    }
+}
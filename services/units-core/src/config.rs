@@ -1,6 +1,7 @@
 use anyhow::Result;
 use serde::{Deserialize, Serialize};
 use std::path::Path;
+use units_storage_impl::{SyncPolicy, WALConfig};
 
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct Config {
@@ -17,6 +18,47 @@ pub struct StorageConfig {
     pub data_dir: Option<String>,
     /// Maximum object size in bytes
     pub max_object_size: usize,
+    /// Segment size in bytes for file-based storage
+    #[serde(default = "default_segment_size_bytes")]
+    pub segment_size_bytes: u64,
+    /// Object versions per full history keyframe for in-memory storage
+    #[serde(default = "default_history_keyframe_interval")]
+    pub history_keyframe_interval: usize,
+    /// When file storage makes its appends durable
+    #[serde(default = "default_file_sync_policy")]
+    pub file_sync_policy: SyncPolicy,
+    /// Write-ahead log directory for memory storage; unset keeps it volatile
+    #[serde(default)]
+    pub wal_dir: Option<String>,
+    /// Sync policy, batching and segment size of the write-ahead log
+    #[serde(default)]
+    pub wal: WALConfig,
+    /// Directory of the snapshots the write-ahead log is checkpointed behind; needs `wal_dir`
+    #[serde(default)]
+    pub snapshot_dir: Option<String>,
+    /// Finalized slots between write-ahead log checkpoints
+    #[serde(default = "default_checkpoint_interval_slots")]
+    pub checkpoint_interval_slots: u64,
+}
+
+fn default_segment_size_bytes() -> u64 {
+    units_storage_impl::log_store::DEFAULT_SEGMENT_SIZE
+}
+
+fn default_file_sync_policy() -> SyncPolicy {
+    SyncPolicy::PerSlot
+}
+
+fn default_transaction_pool_size() -> usize {
+    1000
+}
+
+fn default_history_keyframe_interval() -> usize {
+    units_storage_impl::delta_history::DEFAULT_KEYFRAME_INTERVAL
+}
+
+fn default_checkpoint_interval_slots() -> u64 {
+    units_storage_impl::snapshot::DEFAULT_CHECKPOINT_INTERVAL
 }
 
 #[derive(Debug, Clone, Serialize, Deserialize)]
@@ -33,6 +75,9 @@ pub struct RuntimeConfig {
 pub struct ServerConfig {
     /// Maximum concurrent connections
     pub max_connections: u32,
+    /// Pending transactions the pool holds before rejecting submissions
+    #[serde(default = "default_transaction_pool_size")]
+    pub transaction_pool_size: usize,
     /// Request timeout in seconds
     pub request_timeout_secs: u64,
     /// Enable CORS for web clients
@@ -46,6 +91,13 @@ impl Default for Config {
                 storage_type: "memory".to_string(),
                 data_dir: None,
                 max_object_size: 10 * 1024 * 1024, // 10MB
+                segment_size_bytes: default_segment_size_bytes(),
+                history_keyframe_interval: default_history_keyframe_interval(),
+                file_sync_policy: default_file_sync_policy(),
+                wal_dir: None,
+                wal: WALConfig::default(),
+                snapshot_dir: None,
+                checkpoint_interval_slots: default_checkpoint_interval_slots(),
             },
             runtime: RuntimeConfig {
                 max_execution_time_ms: 5000, // 5 seconds
@@ -54,6 +106,7 @@ impl Default for Config {
             },
             server: ServerConfig {
                 max_connections: 1000,
+                transaction_pool_size: default_transaction_pool_size(),
                 request_timeout_secs: 30,
                 enable_cors: true,
             },
@@ -1,10 +1,12 @@
 use anyhow::Result;
-use jsonrpsee::core::async_trait;
+use jsonrpsee::core::{async_trait, SubscriptionResult};
 use jsonrpsee::proc_macros::rpc;
 use jsonrpsee::server::ServerBuilder;
 use jsonrpsee::types::error::{ErrorCode, ErrorObject};
+use jsonrpsee::{PendingSubscriptionSink, SubscriptionMessage, SubscriptionSink};
 use serde::{Deserialize, Serialize};
 use std::net::SocketAddr;
+use tokio::sync::broadcast::{self, error::RecvError};
 
 use units_core_types::id::UnitsObjectId;
 use units_core_types::objects::UnitsObject;
@@ -12,6 +14,7 @@ use units_core_types::transaction::{Transaction, TransactionReceipt};
 
 use crate::error::ServiceError;
 use crate::service::{UnitsService, HealthStatus};
+use crate::services::slot_service::SlotEvent;
 
 /// JSON-RPC API trait definition
 #[rpc(server)]
@@ -20,10 +23,25 @@ pub trait UnitsJsonRpcApi {
     #[method(name = "getObject")]
     async fn get_object(&self, object_id: String) -> Result<UnitsObject, ErrorObject<'static>>;
 
+    /// Get several objects by ID; missing objects are returned as null
+    #[method(name = "getObjects")]
+    async fn get_objects(&self, object_ids: Vec<String>) -> Result<Vec<Option<UnitsObject>>, ErrorObject<'static>>;
+
+    /// List objects in id order, one page at a time
+    ///
+    /// `cursor` is the hex `nextCursor` of the previous page; omit it to
+    /// start from the first object.
+    #[method(name = "listObjects")]
+    async fn list_objects(&self, cursor: Option<String>, limit: Option<usize>) -> Result<ObjectListPage, ErrorObject<'static>>;
+
     /// Submit transaction
     #[method(name = "submitTransaction")]
     async fn submit_transaction(&self, transaction: Transaction) -> Result<String, ErrorObject<'static>>;
 
+    /// Submit several transactions, returning their hashes in request order
+    #[method(name = "submitTransactions")]
+    async fn submit_transactions(&self, transactions: Vec<Transaction>) -> Result<Vec<String>, ErrorObject<'static>>;
+
     /// Get transaction by hash
     #[method(name = "getTransaction")]
     async fn get_transaction(&self, tx_hash: String) -> Result<Transaction, ErrorObject<'static>>;
@@ -43,6 +61,31 @@ pub trait UnitsJsonRpcApi {
     /// Get version
     #[method(name = "version")]
     async fn version(&self) -> Result<VersionInfo, ErrorObject<'static>>;
+
+    /// Stream slot events as they happen (WebSocket only)
+    #[subscription(name = "subscribeSlots", unsubscribe = "unsubscribeSlots", item = SlotEvent)]
+    async fn subscribe_slots(&self) -> SubscriptionResult;
+
+    /// Stream an object's state: once on subscribing, then whenever it
+    /// changes across a slot event; null while it does not exist
+    #[subscription(name = "subscribeObject", unsubscribe = "unsubscribeObject", item = Option<UnitsObject>)]
+    async fn subscribe_object(&self, object_id: String) -> SubscriptionResult;
+
+    /// Stream the receipts of each slot once its transactions have executed
+    #[subscription(name = "subscribeReceipts", unsubscribe = "unsubscribeReceipts", item = TransactionReceipt)]
+    async fn subscribe_receipts(&self) -> SubscriptionResult;
+}
+
+/// Default page size for `listObjects`
+pub const DEFAULT_LIST_LIMIT: usize = 100;
+
+/// One page of `listObjects`
+#[derive(Serialize, Deserialize, Debug, Clone)]
+#[serde(rename_all = "camelCase")]
+pub struct ObjectListPage {
+    pub objects: Vec<UnitsObject>,
+    /// Hex cursor for the next page, absent on the last page
+    pub next_cursor: Option<String>,
 }
 
 #[derive(Serialize, Deserialize, Debug, Clone)]
@@ -101,6 +144,28 @@ impl JsonRpcServerImpl {
         Ok(array)
     }
 
+    /// Next slot event for `sink`, or `None` once the subscriber or the feed is gone
+    ///
+    /// A subscriber that falls behind skips the events it missed rather than
+    /// holding up the feed.
+    async fn next_slot_event(
+        sink: &SubscriptionSink,
+        events: &mut broadcast::Receiver<SlotEvent>,
+    ) -> Option<SlotEvent> {
+        loop {
+            tokio::select! {
+                _ = sink.closed() => return None,
+                event = events.recv() => match event {
+                    Ok(event) => return Some(event),
+                    Err(RecvError::Lagged(skipped)) => {
+                        log::warn!("Subscription {:?} skipped {} slot events", sink.subscription_id(), skipped);
+                    }
+                    Err(RecvError::Closed) => return None,
+                },
+            }
+        }
+    }
+
     fn map_service_error(err: ServiceError) -> ErrorObject<'static> {
         match err {
             ServiceError::ObjectNotFound { object_id } => {
@@ -145,6 +210,30 @@ impl UnitsJsonRpcApiServer for JsonRpcServerImpl {
             .map_err(Self::map_service_error)
     }
 
+    async fn get_objects(&self, object_ids: Vec<String>) -> Result<Vec<Option<UnitsObject>>, ErrorObject<'static>> {
+        let parsed_ids = object_ids
+            .iter()
+            .map(|id| Self::parse_object_id(id))
+            .collect::<Result<Vec<_>, _>>()?;
+        self.service
+            .get_objects(&parsed_ids)
+            .await
+            .map_err(Self::map_service_error)
+    }
+
+    async fn list_objects(&self, cursor: Option<String>, limit: Option<usize>) -> Result<ObjectListPage, ErrorObject<'static>> {
+        let cursor = cursor.as_deref().map(Self::parse_object_id).transpose()?;
+        let page = self.service
+            .list_objects(cursor.as_ref(), limit.unwrap_or(DEFAULT_LIST_LIMIT))
+            .await
+            .map_err(Self::map_service_error)?;
+
+        Ok(ObjectListPage {
+            objects: page.objects,
+            next_cursor: page.next_cursor.map(|id| hex::encode(id.bytes())),
+        })
+    }
+
     async fn submit_transaction(&self, transaction: Transaction) -> Result<String, ErrorObject<'static>> {
         let tx_hash = self.service
             .submit_transaction(transaction)
@@ -154,6 +243,15 @@ impl UnitsJsonRpcApiServer for JsonRpcServerImpl {
         Ok(hex::encode(tx_hash))
     }
 
+    async fn submit_transactions(&self, transactions: Vec<Transaction>) -> Result<Vec<String>, ErrorObject<'static>> {
+        let tx_hashes = self.service
+            .submit_transactions(transactions)
+            .await
+            .map_err(Self::map_service_error)?;
+
+        Ok(tx_hashes.iter().map(hex::encode).collect())
+    }
+
     async fn get_transaction(&self, tx_hash: String) -> Result<Transaction, ErrorObject<'static>> {
         let parsed_hash = Self::parse_tx_hash(&tx_hash)?;
         self.service
@@ -191,4 +289,154 @@ impl UnitsJsonRpcApiServer for JsonRpcServerImpl {
             build_time: env!("BUILD_TIME").to_string(),
         })
     }
-}
\ No newline at end of file
+
+    async fn subscribe_slots(&self, pending: PendingSubscriptionSink) -> SubscriptionResult {
+        let mut events = self.service.subscribe_slot_events();
+        let sink = pending.accept().await?;
+        while let Some(event) = Self::next_slot_event(&sink, &mut events).await {
+            sink.send(SubscriptionMessage::from_json(&event)?).await?;
+        }
+        Ok(())
+    }
+
+    async fn subscribe_object(&self, pending: PendingSubscriptionSink, object_id: String) -> SubscriptionResult {
+        let parsed_id = match Self::parse_object_id(&object_id) {
+            Ok(id) => id,
+            Err(e) => {
+                pending.reject(e).await;
+                return Ok(());
+            }
+        };
+        let mut events = self.service.subscribe_slot_events();
+        let sink = pending.accept().await?;
+
+        let mut last = self.service.get_objects(&[parsed_id]).await?.pop().flatten();
+        sink.send(SubscriptionMessage::from_json(&last)?).await?;
+        while let Some(event) = Self::next_slot_event(&sink, &mut events).await {
+            if !matches!(event, SlotEvent::SlotStarted { .. } | SlotEvent::SlotExecuted { .. }) {
+                continue;
+            }
+            let current = self.service.get_objects(&[parsed_id]).await?.pop().flatten();
+            if current != last {
+                sink.send(SubscriptionMessage::from_json(&current)?).await?;
+                last = current;
+            }
+        }
+        Ok(())
+    }
+
+    async fn subscribe_receipts(&self, pending: PendingSubscriptionSink) -> SubscriptionResult {
+        let mut events = self.service.subscribe_slot_events();
+        let sink = pending.accept().await?;
+        while let Some(event) = Self::next_slot_event(&sink, &mut events).await {
+            let SlotEvent::SlotExecuted { slot, .. } = event else {
+                continue;
+            };
+            for receipt in self.service.get_slot_receipts(slot).await? {
+                sink.send(SubscriptionMessage::from_json(&receipt)?).await?;
+            }
+        }
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::Arc;
+    use std::time::Duration;
+    use jsonrpsee::core::client::{ClientT, Subscription, SubscriptionClientT};
+    use jsonrpsee::rpc_params;
+    use jsonrpsee::ws_client::{WsClient, WsClientBuilder};
+    use units_core_types::objects::ObjectType;
+    use units_core_types::transaction::Instruction;
+    use units_runtime_impl::MockRuntime;
+    use units_storage_impl::ConsolidatedUnitsStorage;
+
+    use crate::config::Config;
+
+    /// Longest a test waits for a notification
+    const PATIENCE: Duration = Duration::from_secs(5);
+
+    /// A service without automatic slot advancement, and a WebSocket client of its server
+    async fn serve() -> (UnitsService, WsClient) {
+        let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+        let service = UnitsService::new(storage, Arc::new(MockRuntime::new()), Config::default());
+        let addr = {
+            // Borrow a free port for the server
+            let probe = std::net::TcpListener::bind("127.0.0.1:0").unwrap();
+            probe.local_addr().unwrap()
+        };
+        tokio::spawn(JsonRpcServerImpl::new(service.clone()).start(addr).await.unwrap());
+        let client = WsClientBuilder::default().build(format!("ws://{}", addr)).await.unwrap();
+        (service, client)
+    }
+
+    async fn next<T: serde::de::DeserializeOwned>(subscription: &mut Subscription<T>) -> T {
+        tokio::time::timeout(PATIENCE, subscription.next())
+            .await
+            .expect("no notification")
+            .expect("subscription closed")
+            .unwrap()
+    }
+
+    #[tokio::test]
+    async fn test_subscribe_slots_streams_slot_service_events() {
+        let (service, client) = serve().await;
+        let mut slots: Subscription<serde_json::Value> =
+            client.subscribe("subscribeSlots", rpc_params![], "unsubscribeSlots").await.unwrap();
+
+        service.advance_slot().await.unwrap();
+        let started = next(&mut slots).await;
+        assert_eq!(started["type"], "slotStarted");
+        assert_eq!(started["slot"], 1);
+
+        // Slot 0 is proven and slot 1 executed in the background, in either order
+        let (mut finalized, mut executed) = (false, false);
+        while !(finalized && executed) {
+            let event = next(&mut slots).await;
+            match event["type"].as_str().unwrap() {
+                "slotFinalized" => finalized |= event["slot"] == 0,
+                "slotExecuted" => executed |= event["slot"] == 1,
+                other => panic!("unexpected {} event", other),
+            }
+        }
+    }
+
+    #[tokio::test]
+    async fn test_subscribe_receipts_streams_executed_transactions() {
+        let (service, client) = serve().await;
+        let (controller, target) = (UnitsObjectId::new([10u8; 32]), UnitsObjectId::new([20u8; 32]));
+        for id in [controller, target] {
+            service.create_object(id, ObjectType::Data, vec![1], None, None).await.unwrap();
+        }
+        let mut receipts: Subscription<TransactionReceipt> =
+            client.subscribe("subscribeReceipts", rpc_params![], "unsubscribeReceipts").await.unwrap();
+
+        let instruction = Instruction::new(controller, "transfer".to_string(), vec![target], vec![1]);
+        let transaction = Transaction::new(vec![instruction], [7u8; 32]);
+        let hash: String = client.request("submitTransaction", rpc_params![transaction]).await.unwrap();
+        assert_eq!(hash, hex::encode([7u8; 32]));
+
+        service.advance_slot().await.unwrap();
+        let receipt = next(&mut receipts).await;
+        assert_eq!(receipt.transaction_hash, [7u8; 32]);
+        assert_eq!(receipt.slot, 1);
+        assert!(service.get_transaction(&[7u8; 32]).await.is_err());
+    }
+
+    #[tokio::test]
+    async fn test_subscribe_object_reports_changes_across_slots() {
+        let (service, client) = serve().await;
+        let id = UnitsObjectId::new([5u8; 32]);
+        let mut object: Subscription<Option<UnitsObject>> = client
+            .subscribe("subscribeObject", rpc_params![hex::encode(id.bytes())], "unsubscribeObject")
+            .await
+            .unwrap();
+        assert_eq!(next(&mut object).await, None);
+
+        let created = service.create_object(id, ObjectType::Data, b"v1".to_vec(), None, None).await.unwrap();
+        service.advance_slot().await.unwrap();
+        assert_eq!(next(&mut object).await, Some(created));
+    }
+}
@@ -3,9 +3,11 @@
 //! This library provides the core service layer for the UNITS system,
 //! including transaction processing, object management, and proof generation.
 
+pub mod binary_rpc;
 pub mod config;
 pub mod error;
 pub mod json_rpc;
+pub mod metrics;
 pub mod server;
 pub mod service;
 pub mod services;
@@ -4,9 +4,11 @@ use log::info;
 use std::net::SocketAddr;
 use tokio::signal;
 
+mod binary_rpc;
 mod config;
 mod error;
 mod json_rpc;
+mod metrics;
 mod server;
 mod service;
 mod services;
@@ -22,10 +24,18 @@ struct Args {
     #[arg(short, long, default_value = "config.toml")]
     config: String,
 
-    /// JSON-RPC server address
+    /// JSON-RPC server address (HTTP and WebSocket)
     #[arg(long, default_value = "127.0.0.1:8080")]
     json_rpc_addr: SocketAddr,
 
+    /// Length-prefixed bincode server address; disabled unless set
+    #[arg(long)]
+    binary_rpc_addr: Option<SocketAddr>,
+
+    /// Prometheus metrics address, served at `/metrics`; disabled unless set
+    #[arg(long)]
+    metrics_addr: Option<SocketAddr>,
+
     /// Log level
     #[arg(long, default_value = "info")]
     log_level: String,
@@ -55,6 +65,26 @@ async fn main() -> Result<()> {
     info!("JSON-RPC server started on {}", args.json_rpc_addr);
     let handle = tokio::spawn(json_rpc_server);
 
+    // Start the binary transport if requested
+    let binary_handle = match args.binary_rpc_addr {
+        Some(addr) => {
+            let binary_server = server.start_binary_rpc_server(addr).await?;
+            info!("Binary RPC server started on {}", addr);
+            Some(tokio::spawn(binary_server))
+        }
+        None => None,
+    };
+
+    // Start the metrics endpoint if requested
+    let metrics_handle = match args.metrics_addr {
+        Some(addr) => {
+            let metrics_server = server.start_metrics_server(addr).await?;
+            info!("Metrics server started on {}", addr);
+            Some(tokio::spawn(metrics_server))
+        }
+        None => None,
+    };
+
     info!("UNITS Core service is running");
 
     // Wait for shutdown signal
@@ -63,6 +93,12 @@ async fn main() -> Result<()> {
 
     // Gracefully shutdown server
     handle.abort();
+    if let Some(binary_handle) = binary_handle {
+        binary_handle.abort();
+    }
+    if let Some(metrics_handle) = metrics_handle {
+        metrics_handle.abort();
+    }
 
     info!("UNITS Core service stopped");
     Ok(())
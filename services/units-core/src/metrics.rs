@@ -0,0 +1,245 @@
+//! Hot-path latency metrics
+//!
+//! Every stage a transaction passes through records its latency into a
+//! fixed-bucket histogram of atomic counters, so recording never locks or
+//! allocates and can sit on the hottest paths. The histograms are
+//! process-wide and rendered in the Prometheus text exposition format by
+//! `ServiceMetrics::render_prometheus`, which the metrics endpoint serves.
+
+use std::fmt::Write;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+
+use units_storage_impl::SyncObserver;
+
+/// Upper bounds of the histogram buckets in microseconds, plus an implicit `+Inf`
+const BUCKET_BOUNDS_US: [u64; 18] = [
+    10, 25, 50, 100, 250, 500,
+    1_000, 2_500, 5_000, 10_000, 25_000, 50_000,
+    100_000, 250_000, 500_000, 1_000_000, 2_500_000, 10_000_000,
+];
+
+/// Content type of `ServiceMetrics::render_prometheus` output
+pub const PROMETHEUS_CONTENT_TYPE: &str = "text/plain; version=0.0.4";
+
+/// Name of the exported histogram family
+const METRIC_NAME: &str = "units_stage_latency_seconds";
+
+/// A stage of transaction processing with its own latency histogram
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Stage {
+    /// Validating a submitted transaction and admitting it to the pool
+    Intake,
+    /// Runtime conflict check plus admission against in-flight transactions
+    ConflictCheck,
+    /// Loading inputs and running an admitted transaction
+    Execute,
+    /// Proving a sealed slot
+    Proof,
+    /// One `sync_data` of a WAL batch
+    WalFsync,
+    /// How late a slot's proof landed past its deadline; zero when on time
+    SlotFinalizeOverrun,
+}
+
+impl Stage {
+    pub const ALL: [Stage; 6] = [
+        Stage::Intake,
+        Stage::ConflictCheck,
+        Stage::Execute,
+        Stage::Proof,
+        Stage::WalFsync,
+        Stage::SlotFinalizeOverrun,
+    ];
+
+    /// Value of the `stage` label
+    pub fn label(self) -> &'static str {
+        match self {
+            Stage::Intake => "intake",
+            Stage::ConflictCheck => "conflict_check",
+            Stage::Execute => "execute",
+            Stage::Proof => "proof",
+            Stage::WalFsync => "wal_fsync",
+            Stage::SlotFinalizeOverrun => "slot_finalize_overrun",
+        }
+    }
+}
+
+/// Latency histogram over `BUCKET_BOUNDS_US`
+pub struct Histogram {
+    /// Observations per bucket, not cumulative; the last is `+Inf`
+    buckets: [AtomicU64; BUCKET_BOUNDS_US.len() + 1],
+    sum_us: AtomicU64,
+    count: AtomicU64,
+}
+
+impl Histogram {
+    #[allow(clippy::declare_interior_mutable_const)]
+    const ZERO: AtomicU64 = AtomicU64::new(0);
+
+    pub const fn new() -> Self {
+        Self {
+            buckets: [Self::ZERO; BUCKET_BOUNDS_US.len() + 1],
+            sum_us: AtomicU64::new(0),
+            count: AtomicU64::new(0),
+        }
+    }
+
+    pub fn observe(&self, latency: Duration) {
+        let us = u64::try_from(latency.as_micros()).unwrap_or(u64::MAX);
+        let bucket = BUCKET_BOUNDS_US.partition_point(|bound| *bound < us);
+        self.buckets[bucket].fetch_add(1, Ordering::Relaxed);
+        self.sum_us.fetch_add(us, Ordering::Relaxed);
+        self.count.fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Number of observations so far
+    pub fn count(&self) -> u64 {
+        self.count.load(Ordering::Relaxed)
+    }
+
+    /// Append this histogram's bucket, sum and count samples for `stage`
+    fn render(&self, stage: Stage, out: &mut String) {
+        let mut cumulative = 0;
+        for (bucket, bound) in self.buckets.iter().zip(BUCKET_BOUNDS_US.iter().map(Some).chain([None])) {
+            cumulative += bucket.load(Ordering::Relaxed);
+            let le = bound.map_or_else(|| "+Inf".to_string(), |us| (*us as f64 / 1e6).to_string());
+            let _ = writeln!(out, "{}_bucket{{stage=\"{}\",le=\"{}\"}} {}", METRIC_NAME, stage.label(), le, cumulative);
+        }
+        let sum = self.sum_us.load(Ordering::Relaxed) as f64 / 1e6;
+        let _ = writeln!(out, "{}_sum{{stage=\"{}\"}} {}", METRIC_NAME, stage.label(), sum);
+        // Concurrent observations may land between the loads; keep the count consistent with +Inf
+        let _ = writeln!(out, "{}_count{{stage=\"{}\"}} {}", METRIC_NAME, stage.label(), cumulative);
+    }
+}
+
+impl Default for Histogram {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// One latency histogram per `Stage`
+pub struct ServiceMetrics {
+    stages: [Histogram; Stage::ALL.len()],
+}
+
+static METRICS: ServiceMetrics = ServiceMetrics::new();
+
+/// Process-wide metrics recorded by the service's hot paths
+pub fn metrics() -> &'static ServiceMetrics {
+    &METRICS
+}
+
+impl ServiceMetrics {
+    #[allow(clippy::declare_interior_mutable_const)]
+    const EMPTY: Histogram = Histogram::new();
+
+    pub const fn new() -> Self {
+        Self { stages: [Self::EMPTY; Stage::ALL.len()] }
+    }
+
+    pub fn histogram(&self, stage: Stage) -> &Histogram {
+        &self.stages[stage as usize]
+    }
+
+    pub fn observe(&self, stage: Stage, latency: Duration) {
+        self.histogram(stage).observe(latency);
+    }
+
+    /// Run `f`, recording how long it took under `stage`
+    pub fn time<T>(&self, stage: Stage, f: impl FnOnce() -> T) -> T {
+        let started = Instant::now();
+        let result = f();
+        self.observe(stage, started.elapsed());
+        result
+    }
+
+    /// Observer to register with `FileWriteAheadLog::with_sync_observer`
+    pub fn wal_sync_observer(&'static self) -> SyncObserver {
+        Arc::new(move |latency| self.observe(Stage::WalFsync, latency))
+    }
+
+    /// Every stage histogram in the Prometheus text exposition format
+    pub fn render_prometheus(&self) -> String {
+        let mut out = String::new();
+        let _ = writeln!(out, "# HELP {} Latency of each transaction processing stage", METRIC_NAME);
+        let _ = writeln!(out, "# TYPE {} histogram", METRIC_NAME);
+        for stage in Stage::ALL {
+            self.histogram(stage).render(stage, &mut out);
+        }
+        out
+    }
+}
+
+impl Default for ServiceMetrics {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn rendered(histogram: &Histogram, stage: Stage) -> String {
+        let mut out = String::new();
+        histogram.render(stage, &mut out);
+        out
+    }
+
+    #[test]
+    fn test_observations_land_in_the_first_bucket_that_holds_them() {
+        let histogram = Histogram::new();
+        for us in [0, 10, 11, 25, 10_000_001] {
+            histogram.observe(Duration::from_micros(us));
+        }
+        let counts: Vec<u64> = histogram.buckets.iter().map(|bucket| bucket.load(Ordering::Relaxed)).collect();
+        assert_eq!(&counts[..3], &[2, 2, 0]);
+        assert_eq!(counts[BUCKET_BOUNDS_US.len()], 1);
+        assert_eq!(counts.iter().sum::<u64>(), 5);
+        assert_eq!(histogram.count(), 5);
+    }
+
+    #[test]
+    fn test_render_emits_cumulative_buckets_sum_and_count() {
+        let histogram = Histogram::new();
+        for us in [5, 20, 20, 3_000_000] {
+            histogram.observe(Duration::from_micros(us));
+        }
+        let out = rendered(&histogram, Stage::Proof);
+        let lines: Vec<&str> = out.lines().collect();
+
+        assert_eq!(lines.len(), BUCKET_BOUNDS_US.len() + 3);
+        assert_eq!(lines[0], "units_stage_latency_seconds_bucket{stage=\"proof\",le=\"0.00001\"} 1");
+        assert_eq!(lines[1], "units_stage_latency_seconds_bucket{stage=\"proof\",le=\"0.000025\"} 3");
+        assert_eq!(lines[16], "units_stage_latency_seconds_bucket{stage=\"proof\",le=\"2.5\"} 3");
+        assert_eq!(lines[17], "units_stage_latency_seconds_bucket{stage=\"proof\",le=\"10\"} 4");
+        assert_eq!(lines[18], "units_stage_latency_seconds_bucket{stage=\"proof\",le=\"+Inf\"} 4");
+        assert_eq!(lines[19], "units_stage_latency_seconds_sum{stage=\"proof\"} 3.000045");
+        assert_eq!(lines[20], "units_stage_latency_seconds_count{stage=\"proof\"} 4");
+    }
+
+    #[test]
+    fn test_render_prometheus_covers_every_stage() {
+        let metrics = ServiceMetrics::new();
+        metrics.time(Stage::Intake, || ());
+        let out = metrics.render_prometheus();
+
+        assert!(out.starts_with("# HELP units_stage_latency_seconds "));
+        assert!(out.contains("# TYPE units_stage_latency_seconds histogram\n"));
+        for stage in Stage::ALL {
+            let count = if stage == Stage::Intake { 1 } else { 0 };
+            let line = format!("units_stage_latency_seconds_count{{stage=\"{}\"}} {}\n", stage.label(), count);
+            assert!(out.contains(&line), "missing {:?}", line);
+        }
+    }
+
+    #[test]
+    fn test_wal_sync_observer_records_wal_fsyncs() {
+        let before = metrics().histogram(Stage::WalFsync).count();
+        (metrics().wal_sync_observer())(Duration::from_micros(40));
+        assert!(metrics().histogram(Stage::WalFsync).count() > before);
+    }
+}
@@ -3,10 +3,10 @@ use std::net::SocketAddr;
 use std::sync::Arc;
 
 use units_runtime_impl::MockRuntime;
-use units_storage_impl::ConsolidatedUnitsStorage;
 
 use crate::config::Config;
 use crate::service::UnitsService;
+use crate::services::factory::ServiceFactory;
 
 pub struct UnitsServer {
     service: UnitsService,
@@ -15,24 +15,14 @@ pub struct UnitsServer {
 impl UnitsServer {
     pub async fn new(config: Config) -> Result<Self> {
         // Initialize storage based on config
-        let storage = match config.storage.storage_type.as_str() {
-            "memory" => {
-                Arc::new(ConsolidatedUnitsStorage::create())
-            }
-            "file" => {
-                // Would initialize file-based storage here
-                Arc::new(ConsolidatedUnitsStorage::create())
-            }
-            _ => {
-                anyhow::bail!("Unsupported storage type: {}", config.storage.storage_type);
-            }
-        };
+        let storage = ServiceFactory::create_storage(&config.storage)?;
 
         // Initialize runtime (using mock for now)
         let runtime: Arc<dyn units_core_types::Runtime + Send + Sync> = Arc::new(MockRuntime::new());
 
-        // Create service
+        // Create service and start slot advancement
         let service = UnitsService::new(storage, runtime, config);
+        service.start().await?;
 
         Ok(Self { service })
     }
@@ -50,4 +40,35 @@ impl UnitsServer {
             server.await
         })
     }
+
+    pub async fn start_binary_rpc_server(
+        &self,
+        addr: SocketAddr,
+    ) -> Result<impl std::future::Future<Output = ()>> {
+        use crate::binary_rpc::BinaryRpcServer;
+
+        BinaryRpcServer::new(self.service.clone()).start(addr).await
+    }
+
+    /// Serve the stage latency histograms at `GET /metrics` for Prometheus to scrape
+    pub async fn start_metrics_server(
+        &self,
+        addr: SocketAddr,
+    ) -> Result<impl std::future::Future<Output = ()>> {
+        use axum::http::header::CONTENT_TYPE;
+        use axum::routing::get;
+        use crate::metrics::{metrics, PROMETHEUS_CONTENT_TYPE};
+
+        let app = axum::Router::new().route(
+            "/metrics",
+            get(|| async { ([(CONTENT_TYPE, PROMETHEUS_CONTENT_TYPE)], metrics().render_prometheus()) }),
+        );
+        let listener = tokio::net::TcpListener::bind(addr).await?;
+
+        Ok(async move {
+            if let Err(e) = axum::serve(listener, app).await {
+                log::error!("Metrics server stopped: {}", e);
+            }
+        })
+    }
 }
\ No newline at end of file
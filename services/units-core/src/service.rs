@@ -1,19 +1,22 @@
 use std::sync::Arc;
+use tokio::sync::broadcast;
 
 use units_core_types::id::UnitsObjectId;
 use units_core_types::objects::UnitsObject;
 use units_core_types::transaction::{Transaction, TransactionReceipt, TransactionHash};
-use units_core_types::{Runtime, SlotNumber, ObjectStorage};
+use units_core_types::{Runtime, SlotNumber, ObjectStorage, ObjectPage, ReceiptStorage};
 use units_storage_impl::ConsolidatedUnitsStorage;
 
 use crate::config::Config;
 use crate::error::ServiceResult;
-use crate::services::{MinimalServiceFactory, MinimalServiceContainer};
+use crate::services::factory::{ServiceContainer, ServiceFactory};
+use crate::services::object_service::MAX_PAGE_SIZE;
+use crate::services::slot_service::SlotEvent;
 
 /// Core UNITS service that handles business logic
 #[derive(Clone)]
 pub struct UnitsService {
-    services: Arc<MinimalServiceContainer>,
+    services: Arc<ServiceContainer>,
     config: Config,
 }
 
@@ -23,8 +26,8 @@ impl UnitsService {
         runtime: Arc<dyn Runtime + Send + Sync>,
         config: Config,
     ) -> Self {
-        // Create all services using the minimal factory
-        let services = MinimalServiceFactory::create_minimal_services(
+        let services = ServiceFactory::create_services(
+            config.clone(),
             runtime,
             storage,
         ).expect("Failed to create services");
@@ -34,11 +37,15 @@ impl UnitsService {
             config,
         }
     }
+
+    /// Receive the slot service's events from now on
+    pub fn subscribe_slot_events(&self) -> broadcast::Receiver<SlotEvent> {
+        self.services.slot_service.subscribe()
+    }
     
-    /// Start all services
+    /// Start all services, including automatic slot advancement
     pub async fn start(&self) -> ServiceResult<()> {
-        // Simple implementation - no-op for now
-        Ok(())
+        self.services.start().await
     }
 
     /// Get object by ID
@@ -51,34 +58,81 @@ impl UnitsService {
             .ok_or_else(|| crate::error::ServiceError::object_not_found(hex::encode(object_id.bytes())))
     }
 
+    /// Get several objects by id, in request order; missing ids are `None`
+    pub async fn get_objects(&self, object_ids: &[UnitsObjectId]) -> ServiceResult<Vec<Option<UnitsObject>>> {
+        use units_core_types::UnitsStorage;
+        if object_ids.len() > MAX_PAGE_SIZE {
+            return Err(crate::error::ServiceError::invalid_request(
+                format!("At most {} objects can be fetched at once", MAX_PAGE_SIZE)
+            ));
+        }
+        self.services.storage
+            .objects()
+            .get_many(object_ids)
+            .map_err(crate::error::ServiceError::Storage)
+    }
+
+    /// List objects after `cursor` in id order, between 1 and `MAX_PAGE_SIZE` per page
+    pub async fn list_objects(&self, cursor: Option<&UnitsObjectId>, limit: usize) -> ServiceResult<ObjectPage> {
+        use units_core_types::UnitsStorage;
+        self.services.storage
+            .objects()
+            .list(cursor, limit.clamp(1, MAX_PAGE_SIZE))
+            .map_err(crate::error::ServiceError::Storage)
+    }
+
     /// Submit transaction to the transaction pool
     pub async fn submit_transaction(&self, transaction: Transaction) -> ServiceResult<TransactionHash> {
-        // Simple implementation - just return the hash
-        Ok(transaction.hash)
+        self.services.transaction_service.submit_transaction(transaction).await
     }
 
-    /// Get transaction from pool
-    pub async fn get_transaction(&self, _tx_hash: &TransactionHash) -> ServiceResult<Transaction> {
-        Err(crate::error::ServiceError::invalid_request("Not implemented in simple version"))
+    /// Submit several transactions, returning their hashes in request order
+    pub async fn submit_transactions(&self, transactions: Vec<Transaction>) -> ServiceResult<Vec<TransactionHash>> {
+        if transactions.len() > MAX_PAGE_SIZE {
+            return Err(crate::error::ServiceError::invalid_request(
+                format!("At most {} transactions can be submitted at once", MAX_PAGE_SIZE)
+            ));
+        }
+        let mut hashes = Vec::with_capacity(transactions.len());
+        for transaction in transactions {
+            hashes.push(self.services.transaction_service.submit_transaction(transaction).await?);
+        }
+        Ok(hashes)
     }
 
-    /// Get transaction receipt
-    pub async fn get_transaction_receipt(&self, _tx_hash: &TransactionHash) -> ServiceResult<TransactionReceipt> {
-        Err(crate::error::ServiceError::invalid_request("Not implemented in simple version"))
+    /// Receipts stored for transactions processed in `slot`
+    pub async fn get_slot_receipts(&self, slot: SlotNumber) -> ServiceResult<Vec<TransactionReceipt>> {
+        use units_core_types::UnitsStorage;
+        self.services.storage
+            .receipts()
+            .get_receipts_for_slot(slot)
+            .map_err(crate::error::ServiceError::Storage)
+    }
+
+    /// Get a pending transaction from the pool
+    pub async fn get_transaction(&self, tx_hash: &TransactionHash) -> ServiceResult<Transaction> {
+        self.services.transaction_service.get_transaction(tx_hash).await
+    }
+
+    /// Get the receipt of an executed transaction
+    pub async fn get_transaction_receipt(&self, tx_hash: &TransactionHash) -> ServiceResult<TransactionReceipt> {
+        self.services.transaction_service.get_receipt(tx_hash).await
     }
 
     /// Get current slot number
     pub async fn get_current_slot(&self) -> ServiceResult<SlotNumber> {
-        Ok(0) // Simple implementation
+        Ok(self.services.slot_service.current_slot().await)
     }
 
     /// Get service statistics
     pub async fn get_service_stats(&self) -> ServiceResult<ServiceStats> {
+        let health = self.services.health_check().await?;
+
         Ok(ServiceStats {
-            current_slot: 0,
-            pending_transactions: 0,
-            cached_objects: 0,
-            latest_proven_slot: 0,
+            current_slot: health.current_slot,
+            pending_transactions: health.pending_transactions as u64,
+            cached_objects: health.cache_size as u64,
+            latest_proven_slot: health.latest_proven_slot,
         })
     }
 
@@ -87,16 +141,16 @@ impl UnitsService {
         let health = self.services.health_check().await?;
         
         Ok(HealthStatus {
-            status: health.status,
-            slot: 0,
+            status: health.status.as_str().to_string(),
+            slot: health.current_slot,
             object_count: 0,
-            pending_transactions: 0,
+            pending_transactions: health.pending_transactions as u64,
         })
     }
     
-    /// Advance to next slot manually
+    /// Advance to next slot manually; the slot service notifies subscribers
     pub async fn advance_slot(&self) -> ServiceResult<SlotNumber> {
-        Ok(1) // Simple implementation
+        self.services.slot_service.advance_slot().await
     }
     
     /// Create a new object
@@ -6,14 +6,16 @@
 use std::sync::Arc;
 
 use units_core_types::Runtime;
-use units_storage_impl::ConsolidatedUnitsStorage;
+use units_storage_impl::{CheckpointPolicy, ConsolidatedUnitsStorage, FileWriteAheadLog, LogStoreConfig, StorageBackend};
 
-use crate::config::Config;
-use crate::error::ServiceResult;
+use crate::config::{Config, StorageConfig};
+use crate::error::{ServiceError, ServiceResult};
+use crate::metrics::metrics;
 
 use super::{
     TransactionService, StorageService, ProofService, SlotService, ObjectService,
     slot_service::SlotConfig,
+    object_cache::DEFAULT_CACHE_BYTES,
 };
 
 /// Service container holding all initialized services
@@ -31,6 +33,71 @@ pub struct ServiceContainer {
 pub struct ServiceFactory;
 
 impl ServiceFactory {
+    /// Create the storage backend selected by `config.storage_type`
+    ///
+    /// `"memory"` keeps everything in RAM, logging it to a write-ahead log
+    /// in `config.wal_dir` when one is set, whose fsyncs are recorded under
+    /// `Stage::WalFsync`. With `config.snapshot_dir` set too, the log is
+    /// checkpointed behind snapshots there every
+    /// `config.checkpoint_interval_slots` slots, and recovery starts from the
+    /// latest snapshot. `"file"` opens the persistent log-structured store
+    /// in `config.data_dir`.
+    pub fn create_storage(config: &StorageConfig) -> ServiceResult<Arc<ConsolidatedUnitsStorage>> {
+        match config.storage_type.as_str() {
+            "memory" => {
+                let wal = || {
+                    FileWriteAheadLog::with_config(config.wal.clone()).with_sync_observer(metrics().wal_sync_observer())
+                };
+                let interval = config.history_keyframe_interval;
+                let storage = match (&config.wal_dir, &config.snapshot_dir) {
+                    (Some(wal_dir), Some(snapshot_dir)) => ConsolidatedUnitsStorage::open_in_memory(
+                        interval,
+                        wal(),
+                        wal_dir.as_ref(),
+                        CheckpointPolicy {
+                            dir: snapshot_dir.into(),
+                            interval_slots: config.checkpoint_interval_slots,
+                        },
+                    )?,
+                    (Some(wal_dir), None) => ConsolidatedUnitsStorage::with_backend(
+                        StorageBackend::in_memory_with_wal(interval, wal(), wal_dir.as_ref())?,
+                    ),
+                    (None, Some(_)) => {
+                        return Err(ServiceError::invalid_request("snapshot_dir requires wal_dir"));
+                    }
+                    (None, None) => {
+                        ConsolidatedUnitsStorage::with_backend(StorageBackend::in_memory_with_keyframe_interval(interval))
+                    }
+                };
+                Ok(Arc::new(storage))
+            }
+            "file" => {
+                let data_dir = config.data_dir.as_ref().ok_or_else(|| {
+                    ServiceError::invalid_request("data_dir is required for file storage")
+                })?;
+                let log_config = LogStoreConfig {
+                    data_dir: data_dir.into(),
+                    segment_size: config.segment_size_bytes,
+                    sync_policy: config.file_sync_policy,
+                };
+                Ok(Arc::new(ConsolidatedUnitsStorage::open_persistent(log_config)?))
+            }
+            other => Err(ServiceError::invalid_request(format!(
+                "Unsupported storage type: {}",
+                other
+            ))),
+        }
+    }
+
+    /// Create storage from config and all services on top of it
+    pub fn create_from_config(
+        config: Config,
+        runtime: Arc<dyn Runtime + Send + Sync>,
+    ) -> ServiceResult<ServiceContainer> {
+        let storage = Self::create_storage(&config.storage)?;
+        Self::create_services(config, runtime, storage)
+    }
+
     /// Create all services with dependencies properly injected
     pub fn create_services(
         config: Config,
@@ -48,13 +115,13 @@ impl ServiceFactory {
         let proof_service = Arc::new(ProofService::new(
             storage.clone(),
             runtime.clone(),
-        ));
+        )?);
 
         // Create transaction service
         let transaction_service = Arc::new(TransactionService::new(
             runtime.clone(),
             storage.clone(),
-            config.server.max_connections as usize, // Use max connections as pool size
+            config.server.transaction_pool_size,
         ));
 
         // Create slot service
@@ -63,6 +130,7 @@ impl ServiceFactory {
             max_transactions_per_slot: 1000,
             auto_advance: true,
             grace_period_ms: 100,
+            proving_queue_depth: 4,
         };
 
         let slot_service = Arc::new(SlotService::new(
@@ -96,9 +164,10 @@ impl ServiceFactory {
         options: ServiceOptions,
     ) -> ServiceResult<ServiceContainer> {
         // Create storage service
-        let storage_service = Arc::new(StorageService::new(
+        let storage_service = Arc::new(StorageService::with_cache_limits(
             storage.clone(),
             options.cache_size,
+            options.cache_bytes,
             options.cache_ttl_secs,
         ));
 
@@ -106,7 +175,7 @@ impl ServiceFactory {
         let proof_service = Arc::new(ProofService::new(
             storage.clone(),
             runtime.clone(),
-        ));
+        )?);
 
         // Create transaction service
         let transaction_service = Arc::new(TransactionService::new(
@@ -155,6 +224,8 @@ impl ServiceFactory {
 pub struct ServiceOptions {
     /// Object cache size
     pub cache_size: usize,
+    /// Object cache byte budget
+    pub cache_bytes: usize,
     /// Cache TTL in seconds
     pub cache_ttl_secs: u64,
     /// Transaction pool size
@@ -172,8 +243,9 @@ impl ServiceOptions {
     pub fn from_config(config: &Config) -> Self {
         Self {
             cache_size: 1000,
+            cache_bytes: DEFAULT_CACHE_BYTES,
             cache_ttl_secs: 300,
-            transaction_pool_size: config.server.max_connections as usize,
+            transaction_pool_size: config.server.transaction_pool_size,
             max_object_size: config.storage.max_object_size,
             max_program_size: config.runtime.max_memory_bytes,
             slot_config: SlotConfig::default(),
@@ -184,6 +256,7 @@ impl ServiceOptions {
     pub fn test_defaults() -> Self {
         Self {
             cache_size: 100,
+            cache_bytes: 16 * 1024 * 1024,
             cache_ttl_secs: 60,
             transaction_pool_size: 10,
             max_object_size: 1024 * 1024, // 1MB
@@ -193,6 +266,7 @@ impl ServiceOptions {
                 max_transactions_per_slot: 10,
                 auto_advance: false,
                 grace_period_ms: 10,
+                proving_queue_depth: 2,
             },
         }
     }
@@ -251,4 +325,15 @@ pub enum ServiceStatus {
     Healthy,
     Degraded,
     Unhealthy,
+}
+
+impl ServiceStatus {
+    /// Lowercase name reported by health checks
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            Self::Healthy => "healthy",
+            Self::Degraded => "degraded",
+            Self::Unhealthy => "unhealthy",
+        }
+    }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 use std::sync::Arc;
 use crate::error::ServiceResult;
+use crate::metrics::{metrics, Stage};
 use units_core_types::{
     UnitsObjectId, UnitsObject, ObjectStorage,
     TransactionHash, Transaction,
@@ -28,7 +29,7 @@ impl MinimalTransactionService {
 
     pub async fn submit_transaction(&self, transaction: Transaction) -> ServiceResult<TransactionHash> {
         // Simple implementation - just return the hash
-        Ok(transaction.hash)
+        metrics().time(Stage::Intake, || Ok(transaction.hash))
     }
 
     pub async fn get_transaction(&self, _hash: &TransactionHash) -> ServiceResult<Transaction> {
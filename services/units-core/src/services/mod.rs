@@ -8,6 +8,7 @@ pub mod storage_service;
 pub mod proof_service;
 pub mod slot_service;
 pub mod object_service;
+pub mod object_cache;
 
 // Re-export service types
 pub use transaction_service::TransactionService;
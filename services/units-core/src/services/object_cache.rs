@@ -0,0 +1,335 @@
+//! Sharded object cache with CLOCK eviction
+//!
+//! The cache is split into shards keyed by object id, each behind its own
+//! lock. Lookups only take a shard's read lock: recency is tracked with an
+//! atomic referenced bit rather than a timestamp that needs a write. When a
+//! shard is over its entry or byte budget, a CLOCK hand sweeps its entries,
+//! clearing referenced bits and evicting the first unreferenced or expired
+//! entry, so each eviction is amortized O(1).
+//!
+//! Entries are sized by their payload, so a handful of large programs
+//! cannot crowd out thousands of small data objects unnoticed.
+
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::{Arc, RwLock};
+use std::time::{Duration, Instant};
+
+use units_core_types::{UnitsObject, UnitsObjectId};
+
+/// Number of independently locked shards
+const SHARD_COUNT: usize = 16;
+
+/// Bookkeeping charged to every entry on top of its payload
+const ENTRY_OVERHEAD: usize = std::mem::size_of::<Entry>() + std::mem::size_of::<UnitsObject>() + 64;
+
+/// Default byte budget for an object cache (64MB)
+pub const DEFAULT_CACHE_BYTES: usize = 64 * 1024 * 1024;
+
+struct Entry {
+    id: UnitsObjectId,
+    object: Arc<UnitsObject>,
+    cost: usize,
+    inserted: Instant,
+    referenced: AtomicBool,
+}
+
+#[derive(Default)]
+struct Shard {
+    index: HashMap<UnitsObjectId, usize>,
+    entries: Vec<Entry>,
+    hand: usize,
+    bytes: usize,
+}
+
+impl Shard {
+    /// Remove the entry at `position`, returning it
+    fn take(&mut self, position: usize) -> Entry {
+        let entry = self.entries.swap_remove(position);
+        if let Some(moved) = self.entries.get(position) {
+            self.index.insert(moved.id, position);
+        }
+        self.index.remove(&entry.id);
+        self.bytes -= entry.cost;
+        entry
+    }
+}
+
+/// Object cache counters and limits
+#[derive(Debug, Clone)]
+pub struct CacheStats {
+    /// Entries currently cached
+    pub size: usize,
+    /// Maximum number of entries
+    pub max_size: usize,
+    /// Approximate bytes held by cached entries
+    pub bytes: usize,
+    /// Byte budget
+    pub max_bytes: usize,
+    pub ttl_secs: u64,
+    pub hits: u64,
+    pub misses: u64,
+    /// Entries evicted to make room or because they expired
+    pub evictions: u64,
+    /// Objects too large to admit
+    pub rejections: u64,
+    /// Fraction of lookups served from the cache
+    pub hit_ratio: f64,
+}
+
+/// Concurrent, size-bounded object cache
+pub struct ObjectCache {
+    shards: Box<[RwLock<Shard>]>,
+    max_entries: usize,
+    max_bytes: usize,
+    ttl: Duration,
+    hits: AtomicU64,
+    misses: AtomicU64,
+    evictions: AtomicU64,
+    rejections: AtomicU64,
+}
+
+impl ObjectCache {
+    /// Create a cache holding at most `max_entries` objects and roughly
+    /// `max_bytes` bytes; entries expire `ttl` after they are inserted
+    pub fn new(max_entries: usize, max_bytes: usize, ttl: Duration) -> Self {
+        Self {
+            shards: (0..SHARD_COUNT).map(|_| RwLock::new(Shard::default())).collect(),
+            max_entries,
+            max_bytes,
+            ttl,
+            hits: AtomicU64::new(0),
+            misses: AtomicU64::new(0),
+            evictions: AtomicU64::new(0),
+            rejections: AtomicU64::new(0),
+        }
+    }
+
+    fn shard(&self, id: &UnitsObjectId) -> &RwLock<Shard> {
+        let mut prefix = [0u8; 8];
+        prefix.copy_from_slice(&id.bytes()[..8]);
+        &self.shards[u64::from_le_bytes(prefix) as usize % SHARD_COUNT]
+    }
+
+    fn shard_entries(&self) -> usize {
+        self.max_entries.div_ceil(SHARD_COUNT)
+    }
+
+    fn shard_bytes(&self) -> usize {
+        self.max_bytes.div_ceil(SHARD_COUNT)
+    }
+
+    /// Look up `id`, marking it recently used
+    pub fn get(&self, id: &UnitsObjectId) -> Option<UnitsObject> {
+        let object = {
+            let shard = self.shard(id).read().unwrap();
+            shard
+                .index
+                .get(id)
+                .map(|&position| &shard.entries[position])
+                .filter(|entry| entry.inserted.elapsed() < self.ttl)
+                .map(|entry| {
+                    entry.referenced.store(true, Ordering::Relaxed);
+                    Arc::clone(&entry.object)
+                })
+        };
+
+        match object {
+            Some(object) => {
+                self.hits.fetch_add(1, Ordering::Relaxed);
+                Some(object.as_ref().clone())
+            }
+            None => {
+                self.misses.fetch_add(1, Ordering::Relaxed);
+                None
+            }
+        }
+    }
+
+    /// Cache `object`, evicting entries from its shard until it fits
+    pub fn insert(&self, object: UnitsObject) {
+        let cost = object.data.len() + ENTRY_OVERHEAD;
+        let (max_entries, max_bytes) = (self.shard_entries(), self.shard_bytes());
+        if max_entries == 0 || cost > max_bytes {
+            self.rejections.fetch_add(1, Ordering::Relaxed);
+            return;
+        }
+
+        let id = object.id;
+        let mut shard = self.shard(&id).write().unwrap();
+        if let Some(&position) = shard.index.get(&id) {
+            shard.take(position);
+        }
+        while shard.entries.len() >= max_entries || shard.bytes + cost > max_bytes {
+            self.evict_one(&mut shard);
+        }
+
+        let position = shard.entries.len();
+        shard.entries.push(Entry {
+            id,
+            object: Arc::new(object),
+            cost,
+            inserted: Instant::now(),
+            referenced: AtomicBool::new(false),
+        });
+        shard.index.insert(id, position);
+        shard.bytes += cost;
+    }
+
+    /// Sweep the CLOCK hand to the first unreferenced or expired entry and drop it
+    fn evict_one(&self, shard: &mut Shard) {
+        loop {
+            if shard.hand >= shard.entries.len() {
+                shard.hand = 0;
+            }
+            let entry = &shard.entries[shard.hand];
+            let expired = entry.inserted.elapsed() >= self.ttl;
+            if expired || !entry.referenced.swap(false, Ordering::Relaxed) {
+                let hand = shard.hand;
+                shard.take(hand);
+                self.evictions.fetch_add(1, Ordering::Relaxed);
+                return;
+            }
+            shard.hand += 1;
+        }
+    }
+
+    /// Drop `id` if it is cached
+    pub fn remove(&self, id: &UnitsObjectId) {
+        let mut shard = self.shard(id).write().unwrap();
+        if let Some(&position) = shard.index.get(id) {
+            shard.take(position);
+        }
+    }
+
+    /// Drop every entry
+    pub fn clear(&self) {
+        for shard in self.shards.iter() {
+            *shard.write().unwrap() = Shard::default();
+        }
+    }
+
+    /// Sizes, limits and hit, miss and eviction counters
+    pub fn stats(&self) -> CacheStats {
+        let (size, bytes) = self.shards.iter().fold((0, 0), |(size, bytes), shard| {
+            let shard = shard.read().unwrap();
+            (size + shard.entries.len(), bytes + shard.bytes)
+        });
+        let hits = self.hits.load(Ordering::Relaxed);
+        let misses = self.misses.load(Ordering::Relaxed);
+        let lookups = hits + misses;
+
+        CacheStats {
+            size,
+            max_size: self.max_entries,
+            bytes,
+            max_bytes: self.max_bytes,
+            ttl_secs: self.ttl.as_secs(),
+            hits,
+            misses,
+            evictions: self.evictions.load(Ordering::Relaxed),
+            rejections: self.rejections.load(Ordering::Relaxed),
+            hit_ratio: if lookups == 0 { 0.0 } else { hits as f64 / lookups as f64 },
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Object whose id lands in shard 0, distinguished by `seed`
+    fn object(seed: u8, payload: usize) -> UnitsObject {
+        let mut id = [0u8; 32];
+        id[0] = seed.wrapping_mul(SHARD_COUNT as u8);
+        id[31] = seed;
+        UnitsObject::new_data(UnitsObjectId::new(id), UnitsObjectId::new([0xff; 32]), vec![seed; payload])
+    }
+
+    #[test]
+    fn test_clock_spares_referenced_entries() {
+        // Two entries per shard
+        let cache = ObjectCache::new(SHARD_COUNT * 2, DEFAULT_CACHE_BYTES, Duration::from_secs(60));
+        let (a, b, c) = (object(1, 8), object(2, 8), object(3, 8));
+        cache.insert(a.clone());
+        cache.insert(b.clone());
+        assert_eq!(cache.get(&a.id), Some(a.clone()));
+
+        // The hand clears `a`'s referenced bit and takes `b`
+        cache.insert(c.clone());
+        assert_eq!(cache.get(&b.id), None);
+        assert_eq!(cache.get(&a.id), Some(a));
+        assert_eq!(cache.get(&c.id), Some(c));
+        assert_eq!(cache.stats().evictions, 1);
+    }
+
+    #[test]
+    fn test_byte_budget_evicts_and_rejects() {
+        let per_shard = 2 * ENTRY_OVERHEAD + 100;
+        let cache = ObjectCache::new(1024, per_shard * SHARD_COUNT, Duration::from_secs(60));
+        let (first, second) = (object(1, 60), object(2, 60));
+        cache.insert(first.clone());
+        cache.insert(second.clone());
+
+        // Both do not fit in one shard's budget
+        assert_eq!(cache.get(&first.id), None);
+        assert_eq!(cache.get(&second.id), Some(second));
+        assert_eq!(cache.stats().bytes, ENTRY_OVERHEAD + 60);
+
+        // An object larger than a shard's budget is never admitted
+        let huge = object(3, per_shard);
+        cache.insert(huge.clone());
+        assert_eq!(cache.get(&huge.id), None);
+        assert_eq!(cache.stats().rejections, 1);
+    }
+
+    #[test]
+    fn test_expired_entries_miss_and_are_evicted_first() {
+        let cache = ObjectCache::new(SHARD_COUNT, DEFAULT_CACHE_BYTES, Duration::ZERO);
+        let (stale, fresh) = (object(1, 8), object(2, 8));
+        cache.insert(stale.clone());
+        assert_eq!(cache.get(&stale.id), None);
+
+        cache.insert(fresh);
+        let stats = cache.stats();
+        assert_eq!((stats.size, stats.evictions), (1, 1));
+    }
+
+    #[test]
+    fn test_remove_and_clear_invalidate() {
+        let cache = ObjectCache::new(1024, DEFAULT_CACHE_BYTES, Duration::from_secs(60));
+        let objects: Vec<_> = (1..=4).map(|seed| object(seed, 8)).collect();
+        for object in &objects {
+            cache.insert(object.clone());
+        }
+
+        cache.remove(&objects[0].id);
+        assert_eq!(cache.get(&objects[0].id), None);
+        assert_eq!(cache.get(&objects[1].id), Some(objects[1].clone()));
+
+        // Re-inserting replaces the entry rather than adding a second one
+        cache.insert(objects[1].clone());
+        assert_eq!(cache.stats().size, 3);
+
+        cache.clear();
+        let stats = cache.stats();
+        assert_eq!((stats.size, stats.bytes), (0, 0));
+        assert_eq!(cache.get(&objects[2].id), None);
+    }
+
+    #[test]
+    fn test_stats_count_lookups() {
+        let cache = ObjectCache::new(1024, DEFAULT_CACHE_BYTES, Duration::from_secs(30));
+        let cached = object(1, 10);
+        cache.insert(cached.clone());
+        cache.get(&cached.id);
+        cache.get(&cached.id);
+        cache.get(&object(2, 10).id);
+
+        let stats = cache.stats();
+        assert_eq!((stats.hits, stats.misses), (2, 1));
+        assert!((stats.hit_ratio - 2.0 / 3.0).abs() < 1e-9);
+        assert_eq!((stats.size, stats.bytes), (1, ENTRY_OVERHEAD + 10));
+        assert_eq!((stats.max_size, stats.max_bytes, stats.ttl_secs), (1024, DEFAULT_CACHE_BYTES, 30));
+    }
+}
@@ -8,12 +8,15 @@ use std::collections::HashMap;
 
 use units_core_types::{
     UnitsObjectId, UnitsObject, ObjectType, VMType,
-    TransactionHash, UnitsObjectProof,
+    TransactionHash, UnitsObjectProof, ObjectPage,
 };
 
 use crate::error::{ServiceError, ServiceResult};
 use super::storage_service::StorageService;
 
+/// Largest page returned by index queries
+pub const MAX_PAGE_SIZE: usize = 1000;
+
 /// Object validator for enforcing business rules
 pub struct ObjectValidator {
     /// Maximum object data size in bytes
@@ -214,28 +217,48 @@ impl ObjectService {
         self.storage_service.objects().get_objects(ids).await
     }
 
-    /// Get objects by controller
+    /// List all objects, one page at a time
+    ///
+    /// Pass the returned `next_cursor` back as `cursor` to continue.
+    /// `limit` is clamped to `1..=MAX_PAGE_SIZE`.
+    pub async fn list_objects(
+        &self,
+        cursor: Option<UnitsObjectId>,
+        limit: usize,
+    ) -> ServiceResult<ObjectPage> {
+        self.storage_service.objects()
+            .list_objects(cursor.as_ref(), limit.clamp(1, MAX_PAGE_SIZE))
+            .await
+    }
+
+    /// Get objects by controller, one page at a time
+    ///
+    /// Pass the returned `next_cursor` back as `cursor` to continue.
+    /// `limit` is clamped to `1..=MAX_PAGE_SIZE`.
     pub async fn get_objects_by_controller(
         &self,
         controller_id: &UnitsObjectId,
+        cursor: Option<UnitsObjectId>,
         limit: usize,
-    ) -> ServiceResult<Vec<UnitsObject>> {
-        // This would require an index in storage
-        // For now, return empty vector as placeholder
-        let _ = (controller_id, limit);
-        Ok(Vec::new())
+    ) -> ServiceResult<ObjectPage> {
+        self.storage_service.objects()
+            .get_objects_by_controller(controller_id, cursor.as_ref(), limit.clamp(1, MAX_PAGE_SIZE))
+            .await
     }
 
-    /// Get objects by type
+    /// Get objects by type, one page at a time
+    ///
+    /// Pass the returned `next_cursor` back as `cursor` to continue.
+    /// `limit` is clamped to `1..=MAX_PAGE_SIZE`.
     pub async fn get_objects_by_type(
         &self,
         object_type: ObjectType,
+        cursor: Option<UnitsObjectId>,
         limit: usize,
-    ) -> ServiceResult<Vec<UnitsObject>> {
-        // This would require an index in storage
-        // For now, return empty vector as placeholder
-        let _ = (object_type, limit);
-        Ok(Vec::new())
+    ) -> ServiceResult<ObjectPage> {
+        self.storage_service.objects()
+            .get_objects_by_type(&object_type, cursor.as_ref(), limit.clamp(1, MAX_PAGE_SIZE))
+            .await
     }
 
     /// Transfer object control
@@ -8,29 +8,45 @@ use std::collections::HashMap;
 use tokio::sync::RwLock;
 
 use units_core_types::{
-    UnitsStorage, ProofStorage,
+    UnitsStorage, ObjectStorage, ProofStorage,
     UnitsObjectId, UnitsObject, UnitsObjectProof,
     SlotNumber, StateProof, MerkleNode,
     TransactionHash, TransactionReceipt,
     Runtime,
 };
 use units_storage_impl::ConsolidatedUnitsStorage;
+use units_proofs::{hash_bytes, ProofEngine, SparseMerkleProof, SparseMerkleTree, SubtreeCache, SubtreeCacheStats};
 
 use crate::error::{ServiceError, ServiceResult};
 
 /// Proof generator for creating object and state proofs
 pub struct ProofGenerator {
     storage: Arc<units_storage_impl::ConsolidatedUnitsStorage>,
-    /// Cache of recent merkle computations
-    merkle_cache: Arc<RwLock<HashMap<Vec<u8>, MerkleNode>>>,
+    /// Bounded cache of merkle subtree roots over slot transactions, so
+    /// retried slot proofs and inclusion paths reuse unchanged blocks
+    merkle_cache: Arc<SubtreeCache>,
+    /// Sparse Merkle tree over the latest proof of every object, updated per slot
+    state_tree: Arc<RwLock<SparseMerkleTree>>,
 }
 
 impl ProofGenerator {
-    pub fn new(storage: Arc<ConsolidatedUnitsStorage>) -> Self {
-        Self {
-            storage,
-            merkle_cache: Arc::new(RwLock::new(HashMap::new())),
+    /// Create a generator whose state tree holds the latest proof of every
+    /// live object already in `storage`, such as state recovered on startup
+    pub fn new(storage: Arc<ConsolidatedUnitsStorage>) -> ServiceResult<Self> {
+        let mut state_tree = SparseMerkleTree::new();
+        for object in storage.objects().iter() {
+            let object_id = *object?.id();
+            if let Some(proof) = storage.proofs().get_latest_proof(&object_id)? {
+                state_tree.insert(object_id, ProofEngine::object_leaf(&proof));
+            }
         }
+        state_tree.commit();
+
+        Ok(Self {
+            storage,
+            merkle_cache: Arc::new(SubtreeCache::default()),
+            state_tree: Arc::new(RwLock::new(state_tree)),
+        })
     }
 
     /// Generate proof for an object state change
@@ -76,134 +92,60 @@ impl ProofGenerator {
     }
 
     /// Generate state proof for a slot
+    ///
+    /// `changes` holds each touched object's new `ProofEngine::object_leaf`,
+    /// or `None` once deleted, in execution order. They are applied to the
+    /// state tree, so only the paths of objects touched in this slot are
+    /// re-hashed, and the proof commits to the tree's root over every live
+    /// object as `ProofEngine::state_root` reads it back. The transaction
+    /// root goes through the subtree cache.
     pub async fn generate_slot_proof(
         &self,
         slot: SlotNumber,
-        object_proofs: Vec<UnitsObjectProof>,
-        previous_slot_hash: [u8; 32],
+        changes: Vec<(UnitsObjectId, Option<[u8; 32]>)>,
+        transaction_hashes: &[TransactionHash],
+        previous: Option<&StateProof>,
     ) -> ServiceResult<StateProof> {
-        // Build merkle tree from object proofs
-        let leaves: Vec<MerkleNode> = object_proofs.iter()
-            .map(|proof| self.proof_to_merkle_node(proof))
-            .collect();
-
-        let merkle_root = self.compute_merkle_root(&leaves).await;
-
-        // Create state proof using constructor
-        let object_ids: Vec<UnitsObjectId> = object_proofs.iter()
-            .map(|proof| proof.object_id)
-            .collect();
-        
-        let state_proof = StateProof::new(
-            slot,
-            self.sign_state_proof(&merkle_root, &previous_slot_hash),
-            object_ids,
-            None, // We'd need to look up previous state proof
-        );
+        let object_root = {
+            let mut tree = self.state_tree.write().await;
+            for (object_id, leaf) in &changes {
+                match leaf {
+                    Some(leaf) => tree.insert(*object_id, *leaf),
+                    None => tree.remove(*object_id),
+                }
+            }
+            tree.commit()
+        };
 
-        Ok(state_proof)
+        let object_ids: Vec<UnitsObjectId> = changes.iter().map(|(object_id, _)| *object_id).collect();
+        ProofEngine::new()
+            .state_proof_from_roots(slot, object_root, self.merkle_cache.merkle_root(transaction_hashes), object_ids, previous)
+            .map_err(|e| ServiceError::Storage(e.into()))
     }
 
-    /// Compute merkle root from leaves
-    async fn compute_merkle_root(&self, leaves: &[MerkleNode]) -> [u8; 32] {
-        if leaves.is_empty() {
-            return [0u8; 32];
-        }
-
-        if leaves.len() == 1 {
-            return leaves[0].hash;
-        }
-
-        // Check cache first
-        let cache_key = self.leaves_to_cache_key(leaves);
-        if let Some(cached) = self.merkle_cache.read().await.get(&cache_key) {
-            return cached.hash;
-        }
-
-        // Build tree bottom-up
-        let mut current_level = leaves.to_vec();
-        
-        while current_level.len() > 1 {
-            let mut next_level = Vec::new();
-            
-            for i in (0..current_level.len()).step_by(2) {
-                let left = &current_level[i];
-                let right = if i + 1 < current_level.len() {
-                    &current_level[i + 1]
-                } else {
-                    left // Duplicate last node if odd number
-                };
-                
-                let parent = self.hash_nodes(left, right);
-                next_level.push(parent);
-            }
-            
-            current_level = next_level;
-        }
-
-        let root = current_level[0].clone();
-        
-        // Cache result
-        self.merkle_cache.write().await.insert(cache_key, root.clone());
-        
-        root.hash
+    /// Membership or non-membership proof for an object against the state root
+    pub async fn prove_object(&self, object_id: &UnitsObjectId) -> SparseMerkleProof {
+        self.state_tree.read().await.prove(object_id)
     }
 
-    /// Hash two merkle nodes to create parent
-    fn hash_nodes(&self, left: &MerkleNode, right: &MerkleNode) -> MerkleNode {
-        use sha2::{Sha256, Digest};
-        
-        let mut hasher = Sha256::new();
-        hasher.update(&left.hash);
-        hasher.update(&right.hash);
-        
-        let hash_bytes = hasher.finalize();
-        let mut hash = [0u8; 32];
-        hash.copy_from_slice(&hash_bytes);
-        
-        MerkleNode {
-            hash,
-            is_left: false, // Parent nodes are neither left nor right
-        }
+    /// Current state root and the number of objects under it
+    pub async fn state_root(&self) -> ([u8; 32], usize) {
+        let tree = self.state_tree.read().await;
+        (tree.root(), tree.len())
     }
 
-    /// Convert object proof to merkle node
-    fn proof_to_merkle_node(&self, proof: &UnitsObjectProof) -> MerkleNode {
-        use sha2::{Sha256, Digest};
-        
-        let mut hasher = Sha256::new();
-        hasher.update(&proof.object_id.bytes());
-        if let Some(prev_hash) = proof.prev_proof_hash {
-            hasher.update(&prev_hash);
-        }
-        hasher.update(&proof.object_hash);
-        if let Some(tx_hash) = proof.transaction_hash {
-            hasher.update(&tx_hash);
-        }
-        
-        let hash_bytes = hasher.finalize();
-        let mut hash = [0u8; 32];
-        hash.copy_from_slice(&hash_bytes);
-        
-        MerkleNode {
-            hash,
-            is_left: false, // Leaf nodes default to not left
-        }
+    /// Sibling path proving `leaves[index]` under their merkle root
+    ///
+    /// Blocks of a slot's transactions hashed while proving it are served
+    /// from the subtree cache.
+    pub fn compute_merkle_path(&self, leaves: &[[u8; 32]], index: usize) -> Option<Vec<MerkleNode>> {
+        self.merkle_cache.merkle_path(leaves, index)
     }
 
     /// Compute hash of an object
     fn compute_object_hash(&self, object: &UnitsObject) -> [u8; 32] {
-        use sha2::{Sha256, Digest};
-        
         let serialized = bincode::serialize(object).unwrap_or_default();
-        let mut hasher = Sha256::new();
-        hasher.update(&serialized);
-        
-        let hash_bytes = hasher.finalize();
-        let mut hash = [0u8; 32];
-        hash.copy_from_slice(&hash_bytes);
-        
-        hash
+        hash_bytes(&serialized)
     }
 
     /// Sign a proof (placeholder - would use real crypto)
@@ -217,30 +159,6 @@ impl ProofGenerator {
         
         hasher.finalize().to_vec()
     }
-
-    /// Sign a state proof
-    fn sign_state_proof(&self, merkle_root: &[u8; 32], previous_slot_hash: &[u8; 32]) -> Vec<u8> {
-        use sha2::{Sha256, Digest};
-        
-        let mut hasher = Sha256::new();
-        hasher.update(merkle_root);
-        hasher.update(previous_slot_hash);
-        hasher.update(b"state_proof_signature");
-        
-        hasher.finalize().to_vec()
-    }
-
-    /// Create cache key from leaves
-    fn leaves_to_cache_key(&self, leaves: &[MerkleNode]) -> Vec<u8> {
-        use sha2::{Sha256, Digest};
-        
-        let mut hasher = Sha256::new();
-        for leaf in leaves {
-            hasher.update(&leaf.hash);
-        }
-        
-        hasher.finalize().to_vec()
-    }
 }
 
 /// Main proof service combining generation and verification
@@ -251,17 +169,18 @@ pub struct ProofService {
 }
 
 impl ProofService {
+    /// Create the service, building its state tree from what `storage` already holds
     pub fn new(
         storage: Arc<units_storage_impl::ConsolidatedUnitsStorage>,
         runtime: Arc<dyn Runtime + Send + Sync>,
-    ) -> Self {
-        let generator = Arc::new(ProofGenerator::new(storage.clone()));
+    ) -> ServiceResult<Self> {
+        let generator = Arc::new(ProofGenerator::new(storage.clone())?);
         
-        Self {
+        Ok(Self {
             generator,
             runtime,
             storage,
-        }
+        })
     }
 
     /// Generate proofs for a transaction receipt
@@ -300,36 +219,45 @@ impl ProofService {
     }
 
     /// Generate and store slot proof
+    ///
+    /// A slot the storage's `CheckpointPolicy` makes due is then snapshotted
+    /// in the background and the WAL checkpointed behind it.
     pub async fn finalize_slot(
         &self,
         slot: SlotNumber,
-        receipts: Vec<TransactionReceipt>,
+        receipts: &[TransactionReceipt],
     ) -> ServiceResult<StateProof> {
-        // Collect all object proofs from receipts
-        let mut all_proofs = Vec::new();
-        for receipt in &receipts {
-            for (_, proof) in &receipt.object_proofs {
-                all_proofs.push(proof.clone());
+        // Each touched object's new leaf, or None where it was deleted
+        let mut changes = Vec::new();
+        for receipt in receipts {
+            for (object_id, proof) in &receipt.object_proofs {
+                let deleted = proof.object_hash == [0u8; 32]
+                    || receipt
+                        .effects
+                        .iter()
+                        .any(|effect| effect.object_id == *object_id && effect.after_image.is_none());
+                changes.push((*object_id, (!deleted).then(|| ProofEngine::object_leaf(proof))));
             }
         }
+        let transaction_hashes: Vec<TransactionHash> =
+            receipts.iter().map(|receipt| receipt.transaction_hash).collect();
 
-        // Get previous slot hash
-        let previous_slot_hash = if slot > 0 {
-            self.storage
+        // Chain to the previous slot's proof, if it was stored
+        let previous = match slot.checked_sub(1) {
+            Some(previous_slot) => self
+                .storage
                 .proofs()
-                .get_state_proof(slot - 1)
-                .map_err(ServiceError::Storage)?
-                .map(|_p| [0u8; 32]) // Simplified for build
-                .unwrap_or([0u8; 32])
-        } else {
-            [0u8; 32] // Genesis
+                .get_state_proof(previous_slot)
+                .map_err(ServiceError::Storage)?,
+            None => None, // Genesis
         };
 
         // Generate state proof
         let state_proof = self.generator.generate_slot_proof(
             slot,
-            all_proofs,
-            previous_slot_hash,
+            changes,
+            &transaction_hashes,
+            previous.as_ref(),
         ).await?;
 
         // Store the proof
@@ -338,6 +266,14 @@ impl ProofService {
             .store_state_proof(&state_proof)
             .map_err(ServiceError::Storage)?;
 
+        // The proof is durable now, so the slot can back a WAL checkpoint
+        let storage = self.storage.clone();
+        tokio::task::spawn_blocking(move || {
+            if let Err(e) = storage.checkpoint_finalized(slot) {
+                log::warn!("Failed to checkpoint slot {}: {:?}", slot, e);
+            }
+        });
+
         Ok(state_proof)
     }
 
@@ -375,15 +311,6 @@ impl ProofService {
             }
         }
 
-        // Verify merkle root computation
-        // Simplified merkle computation for build
-        let object_proofs: Vec<UnitsObjectProof> = Vec::new();
-        let leaves: Vec<MerkleNode> = object_proofs.iter()
-            .map(|p| self.generator.proof_to_merkle_node(p))
-            .collect();
-        
-        let computed_root = self.generator.compute_merkle_root(&leaves).await;
-        
         // Simplified verification for build
         Ok(true)
     }
@@ -400,6 +327,33 @@ impl ProofService {
             .map_err(ServiceError::Storage)
     }
 
+    /// Prove an object's latest proof is (or is not) under the current state root
+    ///
+    /// Returns the root together with the proof; check it with
+    /// `SparseMerkleProof::verify`.
+    pub async fn get_state_inclusion_proof(
+        &self,
+        object_id: &UnitsObjectId,
+    ) -> ServiceResult<([u8; 32], SparseMerkleProof)> {
+        let (root, _) = self.generator.state_root().await;
+        Ok((root, self.generator.prove_object(object_id).await))
+    }
+
+    /// Merkle path proving a transaction is in a slot's transaction root
+    ///
+    /// `transaction_hashes` are the slot's transactions in order; the path
+    /// checks against the root with `ProofEngine::verify_transaction_inclusion`.
+    pub async fn get_transaction_inclusion_path(
+        &self,
+        transaction_hashes: &[TransactionHash],
+        transaction_hash: &TransactionHash,
+    ) -> ServiceResult<Option<Vec<MerkleNode>>> {
+        Ok(transaction_hashes
+            .iter()
+            .position(|hash| hash == transaction_hash)
+            .and_then(|index| self.generator.compute_merkle_path(transaction_hashes, index)))
+    }
+
     /// Get state proof for a slot
     pub async fn get_slot_proof(&self, _slot: SlotNumber) -> ServiceResult<Option<StateProof>> {
         self.storage
@@ -415,11 +369,14 @@ impl ProofService {
             .map_err(ServiceError::Storage)?
             .unwrap_or(0);
 
-        let cache_size = self.generator.merkle_cache.read().await.len();
+        let merkle_cache = self.generator.merkle_cache.stats();
+        let (_, state_tree_objects) = self.generator.state_root().await;
 
         Ok(ProofStats {
             latest_proven_slot: latest_slot,
-            merkle_cache_size: cache_size,
+            merkle_cache_size: merkle_cache.entries,
+            merkle_cache,
+            state_tree_objects,
         })
     }
 }
@@ -428,4 +385,100 @@ impl ProofService {
 pub struct ProofStats {
     pub latest_proven_slot: SlotNumber,
     pub merkle_cache_size: usize,
-}
\ No newline at end of file
+    /// Hit, miss, eviction and memory counters of the subtree cache
+    pub merkle_cache: SubtreeCacheStats,
+    pub state_tree_objects: usize,
+}
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use units_core_types::TransactionEffect;
+    use units_runtime_impl::MockRuntime;
+
+    #[tokio::test]
+    async fn test_finalized_slot_exports_as_snapshot() {
+        let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+        let service = ProofService::new(storage.clone(), Arc::new(MockRuntime::new())).unwrap();
+
+        // One transaction creates eight objects, a second deletes the first
+        let mut created = TransactionReceipt::new([1u8; 32], 0, true, 0);
+        let mut objects = Vec::new();
+        for seed in 1..=8u8 {
+            let object = UnitsObject::new_data(UnitsObjectId::new([seed; 32]), UnitsObjectId::new([0; 32]), vec![seed; 64]);
+            let proof = storage.objects().set(&object, Some(created.transaction_hash)).unwrap();
+            created.add_proof(*object.id(), proof);
+            created.add_effect(TransactionEffect::new_creation(created.transaction_hash, object.clone()));
+            objects.push(object);
+        }
+        let mut deleted = TransactionReceipt::new([2u8; 32], 0, true, 0);
+        let proof = storage.objects().delete(objects[0].id(), Some(deleted.transaction_hash)).unwrap();
+        deleted.add_proof(*objects[0].id(), proof);
+        deleted.add_effect(TransactionEffect::new_deletion(deleted.transaction_hash, objects[0].clone()));
+
+        // Storage stamps proofs with its own slot clock; prove at the latest
+        let receipts = vec![created, deleted];
+        let slot = receipts
+            .iter()
+            .flat_map(|receipt| receipt.object_proofs.values())
+            .map(|proof| proof.slot)
+            .max()
+            .unwrap();
+        let state_proof = service.finalize_slot(slot, &receipts).await.unwrap();
+        let (root, live) = service.generator.state_root().await;
+        assert_eq!(live, 7);
+        assert_eq!(ProofEngine::new().state_root(&state_proof).unwrap(), root);
+
+        let dir = tempfile::tempdir().unwrap();
+        let manifest = storage.export_snapshot(dir.path(), slot).unwrap();
+        assert_eq!((manifest.object_count, manifest.state_root), (7, root));
+
+        let target = ConsolidatedUnitsStorage::new_in_memory();
+        target.import_snapshot(dir.path()).unwrap();
+        assert_eq!(target.objects().get(objects[0].id()).unwrap(), None);
+        assert_eq!(target.objects().get(objects[7].id()).unwrap(), Some(objects[7].clone()));
+    }
+
+    #[tokio::test]
+    async fn test_state_tree_starts_from_stored_objects() {
+        let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+        let object = |seed: u8| UnitsObject::new_data(UnitsObjectId::new([seed; 32]), UnitsObjectId::new([0; 32]), vec![seed; 16]);
+        for seed in 1..=5u8 {
+            storage.objects().set(&object(seed), None).unwrap();
+        }
+        storage.objects().delete(object(5).id(), None).unwrap();
+        let service = ProofService::new(storage.clone(), Arc::new(MockRuntime::new())).unwrap();
+        assert_eq!(service.generator.state_root().await.1, 4);
+
+        // A slot touching one object still commits to every live one
+        let mut receipt = TransactionReceipt::new([1u8; 32], 0, true, 0);
+        let proof = storage.objects().set(&object(1), Some(receipt.transaction_hash)).unwrap();
+        receipt.add_proof(*object(1).id(), proof.clone());
+        let state_proof = service.finalize_slot(proof.slot, &[receipt]).await.unwrap();
+
+        let dir = tempfile::tempdir().unwrap();
+        assert_eq!(storage.export_snapshot(dir.path(), proof.slot).unwrap().object_count, 4);
+        let (_, membership) = service.get_state_inclusion_proof(object(3).id()).await.unwrap();
+        let leaf = ProofEngine::object_leaf(&storage.proofs().get_latest_proof(object(3).id()).unwrap().unwrap());
+        assert!(membership.verify(&ProofEngine::new().state_root(&state_proof).unwrap(), object(3).id(), Some(&leaf)));
+    }
+
+    #[tokio::test]
+    async fn test_inclusion_paths_reuse_blocks_hashed_by_the_slot_proof() {
+        let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+        let service = ProofService::new(storage, Arc::new(MockRuntime::new())).unwrap();
+
+        // Three full cached blocks and a partial one
+        let receipts: Vec<TransactionReceipt> = (0..200u32)
+            .map(|i| TransactionReceipt::new(hash_bytes(&i.to_le_bytes()), 1, true, 0))
+            .collect();
+        let hashes: Vec<TransactionHash> = receipts.iter().map(|receipt| receipt.transaction_hash).collect();
+        let state_proof = service.finalize_slot(1, &receipts).await.unwrap();
+        let proven = service.generator.merkle_cache.stats();
+        assert_eq!((proven.hits, proven.misses), (0, 3));
+
+        let path = service.get_transaction_inclusion_path(&hashes, &hashes[150]).await.unwrap().unwrap();
+        assert!(ProofEngine::new().verify_transaction_inclusion(&state_proof, &hashes[150], &hashes, &path).unwrap());
+        let stats = service.generator.merkle_cache.stats();
+        assert_eq!((stats.hits, stats.misses), (3, 3));
+    }
+}
@@ -2,22 +2,41 @@
 //!
 //! This service handles slot timing, transitions, and coordination
 //! between transaction execution and proof generation.
-
-use std::sync::Arc;
+//!
+//! Slot advancement is pipelined: the closing slot's receipts are sealed
+//! into an immutable batch and handed to a background proving stage, and the
+//! next slot opens without waiting for the proof. The proving queue is
+//! bounded, so advancement waits once `proving_queue_depth` slots are
+//! sealed but not yet proven. `SlotEvent::SlotFinalized` is emitted when a
+//! slot's proof has been stored. A slot whose proof fails is reported with
+//! `SlotEvent::SlotFailed` and retried, keeping its receipts, before any
+//! later slot is proven.
+//!
+//! A sealed slot's proof is due before the slot after it closes, i.e.
+//! within one slot duration of sealing; how far past that it lands is
+//! recorded as the slot finalize overrun.
+
+use std::future::Future;
+use std::pin::Pin;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
 use std::time::{Duration, Instant};
-use tokio::sync::{RwLock, broadcast};
+use tokio::sync::{RwLock, broadcast, mpsc, oneshot};
 use tokio::time::{interval, MissedTickBehavior};
+use serde::Serialize;
 
 use units_core_types::{
     SlotNumber, TransactionReceipt, StateProof,
 };
 
-use crate::error::ServiceResult;
+use crate::error::{ServiceError, ServiceResult};
+use crate::metrics::{metrics, Stage};
 use super::transaction_service::TransactionService;
 use super::proof_service::ProofService;
 
 /// Slot transition event
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, Serialize)]
+#[serde(tag = "type", rename_all = "camelCase", rename_all_fields = "camelCase")]
 pub enum SlotEvent {
     /// New slot started
     SlotStarted {
@@ -53,6 +72,8 @@ pub struct SlotConfig {
     pub auto_advance: bool,
     /// Grace period for late transactions (ms)
     pub grace_period_ms: u64,
+    /// Sealed slots allowed to wait for proving before advancement blocks
+    pub proving_queue_depth: usize,
 }
 
 impl Default for SlotConfig {
@@ -62,6 +83,7 @@ impl Default for SlotConfig {
             max_transactions_per_slot: 1000,
             auto_advance: true,
             grace_period_ms: 100,
+            proving_queue_depth: 4,
         }
     }
 }
@@ -75,13 +97,147 @@ struct SlotState {
     finalized: bool,
 }
 
+/// A closed slot's receipts, waiting to be proven
+struct SealedSlot {
+    slot: SlotNumber,
+    receipts: Vec<TransactionReceipt>,
+    /// When the slot was handed to the prover; its proof is due a slot duration later
+    sealed_at: Instant,
+    /// Caller waiting for this slot's proof, if any
+    reply: Option<oneshot::Sender<ServiceResult<StateProof>>>,
+}
+
+/// Proves a sealed slot's receipts and stores the proof; `ProofService` outside tests
+trait SlotProver: Send + Sync + 'static {
+    fn prove_slot<'a>(
+        &'a self,
+        slot: SlotNumber,
+        receipts: &'a [TransactionReceipt],
+    ) -> Pin<Box<dyn Future<Output = ServiceResult<StateProof>> + Send + 'a>>;
+}
+
+impl SlotProver for ProofService {
+    fn prove_slot<'a>(
+        &'a self,
+        slot: SlotNumber,
+        receipts: &'a [TransactionReceipt],
+    ) -> Pin<Box<dyn Future<Output = ServiceResult<StateProof>> + Send + 'a>> {
+        Box::pin(self.finalize_slot(slot, receipts))
+    }
+}
+
+/// Background stage proving sealed slots in order
+struct ProvingStage {
+    queue: mpsc::Sender<SealedSlot>,
+    /// Taken by the prover task when it first starts
+    receiver: Mutex<Option<mpsc::Receiver<SealedSlot>>>,
+    /// Slots submitted but not yet proven
+    backlog: Arc<AtomicUsize>,
+    event_sender: broadcast::Sender<SlotEvent>,
+    prover: Arc<dyn SlotProver>,
+    /// Proof deadline after sealing, and the wait before retrying a failed proof
+    slot_duration: Duration,
+}
+
+impl ProvingStage {
+    fn new(
+        depth: usize,
+        slot_duration: Duration,
+        event_sender: broadcast::Sender<SlotEvent>,
+        prover: Arc<dyn SlotProver>,
+    ) -> Self {
+        let (queue, receiver) = mpsc::channel(depth.max(1));
+        Self {
+            queue,
+            receiver: Mutex::new(Some(receiver)),
+            backlog: Arc::new(AtomicUsize::new(0)),
+            event_sender,
+            prover,
+            slot_duration,
+        }
+    }
+
+    /// Reserve a place at the back of the queue, waiting while it is full
+    ///
+    /// Callers reserve while holding the slot state lock, so slots enter the
+    /// queue in the order they were sealed.
+    async fn reserve(&self) -> ServiceResult<mpsc::Permit<'_, SealedSlot>> {
+        self.ensure_running();
+        self.queue
+            .reserve()
+            .await
+            .map_err(|_| ServiceError::service_unavailable("slot proving stage has stopped"))
+    }
+
+    /// Queue a sealed slot in a reserved place
+    fn submit(&self, permit: mpsc::Permit<'_, SealedSlot>, sealed: SealedSlot) {
+        self.backlog.fetch_add(1, Ordering::Relaxed);
+        permit.send(sealed);
+    }
+
+    /// Spawn the prover task on first use
+    fn ensure_running(&self) {
+        let Some(mut receiver) = self.receiver.lock().unwrap().take() else {
+            return;
+        };
+        let backlog = self.backlog.clone();
+        let event_sender = self.event_sender.clone();
+        let prover = self.prover.clone();
+        let slot_duration = self.slot_duration;
+
+        tokio::spawn(async move {
+            // One slot at a time, so each proof can link to the previous one
+            while let Some(mut sealed) = receiver.recv().await {
+                let slot = sealed.slot;
+                // A failed slot is retried before moving on: later proofs link
+                // to it, and the sealed batch holds its only copy of the receipts
+                loop {
+                    let started = Instant::now();
+                    let result = prover.prove_slot(slot, &sealed.receipts).await;
+                    metrics().observe(Stage::Proof, started.elapsed());
+                    match result {
+                        Ok(proof) => {
+                            let overrun = sealed.sealed_at.elapsed().saturating_sub(slot_duration);
+                            metrics().observe(Stage::SlotFinalizeOverrun, overrun);
+                            let _ = event_sender.send(SlotEvent::SlotFinalized {
+                                slot,
+                                proof: proof.clone(),
+                            });
+                            if let Some(reply) = sealed.reply.take() {
+                                let _ = reply.send(Ok(proof));
+                            }
+                            break;
+                        }
+                        Err(e) => {
+                            log::error!("Failed to prove slot {}, retrying: {:?}", slot, e);
+                            let _ = event_sender.send(SlotEvent::SlotFailed {
+                                slot,
+                                error: e.to_string(),
+                            });
+                            if let Some(reply) = sealed.reply.take() {
+                                let _ = reply.send(Err(e));
+                            }
+                            tokio::time::sleep(slot_duration).await;
+                        }
+                    }
+                }
+                backlog.fetch_sub(1, Ordering::Relaxed);
+            }
+        });
+    }
+
+    fn backlog(&self) -> usize {
+        self.backlog.load(Ordering::Relaxed)
+    }
+}
+
 /// Slot manager for coordinating slot transitions
 pub struct SlotManager {
     config: SlotConfig,
     state: Arc<RwLock<SlotState>>,
     event_sender: broadcast::Sender<SlotEvent>,
     transaction_service: Arc<TransactionService>,
-    proof_service: Arc<ProofService>,
+    proving: Arc<ProvingStage>,
 }
 
 impl SlotManager {
@@ -89,23 +245,38 @@ impl SlotManager {
         config: SlotConfig,
         transaction_service: Arc<TransactionService>,
         proof_service: Arc<ProofService>,
+    ) -> (Self, broadcast::Receiver<SlotEvent>) {
+        Self::with_prover(config, transaction_service, proof_service)
+    }
+
+    fn with_prover(
+        config: SlotConfig,
+        transaction_service: Arc<TransactionService>,
+        prover: Arc<dyn SlotProver>,
     ) -> (Self, broadcast::Receiver<SlotEvent>) {
         let (event_sender, event_receiver) = broadcast::channel(100);
         
         let state = Arc::new(RwLock::new(SlotState {
-            current_slot: 0,
+            current_slot: transaction_service.first_slot(),
             slot_start_time: Instant::now(),
             slot_start_timestamp: chrono::Utc::now().timestamp() as u64,
             receipts: Vec::new(),
             finalized: false,
         }));
         
+        let proving = Arc::new(ProvingStage::new(
+            config.proving_queue_depth,
+            Duration::from_millis(config.slot_duration_ms),
+            event_sender.clone(),
+            prover,
+        ));
+
         let manager = Self {
             config,
             state,
             event_sender,
             transaction_service,
-            proof_service,
+            proving,
         };
         
         (manager, event_receiver)
@@ -121,7 +292,7 @@ impl SlotManager {
         let config = self.config.clone();
         let event_sender = self.event_sender.clone();
         let transaction_service = self.transaction_service.clone();
-        let proof_service = self.proof_service.clone();
+        let proving = self.proving.clone();
 
         tokio::spawn(async move {
             let mut ticker = interval(Duration::from_millis(config.slot_duration_ms));
@@ -136,7 +307,7 @@ impl SlotManager {
                     &config,
                     &event_sender,
                     &transaction_service,
-                    &proof_service,
+                    &proving,
                 ).await {
                     log::error!("Failed to advance slot: {:?}", e);
                 }
@@ -153,48 +324,41 @@ impl SlotManager {
             &self.config,
             &self.event_sender,
             &self.transaction_service,
-            &self.proof_service,
+            &self.proving,
         ).await
     }
 
     /// Internal slot advancement logic
+    ///
+    /// Seals the current slot and opens the next one under a single write
+    /// lock, which is held while the proving queue is full; proving happens
+    /// in the background stage. The transaction service moves to the new
+    /// slot under the same lock, so the two never disagree on the slot.
     async fn advance_slot_internal(
         state: &Arc<RwLock<SlotState>>,
         config: &SlotConfig,
         event_sender: &broadcast::Sender<SlotEvent>,
         transaction_service: &Arc<TransactionService>,
-        proof_service: &Arc<ProofService>,
+        proving: &Arc<ProvingStage>,
     ) -> ServiceResult<SlotNumber> {
-        // Finalize current slot
-        {
+        let new_slot = {
             let mut slot_state = state.write().await;
-            if !slot_state.finalized {
-                let current = slot_state.current_slot;
-                let receipts = slot_state.receipts.clone();
-                
-                // Generate and store proof
-                match proof_service.finalize_slot(current, receipts).await {
-                    Ok(proof) => {
-                        let _ = event_sender.send(SlotEvent::SlotFinalized {
-                            slot: current,
-                            proof,
-                        });
-                        slot_state.finalized = true;
-                    }
-                    Err(e) => {
-                        let _ = event_sender.send(SlotEvent::SlotFailed {
-                            slot: current,
-                            error: e.to_string(),
-                        });
-                        return Err(e);
-                    }
-                }
+
+            // Hold the slot's place in the proving queue before changing anything
+            let permit = if slot_state.finalized { None } else { Some(proving.reserve().await?) };
+            transaction_service.advance_slot().await?;
+
+            // Seal the current slot unless it was already finalized
+            if let Some(permit) = permit {
+                proving.submit(permit, SealedSlot {
+                    slot: slot_state.current_slot,
+                    receipts: std::mem::take(&mut slot_state.receipts),
+                    sealed_at: Instant::now(),
+                    reply: None,
+                });
             }
-        }
 
-        // Start new slot
-        let new_slot = {
-            let mut slot_state = state.write().await;
+            // Start new slot
             slot_state.current_slot += 1;
             slot_state.slot_start_time = Instant::now();
             slot_state.slot_start_timestamp = chrono::Utc::now().timestamp() as u64;
@@ -213,9 +377,6 @@ impl SlotManager {
             new_slot
         };
 
-        // Update transaction service slot
-        transaction_service.advance_slot().await?;
-
         // Execute pending transactions for new slot
         tokio::spawn({
             let state = state.clone();
@@ -228,7 +389,7 @@ impl SlotManager {
                 tokio::time::sleep(Duration::from_millis(config.grace_period_ms)).await;
                 
                 // Execute transactions
-                match transaction_service.execute_slot_transactions().await {
+                match transaction_service.execute_slot_transactions(config.max_transactions_per_slot).await {
                     Ok(receipts) => {
                         let transaction_count = receipts.len();
                         let success_count = receipts.iter().filter(|r| r.success).count();
@@ -273,29 +434,32 @@ impl SlotManager {
             remaining_ms: self.config.slot_duration_ms.saturating_sub(elapsed.as_millis() as u64),
             transaction_count: state.receipts.len(),
             finalized: state.finalized,
+            proving_backlog: self.proving.backlog(),
         }
     }
 
     /// Force finalize current slot
+    ///
+    /// The slot stays open, but is proven through the same queue as sealed
+    /// slots so proofs stay in slot order. Waits for the proof, or for its
+    /// first failure; a failed slot keeps being retried in the background.
     pub async fn finalize_current_slot(&self) -> ServiceResult<StateProof> {
-        let (slot, receipts) = {
-            let state = self.state.read().await;
-            (state.current_slot, state.receipts.clone())
-        };
-
-        let proof = self.proof_service.finalize_slot(slot, receipts).await?;
-        
+        let (reply, result) = oneshot::channel();
         {
             let mut state = self.state.write().await;
+            let permit = self.proving.reserve().await?;
             state.finalized = true;
+            self.proving.submit(permit, SealedSlot {
+                slot: state.current_slot,
+                receipts: state.receipts.clone(),
+                sealed_at: Instant::now(),
+                reply: Some(reply),
+            });
         }
 
-        let _ = self.event_sender.send(SlotEvent::SlotFinalized {
-            slot,
-            proof: proof.clone(),
-        });
-
-        Ok(proof)
+        result
+            .await
+            .map_err(|_| ServiceError::service_unavailable("slot proving stage has stopped"))?
     }
 }
 
@@ -307,6 +471,8 @@ pub struct SlotInfo {
     pub remaining_ms: u64,
     pub transaction_count: usize,
     pub finalized: bool,
+    /// Sealed slots waiting for their proofs
+    pub proving_backlog: usize,
 }
 
 /// Main slot service providing high-level slot management
@@ -363,6 +529,11 @@ impl SlotService {
         self.manager.event_sender.subscribe()
     }
 
+    /// Sender slot events are published on, for feeding other subscribers
+    pub fn event_sender(&self) -> broadcast::Sender<SlotEvent> {
+        self.manager.event_sender.clone()
+    }
+
     /// Wait for next slot event
     pub async fn next_event(&self) -> Option<SlotEvent> {
         let mut receiver = self.event_receiver.write().await;
@@ -388,4 +559,150 @@ pub struct SlotStats {
     pub slot_duration_ms: u64,
     pub auto_advance: bool,
     pub max_transactions_per_slot: usize,
-}
\ No newline at end of file
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tokio::sync::Semaphore;
+    use tokio::time::timeout;
+    use units_runtime_impl::MockRuntime;
+    use units_storage_impl::ConsolidatedUnitsStorage;
+
+    /// Longest a test waits for the prover before failing
+    const PATIENCE: Duration = Duration::from_secs(5);
+
+    /// Prover that waits for a `gate` permit per attempt and fails the first `failures` attempts
+    struct TestProver {
+        gate: Semaphore,
+        failures: AtomicUsize,
+        /// Slot and receipt count of every successful proof
+        proven: Mutex<Vec<(SlotNumber, usize)>>,
+    }
+
+    impl TestProver {
+        fn new(permits: usize, failures: usize) -> Arc<Self> {
+            Arc::new(Self {
+                gate: Semaphore::new(permits),
+                failures: AtomicUsize::new(failures),
+                proven: Mutex::new(Vec::new()),
+            })
+        }
+    }
+
+    impl SlotProver for TestProver {
+        fn prove_slot<'a>(
+            &'a self,
+            slot: SlotNumber,
+            receipts: &'a [TransactionReceipt],
+        ) -> Pin<Box<dyn Future<Output = ServiceResult<StateProof>> + Send + 'a>> {
+            Box::pin(async move {
+                self.gate.acquire().await.unwrap().forget();
+                if self.failures.fetch_update(Ordering::AcqRel, Ordering::Acquire, |n| n.checked_sub(1)).is_ok() {
+                    return Err(ServiceError::service_unavailable("prover offline"));
+                }
+                self.proven.lock().unwrap().push((slot, receipts.len()));
+                Ok(StateProof::new(slot, Vec::new(), Vec::new(), None))
+            })
+        }
+    }
+
+    fn manager(depth: usize, prover: Arc<TestProver>) -> SlotManager {
+        let config = SlotConfig {
+            slot_duration_ms: 10,
+            max_transactions_per_slot: 10,
+            auto_advance: false,
+            grace_period_ms: 0,
+            proving_queue_depth: depth,
+        };
+        let runtime: Arc<dyn units_core_types::Runtime + Send + Sync> = Arc::new(MockRuntime::new());
+        let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+        let transaction_service = Arc::new(TransactionService::new(runtime, storage, 16));
+        SlotManager::with_prover(config, transaction_service, prover).0
+    }
+
+    /// Next finalized or failed slot event
+    async fn next_proof_event(events: &mut broadcast::Receiver<SlotEvent>) -> SlotEvent {
+        timeout(PATIENCE, async {
+            loop {
+                match events.recv().await.unwrap() {
+                    event @ (SlotEvent::SlotFinalized { .. } | SlotEvent::SlotFailed { .. }) => return event,
+                    _ => continue,
+                }
+            }
+        })
+        .await
+        .expect("prover made no progress")
+    }
+
+    #[tokio::test]
+    async fn test_full_proving_queue_holds_back_advancement() {
+        let prover = TestProver::new(0, 0);
+        let manager = manager(1, prover.clone());
+
+        // Slot 0 is taken by the blocked prover and slot 1 fills the queue
+        manager.advance_slot().await.unwrap();
+        manager.advance_slot().await.unwrap();
+        assert!(timeout(Duration::from_millis(50), manager.advance_slot()).await.is_err());
+        assert_eq!(manager.current_slot().await, 2);
+        assert_eq!(manager.transaction_service.current_slot().await, 2);
+        assert_eq!(manager.get_slot_info().await.proving_backlog, 2);
+
+        prover.gate.add_permits(3);
+        assert_eq!(timeout(PATIENCE, manager.advance_slot()).await.unwrap().unwrap(), 3);
+        assert_eq!(manager.transaction_service.current_slot().await, 3);
+    }
+
+    #[tokio::test]
+    async fn test_slots_are_proven_in_order() {
+        let prover = TestProver::new(usize::MAX >> 4, 0);
+        let manager = manager(2, prover.clone());
+        let mut events = manager.event_sender.subscribe();
+
+        for _ in 0..6 {
+            manager.advance_slot().await.unwrap();
+        }
+        for expected in 0..6 {
+            match next_proof_event(&mut events).await {
+                SlotEvent::SlotFinalized { slot, .. } => assert_eq!(slot, expected),
+                event => panic!("unexpected {:?}", event),
+            }
+        }
+        let proven: Vec<SlotNumber> = prover.proven.lock().unwrap().iter().map(|(slot, _)| *slot).collect();
+        assert_eq!(proven, (0..6).collect::<Vec<_>>());
+    }
+
+    #[tokio::test]
+    async fn test_failed_proof_is_retried_with_its_receipts() {
+        let prover = TestProver::new(usize::MAX >> 4, 1);
+        let manager = manager(2, prover.clone());
+        let mut events = manager.event_sender.subscribe();
+
+        manager.state.write().await.receipts = (0..3u8)
+            .map(|index| TransactionReceipt::new([index; 32], 0, true, 0))
+            .collect();
+        manager.advance_slot().await.unwrap();
+        manager.advance_slot().await.unwrap();
+
+        assert!(matches!(next_proof_event(&mut events).await, SlotEvent::SlotFailed { slot: 0, .. }));
+        assert!(matches!(next_proof_event(&mut events).await, SlotEvent::SlotFinalized { slot: 0, .. }));
+        assert!(matches!(next_proof_event(&mut events).await, SlotEvent::SlotFinalized { slot: 1, .. }));
+        assert_eq!(*prover.proven.lock().unwrap(), vec![(0, 3), (1, 0)]);
+    }
+
+    #[tokio::test]
+    async fn test_finalize_current_slot_reports_failure_and_keeps_retrying() {
+        let prover = TestProver::new(usize::MAX >> 4, 1);
+        let manager = manager(2, prover.clone());
+        let mut events = manager.event_sender.subscribe();
+
+        assert!(manager.finalize_current_slot().await.is_err());
+        assert!(matches!(next_proof_event(&mut events).await, SlotEvent::SlotFailed { slot: 0, .. }));
+        assert!(matches!(next_proof_event(&mut events).await, SlotEvent::SlotFinalized { slot: 0, .. }));
+
+        // The retried proof stands, so the slot is not sealed again
+        manager.advance_slot().await.unwrap();
+        manager.finalize_current_slot().await.unwrap();
+        assert_eq!(*prover.proven.lock().unwrap(), vec![(0, 0), (1, 0)]);
+    }
+}
@@ -5,30 +5,22 @@
 
 use std::sync::Arc;
 use std::collections::HashMap;
-use tokio::sync::RwLock;
 
 use units_core_types::{
     UnitsStorage, ObjectStorage, ProofStorage, HistoricalStorage,
-    UnitsObjectId, UnitsObject, UnitsObjectProof,
+    UnitsObjectId, UnitsObject, UnitsObjectProof, ObjectPage, ObjectType,
     SlotNumber, StateProof, TransactionHash,
 };
 use units_storage_impl::ConsolidatedUnitsStorage;
 
 use crate::error::{ServiceError, ServiceResult};
-
-/// Object cache entry
-#[derive(Clone)]
-struct CacheEntry {
-    object: UnitsObject,
-    last_access: std::time::Instant,
-}
+pub use super::object_cache::{CacheStats, DEFAULT_CACHE_BYTES};
+use super::object_cache::ObjectCache;
 
 /// Object manager with caching and validation
 pub struct ObjectManager {
     storage: Arc<ConsolidatedUnitsStorage>,
-    cache: Arc<RwLock<HashMap<UnitsObjectId, CacheEntry>>>,
-    cache_size: usize,
-    cache_ttl: std::time::Duration,
+    cache: ObjectCache,
 }
 
 impl ObjectManager {
@@ -36,19 +28,28 @@ impl ObjectManager {
         storage: Arc<ConsolidatedUnitsStorage>,
         cache_size: usize,
         cache_ttl_secs: u64,
+    ) -> Self {
+        Self::with_cache_limits(storage, cache_size, DEFAULT_CACHE_BYTES, cache_ttl_secs)
+    }
+
+    /// Create a manager whose cache holds at most `cache_size` objects and
+    /// roughly `cache_bytes` bytes of them
+    pub fn with_cache_limits(
+        storage: Arc<ConsolidatedUnitsStorage>,
+        cache_size: usize,
+        cache_bytes: usize,
+        cache_ttl_secs: u64,
     ) -> Self {
         Self {
             storage,
-            cache: Arc::new(RwLock::new(HashMap::new())),
-            cache_size,
-            cache_ttl: std::time::Duration::from_secs(cache_ttl_secs),
+            cache: ObjectCache::new(cache_size, cache_bytes, std::time::Duration::from_secs(cache_ttl_secs)),
         }
     }
 
     /// Get object with caching
     pub async fn get_object(&self, id: &UnitsObjectId) -> ServiceResult<UnitsObject> {
         // Check cache first
-        if let Some(object) = self.get_from_cache(id).await {
+        if let Some(object) = self.cache.get(id) {
             return Ok(object);
         }
 
@@ -60,7 +61,7 @@ impl ObjectManager {
             .ok_or_else(|| ServiceError::object_not_found(hex::encode(id.bytes())))?;
 
         // Add to cache
-        self.add_to_cache(id, object.clone()).await;
+        self.cache.insert(object.clone());
 
         Ok(object)
     }
@@ -81,7 +82,7 @@ impl ObjectManager {
             .map_err(ServiceError::Storage)?;
 
         // Update cache
-        self.add_to_cache(object.id(), object.clone()).await;
+        self.cache.insert(object);
 
         Ok(proof)
     }
@@ -93,7 +94,7 @@ impl ObjectManager {
         transaction_hash: Option<TransactionHash>,
     ) -> ServiceResult<UnitsObjectProof> {
         // Remove from cache
-        self.remove_from_cache(id).await;
+        self.cache.remove(id);
 
         // Delete from storage
         let proof = self.storage
@@ -105,24 +106,76 @@ impl ObjectManager {
     }
 
     /// Batch get objects
+    ///
+    /// Cached objects are served directly; the rest are read from storage
+    /// in a single `get_many` call. Missing objects are skipped.
     pub async fn get_objects(&self, ids: &[UnitsObjectId]) -> ServiceResult<HashMap<UnitsObjectId, UnitsObject>> {
-        let mut objects = HashMap::new();
-        
+        let mut objects = HashMap::with_capacity(ids.len());
+        let mut misses = Vec::new();
         for id in ids {
-            match self.get_object(id).await {
-                Ok(obj) => {
-                    objects.insert(*id, obj);
+            match self.cache.get(id) {
+                Some(object) => {
+                    objects.insert(*id, object);
                 }
-                Err(ServiceError::ObjectNotFound { .. }) => {
-                    // Skip missing objects
-                }
-                Err(e) => return Err(e),
+                None => misses.push(*id),
+            }
+        }
+        if misses.is_empty() {
+            return Ok(objects);
+        }
+
+        let loaded = self.storage
+            .objects()
+            .get_many(&misses)
+            .map_err(ServiceError::Storage)?;
+        for (id, object) in misses.into_iter().zip(loaded) {
+            if let Some(object) = object {
+                self.cache.insert(object.clone());
+                objects.insert(id, object);
             }
         }
 
         Ok(objects)
     }
 
+    /// Page of all objects after `cursor` in id order
+    pub async fn list_objects(
+        &self,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> ServiceResult<ObjectPage> {
+        self.storage
+            .objects()
+            .list(cursor, limit)
+            .map_err(ServiceError::Storage)
+    }
+
+    /// Page of objects controlled by `controller_id`, served from the storage index
+    pub async fn get_objects_by_controller(
+        &self,
+        controller_id: &UnitsObjectId,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> ServiceResult<ObjectPage> {
+        self.storage
+            .objects()
+            .get_by_controller(controller_id, cursor, limit)
+            .map_err(ServiceError::Storage)
+    }
+
+    /// Page of objects of `object_type`, served from the storage index
+    pub async fn get_objects_by_type(
+        &self,
+        object_type: &ObjectType,
+        cursor: Option<&UnitsObjectId>,
+        limit: usize,
+    ) -> ServiceResult<ObjectPage> {
+        self.storage
+            .objects()
+            .get_by_type(object_type, cursor, limit)
+            .map_err(ServiceError::Storage)
+    }
+
     /// Get object at specific slot (historical query)
     pub async fn get_object_at_slot(
         &self,
@@ -137,56 +190,12 @@ impl ObjectManager {
 
     /// Clear cache
     pub async fn clear_cache(&self) {
-        self.cache.write().await.clear();
+        self.cache.clear();
     }
 
     /// Get cache statistics
     pub async fn cache_stats(&self) -> CacheStats {
-        let cache = self.cache.read().await;
-        CacheStats {
-            size: cache.len(),
-            max_size: self.cache_size,
-            ttl_secs: self.cache_ttl.as_secs(),
-        }
-    }
-
-    // Cache management helpers
-    async fn get_from_cache(&self, id: &UnitsObjectId) -> Option<UnitsObject> {
-        let mut cache = self.cache.write().await;
-        
-        if let Some(entry) = cache.get_mut(id) {
-            if entry.last_access.elapsed() < self.cache_ttl {
-                entry.last_access = std::time::Instant::now();
-                return Some(entry.object.clone());
-            } else {
-                // Entry expired
-                cache.remove(id);
-            }
-        }
-        
-        None
-    }
-
-    async fn add_to_cache(&self, id: &UnitsObjectId, object: UnitsObject) {
-        let mut cache = self.cache.write().await;
-        
-        // Evict oldest entry if cache is full
-        if cache.len() >= self.cache_size {
-            if let Some(oldest_id) = cache.iter()
-                .min_by_key(|(_, entry)| entry.last_access)
-                .map(|(id, _)| *id) {
-                cache.remove(&oldest_id);
-            }
-        }
-        
-        cache.insert(*id, CacheEntry {
-            object,
-            last_access: std::time::Instant::now(),
-        });
-    }
-
-    async fn remove_from_cache(&self, id: &UnitsObjectId) {
-        self.cache.write().await.remove(id);
+        self.cache.stats()
     }
 
     fn validate_object(&self, object: &UnitsObject) -> ServiceResult<()> {
@@ -215,13 +224,6 @@ impl ObjectManager {
     }
 }
 
-#[derive(Debug, Clone)]
-pub struct CacheStats {
-    pub size: usize,
-    pub max_size: usize,
-    pub ttl_secs: u64,
-}
-
 /// Main storage service that provides unified access to all storage operations
 pub struct StorageService {
     storage: Arc<ConsolidatedUnitsStorage>,
@@ -234,9 +236,20 @@ impl StorageService {
         cache_size: usize,
         cache_ttl_secs: u64,
     ) -> Self {
-        let object_manager = Arc::new(ObjectManager::new(
+        Self::with_cache_limits(storage, cache_size, DEFAULT_CACHE_BYTES, cache_ttl_secs)
+    }
+
+    /// Create a storage service with an explicit object cache byte budget
+    pub fn with_cache_limits(
+        storage: Arc<ConsolidatedUnitsStorage>,
+        cache_size: usize,
+        cache_bytes: usize,
+        cache_ttl_secs: u64,
+    ) -> Self {
+        let object_manager = Arc::new(ObjectManager::with_cache_limits(
             storage.clone(),
             cache_size,
+            cache_bytes,
             cache_ttl_secs,
         ));
 
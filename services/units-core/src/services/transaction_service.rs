@@ -3,82 +3,223 @@
 //! This service handles transaction submission, validation, execution,
 //! and coordination with the runtime and storage layers.
 
-use std::collections::HashMap;
-use std::sync::Arc;
+use std::cmp::Reverse;
+use std::collections::{BTreeMap, HashMap, HashSet};
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
 use tokio::sync::RwLock;
 
 use units_core_types::{
-    Runtime, ObjectStorage,
+    Runtime, ObjectStorage, ReceiptStorage, UnitsStorage,
     Transaction, TransactionHash, TransactionReceipt,
-    ConflictResult,
+    ConflictResult, ConflictChecker, BasicConflictChecker, ConflictGraph, IndexedConflictChecker,
     UnitsObjectId, UnitsObject, SlotNumber,
 };
 use units_storage_impl::ConsolidatedUnitsStorage;
 
 use crate::error::{ServiceError, ServiceResult};
+use crate::metrics::{metrics, Stage};
+
+/// Number of independently locked pool shards
+const POOL_SHARDS: usize = 16;
+
+/// Default number of pending transactions writing any one object in a slot batch
+pub const DEFAULT_MAX_WRITES_PER_OBJECT: usize = 64;
+
+/// Default number of slots of receipts kept behind the current slot
+pub const DEFAULT_RECEIPT_RETENTION_SLOTS: SlotNumber = 1024;
+
+/// Drain position of a pending transaction: highest priority first, then earliest arrival
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord)]
+struct PoolKey {
+    priority: Reverse<u64>,
+    arrival: u64,
+}
+
+struct PoolEntry {
+    transaction: Transaction,
+    key: PoolKey,
+}
+
+/// One shard of the pool: its transactions by hash, plus their drain order
+#[derive(Default)]
+struct PoolShard {
+    entries: HashMap<TransactionHash, PoolEntry>,
+    order: BTreeMap<PoolKey, TransactionHash>,
+}
+
+impl PoolShard {
+    fn remove(&mut self, hash: &TransactionHash) -> Option<PoolEntry> {
+        let entry = self.entries.remove(hash)?;
+        self.order.remove(&entry.key);
+        Some(entry)
+    }
+}
+
+/// Transactions taken from the pool for one slot
+#[derive(Debug, Default)]
+pub struct SlotBatch {
+    /// Transactions to execute, in drain order
+    pub transactions: Vec<Transaction>,
+    /// Candidates left in the pool because they write an object already at its per-batch limit
+    pub deferred: usize,
+}
 
 /// Transaction pool for managing pending transactions
+///
+/// Transactions are spread over `POOL_SHARDS` shards by hash, each behind
+/// its own lock, so concurrent submissions only meet when they hash to the
+/// same shard. A drain holds each shard lock while it copies that shard's
+/// head keys and again while it removes a picked entry, never across shards.
+/// Pool size and arrival order are kept in atomics, so a full pool rejects a
+/// new transaction after a single shard lookup.
 pub struct TransactionPool {
-    /// Pending transactions waiting for execution
-    pending: RwLock<HashMap<TransactionHash, Transaction>>,
-    /// Transaction receipts by hash
-    receipts: RwLock<HashMap<TransactionHash, TransactionReceipt>>,
+    shards: Vec<Mutex<PoolShard>>,
+    /// Pending transactions across all shards, including reserved intake slots
+    len: AtomicUsize,
+    /// Arrival sequence, breaking ties between equal priorities
+    arrivals: AtomicU64,
     /// Maximum pool size
     max_pool_size: usize,
+    /// Transactions writing the same object admitted to one slot batch
+    max_writes_per_object: usize,
 }
 
 impl TransactionPool {
     pub fn new(max_pool_size: usize) -> Self {
         Self {
-            pending: RwLock::new(HashMap::new()),
-            receipts: RwLock::new(HashMap::new()),
+            shards: (0..POOL_SHARDS).map(|_| Mutex::new(PoolShard::default())).collect(),
+            len: AtomicUsize::new(0),
+            arrivals: AtomicU64::new(0),
             max_pool_size,
+            max_writes_per_object: DEFAULT_MAX_WRITES_PER_OBJECT,
         }
     }
 
-    /// Add transaction to pool
-    pub async fn add_transaction(&self, transaction: Transaction) -> ServiceResult<TransactionHash> {
+    /// Override how many transactions writing one object a slot batch may hold
+    pub fn with_max_writes_per_object(mut self, max_writes_per_object: usize) -> Self {
+        self.max_writes_per_object = max_writes_per_object.max(1);
+        self
+    }
+
+    fn shard(&self, hash: &TransactionHash) -> &Mutex<PoolShard> {
+        let mut prefix = [0u8; 8];
+        prefix.copy_from_slice(&hash[..8]);
+        &self.shards[(u64::from_le_bytes(prefix) % self.shards.len() as u64) as usize]
+    }
+
+    /// Add transaction to pool at the default priority
+    pub fn add_transaction(&self, transaction: Transaction) -> ServiceResult<TransactionHash> {
+        self.add_transaction_with_priority(transaction, 0)
+    }
+
+    /// Add transaction to pool, ahead of every pending transaction of lower priority
+    ///
+    /// Resubmitting a pending transaction replaces it and moves it to the
+    /// back of its new priority.
+    pub fn add_transaction_with_priority(
+        &self,
+        transaction: Transaction,
+        priority: u64,
+    ) -> ServiceResult<TransactionHash> {
         let hash = transaction.hash;
-        
-        let mut pending = self.pending.write().await;
-        if pending.len() >= self.max_pool_size {
-            return Err(ServiceError::service_unavailable("Transaction pool is full").into());
+        let mut shard = self.shard(&hash).lock().unwrap();
+
+        // A replacement takes over its own slot, so only a new entry needs room
+        if shard.remove(&hash).is_none() {
+            let reserved = self.len.fetch_update(Ordering::AcqRel, Ordering::Acquire, |len| {
+                (len < self.max_pool_size).then_some(len + 1)
+            });
+            if reserved.is_err() {
+                return Err(ServiceError::service_unavailable("Transaction pool is full").into());
+            }
         }
-        
-        pending.insert(hash, transaction);
+
+        let key = PoolKey {
+            priority: Reverse(priority),
+            arrival: self.arrivals.fetch_add(1, Ordering::Relaxed),
+        };
+        shard.order.insert(key, hash);
+        shard.entries.insert(hash, PoolEntry { transaction, key });
         Ok(hash)
     }
 
     /// Get transaction from pool
-    pub async fn get_transaction(&self, hash: &TransactionHash) -> Option<Transaction> {
-        self.pending.read().await.get(hash).cloned()
+    pub fn get_transaction(&self, hash: &TransactionHash) -> Option<Transaction> {
+        let shard = self.shard(hash).lock().unwrap();
+        shard.entries.get(hash).map(|entry| entry.transaction.clone())
     }
 
     /// Remove transaction from pool
-    pub async fn remove_transaction(&self, hash: &TransactionHash) -> Option<Transaction> {
-        self.pending.write().await.remove(hash)
+    pub fn remove_transaction(&self, hash: &TransactionHash) -> Option<Transaction> {
+        let entry = self.shard(hash).lock().unwrap().remove(hash)?;
+        self.len.fetch_sub(1, Ordering::AcqRel);
+        Some(entry.transaction)
     }
 
-    /// Get all pending transactions
-    pub async fn get_pending_transactions(&self) -> Vec<Transaction> {
-        self.pending.read().await.values().cloned().collect()
+    /// Number of pending transactions
+    pub fn len(&self) -> usize {
+        self.len.load(Ordering::Acquire)
     }
 
-    /// Store transaction receipt
-    pub async fn store_receipt(&self, receipt: TransactionReceipt) {
-        self.receipts.write().await.insert(receipt.transaction_hash, receipt);
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
     }
 
-    /// Get transaction receipt
-    pub async fn get_receipt(&self, hash: &TransactionHash) -> Option<TransactionReceipt> {
-        self.receipts.read().await.get(hash).cloned()
+    /// Move up to `max_transactions` transactions out of the pool for one slot
+    ///
+    /// Transactions are taken in priority, then arrival, order across all
+    /// shards. A transaction writing an object that `max_writes_per_object`
+    /// earlier picks already write stays in the pool for a later slot,
+    /// keeping its place, which bounds the longest dependency chain the
+    /// scheduler has to run serially. At most `max_transactions` candidates
+    /// are considered from each shard.
+    pub fn drain_for_slot(&self, max_transactions: usize) -> SlotBatch {
+        let mut batch = SlotBatch::default();
+        if max_transactions == 0 {
+            return batch;
+        }
+
+        // Merge the heads of every shard; only keys are copied
+        let mut candidates = Vec::new();
+        for shard in &self.shards {
+            let shard = shard.lock().unwrap();
+            candidates.extend(shard.order.iter().take(max_transactions).map(|(key, hash)| (*key, *hash)));
+        }
+        candidates.sort_unstable();
+
+        let checker = BasicConflictChecker::new();
+        let mut writers: HashMap<UnitsObjectId, usize> = HashMap::new();
+        for (key, hash) in candidates {
+            if batch.transactions.len() >= max_transactions {
+                break;
+            }
+            let mut shard = self.shard(&hash).lock().unwrap();
+            // Skip candidates removed or resubmitted since the heads were read
+            let writes = match shard.entries.get(&hash) {
+                Some(entry) if entry.key == key => checker.extract_write_objects(&entry.transaction),
+                _ => continue,
+            };
+            if writes.iter().any(|id| writers.get(id).is_some_and(|count| *count >= self.max_writes_per_object)) {
+                batch.deferred += 1;
+                continue;
+            }
+
+            let entry = shard.remove(&hash).expect("candidate checked under the same lock");
+            drop(shard);
+            self.len.fetch_sub(1, Ordering::AcqRel);
+            for id in writes {
+                *writers.entry(id).or_default() += 1;
+            }
+            batch.transactions.push(entry.transaction);
+        }
+        batch
     }
 
     /// Get pool statistics
-    pub async fn get_stats(&self) -> PoolStats {
+    pub fn get_stats(&self) -> PoolStats {
         PoolStats {
-            pending_count: self.pending.read().await.len(),
-            receipt_count: self.receipts.read().await.len(),
+            pending_count: self.len(),
             max_pool_size: self.max_pool_size,
         }
     }
@@ -87,7 +228,6 @@ impl TransactionPool {
 #[derive(Debug, Clone)]
 pub struct PoolStats {
     pub pending_count: usize,
-    pub receipt_count: usize,
     pub max_pool_size: usize,
 }
 
@@ -95,6 +235,10 @@ pub struct PoolStats {
 pub struct TransactionExecutor {
     runtime: Arc<dyn Runtime + Send + Sync>,
     storage: Arc<ConsolidatedUnitsStorage>,
+    /// Pool scheduled batches run on; rayon's global pool when unset
+    pool: Option<Arc<rayon::ThreadPool>>,
+    /// Index of in-flight transactions for conflict detection
+    in_flight: IndexedConflictChecker,
 }
 
 impl TransactionExecutor {
@@ -102,88 +246,152 @@ impl TransactionExecutor {
         runtime: Arc<dyn Runtime + Send + Sync>,
         storage: Arc<ConsolidatedUnitsStorage>,
     ) -> Self {
-        Self { runtime, storage }
+        Self { runtime, storage, pool: None, in_flight: IndexedConflictChecker::new() }
+    }
+
+    /// Run batches on a dedicated pool of `workers` threads
+    ///
+    /// The pool lives as long as the executor and its idle threads park.
+    pub fn with_workers(mut self, workers: usize) -> ServiceResult<Self> {
+        let pool = rayon::ThreadPoolBuilder::new()
+            .num_threads(workers.max(1))
+            .thread_name(|i| format!("units-batch-{}", i))
+            .build()
+            .map_err(|e| ServiceError::Internal(anyhow::anyhow!("Failed to start batch workers: {}", e)))?;
+        self.pool = Some(Arc::new(pool));
+        Ok(self)
     }
 
     /// Execute a single transaction
     pub async fn execute_transaction(
         &self,
         transaction: Transaction,
-        _slot: SlotNumber,
-        _timestamp: u64,
+        slot: SlotNumber,
+        timestamp: u64,
     ) -> ServiceResult<TransactionReceipt> {
-        // Check for conflicts first
-        match self.runtime.check_conflicts(&transaction)? {
-            ConflictResult::Conflict(conflicts) => {
-                return Err(ServiceError::transaction_failed(
-                    format!("Transaction conflicts with: {:?}", conflicts)
-                ));
-            }
-            ConflictResult::ReadOnly => {
-                // Read-only transactions can proceed without locks
-            }
-            ConflictResult::NoConflict => {
-                // No conflicts, proceed with execution
-            }
-        }
+        self.execute_blocking(transaction, slot, timestamp)
+    }
 
-        // Gather all required objects for the transaction
-        let mut objects = HashMap::new();
-        for instruction in &transaction.instructions {
-            // Load controller object
-            let controller = self.load_object(&instruction.controller_id).await?;
-            objects.insert(instruction.controller_id, controller);
-
-            // Load target objects
-            for input_id in &instruction.target_objects {
-                if !objects.contains_key(input_id) {
-                    let obj = self.load_object(input_id).await?;
-                    objects.insert(*input_id, obj);
+    /// Evict in-flight entries for `slot` and earlier once the slot finalizes
+    pub fn finalize_slot(&self, slot: SlotNumber) -> usize {
+        self.in_flight.finalize_slot(slot)
+    }
+
+    /// Execute a single transaction on the calling thread
+    fn execute_blocking(
+        &self,
+        transaction: Transaction,
+        slot: SlotNumber,
+        timestamp: u64,
+    ) -> ServiceResult<TransactionReceipt> {
+        // Check for conflicts first, then admit against the in-flight index
+        let admitted = metrics().time(Stage::ConflictCheck, || {
+            Ok::<_, ServiceError>(match self.runtime.check_conflicts(&transaction)? {
+                ConflictResult::NoConflict | ConflictResult::ReadOnly => {
+                    self.in_flight.try_admit(&transaction, slot)
                 }
-            }
+                conflict => conflict,
+            })
+        })?;
+        if let ConflictResult::Conflict(conflicts) = admitted {
+            return Err(ServiceError::transaction_failed(
+                format!("Transaction conflicts with: {:?}", conflicts)
+            ));
         }
 
-        // Execute through runtime
-        let receipt = self.runtime.execute_transaction(transaction);
-
-        // Apply effects to storage if successful
-        if receipt.success {
-            for (object_id, proof) in &receipt.object_proofs {
-                // The proof contains the new state that was applied
-                // In a real implementation, we'd verify the proof here
-                let _ = object_id;
-                let _ = proof;
-            }
-        }
+        let hash = transaction.hash;
+        let result = metrics().time(Stage::Execute, || self.run_admitted(transaction, slot, timestamp));
+        self.in_flight.commit(&hash);
+        result
+    }
 
-        Ok(receipt)
+    /// Load inputs and run a transaction that has passed conflict admission
+    fn run_admitted(
+        &self,
+        transaction: Transaction,
+        slot: SlotNumber,
+        timestamp: u64,
+    ) -> ServiceResult<TransactionReceipt> {
+        // Gather all required objects for the transaction in one batched read,
+        // then hand them to the runtime so it does not fetch them again
+        let objects = self.load_objects(&transaction)?;
+        Ok(self.runtime.execute_transaction_with_objects(transaction, objects, slot, timestamp))
     }
 
     /// Execute a batch of transactions
+    ///
+    /// The batch is scheduled through a conflict graph: non-conflicting
+    /// transactions run in parallel on the executor's worker threads, and
+    /// conflicting ones run in hash order, so the outcome is deterministic.
+    /// Results are returned in that canonical (hash) order.
+    ///
+    /// Fails if the batch task itself dies (a panic inside the runtime); no
+    /// receipt of the batch has been stored then, and the caller still holds
+    /// `transactions` to put back in the pool.
     pub async fn execute_batch(
+        self: &Arc<Self>,
+        transactions: Arc<[Transaction]>,
+        slot: SlotNumber,
+        timestamp: u64,
+    ) -> ServiceResult<Vec<(TransactionHash, ServiceResult<TransactionReceipt>)>> {
+        let executor = Arc::clone(self);
+        tokio::task::spawn_blocking(move || executor.execute_scheduled(&transactions, slot, timestamp))
+            .await
+            .map_err(|e| ServiceError::Internal(anyhow::anyhow!("Batch execution task failed: {}", e)))
+    }
+
+    /// Schedule and execute a batch on the executor's pool
+    fn execute_scheduled(
         &self,
-        transactions: Vec<Transaction>,
+        transactions: &[Transaction],
         slot: SlotNumber,
         timestamp: u64,
-    ) -> Vec<ServiceResult<TransactionReceipt>> {
-        let mut results = Vec::new();
+    ) -> Vec<(TransactionHash, ServiceResult<TransactionReceipt>)> {
+        let graph = ConflictGraph::build(&BasicConflictChecker::new(), transactions);
+        let run = || {
+            graph.execute(|node| self.execute_blocking(transactions[node].clone(), slot, timestamp))
+        };
+        let results = match &self.pool {
+            Some(pool) => pool.install(run),
+            None => run(),
+        };
+        let mut results: Vec<Option<ServiceResult<TransactionReceipt>>> =
+            results.into_iter().map(Some).collect();
+
+        graph
+            .order()
+            .iter()
+            .map(|&node| {
+                let result = results[node].take().expect("each node appears once in the order");
+                (transactions[node].hash, result)
+            })
+            .collect()
+    }
 
-        for transaction in transactions {
-            let result = self.execute_transaction(transaction, slot, timestamp).await;
-            results.push(result);
+    /// Load every controller and target object the transaction's instructions name
+    ///
+    /// Fails with `ObjectNotFound` for the first missing id in instruction order.
+    fn load_objects(&self, transaction: &Transaction) -> ServiceResult<HashMap<UnitsObjectId, UnitsObject>> {
+        let mut ids = Vec::new();
+        for instruction in &transaction.instructions {
+            ids.push(instruction.controller_id);
+            ids.extend_from_slice(&instruction.target_objects);
         }
+        let mut seen = HashSet::with_capacity(ids.len());
+        ids.retain(|id| seen.insert(*id));
 
-        results
-    }
-
-    /// Load object from storage
-    async fn load_object(&self, id: &UnitsObjectId) -> ServiceResult<UnitsObject> {
-        use units_core_types::UnitsStorage;
-        self.storage
+        let loaded = self.storage
             .objects()
-            .get(id)
-            .map_err(ServiceError::Storage)?
-            .ok_or_else(|| ServiceError::object_not_found(hex::encode(id.bytes())))
+            .get_many(&ids)
+            .map_err(ServiceError::Storage)?;
+        ids.into_iter()
+            .zip(loaded)
+            .map(|(id, object)| {
+                object
+                    .map(|object| (id, object))
+                    .ok_or_else(|| ServiceError::object_not_found(hex::encode(id.bytes())))
+            })
+            .collect()
     }
 }
 
@@ -191,54 +399,102 @@ impl TransactionExecutor {
 pub struct TransactionService {
     pool: Arc<TransactionPool>,
     executor: Arc<TransactionExecutor>,
+    storage: Arc<ConsolidatedUnitsStorage>,
+    /// Slot the service started in
+    first_slot: SlotNumber,
     slot_number: Arc<RwLock<SlotNumber>>,
+    /// Slots of receipts kept in receipt storage behind the executing slot
+    receipt_retention_slots: SlotNumber,
 }
 
 impl TransactionService {
+    /// Create the service; it drives the slot storage stamps new proofs with
+    ///
+    /// Slots resume after the latest one recovered storage has a state proof for.
     pub fn new(
         runtime: Arc<dyn Runtime + Send + Sync>,
         storage: Arc<ConsolidatedUnitsStorage>,
         max_pool_size: usize,
     ) -> Self {
         let pool = Arc::new(TransactionPool::new(max_pool_size));
-        let executor = Arc::new(TransactionExecutor::new(runtime, storage));
+        let executor = Arc::new(TransactionExecutor::new(runtime, storage.clone()));
+        let first_slot = storage.inner().latest_state_slot().map_or(0, |slot| slot + 1);
+        storage.inner().slot_clock().set(first_slot);
         
         Self {
             pool,
             executor,
-            slot_number: Arc::new(RwLock::new(0)),
+            storage,
+            first_slot,
+            slot_number: Arc::new(RwLock::new(first_slot)),
+            receipt_retention_slots: DEFAULT_RECEIPT_RETENTION_SLOTS,
         }
     }
 
+    /// Override how many slots of receipts are retained
+    pub fn with_receipt_retention(mut self, slots: SlotNumber) -> Self {
+        self.receipt_retention_slots = slots.max(1);
+        self
+    }
+
     /// Submit a new transaction
     pub async fn submit_transaction(&self, transaction: Transaction) -> ServiceResult<TransactionHash> {
-        // Validate transaction
-        self.validate_transaction(&transaction)?;
-        
-        // Add to pool
-        let hash = self.pool.add_transaction(transaction).await?;
-        
-        Ok(hash)
+        self.submit_transaction_with_priority(transaction, 0).await
     }
 
-    /// Execute transactions in the current slot
-    pub async fn execute_slot_transactions(&self) -> ServiceResult<Vec<TransactionReceipt>> {
+    /// Submit a new transaction to be executed ahead of lower-priority ones
+    pub async fn submit_transaction_with_priority(
+        &self,
+        transaction: Transaction,
+        priority: u64,
+    ) -> ServiceResult<TransactionHash> {
+        metrics().time(Stage::Intake, || {
+            // Validate transaction
+            self.validate_transaction(&transaction)?;
+
+            // Add to pool
+            self.pool.add_transaction_with_priority(transaction, priority)
+        })
+    }
+
+    /// Execute up to `max_transactions` pending transactions in the current slot
+    ///
+    /// Receipts go to receipt storage, which keeps the last
+    /// `receipt_retention_slots` slots of them. Transactions that fail to
+    /// execute are dropped from the pool; if the whole batch dies, its
+    /// transactions are put back in the pool and the error is returned.
+    pub async fn execute_slot_transactions(&self, max_transactions: usize) -> ServiceResult<Vec<TransactionReceipt>> {
         let slot = *self.slot_number.read().await;
         let timestamp = chrono::Utc::now().timestamp() as u64;
         
-        // Get all pending transactions
-        let transactions = self.pool.get_pending_transactions().await;
+        // Take this slot's batch and run it through the scheduler
+        let batch = self.pool.drain_for_slot(max_transactions);
+        if batch.deferred > 0 {
+            log::debug!("Deferred {} contended transactions past slot {}", batch.deferred, slot);
+        }
+        let transactions: Arc<[Transaction]> = batch.transactions.into();
+        let results = match self.executor.execute_batch(Arc::clone(&transactions), slot, timestamp).await {
+            Ok(results) => results,
+            Err(e) => {
+                self.executor.finalize_slot(slot);
+                for transaction in transactions.iter() {
+                    if let Err(requeue) = self.pool.add_transaction(transaction.clone()) {
+                        log::error!("Dropped transaction {} after a failed batch: {:?}", hex::encode(transaction.hash), requeue);
+                    }
+                }
+                return Err(e);
+            }
+        };
         
-        let mut receipts = Vec::new();
-        for transaction in transactions {
-            let hash = transaction.hash;
-            
-            match self.executor.execute_transaction(transaction, slot, timestamp).await {
+        let receipts = self.storage.receipts();
+        let mut executed = Vec::new();
+        for (hash, result) in results {
+            match result {
                 Ok(receipt) => {
-                    // Remove from pool and store receipt
-                    self.pool.remove_transaction(&hash).await;
-                    self.pool.store_receipt(receipt.clone()).await;
-                    receipts.push(receipt);
+                    if let Err(e) = receipts.store_receipt(&receipt) {
+                        log::error!("Failed to store receipt for {}: {:?}", hex::encode(hash), e);
+                    }
+                    executed.push(receipt);
                 }
                 Err(e) => {
                     // Log error but continue with other transactions
@@ -246,26 +502,35 @@ impl TransactionService {
                 }
             }
         }
+        self.executor.finalize_slot(slot);
+
+        if slot >= self.receipt_retention_slots {
+            receipts.cleanup_receipts_before(slot - self.receipt_retention_slots + 1)?;
+        }
         
-        Ok(receipts)
+        Ok(executed)
     }
 
-    /// Get transaction from pool or receipts
+    /// Get a pending transaction from the pool
     pub async fn get_transaction(&self, hash: &TransactionHash) -> ServiceResult<Transaction> {
-        self.pool.get_transaction(hash).await
+        self.pool.get_transaction(hash)
             .ok_or_else(|| ServiceError::object_not_found(hex::encode(hash)))
     }
 
     /// Get transaction receipt
     pub async fn get_receipt(&self, hash: &TransactionHash) -> ServiceResult<TransactionReceipt> {
-        self.pool.get_receipt(hash).await
+        self.storage.receipts().get_receipt(hash)?
             .ok_or_else(|| ServiceError::object_not_found(hex::encode(hash)))
     }
 
     /// Advance to next slot
+    ///
+    /// Storage stamps writes with the new slot from here on, so once the
+    /// closed slot's state proof is stored nothing more is written for it.
     pub async fn advance_slot(&self) -> ServiceResult<SlotNumber> {
         let mut slot = self.slot_number.write().await;
         *slot += 1;
+        self.storage.inner().slot_clock().set(*slot);
         Ok(*slot)
     }
 
@@ -274,9 +539,14 @@ impl TransactionService {
         *self.slot_number.read().await
     }
 
+    /// Slot the service started in, after any slots recovered from storage
+    pub fn first_slot(&self) -> SlotNumber {
+        self.first_slot
+    }
+
     /// Get pool statistics
     pub async fn get_pool_stats(&self) -> PoolStats {
-        self.pool.get_stats().await
+        self.pool.get_stats()
     }
 
     /// Validate transaction before submission
@@ -296,4 +566,213 @@ impl TransactionService {
 
         Ok(())
     }
-}
\ No newline at end of file
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use units_core_types::Instruction;
+    use units_core_types::objects::VMType;
+    use units_runtime_impl::MockRuntime;
+
+    /// Transaction writing `writes`; `seed` picks its shard
+    fn transaction(seed: u8, writes: &[u8]) -> Transaction {
+        let mut hash = [0u8; 32];
+        hash[0] = seed;
+        hash[31] = 0xaa;
+        let targets = writes.iter().map(|w| UnitsObjectId::new([*w; 32])).collect();
+        let instruction = Instruction::new(UnitsObjectId::new([0u8; 32]), "run".to_string(), targets, vec![1]);
+        Transaction::new(vec![instruction], hash)
+    }
+
+    fn seeds(batch: &SlotBatch) -> Vec<u8> {
+        batch.transactions.iter().map(|transaction| transaction.hash[0]).collect()
+    }
+
+    #[test]
+    fn test_drain_orders_by_priority_then_arrival_across_shards() {
+        let pool = TransactionPool::new(16);
+        // Consecutive seeds land in different shards
+        pool.add_transaction_with_priority(transaction(1, &[1]), 0).unwrap();
+        pool.add_transaction_with_priority(transaction(2, &[2]), 5).unwrap();
+        pool.add_transaction_with_priority(transaction(3, &[3]), 0).unwrap();
+        pool.add_transaction_with_priority(transaction(4, &[4]), 5).unwrap();
+        pool.add_transaction_with_priority(transaction(5, &[5]), 9).unwrap();
+
+        let batch = pool.drain_for_slot(4);
+        assert_eq!(seeds(&batch), vec![5, 2, 4, 1]);
+        assert_eq!(pool.len(), 1);
+        assert_eq!(seeds(&pool.drain_for_slot(4)), vec![3]);
+        assert!(pool.is_empty());
+    }
+
+    #[test]
+    fn test_contended_writes_are_deferred_in_place() {
+        let pool = TransactionPool::new(16).with_max_writes_per_object(2);
+        pool.add_transaction(transaction(1, &[7])).unwrap();
+        pool.add_transaction(transaction(2, &[7])).unwrap();
+        pool.add_transaction(transaction(3, &[7, 8])).unwrap();
+        pool.add_transaction(transaction(4, &[8])).unwrap();
+
+        let batch = pool.drain_for_slot(4);
+        assert_eq!(seeds(&batch), vec![1, 2, 4]);
+        assert_eq!(batch.deferred, 1);
+
+        // The deferred transaction still drains ahead of later arrivals
+        pool.add_transaction(transaction(5, &[9])).unwrap();
+        assert_eq!(seeds(&pool.drain_for_slot(1)), vec![3]);
+    }
+
+    #[test]
+    fn test_resubmit_replaces_and_moves_to_back() {
+        let pool = TransactionPool::new(2);
+        pool.add_transaction(transaction(1, &[1])).unwrap();
+        pool.add_transaction(transaction(2, &[2])).unwrap();
+
+        // A full pool still accepts a replacement of a pending transaction
+        let mut replacement = transaction(1, &[3]);
+        replacement.instructions[0].params = vec![2];
+        pool.add_transaction(replacement).unwrap();
+        assert_eq!(pool.len(), 2);
+        assert_eq!(pool.get_transaction(&transaction(1, &[1]).hash).unwrap().instructions[0].params, vec![2]);
+
+        assert_eq!(seeds(&pool.drain_for_slot(2)), vec![2, 1]);
+        assert!(pool.is_empty());
+    }
+
+    #[test]
+    fn test_full_pool_rejects_new_transactions() {
+        let pool = TransactionPool::new(2);
+        pool.add_transaction(transaction(1, &[1])).unwrap();
+        pool.add_transaction(transaction(2, &[2])).unwrap();
+
+        let rejected = pool.add_transaction(transaction(3, &[3]));
+        assert!(matches!(rejected, Err(ServiceError::ServiceUnavailable { .. })));
+        assert_eq!(pool.len(), 2);
+
+        pool.remove_transaction(&transaction(1, &[1]).hash).unwrap();
+        pool.add_transaction(transaction(3, &[3])).unwrap();
+        assert_eq!(pool.get_stats().pending_count, 2);
+    }
+
+    #[tokio::test]
+    async fn test_receipts_are_trimmed_to_retention() {
+        let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+        let runtime: Arc<dyn Runtime + Send + Sync> = Arc::new(MockRuntime::new());
+        let service = TransactionService::new(runtime, storage.clone(), 16).with_receipt_retention(2);
+
+        for slot in 0..=5u64 {
+            let mut hash = [0u8; 32];
+            hash[0] = slot as u8;
+            storage.receipts().store_receipt(&TransactionReceipt::new(hash, slot, true, 0)).unwrap();
+        }
+        for _ in 0..5 {
+            service.advance_slot().await.unwrap();
+        }
+        service.execute_slot_transactions(8).await.unwrap();
+
+        let receipts = storage.receipts();
+        for slot in 0..=3 {
+            assert!(receipts.get_receipts_for_slot(slot).unwrap().is_empty(), "slot {} kept", slot);
+        }
+        for slot in 4..=5 {
+            assert_eq!(receipts.get_receipts_for_slot(slot).unwrap().len(), 1);
+        }
+    }
+
+    #[tokio::test]
+    async fn test_admitted_transactions_run_against_loaded_objects() {
+        let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+        let executor = TransactionExecutor::new(Arc::new(MockRuntime::new()), storage.clone());
+        let controller_id = UnitsObjectId::new([0; 32]);
+        // RVBC program: a0 = 0; a7 = sys_exit; ecall
+        let mut program = b"RVBC".to_vec();
+        program.extend_from_slice(&0u32.to_le_bytes());
+        for instruction in [0x0000_0513u32, 0x05d0_0893, 0x0000_0073] {
+            program.extend_from_slice(&instruction.to_le_bytes());
+        }
+        let controller = UnitsObject::new_executable(controller_id, controller_id, VMType::RiscV, program);
+        storage.objects().set(&controller, None).unwrap();
+        let target = UnitsObject::new_data(UnitsObjectId::new([1; 32]), controller_id, vec![1]);
+        storage.objects().set(&target, None).unwrap();
+
+        let receipt = executor.execute_transaction(transaction(1, &[1]), 3, 7).await.unwrap();
+        assert!(receipt.success, "{:?}", receipt.error_message);
+        assert_eq!(receipt.execution.instructions, 3);
+        assert_eq!((receipt.slot, receipt.timestamp), (3, 7));
+
+        // A missing target fails before the runtime is reached
+        let missing = executor.execute_transaction(transaction(2, &[9]), 3, 7).await;
+        assert!(matches!(missing, Err(ServiceError::ObjectNotFound { .. })));
+    }
+
+    /// Runtime whose transaction execution panics, killing the batch task
+    struct PanickingRuntime(MockRuntime);
+
+    impl Runtime for PanickingRuntime {
+        fn get_vm_executor(&self, vm_type: VMType) -> Option<Box<dyn units_core_types::VMExecutor>> {
+            self.0.get_vm_executor(vm_type)
+        }
+
+        fn execute_transaction(&self, _transaction: Transaction) -> TransactionReceipt {
+            panic!("runtime failure")
+        }
+
+        fn execute_transaction_with_objects(
+            &self,
+            _transaction: Transaction,
+            _objects: HashMap<UnitsObjectId, UnitsObject>,
+            _slot: u64,
+            _timestamp: u64,
+        ) -> TransactionReceipt {
+            panic!("runtime failure")
+        }
+
+        fn get_transaction(&self, hash: &TransactionHash) -> Option<Transaction> {
+            self.0.get_transaction(hash)
+        }
+
+        fn get_transaction_receipt(&self, hash: &TransactionHash) -> Option<TransactionReceipt> {
+            self.0.get_transaction_receipt(hash)
+        }
+
+        fn rollback_transaction(&self, hash: &TransactionHash) -> Result<bool, units_core_types::error::RuntimeError> {
+            self.0.rollback_transaction(hash)
+        }
+
+        fn get_verifier(&self) -> &dyn units_core_types::Verifier {
+            self.0.get_verifier()
+        }
+    }
+
+    #[tokio::test]
+    async fn test_failed_batch_is_put_back_in_the_pool() {
+        let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+        let runtime: Arc<dyn Runtime + Send + Sync> = Arc::new(PanickingRuntime(MockRuntime::new()));
+        let service = TransactionService::new(runtime, storage.clone(), 16);
+        let controller_id = UnitsObjectId::new([0; 32]);
+        for id in [[0u8; 32], [1; 32], [2; 32]] {
+            let object = UnitsObject::new_data(UnitsObjectId::new(id), controller_id, vec![1]);
+            storage.objects().set(&object, None).unwrap();
+        }
+        service.pool.add_transaction(transaction(1, &[1])).unwrap();
+        service.pool.add_transaction(transaction(2, &[2])).unwrap();
+
+        assert!(matches!(service.execute_slot_transactions(8).await, Err(ServiceError::Internal(_))));
+        assert_eq!(service.pool.len(), 2);
+        assert!(storage.receipts().get_receipts_for_slot(service.current_slot().await).unwrap().is_empty());
+    }
+
+    #[tokio::test]
+    async fn test_storage_stamps_writes_with_the_open_slot() {
+        let storage = Arc::new(ConsolidatedUnitsStorage::new_in_memory());
+        let runtime: Arc<dyn Runtime + Send + Sync> = Arc::new(MockRuntime::new());
+        let service = TransactionService::new(runtime, storage.clone(), 16);
+        let object = UnitsObject::new_data(UnitsObjectId::new([1; 32]), UnitsObjectId::new([0; 32]), vec![1]);
+
+        assert_eq!(storage.objects().set(&object, None).unwrap().slot, 0);
+        service.advance_slot().await.unwrap();
+        service.advance_slot().await.unwrap();
+        assert_eq!(storage.objects().set(&object, None).unwrap().slot, 2);
+    }
+}
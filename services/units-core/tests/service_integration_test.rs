@@ -109,13 +109,15 @@ async fn test_transaction_operations() {
         commitment_level: CommitmentLevel::Committed,
     };
     
-    // Submit transaction - this should work with minimal implementation
+    // Submit transaction into the pool
     let tx_hash = service.submit_transaction(transaction).await.expect("Failed to submit transaction");
     assert_eq!(tx_hash, [99u8; 32]);
     
-    // Try to get transaction (should fail in minimal implementation)
-    let result = service.get_transaction(&tx_hash).await;
-    assert!(result.is_err()); // Expected to fail in minimal implementation
+    // It stays pending until a slot executes it
+    let pending = service.get_transaction(&tx_hash).await.expect("Failed to get pending transaction");
+    assert_eq!(pending.hash, tx_hash);
+    assert!(service.get_transaction_receipt(&tx_hash).await.is_err());
+    assert_eq!(service.health_check().await.unwrap().pending_transactions, 1);
 }
 
 #[tokio::test]
@@ -130,9 +132,10 @@ async fn test_slot_operations() {
     let current_slot = service.get_current_slot().await.expect("Failed to get current slot");
     assert_eq!(current_slot, 0);
     
-    // Try to advance slot (minimal implementation returns fixed value)
+    // Advance slot
     let new_slot = service.advance_slot().await.expect("Failed to advance slot");
-    assert_eq!(new_slot, 1); // Minimal implementation returns 1
+    assert_eq!(new_slot, 1);
+    assert_eq!(service.get_current_slot().await.unwrap(), 1);
 }
 
 #[tokio::test]